@@ -269,7 +269,7 @@ bool CApplication::InternOnFrame()
 
 // -----------------------------------------------------------------------------
 
-void main()
+int main()
 {
     CApplication Application;
 
@@ -70,7 +70,7 @@ float iterateMandelbrot(float2 _coord, int _maxIterations)
     {
         z = squareImganiary(z) + _coord;
         if (length(z) > 2)
-            return i / _maxIterations;
+            return (float) i / _maxIterations;
 
     }
     return _maxIterations;
@@ -176,6 +176,29 @@ namespace gfx
     void DrawMesh(BHandle _pMesh);
 } // namespace gfx
 
+namespace gfx
+{
+    void CreateCommandList(BHandle* _ppCommandList);
+    void ReleaseCommandList(BHandle _pCommandList);
+
+    void SubmitCommandList(BHandle _pCommandList);
+    void WaitForCommandLists();
+
+    void SetDepthTest(BHandle _pCommandList, SDepthTest::ETest _Test);
+    void SetWireFrame(BHandle _pCommandList, bool _Flag);
+    void SetAlphaBlending(BHandle _pCommandList, bool _Flag);
+
+    void UploadConstantBuffer(BHandle _pCommandList, void* _pData, BHandle _pConstantBuffer);
+
+    void ResetRenderTargets(BHandle _pCommandList);
+    void SetRenderTargets(BHandle _pCommandList, BHandle* _ppColorTargets, int _NumberOfColorTargets, BHandle _pDepthTarget);
+
+    void ClearColorTarget(BHandle _pCommandList, BHandle _pTexture, const float* _pColor);
+    void ClearDepthTarget(BHandle _pCommandList, BHandle _pTexture, float _Depth);
+
+    void DrawMesh(BHandle _pCommandList, BHandle _pMesh);
+} // namespace gfx
+
 namespace gfx
 {
     float GetDotProduct2D(const float* _pVector1, const float* _pVector2);
@@ -413,7 +413,7 @@ bool CApplication::InternOnFrame()
 
 // -----------------------------------------------------------------------------
 
-void main()
+int main()
 {
 	CApplication Application;
 
@@ -354,7 +354,7 @@ bool CMandelbrot::InternOnFrame()
 
 // -----------------------------------------------------------------------------
 
-void main()
+int main()
 {
 	CMandelbrot Application;
 
@@ -532,7 +532,7 @@ bool CApplication::InternOnFrame()
 
 // -----------------------------------------------------------------------------
 
-void main()
+int main()
 {
     CApplication Application;
 
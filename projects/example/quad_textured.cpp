@@ -346,7 +346,7 @@ bool CApplication::InternOnFrame()
 
 // -----------------------------------------------------------------------------
 
-void main()
+int main()
 {
     CApplication Application;
 
@@ -337,7 +337,7 @@ bool CApplication::InternOnFrame()
 
 // -----------------------------------------------------------------------------
 
-void main()
+int main()
 {
     CApplication Application;
 
@@ -1,13 +1,61 @@
 #include "CApplication.h"
 
+#include <algorithm>
 #include <iostream>
 
+namespace
+{
+    const int          s_ProbeWidth             = 160;      // The height follows from the aspect ratio of the window.
+    const unsigned int s_HeadlessNumberOfSteps  = 4;        // Steps of the probe per frame on the headless backend.
+
+    // -----------------------------------------------------------------------------
+    // The probe is iterated on the main thread before the frame is drawn, so
+    // it only gets a small part of the frame time. The headless backend renders
+    // a given number of frames, there every frame gets the same steps instead,
+    // so the frames do not depend on the speed of the machine.
+    // -----------------------------------------------------------------------------
+    SMandelbrotIterationControl GetProbeControl()
+    {
+        SMandelbrotIterationControl Control;
+
+        GetMandelbrotIterationControl(&Control);
+
+        Control.m_MinIteration  = 1;
+        Control.m_BudgetSeconds = 0.002;
+
+#if defined(YOSHIX_HEADLESS)
+        Control.m_NumberOfSteps = s_HeadlessNumberOfSteps;
+#endif
+
+        return Control;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void GetProbeSettings(int _Width, int _Height, SMandelbrotSettings* _pSettings)
+    {
+        PSPerObjectConstants Constants;
+
+        Constants.m_PSColor[0]     = 0.95f; //R
+        Constants.m_PSColor[1]     = 0.25f; //G
+        Constants.m_PSColor[2]     = 0.0f;  //B
+        Constants.m_PSMaxIteration = 1;
+
+        GetMandelbrotSettings(s_ProbeWidth, std::max(s_ProbeWidth * _Height / std::max(_Width, 1), 1), Constants, _pSettings);
+    }
+} // namespace
+
+// -----------------------------------------------------------------------------
+
 CApplication::CApplication()
     : m_Position{ 0.0f, 0.0f, 0.0f }
     , m_FieldOfViewY(60.0f)        // Set the vertical view angle of the camera to 60 degrees.
-    , m_ticks(0)
     , m_MaxIteration(1)
+    , m_ProbeSettings()
+    , m_ProbeRenderer(1)
+    , m_MaxIterationController(GetProbeControl())
 {
+    GetProbeSettings(800, 600, &m_ProbeSettings);
 }
 
 // -----------------------------------------------------------------------------
@@ -143,6 +191,10 @@ bool CApplication::InternOnResize(int _Width, int _Height)
 
     gfx::GetProjectionMatrix(60.0f, AspectRatio, 0.01f, 1000.0f, m_ProjectionMatrix);
 
+    GetProbeSettings(_Width, _Height, &m_ProbeSettings);
+
+    m_MaxIterationController.Restart();
+
     return true;
 }
 
@@ -178,6 +230,17 @@ bool CApplication::InternOnFrame()
 
     PSPerObjectConstants PerObjectConstantsPS;
 
+    // -----------------------------------------------------------------------------
+    // The maximum iteration grows with the details the probe still finds and
+    // stays once the view is resolved.
+    // -----------------------------------------------------------------------------
+    if (!m_MaxIterationController.IsResolved())
+    {
+        m_MaxIterationController.Update(m_ProbeRenderer, m_ProbeSettings);
+
+        m_MaxIteration = std::max(static_cast<int>(m_MaxIterationController.GetMaxIteration()), 1);
+    }
+
     switch (m_MaxIteration % 4)
     {
     case 0:
@@ -207,13 +270,6 @@ bool CApplication::InternOnFrame()
         break;
     }
 
-    m_ticks++;
-    if (m_ticks == 10)
-    {
-        m_ticks = 0;
-        m_MaxIteration++;
-    }
-
     PerObjectConstantsPS.m_PSMaxIteration = m_MaxIteration;
 
     gfx::UploadConstantBuffer(&PerObjectConstantsPS, m_pPSPerObjectConstants);
@@ -2,6 +2,8 @@
 
 #include "yoshix.h"
 
+#include "CMandelbrotIterationController.h"
+#include "CMandelbrotRenderer.h"
 #include "SVSConstantsMandelbrot.h"
 #include "SPSConstantsMandelbrot.h"
 
@@ -14,9 +16,13 @@ public:
     virtual ~CApplication();
 
 private:
-    int             m_ticks;
     int             m_MaxIteration;
 
+private:
+    SMandelbrotSettings            m_ProbeSettings;             // The view of the window in a few pixels.
+    CMandelbrotRenderer            m_ProbeRenderer;
+    CMandelbrotIterationController m_MaxIterationController;    // Raises m_MaxIteration as long as the probe shows new details.
+
 private:
     float           m_Position[3];
     float           m_FieldOfViewY;             // Vertical view angle of the camera
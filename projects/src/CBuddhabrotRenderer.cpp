@@ -0,0 +1,330 @@
+#include "CBuddhabrotRenderer.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // -----------------------------------------------------------------------------
+    // Points handed out at once to a worker. The densities of the workers are
+    // merged at least every s_MaxBatchesPerMerge batches, so a 32 bit count of
+    // a pixel can not overflow in practice.
+    // -----------------------------------------------------------------------------
+    const int          s_NumberOfSamplesPerBatch = 4096;
+    const int          s_MaxBatchesPerMerge      = 4096;
+
+    // -----------------------------------------------------------------------------
+    // Rows handed out at once to the workers by the merge and the color mapping.
+    // -----------------------------------------------------------------------------
+    const int          s_NumberOfRowsPerBand = 16;
+
+    const unsigned int s_DefaultMinIteration = 20;
+    const double       s_DefaultExtent       = 3.2;         // Of the shorter side of the image in the complex plane.
+
+    // -----------------------------------------------------------------------------
+    // SplitMix64, which is fast and turns the consecutive seeds of the batches
+    // into independent streams.
+    // -----------------------------------------------------------------------------
+    unsigned long long GetNextRandom(unsigned long long* _pState)
+    {
+        unsigned long long Value = (*_pState += 0x9E3779B97F4A7C15ull);
+
+        Value = (Value ^ (Value >> 30)) * 0xBF58476D1CE4E5B9ull;
+        Value = (Value ^ (Value >> 27)) * 0x94D049BB133111EBull;
+
+        return Value ^ (Value >> 31);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    double GetNextUniform(unsigned long long* _pState)
+    {
+        return static_cast<double>(GetNextRandom(_pState) >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    unsigned char GetColorChannel(float _Value)
+    {
+        return static_cast<unsigned char>(std::min(std::max(_Value, 0.0f), 1.0f) * 255.0f + 0.5f);
+    }
+} // namespace
+
+// -----------------------------------------------------------------------------
+
+void GetBuddhabrotSettings(int _Width, int _Height, unsigned int _MaxIteration, SBuddhabrotSettings* _pSettings)
+{
+    _pSettings->m_Width        = _Width;
+    _pSettings->m_Height       = _Height;
+    _pSettings->m_Center[0]    = -0.5;
+    _pSettings->m_Center[1]    = 0.0;
+    _pSettings->m_PixelSize    = s_DefaultExtent / std::max(std::min(_Width, _Height), 1);
+    _pSettings->m_MinIteration = std::min(s_DefaultMinIteration, _MaxIteration);
+    _pSettings->m_MaxIteration = _MaxIteration;
+    _pSettings->m_Color[0]     = 1.0f;
+    _pSettings->m_Color[1]     = 1.0f;
+    _pSettings->m_Color[2]     = 1.0f;
+    _pSettings->m_Seed         = 0;
+}
+
+// -----------------------------------------------------------------------------
+
+CBuddhabrotRenderer::CBuddhabrotRenderer(int _NumberOfThreads)
+    : m_Scheduler(_NumberOfThreads)
+    , m_Settings()
+    , m_pAdvancePixels(GetMandelbrotKernel().m_pAdvancePixelsDouble)
+    , m_NumberOfBatches(0)
+    , m_Density()
+    , m_ThreadDensities(m_Scheduler.GetNumberOfThreads())
+    , m_ThreadNumberOfOrbits(m_Scheduler.GetNumberOfThreads(), 0)
+{
+    m_Settings.m_Width = 0;
+}
+
+// -----------------------------------------------------------------------------
+
+CBuddhabrotRenderer::~CBuddhabrotRenderer()
+{
+}
+
+// -----------------------------------------------------------------------------
+
+int CBuddhabrotRenderer::GetNumberOfThreads() const
+{
+    return m_Scheduler.GetNumberOfThreads();
+}
+
+// -----------------------------------------------------------------------------
+
+bool CBuddhabrotRenderer::Start(const SBuddhabrotSettings& _rSettings)
+{
+    if (_rSettings.m_Width <= 0 || _rSettings.m_Height <= 0 || _rSettings.m_PixelSize <= 0.0 || _rSettings.m_MinIteration > _rSettings.m_MaxIteration) return false;
+
+    size_t NumberOfPixels = static_cast<size_t>(_rSettings.m_Width) * static_cast<size_t>(_rSettings.m_Height);
+
+    m_Settings        = _rSettings;
+    m_NumberOfBatches = 0;
+
+    m_Density.assign(NumberOfPixels, 0);
+
+    for (std::vector<unsigned int>& rDensity : m_ThreadDensities)
+    {
+        rDensity.assign(NumberOfPixels, 0);
+    }
+
+    std::fill(m_ThreadNumberOfOrbits.begin(), m_ThreadNumberOfOrbits.end(), 0);
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool CBuddhabrotRenderer::Advance(unsigned long long _NumberOfSamples)
+{
+    if (m_Settings.m_Width == 0) return false;
+
+    unsigned long long NumberOfBatches = (_NumberOfSamples + s_NumberOfSamplesPerBatch - 1) / s_NumberOfSamplesPerBatch;
+
+    while (NumberOfBatches > 0)
+    {
+        int NumberOfRoundBatches = static_cast<int>(std::min<unsigned long long>(NumberOfBatches, s_MaxBatchesPerMerge));
+
+        unsigned long long FirstBatch = m_NumberOfBatches;
+
+        m_Scheduler.Run(NumberOfRoundBatches, [&](int _Batch, int _Thread)
+        {
+            SampleBatch(FirstBatch + _Batch, _Thread);
+        });
+
+        MergeDensities();
+
+        m_NumberOfBatches += NumberOfRoundBatches;
+        NumberOfBatches   -= NumberOfRoundBatches;
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+void CBuddhabrotRenderer::GetImage(SMandelbrotImage* _pImage)
+{
+    size_t NumberOfPixels = m_Density.size();
+
+    _pImage->m_Width  = m_Settings.m_Width;
+    _pImage->m_Height = m_Settings.m_Height;
+
+    _pImage->m_Iterations.clear();
+    _pImage->m_SmoothIterations.clear();
+    _pImage->m_Coverage.clear();
+    _pImage->m_Pixels.resize(NumberOfPixels * 4);
+
+    if (NumberOfPixels == 0) return;
+
+    // -----------------------------------------------------------------------------
+    // The density falls off steeply away from the set, the square root keeps
+    // the faint orbits visible next to the bright ones.
+    // -----------------------------------------------------------------------------
+    unsigned long long MaxDensity = *std::max_element(m_Density.begin(), m_Density.end());
+
+    float Scale = MaxDensity > 0 ? 1.0f / std::sqrt(static_cast<float>(MaxDensity)) : 0.0f;
+
+    int NumberOfBands = (m_Settings.m_Height + s_NumberOfRowsPerBand - 1) / s_NumberOfRowsPerBand;
+
+    m_Scheduler.Run(NumberOfBands, [&](int _Band, int)
+    {
+        int MinY = _Band * s_NumberOfRowsPerBand;
+        int MaxY = std::min(MinY + s_NumberOfRowsPerBand, m_Settings.m_Height);
+
+        size_t First = static_cast<size_t>(MinY) * m_Settings.m_Width;
+        size_t Last  = static_cast<size_t>(MaxY) * m_Settings.m_Width;
+
+        for (size_t IndexOfPixel = First; IndexOfPixel < Last; ++IndexOfPixel)
+        {
+            float Brightness = std::sqrt(static_cast<float>(m_Density[IndexOfPixel])) * Scale;
+
+            unsigned char* pPixel = &_pImage->m_Pixels[IndexOfPixel * 4];
+
+            pPixel[0] = GetColorChannel(m_Settings.m_Color[0] * Brightness);
+            pPixel[1] = GetColorChannel(m_Settings.m_Color[1] * Brightness);
+            pPixel[2] = GetColorChannel(m_Settings.m_Color[2] * Brightness);
+            pPixel[3] = 255;
+        }
+    });
+}
+
+// -----------------------------------------------------------------------------
+
+const std::vector<unsigned long long>& CBuddhabrotRenderer::GetDensity() const
+{
+    return m_Density;
+}
+
+// -----------------------------------------------------------------------------
+
+unsigned long long CBuddhabrotRenderer::GetNumberOfSamples() const
+{
+    return m_NumberOfBatches * s_NumberOfSamplesPerBatch;
+}
+
+// -----------------------------------------------------------------------------
+
+unsigned long long CBuddhabrotRenderer::GetNumberOfOrbits() const
+{
+    unsigned long long NumberOfOrbits = 0;
+
+    for (unsigned long long ThreadNumberOfOrbits : m_ThreadNumberOfOrbits) NumberOfOrbits += ThreadNumberOfOrbits;
+
+    return NumberOfOrbits;
+}
+
+// -----------------------------------------------------------------------------
+
+void CBuddhabrotRenderer::SampleBatch(unsigned long long _Batch, int _Thread)
+{
+    thread_local std::vector<SMandelbrotPixel> s_Pixels;
+
+    s_Pixels.resize(s_NumberOfSamplesPerBatch);
+
+    // -----------------------------------------------------------------------------
+    // c is uniform in the upper half of the square from -2 - 2i to 2 + 2i,
+    // outside of it every orbit escapes in the first iteration. The stream of
+    // random numbers only depends on the seed and the batch.
+    // -----------------------------------------------------------------------------
+    unsigned long long State = m_Settings.m_Seed ^ (_Batch * 0xD1B54A32D192ED03ull);
+
+    for (int IndexOfSample = 0; IndexOfSample < s_NumberOfSamplesPerBatch; ++IndexOfSample)
+    {
+        SMandelbrotPixel& rPixel = s_Pixels[IndexOfSample];
+
+        rPixel.m_C[0]         = -2.0 + 4.0 * GetNextUniform(&State);
+        rPixel.m_C[1]         = 2.0 * GetNextUniform(&State);
+        rPixel.m_Z[0]         = 0.0;
+        rPixel.m_Z[1]         = 0.0;
+        rPixel.m_Iteration    = 0;
+        rPixel.m_IsEscaped    = 0;
+        rPixel.m_IndexOfPixel = static_cast<unsigned int>(IndexOfSample);
+    }
+
+    SMandelbrotInteriorStatistics Statistics = SMandelbrotInteriorStatistics();
+
+    m_pAdvancePixels(s_Pixels.data(), s_NumberOfSamplesPerBatch, m_Settings.m_MaxIteration, true, &Statistics);
+
+    // -----------------------------------------------------------------------------
+    // An escaped point keeps the last iteration its orbit was inside, so the
+    // orbit is replayed one step further to the first point outside. Pixel
+    // centers lie on whole multiples of the pixel size from the top left one.
+    // -----------------------------------------------------------------------------
+    unsigned int* pDensity = m_ThreadDensities[_Thread].data();
+
+    int    Width       = m_Settings.m_Width;
+    int    Height      = m_Settings.m_Height;
+    double InverseSize = 1.0 / m_Settings.m_PixelSize;
+    double Left        = m_Settings.m_Center[0] - m_Settings.m_PixelSize * 0.5 * (Width - 1);
+    double Top         = m_Settings.m_Center[1] + m_Settings.m_PixelSize * 0.5 * (Height - 1);
+
+    unsigned long long NumberOfOrbits = 0;
+
+    for (const SMandelbrotPixel& rPixel : s_Pixels)
+    {
+        if (rPixel.m_IsEscaped == 0 || rPixel.m_Iteration < m_Settings.m_MinIteration) continue;
+
+        ++NumberOfOrbits;
+
+        double CX = rPixel.m_C[0];
+        double CY = rPixel.m_C[1];
+        double ZX = 0.0;
+        double ZY = 0.0;
+
+        for (unsigned int Iteration = 0; Iteration <= rPixel.m_Iteration; ++Iteration)
+        {
+            double X2 = ZX * ZX;
+            double Y2 = ZY * ZY;
+
+            ZY = 2.0 * ZX * ZY + CY;
+            ZX = X2 - Y2 + CX;
+
+            double X = std::floor((ZX - Left) * InverseSize + 0.5);
+
+            if (X < 0.0 || X >= Width) continue;
+
+            double Y       = std::floor((Top - ZY) * InverseSize + 0.5);
+            double YMirror = std::floor((Top + ZY) * InverseSize + 0.5);
+
+            if (Y       >= 0.0 && Y       < Height) ++pDensity[static_cast<size_t>(Y)       * Width + static_cast<size_t>(X)];
+            if (YMirror >= 0.0 && YMirror < Height) ++pDensity[static_cast<size_t>(YMirror) * Width + static_cast<size_t>(X)];
+        }
+    }
+
+    m_ThreadNumberOfOrbits[_Thread] += NumberOfOrbits;
+}
+
+// -----------------------------------------------------------------------------
+
+void CBuddhabrotRenderer::MergeDensities()
+{
+    // -----------------------------------------------------------------------------
+    // Every band of rows is summed over all workers and cleared, so the merge
+    // runs on all cores and every worker starts again with an empty density.
+    // -----------------------------------------------------------------------------
+    int NumberOfBands = (m_Settings.m_Height + s_NumberOfRowsPerBand - 1) / s_NumberOfRowsPerBand;
+
+    m_Scheduler.Run(NumberOfBands, [&](int _Band, int)
+    {
+        int MinY = _Band * s_NumberOfRowsPerBand;
+        int MaxY = std::min(MinY + s_NumberOfRowsPerBand, m_Settings.m_Height);
+
+        size_t First = static_cast<size_t>(MinY) * m_Settings.m_Width;
+        size_t Last  = static_cast<size_t>(MaxY) * m_Settings.m_Width;
+
+        for (std::vector<unsigned int>& rThreadDensity : m_ThreadDensities)
+        {
+            for (size_t IndexOfPixel = First; IndexOfPixel < Last; ++IndexOfPixel)
+            {
+                m_Density[IndexOfPixel] += rThreadDensity[IndexOfPixel];
+            }
+
+            std::fill(rThreadDensity.begin() + First, rThreadDensity.begin() + Last, 0u);
+        }
+    });
+}
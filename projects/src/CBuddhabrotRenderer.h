@@ -0,0 +1,84 @@
+#pragma once
+
+#include "CTileScheduler.h"
+#include "MandelbrotKernel.h"
+#include "SMandelbrotSettings.h"
+
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// The view and the sampling of a Buddhabrot. The view is laid out like the one
+// of SMandelbrotSettings, row 0 is the top of the image.
+// -----------------------------------------------------------------------------
+
+struct SBuddhabrotSettings
+{
+    int                m_Width;
+    int                m_Height;
+    double             m_Center[2];                 // Real and imaginary part of the point in the center of the image.
+    double             m_PixelSize;
+    unsigned int       m_MinIteration;              // Orbits which escape earlier are not drawn, they only add a haze around the set.
+    unsigned int       m_MaxIteration;              // Points which are still bound after this many iterations count as part of the set and are not drawn.
+    float              m_Color[3];                  // Color of the densest pixel.
+    unsigned long long m_Seed;                      // The same seed gives the same density on any number of threads.
+};
+
+// -----------------------------------------------------------------------------
+// The whole set in an image of the given size.
+// -----------------------------------------------------------------------------
+
+void GetBuddhabrotSettings(int _Width, int _Height, unsigned int _MaxIteration, SBuddhabrotSettings* _pSettings);
+
+// -----------------------------------------------------------------------------
+// Renders the density of the orbits of the points outside the Mandelbrot set
+// (Buddhabrot). Random points c above the real axis are iterated in batches
+// with the kernels of the escape time renderer, which skip the cardioid and
+// the bulb and vectorize the bound points. Only the few points that escape are
+// iterated once more and their orbit is drawn into the density, mirrored at
+// the real axis for the point conj(c).
+//
+// Every worker draws into a density of its own and the densities are merged
+// at the end of Advance, so the workers share no memory while they sample. This
+// costs a 32 bit density per worker. Calling Advance again refines the image
+// progressively, GetImage can be called in between for a preview.
+// -----------------------------------------------------------------------------
+
+class CBuddhabrotRenderer
+{
+public:
+
+    explicit CBuddhabrotRenderer(int _NumberOfThreads = 0);
+    ~CBuddhabrotRenderer();
+
+    CBuddhabrotRenderer(const CBuddhabrotRenderer&) = delete;
+    CBuddhabrotRenderer& operator = (const CBuddhabrotRenderer&) = delete;
+
+public:
+
+    int GetNumberOfThreads() const;
+
+    bool Start(const SBuddhabrotSettings& _rSettings);                             // Clears the density.
+    bool Advance(unsigned long long _NumberOfSamples);                              // Samples more points, rounded up to whole batches, and merges them into the density.
+
+    void GetImage(SMandelbrotImage* _pImage);                                       // Maps the density onto m_Pixels, the iteration buffers of the image stay empty.
+
+    const std::vector<unsigned long long>& GetDensity() const;                      // Orbit points per pixel.
+
+    unsigned long long GetNumberOfSamples() const;
+    unsigned long long GetNumberOfOrbits() const;                                   // Samples whose orbit was drawn.
+
+private:
+
+    CTileScheduler                         m_Scheduler;
+    SBuddhabrotSettings                    m_Settings;                              // m_Width == 0 before Start.
+    FAdvancePixels                         m_pAdvancePixels;
+    unsigned long long                     m_NumberOfBatches;                       // Batches sampled since Start, the index of a batch seeds its random numbers.
+    std::vector<unsigned long long>        m_Density;
+    std::vector<std::vector<unsigned int>> m_ThreadDensities;                       // One per worker, cleared by every merge.
+    std::vector<unsigned long long>        m_ThreadNumberOfOrbits;                  // One per worker, only updated once per batch.
+
+private:
+
+    void SampleBatch(unsigned long long _Batch, int _Thread);
+    void MergeDensities();
+};
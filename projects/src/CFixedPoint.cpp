@@ -0,0 +1,359 @@
+#include "CFixedPoint.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // -----------------------------------------------------------------------------
+    // Limbs below this many positions under the last kept limb are skipped in
+    // the multiplication. Their sum can not reach the last kept limb.
+    // -----------------------------------------------------------------------------
+    const int s_NumberOfGuardLimbs = 2;
+
+    // -----------------------------------------------------------------------------
+    // Larger exponents are clamped, they leave nothing but 0 or an overflow.
+    // -----------------------------------------------------------------------------
+    const int s_MaxExponent = 1000000;
+} // namespace
+
+// -----------------------------------------------------------------------------
+
+int CFixedPoint::GetNumberOfLimbs(int _NumberOfFractionBits)
+{
+    return (_NumberOfFractionBits + 31) / 32 + 1;
+}
+
+// -----------------------------------------------------------------------------
+
+CFixedPoint::CFixedPoint(int _NumberOfLimbs)
+    : m_IsNegative(false)
+    , m_Limbs(_NumberOfLimbs < 2 ? 2 : _NumberOfLimbs, 0u)
+{
+}
+
+// -----------------------------------------------------------------------------
+
+CFixedPoint::CFixedPoint(double _Value, int _NumberOfLimbs)
+    : m_IsNegative(_Value < 0.0)
+    , m_Limbs(_NumberOfLimbs < 2 ? 2 : _NumberOfLimbs, 0u)
+{
+    double Magnitude = std::fabs(_Value);
+
+    // -----------------------------------------------------------------------------
+    // Peel off 32 bits at a time, starting with the integer part. A double has
+    // at most 53 significant bits, so this stops after a few limbs.
+    // -----------------------------------------------------------------------------
+    for (int IndexOfLimb = static_cast<int>(m_Limbs.size()) - 1; IndexOfLimb >= 0 && Magnitude > 0.0; --IndexOfLimb)
+    {
+        double Limb = std::floor(Magnitude);
+
+        m_Limbs[IndexOfLimb] = static_cast<uint32_t>(Limb);
+
+        Magnitude = (Magnitude - Limb) * 4294967296.0;
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+bool CFixedPoint::SetFromString(const char* _pText)
+{
+    const char* pText = _pText;
+
+    while (*pText == ' ') ++pText;
+
+    bool IsNegative = *pText == '-';
+
+    if (*pText == '-' || *pText == '+') ++pText;
+
+    // -----------------------------------------------------------------------------
+    // Collect the digits of the mantissa without its point. The point is in
+    // front of the digit at PointPosition, an exponent moves it.
+    // -----------------------------------------------------------------------------
+    std::string Digits;
+
+    for (; *pText >= '0' && *pText <= '9'; ++pText) Digits.push_back(*pText);
+
+    int PointPosition = static_cast<int>(Digits.size());
+
+    if (*pText == '.')
+    {
+        for (++pText; *pText >= '0' && *pText <= '9'; ++pText) Digits.push_back(*pText);
+    }
+
+    if (Digits.empty()) return false;
+
+    if (*pText == 'e' || *pText == 'E')
+    {
+        ++pText;
+
+        bool IsExponentNegative = *pText == '-';
+
+        if (*pText == '-' || *pText == '+') ++pText;
+
+        if (*pText < '0' || *pText > '9') return false;
+
+        int Exponent = 0;
+
+        for (; *pText >= '0' && *pText <= '9'; ++pText) Exponent = std::min(Exponent * 10 + (*pText - '0'), s_MaxExponent);
+
+        PointPosition += IsExponentNegative ? -Exponent : Exponent;
+    }
+
+    if (*pText != '\0' && *pText != ' ') return false;
+
+    int NumberOfDigits = static_cast<int>(Digits.size());
+
+    auto GetDigit = [&](int _Position) { return _Position >= 0 && _Position < NumberOfDigits ? static_cast<uint32_t>(Digits[_Position] - '0') : 0u; };
+
+    uint64_t IntegerPart = 0;
+
+    for (int Position = 0; Position < PointPosition; ++Position)
+    {
+        IntegerPart = IntegerPart * 10u + GetDigit(Position);
+
+        if (IntegerPart > UINT32_MAX) return false;
+    }
+
+    // -----------------------------------------------------------------------------
+    // Build the fraction from its last digit on: f = (f + digit) / 10. Leading
+    // zeros beyond the last limb would leave all limbs 0 and are skipped.
+    // -----------------------------------------------------------------------------
+    std::fill(m_Limbs.begin(), m_Limbs.end(), 0u);
+
+    int IndexOfInteger     = static_cast<int>(m_Limbs.size()) - 1;
+    int FirstFractionDigit = std::max(PointPosition, -10 * static_cast<int>(m_Limbs.size()));
+
+    for (int Position = NumberOfDigits - 1; Position >= FirstFractionDigit; --Position)
+    {
+        uint64_t Remainder = GetDigit(Position);
+
+        for (int IndexOfLimb = IndexOfInteger - 1; IndexOfLimb >= 0; --IndexOfLimb)
+        {
+            uint64_t Value = (Remainder << 32) | m_Limbs[IndexOfLimb];
+
+            m_Limbs[IndexOfLimb] = static_cast<uint32_t>(Value / 10u);
+
+            Remainder = Value % 10u;
+        }
+    }
+
+    m_Limbs[IndexOfInteger] = static_cast<uint32_t>(IntegerPart);
+    m_IsNegative            = IsNegative && !IsZero();
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+double CFixedPoint::ToDouble() const
+{
+    double Result = 0.0;
+    double Scale  = 1.0;
+    int    NumberOfSignificantLimbs = 0;
+
+    for (int IndexOfLimb = static_cast<int>(m_Limbs.size()) - 1; IndexOfLimb >= 0 && NumberOfSignificantLimbs < 3; --IndexOfLimb)
+    {
+        Result += m_Limbs[IndexOfLimb] * Scale;
+        Scale  *= 1.0 / 4294967296.0;
+
+        if (Result != 0.0) ++NumberOfSignificantLimbs;
+    }
+
+    return m_IsNegative ? -Result : Result;
+}
+
+// -----------------------------------------------------------------------------
+
+void CFixedPoint::ToDoubles(double* _pParts, int _NumberOfParts) const
+{
+    CFixedPoint Remainder = *this;
+
+    // -----------------------------------------------------------------------------
+    // Every part is the remainder of the previous ones rounded to a double.
+    // The conversion of a double back to a fixed point is exact.
+    // -----------------------------------------------------------------------------
+    for (int IndexOfPart = 0; IndexOfPart < _NumberOfParts; ++IndexOfPart)
+    {
+        _pParts[IndexOfPart] = Remainder.ToDouble();
+
+        Sub(Remainder, CFixedPoint(_pParts[IndexOfPart], static_cast<int>(m_Limbs.size())), &Remainder);
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+int CFixedPoint::GetNumberOfLimbs() const
+{
+    return static_cast<int>(m_Limbs.size());
+}
+
+// -----------------------------------------------------------------------------
+
+void CFixedPoint::Add(const CFixedPoint& _rLeft, const CFixedPoint& _rRight, CFixedPoint* _pResult)
+{
+    if (_rLeft.m_IsNegative == _rRight.m_IsNegative)
+    {
+        bool IsNegative = _rLeft.m_IsNegative;
+
+        AddMagnitude(_rLeft, _rRight, _pResult);
+
+        _pResult->m_IsNegative = IsNegative;
+    }
+    else if (CompareMagnitude(_rLeft, _rRight) >= 0)
+    {
+        bool IsNegative = _rLeft.m_IsNegative;
+
+        SubMagnitude(_rLeft, _rRight, _pResult);
+
+        _pResult->m_IsNegative = IsNegative;
+    }
+    else
+    {
+        bool IsNegative = _rRight.m_IsNegative;
+
+        SubMagnitude(_rRight, _rLeft, _pResult);
+
+        _pResult->m_IsNegative = IsNegative;
+    }
+
+    if (_pResult->m_IsNegative && _pResult->IsZero()) _pResult->m_IsNegative = false;
+}
+
+// -----------------------------------------------------------------------------
+
+void CFixedPoint::Sub(const CFixedPoint& _rLeft, const CFixedPoint& _rRight, CFixedPoint* _pResult)
+{
+    CFixedPoint Negated = _rRight;
+
+    Negated.m_IsNegative = !Negated.m_IsNegative;
+
+    Add(_rLeft, Negated, _pResult);
+}
+
+// -----------------------------------------------------------------------------
+
+void CFixedPoint::Mul(const CFixedPoint& _rLeft, const CFixedPoint& _rRight, CFixedPoint* _pResult)
+{
+    int NumberOfLimbs = static_cast<int>(_rLeft.m_Limbs.size());
+
+    // -----------------------------------------------------------------------------
+    // Full product limb k has the weight of result limb k - (NumberOfLimbs - 1).
+    // Products which only reach limbs far below the kept ones are skipped.
+    // -----------------------------------------------------------------------------
+    thread_local std::vector<uint32_t> s_Product;
+
+    s_Product.assign(2 * NumberOfLimbs, 0u);
+
+    int FirstKeptLimb = NumberOfLimbs - 1;
+    int FirstSumLimb  = FirstKeptLimb - s_NumberOfGuardLimbs;
+
+    for (int IndexOfLeft = 0; IndexOfLeft < NumberOfLimbs; ++IndexOfLeft)
+    {
+        uint64_t Left = _rLeft.m_Limbs[IndexOfLeft];
+
+        if (Left == 0) continue;
+
+        int FirstRight = FirstSumLimb - IndexOfLeft;
+
+        if (FirstRight < 0) FirstRight = 0;
+
+        uint64_t Carry = 0;
+
+        for (int IndexOfRight = FirstRight; IndexOfRight < NumberOfLimbs; ++IndexOfRight)
+        {
+            uint64_t Value = s_Product[IndexOfLeft + IndexOfRight] + Left * _rRight.m_Limbs[IndexOfRight] + Carry;
+
+            s_Product[IndexOfLeft + IndexOfRight] = static_cast<uint32_t>(Value);
+
+            Carry = Value >> 32;
+        }
+
+        for (int IndexOfProduct = IndexOfLeft + NumberOfLimbs; Carry != 0 && IndexOfProduct < 2 * NumberOfLimbs; ++IndexOfProduct)
+        {
+            uint64_t Value = s_Product[IndexOfProduct] + Carry;
+
+            s_Product[IndexOfProduct] = static_cast<uint32_t>(Value);
+
+            Carry = Value >> 32;
+        }
+    }
+
+    bool IsNegative = _rLeft.m_IsNegative != _rRight.m_IsNegative;
+
+    _pResult->m_Limbs.resize(NumberOfLimbs);
+
+    for (int IndexOfLimb = 0; IndexOfLimb < NumberOfLimbs; ++IndexOfLimb)
+    {
+        _pResult->m_Limbs[IndexOfLimb] = s_Product[IndexOfLimb + FirstKeptLimb];
+    }
+
+    _pResult->m_IsNegative = IsNegative && !_pResult->IsZero();
+}
+
+// -----------------------------------------------------------------------------
+
+int CFixedPoint::CompareMagnitude(const CFixedPoint& _rLeft, const CFixedPoint& _rRight)
+{
+    for (int IndexOfLimb = static_cast<int>(_rLeft.m_Limbs.size()) - 1; IndexOfLimb >= 0; --IndexOfLimb)
+    {
+        if (_rLeft.m_Limbs[IndexOfLimb] != _rRight.m_Limbs[IndexOfLimb])
+        {
+            return _rLeft.m_Limbs[IndexOfLimb] < _rRight.m_Limbs[IndexOfLimb] ? -1 : 1;
+        }
+    }
+
+    return 0;
+}
+
+// -----------------------------------------------------------------------------
+
+void CFixedPoint::AddMagnitude(const CFixedPoint& _rLeft, const CFixedPoint& _rRight, CFixedPoint* _pResult)
+{
+    size_t NumberOfLimbs = _rLeft.m_Limbs.size();
+
+    _pResult->m_Limbs.resize(NumberOfLimbs);
+
+    uint64_t Carry = 0;
+
+    for (size_t IndexOfLimb = 0; IndexOfLimb < NumberOfLimbs; ++IndexOfLimb)
+    {
+        uint64_t Value = static_cast<uint64_t>(_rLeft.m_Limbs[IndexOfLimb]) + _rRight.m_Limbs[IndexOfLimb] + Carry;
+
+        _pResult->m_Limbs[IndexOfLimb] = static_cast<uint32_t>(Value);
+
+        Carry = Value >> 32;
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+void CFixedPoint::SubMagnitude(const CFixedPoint& _rLeft, const CFixedPoint& _rRight, CFixedPoint* _pResult)
+{
+    size_t NumberOfLimbs = _rLeft.m_Limbs.size();
+
+    _pResult->m_Limbs.resize(NumberOfLimbs);
+
+    uint64_t Borrow = 0;
+
+    for (size_t IndexOfLimb = 0; IndexOfLimb < NumberOfLimbs; ++IndexOfLimb)
+    {
+        uint64_t Value = static_cast<uint64_t>(_rLeft.m_Limbs[IndexOfLimb]) - _rRight.m_Limbs[IndexOfLimb] - Borrow;
+
+        _pResult->m_Limbs[IndexOfLimb] = static_cast<uint32_t>(Value);
+
+        Borrow = (Value >> 63) & 1u;
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+bool CFixedPoint::IsZero() const
+{
+    for (uint32_t Limb : m_Limbs)
+    {
+        if (Limb != 0) return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// A signed fixed point number with a 32 bit integer part and an arbitrary
+// number of 32 bit fraction limbs. The numbers of the reference orbit never
+// leave [-16, 16], so a fixed point is enough and much cheaper than a
+// floating point with arbitrary precision.
+//
+// Limbs are stored least significant first, the last limb is the integer
+// part. All operands of an operation must have the same number of limbs.
+// -----------------------------------------------------------------------------
+
+class CFixedPoint
+{
+public:
+
+    static int GetNumberOfLimbs(int _NumberOfFractionBits);
+
+public:
+
+    explicit CFixedPoint(int _NumberOfLimbs = 2);
+    CFixedPoint(double _Value, int _NumberOfLimbs);
+
+public:
+
+    bool SetFromString(const char* _pText);                         // A decimal number, optionally with an exponent like -7.5e-1.
+
+    double ToDouble() const;
+    void ToDoubles(double* _pParts, int _NumberOfParts) const;      // Splits the number into a sum of doubles, largest first, e.g. for double-double arithmetic.
+
+    int GetNumberOfLimbs() const;
+
+public:
+
+    static void Add(const CFixedPoint& _rLeft, const CFixedPoint& _rRight, CFixedPoint* _pResult);
+    static void Sub(const CFixedPoint& _rLeft, const CFixedPoint& _rRight, CFixedPoint* _pResult);
+    static void Mul(const CFixedPoint& _rLeft, const CFixedPoint& _rRight, CFixedPoint* _pResult);
+
+private:
+
+    bool                  m_IsNegative;
+    std::vector<uint32_t> m_Limbs;
+
+private:
+
+    static int  CompareMagnitude(const CFixedPoint& _rLeft, const CFixedPoint& _rRight);
+    static void AddMagnitude(const CFixedPoint& _rLeft, const CFixedPoint& _rRight, CFixedPoint* _pResult);
+    static void SubMagnitude(const CFixedPoint& _rLeft, const CFixedPoint& _rRight, CFixedPoint* _pResult);
+
+    bool IsZero() const;
+};
@@ -0,0 +1,471 @@
+#include "CImageWriter.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+namespace
+{
+    // -----------------------------------------------------------------------------
+    // The symbols of deflate which stand for match lengths 3 to 258 start at 257.
+    // Every symbol covers the lengths from its base on with its extra bits.
+    // -----------------------------------------------------------------------------
+    const int s_NumberOfLengthSymbols = 29;
+
+    const int s_LengthBases[s_NumberOfLengthSymbols] =
+    {
+        3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258,
+    };
+
+    const int s_LengthExtraBits[s_NumberOfLengthSymbols] =
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0,
+    };
+
+    const int s_MinMatchLength = 3;
+    const int s_MaxMatchLength = 258;
+    const int s_EndOfBlock     = 256;
+
+    const unsigned int s_AdlerModulo = 65521;
+    const size_t       s_AdlerBlock  = 5552;                   // Bytes which can be summed up before the sums overflow 32 bits.
+
+    const unsigned char s_PNGSignature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+    // -----------------------------------------------------------------------------
+    // The fixed Huffman codes of deflate. Huffman codes are stored with their
+    // first bit in the lowest bit of the stream, so they are kept reversed.
+    // -----------------------------------------------------------------------------
+    struct SFixedCode
+    {
+        unsigned int m_Bits;
+        int          m_NumberOfBits;
+    };
+
+    // -----------------------------------------------------------------------------
+
+    const SFixedCode* GetFixedCodes()
+    {
+        struct SFixedCodes
+        {
+            SFixedCode m_Codes[288];
+
+            SFixedCodes()
+            {
+                for (int Symbol = 0; Symbol < 288; ++Symbol)
+                {
+                    unsigned int Code;
+                    int          NumberOfBits;
+
+                    if      (Symbol < 144) { Code = 0x30  + Symbol;         NumberOfBits = 8; }
+                    else if (Symbol < 256) { Code = 0x190 + Symbol - 144;   NumberOfBits = 9; }
+                    else if (Symbol < 280) { Code =         Symbol - 256;   NumberOfBits = 7; }
+                    else                   { Code = 0xC0  + Symbol - 280;   NumberOfBits = 8; }
+
+                    unsigned int Reversed = 0;
+
+                    for (int IndexOfBit = 0; IndexOfBit < NumberOfBits; ++IndexOfBit)
+                    {
+                        Reversed |= ((Code >> IndexOfBit) & 1u) << (NumberOfBits - 1 - IndexOfBit);
+                    }
+
+                    m_Codes[Symbol].m_Bits         = Reversed;
+                    m_Codes[Symbol].m_NumberOfBits = NumberOfBits;
+                }
+            }
+        };
+
+        static const SFixedCodes s_FixedCodes;
+
+        return s_FixedCodes.m_Codes;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    unsigned int GetCRC(const unsigned char* _pData, size_t _NumberOfBytes, unsigned int _CRC)
+    {
+        struct SCRCTable
+        {
+            unsigned int m_Values[256];
+
+            SCRCTable()
+            {
+                for (unsigned int Index = 0; Index < 256; ++Index)
+                {
+                    unsigned int Value = Index;
+
+                    for (int IndexOfBit = 0; IndexOfBit < 8; ++IndexOfBit)
+                    {
+                        Value = (Value & 1u) != 0 ? 0xEDB88320u ^ (Value >> 1) : Value >> 1;
+                    }
+
+                    m_Values[Index] = Value;
+                }
+            }
+        };
+
+        static const SCRCTable s_CRCTable;
+
+        for (size_t IndexOfByte = 0; IndexOfByte < _NumberOfBytes; ++IndexOfByte)
+        {
+            _CRC = s_CRCTable.m_Values[(_CRC ^ _pData[IndexOfByte]) & 0xFFu] ^ (_CRC >> 8);
+        }
+
+        return _CRC;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void PutBigEndian(unsigned int _Value, unsigned char* _pBytes)
+    {
+        _pBytes[0] = static_cast<unsigned char>(_Value >> 24);
+        _pBytes[1] = static_cast<unsigned char>(_Value >> 16);
+        _pBytes[2] = static_cast<unsigned char>(_Value >>  8);
+        _pBytes[3] = static_cast<unsigned char>(_Value);
+    }
+} // namespace
+
+// -----------------------------------------------------------------------------
+
+CImageWriter::CImageWriter()
+    : m_pFile(nullptr)
+    , m_Format(SImageFormat::PPM)
+    , m_Width(0)
+    , m_Height(0)
+    , m_NumberOfRows(0)
+    , m_IsValid(false)
+    , m_Row()
+    , m_Compressed()
+    , m_Bits(0)
+    , m_NumberOfBits(0)
+    , m_PreviousByte(-1)
+{
+    m_Adler[0] = 1;
+    m_Adler[1] = 0;
+}
+
+// -----------------------------------------------------------------------------
+
+CImageWriter::~CImageWriter()
+{
+    if (m_pFile != nullptr) Close();
+}
+
+// -----------------------------------------------------------------------------
+
+SImageFormat::EFormat CImageWriter::GetFormat(const char* _pPath)
+{
+    const char* pExtension = std::strrchr(_pPath, '.');
+
+    if (pExtension == nullptr || std::strlen(pExtension) != 4) return SImageFormat::PPM;
+
+    for (int IndexOfCharacter = 0; IndexOfCharacter < 3; ++IndexOfCharacter)
+    {
+        if (std::tolower(static_cast<unsigned char>(pExtension[1 + IndexOfCharacter])) != "png"[IndexOfCharacter]) return SImageFormat::PPM;
+    }
+
+    return SImageFormat::PNG;
+}
+
+// -----------------------------------------------------------------------------
+
+bool CImageWriter::Open(const char* _pPath, int _Width, int _Height)
+{
+    if (m_pFile != nullptr) Close();
+
+    if (_Width <= 0 || _Height <= 0) return false;
+
+    m_pFile = std::fopen(_pPath, "wb");
+
+    if (m_pFile == nullptr) return false;
+
+    m_Format       = GetFormat(_pPath);
+    m_Width        = _Width;
+    m_Height       = _Height;
+    m_NumberOfRows = 0;
+    m_IsValid      = true;
+    m_Bits         = 0;
+    m_NumberOfBits = 0;
+    m_PreviousByte = -1;
+    m_Adler[0]     = 1;
+    m_Adler[1]     = 0;
+
+    m_Compressed.clear();
+
+    if (m_Format == SImageFormat::PPM)
+    {
+        m_Row.resize(3 * static_cast<size_t>(_Width));
+
+        m_IsValid = std::fprintf(m_pFile, "P6\n%d %d\n255\n", _Width, _Height) > 0;
+    }
+    else
+    {
+        m_Row.resize(1 + 3 * static_cast<size_t>(_Width));
+
+        // -----------------------------------------------------------------------------
+        // 8 bit RGB without interlacing.
+        // -----------------------------------------------------------------------------
+        unsigned char Header[13];
+
+        PutBigEndian(static_cast<unsigned int>(_Width),  &Header[0]);
+        PutBigEndian(static_cast<unsigned int>(_Height), &Header[4]);
+
+        Header[8]  = 8;
+        Header[9]  = 2;
+        Header[10] = 0;
+        Header[11] = 0;
+        Header[12] = 0;
+
+        m_IsValid = std::fwrite(s_PNGSignature, sizeof(s_PNGSignature), 1, m_pFile) == 1;
+
+        WriteChunk("IHDR", Header, sizeof(Header));
+
+        // -----------------------------------------------------------------------------
+        // The zlib header of a deflate stream with a 32 KB window.
+        // -----------------------------------------------------------------------------
+        m_Compressed.push_back(0x78);
+        m_Compressed.push_back(0x01);
+    }
+
+    return m_IsValid;
+}
+
+// -----------------------------------------------------------------------------
+
+bool CImageWriter::WriteRows(const unsigned char* _pPixels, int _NumberOfRows)
+{
+    if (m_pFile == nullptr || _NumberOfRows < 0 || m_NumberOfRows + _NumberOfRows > m_Height) return false;
+
+    // -----------------------------------------------------------------------------
+    // The rows of a call form a deflate block of their own, which is written as
+    // soon as the rows are encoded. Its bits in the last unfinished byte go
+    // with the next block.
+    // -----------------------------------------------------------------------------
+    if (m_Format == SImageFormat::PNG) PutBits(0x2, 3);
+
+    for (int IndexOfRow = 0; IndexOfRow < _NumberOfRows; ++IndexOfRow)
+    {
+        const unsigned char* pPixels = _pPixels + 4 * static_cast<size_t>(m_Width) * IndexOfRow;
+
+        if (m_Format == SImageFormat::PPM)
+        {
+            for (int X = 0; X < m_Width; ++X)
+            {
+                m_Row[3 * X + 0] = pPixels[4 * X + 0];
+                m_Row[3 * X + 1] = pPixels[4 * X + 1];
+                m_Row[3 * X + 2] = pPixels[4 * X + 2];
+            }
+
+            m_IsValid = std::fwrite(m_Row.data(), m_Row.size(), 1, m_pFile) == 1 && m_IsValid;
+        }
+        else
+        {
+            // -----------------------------------------------------------------------------
+            // The Sub filter stores every channel as the difference to the pixel
+            // on the left, so areas of one color become runs of zeros.
+            // -----------------------------------------------------------------------------
+            unsigned char* pRow = &m_Row[1];
+
+            m_Row[0] = 1;
+
+            pRow[0] = pPixels[0];
+            pRow[1] = pPixels[1];
+            pRow[2] = pPixels[2];
+
+            for (int X = 1; X < m_Width; ++X)
+            {
+                pRow[3 * X + 0] = static_cast<unsigned char>(pPixels[4 * X + 0] - pPixels[4 * X - 4]);
+                pRow[3 * X + 1] = static_cast<unsigned char>(pPixels[4 * X + 1] - pPixels[4 * X - 3]);
+                pRow[3 * X + 2] = static_cast<unsigned char>(pPixels[4 * X + 2] - pPixels[4 * X - 2]);
+            }
+
+            Deflate(m_Row.data(), m_Row.size());
+        }
+    }
+
+    m_NumberOfRows += _NumberOfRows;
+
+    if (m_Format == SImageFormat::PNG)
+    {
+        PutSymbol(s_EndOfBlock);
+
+        WriteChunk("IDAT", m_Compressed.data(), m_Compressed.size());
+
+        m_Compressed.clear();
+    }
+
+    return m_IsValid;
+}
+
+// -----------------------------------------------------------------------------
+
+bool CImageWriter::Close()
+{
+    if (m_pFile == nullptr) return false;
+
+    if (m_Format == SImageFormat::PNG)
+    {
+        // -----------------------------------------------------------------------------
+        // An empty final block ends the deflate stream, the checksum of the
+        // uncompressed stream ends the zlib stream.
+        // -----------------------------------------------------------------------------
+        PutBits(0x3, 3);
+        PutSymbol(s_EndOfBlock);
+
+        FlushBits();
+
+        unsigned char Adler[4];
+
+        PutBigEndian((m_Adler[1] << 16) | m_Adler[0], Adler);
+
+        m_Compressed.insert(m_Compressed.end(), Adler, Adler + 4);
+
+        WriteChunk("IDAT", m_Compressed.data(), m_Compressed.size());
+        WriteChunk("IEND", nullptr, 0);
+
+        m_Compressed.clear();
+    }
+
+    bool IsComplete = m_IsValid && m_NumberOfRows == m_Height;
+
+    IsComplete = std::fclose(m_pFile) == 0 && IsComplete;
+
+    m_pFile = nullptr;
+
+    return IsComplete;
+}
+
+// -----------------------------------------------------------------------------
+
+int CImageWriter::GetNumberOfRows() const
+{
+    return m_NumberOfRows;
+}
+
+// -----------------------------------------------------------------------------
+
+void CImageWriter::WriteChunk(const char* _pType, const unsigned char* _pData, size_t _NumberOfBytes)
+{
+    unsigned char Length[4];
+    unsigned char CRC[4];
+
+    PutBigEndian(static_cast<unsigned int>(_NumberOfBytes), Length);
+
+    unsigned int Checksum = GetCRC(reinterpret_cast<const unsigned char*>(_pType), 4, 0xFFFFFFFFu);
+
+    Checksum = GetCRC(_pData, _NumberOfBytes, Checksum);
+
+    PutBigEndian(Checksum ^ 0xFFFFFFFFu, CRC);
+
+    bool IsWritten = std::fwrite(Length, 4, 1, m_pFile) == 1
+        && std::fwrite(_pType, 4, 1, m_pFile) == 1
+        && (_NumberOfBytes == 0 || std::fwrite(_pData, _NumberOfBytes, 1, m_pFile) == 1)
+        && std::fwrite(CRC, 4, 1, m_pFile) == 1;
+
+    m_IsValid = IsWritten && m_IsValid;
+}
+
+// -----------------------------------------------------------------------------
+
+void CImageWriter::Deflate(const unsigned char* _pData, size_t _NumberOfBytes)
+{
+    // -----------------------------------------------------------------------------
+    // A run of bytes equal to the one before is a match of distance 1.
+    // -----------------------------------------------------------------------------
+    size_t IndexOfByte = 0;
+
+    while (IndexOfByte < _NumberOfBytes)
+    {
+        int Byte = _pData[IndexOfByte];
+
+        if (Byte == m_PreviousByte)
+        {
+            size_t MaxLength = std::min(static_cast<size_t>(s_MaxMatchLength), _NumberOfBytes - IndexOfByte);
+            size_t Length    = 1;
+
+            while (Length < MaxLength && _pData[IndexOfByte + Length] == Byte) ++Length;
+
+            if (Length >= static_cast<size_t>(s_MinMatchLength))
+            {
+                int IndexOfSymbol = s_NumberOfLengthSymbols - 1;
+
+                while (s_LengthBases[IndexOfSymbol] > static_cast<int>(Length)) --IndexOfSymbol;
+
+                PutSymbol(s_EndOfBlock + 1 + IndexOfSymbol);
+                PutBits(static_cast<unsigned int>(Length - s_LengthBases[IndexOfSymbol]), s_LengthExtraBits[IndexOfSymbol]);
+
+                // -----------------------------------------------------------------------------
+                // The fixed code of distance 1 is five zero bits.
+                // -----------------------------------------------------------------------------
+                PutBits(0, 5);
+
+                IndexOfByte += Length;
+
+                continue;
+            }
+        }
+
+        PutSymbol(Byte);
+
+        m_PreviousByte = Byte;
+
+        ++IndexOfByte;
+    }
+
+    // -----------------------------------------------------------------------------
+    // Adler-32 of the uncompressed bytes.
+    // -----------------------------------------------------------------------------
+    for (size_t Start = 0; Start < _NumberOfBytes; Start += s_AdlerBlock)
+    {
+        size_t End = std::min(Start + s_AdlerBlock, _NumberOfBytes);
+
+        unsigned int A = m_Adler[0];
+        unsigned int B = m_Adler[1];
+
+        for (size_t Index = Start; Index < End; ++Index)
+        {
+            A += _pData[Index];
+            B += A;
+        }
+
+        m_Adler[0] = A % s_AdlerModulo;
+        m_Adler[1] = B % s_AdlerModulo;
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+void CImageWriter::PutBits(unsigned int _Bits, int _NumberOfBits)
+{
+    m_Bits         |= static_cast<unsigned long long>(_Bits) << m_NumberOfBits;
+    m_NumberOfBits += _NumberOfBits;
+
+    while (m_NumberOfBits >= 8)
+    {
+        m_Compressed.push_back(static_cast<unsigned char>(m_Bits));
+
+        m_Bits         >>= 8;
+        m_NumberOfBits  -= 8;
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+void CImageWriter::PutSymbol(int _Symbol)
+{
+    const SFixedCode& rCode = GetFixedCodes()[_Symbol];
+
+    PutBits(rCode.m_Bits, rCode.m_NumberOfBits);
+}
+
+// -----------------------------------------------------------------------------
+
+void CImageWriter::FlushBits()
+{
+    if (m_NumberOfBits > 0)
+    {
+        m_Compressed.push_back(static_cast<unsigned char>(m_Bits));
+
+        m_Bits         = 0;
+        m_NumberOfBits = 0;
+    }
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdio>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// The file formats CImageWriter can write. Both store 8 bit RGB.
+// -----------------------------------------------------------------------------
+
+struct SImageFormat
+{
+    enum EFormat
+    {
+        PPM,                                    // Binary portable pixmap (P6), the rows as they are.
+        PNG,                                    // Deflate compressed, see CImageWriter.
+    };
+};
+
+// -----------------------------------------------------------------------------
+// Writes an image row by row, so the whole image never has to be in memory.
+// Every call of WriteRows encodes and writes its rows right away and only
+// keeps the previous row.
+//
+// The PNG encoder needs no zlib. It applies the Sub filter to every row and
+// compresses with the fixed Huffman codes of deflate and matches of distance
+// 1, which turns the long runs of equal colors of a fractal into a few bits.
+// It is far from the best compression, but it is fast and its memory does not
+// grow with the image.
+// -----------------------------------------------------------------------------
+
+class CImageWriter
+{
+public:
+
+    CImageWriter();
+    ~CImageWriter();                                                                    // Closes an open file.
+
+    CImageWriter(const CImageWriter&) = delete;
+    CImageWriter& operator = (const CImageWriter&) = delete;
+
+public:
+
+    static SImageFormat::EFormat GetFormat(const char* _pPath);                         // PNG for the extension .png, PPM otherwise.
+
+public:
+
+    bool Open(const char* _pPath, int _Width, int _Height);
+    bool WriteRows(const unsigned char* _pPixels, int _NumberOfRows);                   // RGBA with 8 bits per channel like SMandelbrotImage::m_Pixels, alpha is dropped.
+    bool Close();                                                                       // Fails if a write failed or not all rows were written.
+
+    int GetNumberOfRows() const;                                                        // Rows written so far.
+
+private:
+
+    FILE*                      m_pFile;
+    SImageFormat::EFormat      m_Format;
+    int                        m_Width;
+    int                        m_Height;
+    int                        m_NumberOfRows;
+    bool                       m_IsValid;                                               // No write failed so far.
+
+    std::vector<unsigned char> m_Row;                                                   // The RGB row to write, for PNG its filter type in front.
+    std::vector<unsigned char> m_Compressed;                                            // The deflate stream of the current rows.
+    unsigned long long         m_Bits;                                                  // Bits of the deflate stream not yet in m_Compressed, the first in the lowest bit.
+    int                        m_NumberOfBits;
+    int                        m_PreviousByte;                                          // Last byte of the uncompressed stream, -1 at its start.
+    unsigned int               m_Adler[2];                                              // Running Adler-32 of the uncompressed stream.
+
+private:
+
+    void WriteChunk(const char* _pType, const unsigned char* _pData, size_t _NumberOfBytes);
+
+    void Deflate(const unsigned char* _pData, size_t _NumberOfBytes);
+    void PutBits(unsigned int _Bits, int _NumberOfBits);
+    void PutSymbol(int _Symbol);
+    void FlushBits();                                                                   // Pads the last byte of the stream with zeros.
+};
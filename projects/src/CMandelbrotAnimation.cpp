@@ -0,0 +1,322 @@
+#include "CMandelbrotAnimation.h"
+
+#include "CFixedPoint.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <future>
+#include <thread>
+
+namespace
+{
+    // -----------------------------------------------------------------------------
+    // Bits beyond the smaller pixel size of two keyframes, so the distance of
+    // their centers is exact in double precision.
+    // -----------------------------------------------------------------------------
+    const int s_NumberOfGuardBits = 64;
+
+    // -----------------------------------------------------------------------------
+
+    int GetDefaultNumberOfThreads(int _NumberOfThreads)
+    {
+        if (_NumberOfThreads > 0) return _NumberOfThreads;
+
+        int NumberOfCores = static_cast<int>(std::thread::hardware_concurrency());
+
+        return NumberOfCores > 0 ? NumberOfCores : 1;
+    }
+} // namespace
+
+// -----------------------------------------------------------------------------
+
+CMandelbrotAnimation::CMandelbrotAnimation(int _NumberOfThreads)
+    : m_NumberOfThreads(GetDefaultNumberOfThreads(_NumberOfThreads))
+    , m_NumberOfFramesInFlight(std::min(m_NumberOfThreads, s_MaxNumberOfFramesInFlight))
+    , m_Scheduler(m_NumberOfThreads - m_NumberOfFramesInFlight + 1)
+    , m_Keyframes()
+    , m_Centers()
+    , m_Distances()
+    , m_ReferencePixelSizes()
+    , m_ReferenceMaxIterations()
+{
+    for (std::unique_ptr<CMandelbrotRenderer>& rpRenderer : m_pRenderers)
+    {
+        rpRenderer.reset(new CMandelbrotRenderer(m_Scheduler));
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+CMandelbrotAnimation::~CMandelbrotAnimation()
+{
+}
+
+// -----------------------------------------------------------------------------
+
+int CMandelbrotAnimation::GetNumberOfThreads() const
+{
+    return m_NumberOfThreads;
+}
+
+// -----------------------------------------------------------------------------
+
+bool CMandelbrotAnimation::SetKeyframes(const std::vector<SMandelbrotKeyframe>& _rKeyframes)
+{
+    if (_rKeyframes.empty()) return false;
+
+    int NumberOfKeyframes = static_cast<int>(_rKeyframes.size());
+
+    for (int IndexOfKeyframe = 0; IndexOfKeyframe < NumberOfKeyframes; ++IndexOfKeyframe)
+    {
+        const SMandelbrotKeyframe& rKeyframe = _rKeyframes[IndexOfKeyframe];
+
+        if (rKeyframe.m_Frame < 0 || rKeyframe.m_PixelSize <= 0.0) return false;
+
+        if (IndexOfKeyframe > 0 && rKeyframe.m_Frame <= _rKeyframes[IndexOfKeyframe - 1].m_Frame) return false;
+    }
+
+    std::vector<double> Centers(2 * NumberOfKeyframes);
+    std::vector<double> Distances(2 * NumberOfKeyframes, 0.0);
+
+    for (int IndexOfKeyframe = 0; IndexOfKeyframe < NumberOfKeyframes; ++IndexOfKeyframe)
+    {
+        const SMandelbrotKeyframe& rKeyframe = _rKeyframes[IndexOfKeyframe];
+
+        // -----------------------------------------------------------------------------
+        // The distance to the previous keyframe is taken from the exact centers,
+        // in a deep zoom the two centers agree in far more digits than a double
+        // has.
+        // -----------------------------------------------------------------------------
+        double MinPixelSize = IndexOfKeyframe > 0 ? std::min(rKeyframe.m_PixelSize, _rKeyframes[IndexOfKeyframe - 1].m_PixelSize) : rKeyframe.m_PixelSize;
+
+        int NumberOfFractionBits = static_cast<int>(std::ceil(-std::log2(MinPixelSize))) + s_NumberOfGuardBits;
+        int NumberOfLimbs        = CFixedPoint::GetNumberOfLimbs(std::max(NumberOfFractionBits, s_NumberOfGuardBits));
+
+        for (int Axis = 0; Axis < 2; ++Axis)
+        {
+            CFixedPoint Center(NumberOfLimbs);
+
+            if (!Center.SetFromString(rKeyframe.m_Center[Axis].c_str())) return false;
+
+            Centers[2 * IndexOfKeyframe + Axis] = Center.ToDouble();
+
+            if (IndexOfKeyframe == 0) continue;
+
+            CFixedPoint PreviousCenter(NumberOfLimbs);
+            CFixedPoint Distance(NumberOfLimbs);
+
+            PreviousCenter.SetFromString(_rKeyframes[IndexOfKeyframe - 1].m_Center[Axis].c_str());
+
+            CFixedPoint::Sub(Center, PreviousCenter, &Distance);
+
+            Distances[2 * IndexOfKeyframe + Axis] = Distance.ToDouble();
+        }
+    }
+
+    m_Keyframes = _rKeyframes;
+
+    m_Centers.swap(Centers);
+    m_Distances.swap(Distances);
+
+    // -----------------------------------------------------------------------------
+    // The reference orbit of a keyframe has to serve its deepest frame with the
+    // most iterations.
+    // -----------------------------------------------------------------------------
+    m_ReferencePixelSizes.assign(NumberOfKeyframes, 0.0);
+    m_ReferenceMaxIterations.assign(NumberOfKeyframes, 0);
+
+    for (int IndexOfKeyframe = 0; IndexOfKeyframe < NumberOfKeyframes; ++IndexOfKeyframe)
+    {
+        m_ReferencePixelSizes[IndexOfKeyframe]    = m_Keyframes[IndexOfKeyframe].m_PixelSize;
+        m_ReferenceMaxIterations[IndexOfKeyframe] = m_Keyframes[IndexOfKeyframe].m_MaxIteration;
+    }
+
+    for (int Frame = 0; Frame < GetNumberOfFrames(); ++Frame)
+    {
+        SFrameView View = GetFrameView(Frame);
+
+        m_ReferencePixelSizes[View.m_Keyframe]    = std::min(m_ReferencePixelSizes[View.m_Keyframe], View.m_PixelSize);
+        m_ReferenceMaxIterations[View.m_Keyframe] = std::max(m_ReferenceMaxIterations[View.m_Keyframe], View.m_MaxIteration);
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+int CMandelbrotAnimation::GetNumberOfFrames() const
+{
+    return m_Keyframes.empty() ? 0 : m_Keyframes.back().m_Frame + 1;
+}
+
+// -----------------------------------------------------------------------------
+
+void CMandelbrotAnimation::GetFrameSettings(int _Frame, const SMandelbrotSettings& _rSettings, SMandelbrotSettings* _pSettings) const
+{
+    *_pSettings = _rSettings;
+
+    if (m_Keyframes.empty()) return;
+
+    SFrameView View = GetFrameView(_Frame);
+
+    const SMandelbrotKeyframe& rKeyframe = m_Keyframes[View.m_Keyframe];
+
+    _pSettings->m_Center[0]        = m_Centers[2 * View.m_Keyframe + 0];
+    _pSettings->m_Center[1]        = m_Centers[2 * View.m_Keyframe + 1];
+    _pSettings->m_PreciseCenter[0] = rKeyframe.m_Center[0];
+    _pSettings->m_PreciseCenter[1] = rKeyframe.m_Center[1];
+    _pSettings->m_CenterOffset[0]  = View.m_CenterOffset[0];
+    _pSettings->m_CenterOffset[1]  = View.m_CenterOffset[1];
+    _pSettings->m_PixelSize        = View.m_PixelSize;
+    _pSettings->m_RowOffset        = 0.0;
+    _pSettings->m_FirstRow         = 0;
+    _pSettings->m_MaxIteration     = View.m_MaxIteration;
+}
+
+// -----------------------------------------------------------------------------
+
+bool CMandelbrotAnimation::Render(const SMandelbrotSettings& _rSettings, const SMandelbrotPalette* _pPalette, const FFrameFunction& _rFunction)
+{
+    if (m_Keyframes.empty()) return false;
+
+    int NumberOfFrames = GetNumberOfFrames();
+
+    SMandelbrotImage  Images[s_MaxNumberOfFramesInFlight];
+    std::future<bool> Frames[s_MaxNumberOfFramesInFlight];
+
+    std::vector<std::shared_ptr<const CReferenceOrbit>> ReferenceOrbits(m_Keyframes.size());
+
+    // -----------------------------------------------------------------------------
+    // Renders a frame in its slot, a deep zoom against the orbit of its
+    // keyframe.
+    // -----------------------------------------------------------------------------
+    auto RenderFrame = [&](const SMandelbrotSettings& _rFrameSettings, std::shared_ptr<const CReferenceOrbit> _pReferenceOrbit, int _Slot)
+    {
+        CMandelbrotRenderer& rRenderer = *m_pRenderers[_Slot];
+
+        rRenderer.SetSharedReferenceOrbit(_pReferenceOrbit);
+
+        if (!rRenderer.Render(_rFrameSettings, &Images[_Slot])) return false;
+
+        if (_pPalette != nullptr) rRenderer.MapColors(*_pPalette, &Images[_Slot]);
+
+        return true;
+    };
+
+    bool IsRendered = true;
+
+    for (int Frame = 0; Frame < NumberOfFrames + m_NumberOfFramesInFlight; ++Frame)
+    {
+        int Slot = Frame % m_NumberOfFramesInFlight;
+
+        // -----------------------------------------------------------------------------
+        // The frame rendered in the slot before is handed on, meanwhile the
+        // other slots keep the cores busy.
+        // -----------------------------------------------------------------------------
+        if (Frames[Slot].valid())
+        {
+            bool IsFrameRendered = Frames[Slot].get();
+
+            IsRendered = IsRendered && IsFrameRendered && _rFunction(Images[Slot], Frame - m_NumberOfFramesInFlight);
+        }
+
+        if (Frame >= NumberOfFrames || !IsRendered) continue;
+
+        SMandelbrotSettings Settings;
+
+        GetFrameSettings(Frame, _rSettings, &Settings);
+
+        // -----------------------------------------------------------------------------
+        // The reference orbit of a keyframe is computed for its deepest frame
+        // when its first frame starts. The frames in flight keep the orbits of
+        // the keyframes before alive as long as they need them.
+        // -----------------------------------------------------------------------------
+        std::shared_ptr<const CReferenceOrbit> pReferenceOrbit;
+
+        if (GetMandelbrotPrecision(Settings) == SMandelbrotPrecision::Perturbation)
+        {
+            int Keyframe = GetFrameView(Frame).m_Keyframe;
+
+            if (ReferenceOrbits[Keyframe] == nullptr)
+            {
+                SMandelbrotSettings ReferenceSettings = Settings;
+
+                ReferenceSettings.m_PixelSize    = m_ReferencePixelSizes[Keyframe];
+                ReferenceSettings.m_MaxIteration = m_ReferenceMaxIterations[Keyframe];
+
+                std::shared_ptr<CReferenceOrbit> pNewReferenceOrbit = std::make_shared<CReferenceOrbit>();
+
+                pNewReferenceOrbit->Update(ReferenceSettings);
+
+                ReferenceOrbits[Keyframe] = pNewReferenceOrbit;
+            }
+
+            for (int IndexOfKeyframe = 0; IndexOfKeyframe < Keyframe; ++IndexOfKeyframe)
+            {
+                ReferenceOrbits[IndexOfKeyframe].reset();
+            }
+
+            pReferenceOrbit = ReferenceOrbits[Keyframe];
+        }
+
+        Frames[Slot] = std::async(std::launch::async, RenderFrame, Settings, pReferenceOrbit, Slot);
+    }
+
+    return IsRendered;
+}
+
+// -----------------------------------------------------------------------------
+
+CMandelbrotAnimation::SFrameView CMandelbrotAnimation::GetFrameView(int _Frame) const
+{
+    int NumberOfKeyframes = static_cast<int>(m_Keyframes.size());
+
+    int IndexOfKeyframe = 0;
+
+    while (IndexOfKeyframe + 1 < NumberOfKeyframes && m_Keyframes[IndexOfKeyframe + 1].m_Frame <= _Frame) ++IndexOfKeyframe;
+
+    const SMandelbrotKeyframe& rFrom = m_Keyframes[IndexOfKeyframe];
+
+    SFrameView View = { IndexOfKeyframe, { 0.0, 0.0 }, rFrom.m_PixelSize, rFrom.m_MaxIteration };
+
+    if (IndexOfKeyframe + 1 == NumberOfKeyframes || _Frame <= rFrom.m_Frame) return View;
+
+    const SMandelbrotKeyframe& rTo = m_Keyframes[IndexOfKeyframe + 1];
+
+    // -----------------------------------------------------------------------------
+    // The pixel size is interpolated logarithmically. The center covers the
+    // same share of its way as the pixel size, so a point which lies at the
+    // same place of the screen in both keyframes stays there in between.
+    // -----------------------------------------------------------------------------
+    double Time = static_cast<double>(_Frame - rFrom.m_Frame) / static_cast<double>(rTo.m_Frame - rFrom.m_Frame);
+
+    double PixelSize = rFrom.m_PixelSize * std::pow(rTo.m_PixelSize / rFrom.m_PixelSize, Time);
+
+    bool IsZoom = rFrom.m_PixelSize != rTo.m_PixelSize;
+
+    double Way = IsZoom ? (rFrom.m_PixelSize - PixelSize) / (rFrom.m_PixelSize - rTo.m_PixelSize) : Time;
+
+    View.m_PixelSize    = PixelSize;
+    View.m_MaxIteration = static_cast<unsigned int>(std::lround(rFrom.m_MaxIteration + (static_cast<double>(rTo.m_MaxIteration) - rFrom.m_MaxIteration) * Time));
+
+    // -----------------------------------------------------------------------------
+    // The offset is taken from the nearer keyframe, where it is small enough
+    // to be exact in double precision. The way left to the second keyframe is
+    // computed on its own, 1 - Way would round away the last pixels of a deep
+    // zoom.
+    // -----------------------------------------------------------------------------
+    const double* pDistance = &m_Distances[2 * (IndexOfKeyframe + 1)];
+
+    if (Way >= 0.5)
+    {
+        View.m_Keyframe = IndexOfKeyframe + 1;
+
+        Way = IsZoom ? (rTo.m_PixelSize - PixelSize) / (rFrom.m_PixelSize - rTo.m_PixelSize) : Time - 1.0;
+    }
+
+    View.m_CenterOffset[0] = pDistance[0] * Way;
+    View.m_CenterOffset[1] = pDistance[1] * Way;
+
+    return View;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "CMandelbrotRenderer.h"
+#include "SMandelbrotSettings.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// A view of a zoom animation, which is reached in the given frame.
+// -----------------------------------------------------------------------------
+
+struct SMandelbrotKeyframe
+{
+    int          m_Frame;
+    std::string  m_Center[2];                   // Decimal digits of the real and imaginary part of the center.
+    double       m_PixelSize;
+    unsigned int m_MaxIteration;
+};
+
+// -----------------------------------------------------------------------------
+// Renders the frames of a zoom between keyframes. Between two keyframes the
+// pixel size changes exponentially, so the zoom runs at a constant speed, and
+// the center moves with the pixel size, so the point the zoom heads for stays
+// in place on the screen. The maximum iteration follows the zoom linearly.
+//
+// Every frame keeps the exact center of the nearer keyframe and only offsets
+// its view from it, see SMandelbrotSettings::m_CenterOffset. So all frames of
+// a deep zoom towards a keyframe iterate against the same reference orbit,
+// which is computed once for the deepest of them and shared by the renderers.
+//
+// Two frames are rendered at a time on renderers of their own, which share
+// one scheduler. When the tiles of a frame run out, its workers move on to the
+// tiles of the next frame, and a finished frame is handed on while the next
+// two are rendered. The threads of the frames work on their own tiles, so the
+// scheduler has one worker less per frame in flight than the given threads.
+// -----------------------------------------------------------------------------
+
+class CMandelbrotAnimation
+{
+public:
+
+    typedef std::function<bool(const SMandelbrotImage& _rImage, int _Frame)> FFrameFunction;
+
+public:
+
+    explicit CMandelbrotAnimation(int _NumberOfThreads = 0);
+    ~CMandelbrotAnimation();
+
+    CMandelbrotAnimation(const CMandelbrotAnimation&) = delete;
+    CMandelbrotAnimation& operator = (const CMandelbrotAnimation&) = delete;
+
+public:
+
+    int GetNumberOfThreads() const;
+
+    bool SetKeyframes(const std::vector<SMandelbrotKeyframe>& _rKeyframes);     // Needs at least one keyframe and strictly increasing frames.
+
+    int GetNumberOfFrames() const;                                              // Up to the last keyframe.
+
+    void GetFrameSettings(int _Frame, const SMandelbrotSettings& _rSettings, SMandelbrotSettings* _pSettings) const;       // The view of the frame, everything else is taken from _rSettings.
+
+    bool Render(const SMandelbrotSettings& _rSettings, const SMandelbrotPalette* _pPalette, const FFrameFunction& _rFunction);      // Hands the frames to _rFunction in order, the palette is optional.
+
+private:
+
+    static constexpr int s_MaxNumberOfFramesInFlight = 2;
+
+private:
+
+    struct SFrameView
+    {
+        int          m_Keyframe;                // The keyframe whose center the frame keeps.
+        double       m_CenterOffset[2];
+        double       m_PixelSize;
+        unsigned int m_MaxIteration;
+    };
+
+private:
+
+    int                                  m_NumberOfThreads;
+    int                                  m_NumberOfFramesInFlight;              // Only one frame with a single thread.
+    CTileScheduler                       m_Scheduler;
+    std::unique_ptr<CMandelbrotRenderer> m_pRenderers[s_MaxNumberOfFramesInFlight];
+    std::vector<SMandelbrotKeyframe>     m_Keyframes;
+    std::vector<double>                  m_Centers;                             // Real and imaginary part of every keyframe in double precision.
+    std::vector<double>                  m_Distances;                           // Real and imaginary part of the center of every keyframe minus the one of the keyframe before.
+    std::vector<double>                  m_ReferencePixelSizes;                 // The smallest pixel size of the frames of every keyframe.
+    std::vector<unsigned int>            m_ReferenceMaxIterations;              // The largest maximum iteration of the frames of every keyframe.
+
+private:
+
+    SFrameView GetFrameView(int _Frame) const;
+};
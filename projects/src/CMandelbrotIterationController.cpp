@@ -0,0 +1,172 @@
+#include "CMandelbrotIterationController.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace
+{
+    const unsigned int s_DefaultMinIteration    = 32;
+    const unsigned int s_DefaultMaxIteration    = 1u << 16;
+    const double       s_DefaultGrowth          = 1.25;
+    const double       s_DefaultMinEscapedShare = 0.0002;
+    const double       s_DefaultBudgetSeconds   = 0.004;
+    const unsigned int s_DefaultNumberOfSteps   = 0;
+} // namespace
+
+// -----------------------------------------------------------------------------
+
+void GetMandelbrotIterationControl(SMandelbrotIterationControl* _pControl)
+{
+    _pControl->m_MinIteration    = s_DefaultMinIteration;
+    _pControl->m_MaxIteration    = s_DefaultMaxIteration;
+    _pControl->m_Growth          = s_DefaultGrowth;
+    _pControl->m_MinEscapedShare = s_DefaultMinEscapedShare;
+    _pControl->m_BudgetSeconds   = s_DefaultBudgetSeconds;
+    _pControl->m_NumberOfSteps   = s_DefaultNumberOfSteps;
+}
+
+// -----------------------------------------------------------------------------
+
+CMandelbrotIterationController::CMandelbrotIterationController(const SMandelbrotIterationControl& _rControl)
+    : m_Control(_rControl)
+    , m_State()
+    , m_Image()
+    , m_MaxIteration(0)
+    , m_NumberOfBoundPixels(0)
+    , m_NumberOfEscapedPixels(0)
+    , m_SecondsPerIteration(0.0)
+    , m_IsResolved(false)
+{
+}
+
+// -----------------------------------------------------------------------------
+
+CMandelbrotIterationController::~CMandelbrotIterationController()
+{
+}
+
+// -----------------------------------------------------------------------------
+
+void CMandelbrotIterationController::Restart()
+{
+    m_State.m_Settings.m_Width = 0;
+
+    m_State.m_BoundPixels.clear();
+
+    m_MaxIteration          = 0;
+    m_NumberOfBoundPixels   = 0;
+    m_NumberOfEscapedPixels = 0;
+    m_SecondsPerIteration   = 0.0;
+    m_IsResolved            = false;
+}
+
+// -----------------------------------------------------------------------------
+
+bool CMandelbrotIterationController::Update(CMandelbrotRenderer& _rRenderer, const SMandelbrotSettings& _rSettings)
+{
+    if (_rSettings.m_Width <= 0 || _rSettings.m_Height <= 0) return false;
+
+    SMandelbrotSettings Settings = _rSettings;
+
+    unsigned long long NumberOfPixels = static_cast<unsigned long long>(_rSettings.m_Width) * static_cast<unsigned long long>(_rSettings.m_Height);
+
+    auto Start = std::chrono::steady_clock::now();
+
+    for (unsigned int Step = 0; !m_IsResolved; ++Step)
+    {
+        if (m_Control.m_NumberOfSteps > 0 && Step == m_Control.m_NumberOfSteps) break;
+
+        double Growth = std::max(m_MaxIteration * m_Control.m_Growth, m_MaxIteration + 1.0);
+
+        unsigned int MaxIteration = m_MaxIteration == 0 ? m_Control.m_MinIteration : static_cast<unsigned int>(std::min(Growth, static_cast<double>(m_Control.m_MaxIteration)));
+
+        // -----------------------------------------------------------------------------
+        // Only the bound pixels are continued, so the next step costs about
+        // as much per iteration of a bound pixel as the last one.
+        // -----------------------------------------------------------------------------
+        if (m_Control.m_NumberOfSteps == 0 && Step > 0)
+        {
+            double Seconds         = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+            double ExpectedSeconds = m_SecondsPerIteration * m_NumberOfBoundPixels * (MaxIteration - m_MaxIteration);
+
+            if (Seconds + ExpectedSeconds > m_Control.m_BudgetSeconds) break;
+        }
+
+        Settings.m_MaxIteration = MaxIteration;
+
+        auto StepStart = std::chrono::steady_clock::now();
+
+        if (!_rRenderer.Advance(Settings, &m_State, &m_Image)) return false;
+
+        double StepSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - StepStart).count();
+
+        // -----------------------------------------------------------------------------
+        // Pixels whose iteration reaches the maximum iteration of the last
+        // step were bound before it and iterated in it.
+        // -----------------------------------------------------------------------------
+        unsigned long long NumberOfBoundPixels   = 0;
+        unsigned long long NumberOfEscapedPixels = 0;
+        unsigned long long NumberOfIterations    = 0;
+
+        for (unsigned int Iteration : m_Image.m_Iterations)
+        {
+            if (Iteration < m_MaxIteration) continue;
+
+            NumberOfIterations += Iteration - m_MaxIteration;
+
+            if (Iteration >= MaxIteration) ++NumberOfBoundPixels;
+            else                           ++NumberOfEscapedPixels;
+        }
+
+        // -----------------------------------------------------------------------------
+        // As long as no pixel escaped at all, a deep view has not even reached
+        // the iterations its first details need.
+        // -----------------------------------------------------------------------------
+        m_SecondsPerIteration   = NumberOfIterations > 0 ? StepSeconds / NumberOfIterations : 0.0;
+        m_MaxIteration          = MaxIteration;
+        m_NumberOfBoundPixels   = NumberOfBoundPixels;
+        m_NumberOfEscapedPixels = NumberOfEscapedPixels;
+        m_IsResolved            = MaxIteration >= m_Control.m_MaxIteration || (NumberOfBoundPixels < NumberOfPixels && NumberOfEscapedPixels < m_Control.m_MinEscapedShare * NumberOfPixels);
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool CMandelbrotIterationController::IsResolved() const
+{
+    return m_IsResolved;
+}
+
+// -----------------------------------------------------------------------------
+
+unsigned int CMandelbrotIterationController::GetMaxIteration() const
+{
+    return m_MaxIteration;
+}
+
+// -----------------------------------------------------------------------------
+
+double CMandelbrotIterationController::GetBoundShare() const
+{
+    size_t NumberOfPixels = m_Image.m_Iterations.size();
+
+    return NumberOfPixels > 0 ? static_cast<double>(m_NumberOfBoundPixels) / NumberOfPixels : 0.0;
+}
+
+// -----------------------------------------------------------------------------
+
+double CMandelbrotIterationController::GetEscapedShare() const
+{
+    size_t NumberOfPixels = m_Image.m_Iterations.size();
+
+    return NumberOfPixels > 0 ? static_cast<double>(m_NumberOfEscapedPixels) / NumberOfPixels : 0.0;
+}
+
+// -----------------------------------------------------------------------------
+
+const SMandelbrotImage& CMandelbrotIterationController::GetImage() const
+{
+    return m_Image;
+}
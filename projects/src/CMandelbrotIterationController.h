@@ -0,0 +1,76 @@
+#pragma once
+
+#include "CMandelbrotRenderer.h"
+#include "SMandelbrotSettings.h"
+
+// -----------------------------------------------------------------------------
+// How CMandelbrotIterationController raises the maximum iteration of a view.
+// -----------------------------------------------------------------------------
+
+struct SMandelbrotIterationControl
+{
+    unsigned int m_MinIteration;                // The maximum iteration a view starts with.
+    unsigned int m_MaxIteration;                // The maximum iteration is never raised beyond this.
+    double       m_Growth;                      // Factor the maximum iteration grows by per step, a step adds at least one iteration.
+    double       m_MinEscapedShare;             // The view is resolved once a step lets fewer than this share of all pixels escape, but not before the first pixel escaped.
+    double       m_BudgetSeconds;               // Time of an Update, which does as many steps as are expected to fit and at least one.
+    unsigned int m_NumberOfSteps;               // Steps of an Update instead of the budget if not 0, so the result does not depend on the speed of the machine.
+};
+
+// -----------------------------------------------------------------------------
+// Grows a maximum iteration up to 2^16 by a quarter per step in a budget of
+// 4 ms and stops when less than 0.02% of the pixels escape in a step.
+// -----------------------------------------------------------------------------
+
+void GetMandelbrotIterationControl(SMandelbrotIterationControl* _pControl);
+
+// -----------------------------------------------------------------------------
+// Finds the maximum iteration a view needs. The view is iterated with
+// CMandelbrotRenderer::Advance, so every step only continues the pixels which
+// are still bound. After a step the controller counts the pixels which are
+// still bound and the ones which escaped in it. As long as enough pixels
+// escape, the next step raises the maximum iteration further. The cost of
+// the next step is expected to be the time per iteration of a bound pixel in
+// the last step times the iterations the bound pixels get, so an Update stops
+// before it would run beyond its budget and the next Update goes on. With a
+// fixed number of steps instead, the same views reach the same maximum
+// iterations in the same Updates on every machine.
+//
+// The image may be a small probe of a larger view, the share of the pixels
+// which escape in a step hardly depends on the resolution. So a display can
+// take the maximum iteration of a probe for its own rendering.
+// -----------------------------------------------------------------------------
+
+class CMandelbrotIterationController
+{
+public:
+
+    explicit CMandelbrotIterationController(const SMandelbrotIterationControl& _rControl);
+    ~CMandelbrotIterationController();
+
+public:
+
+    void Restart();                                                                 // Starts over at the minimum iteration, e.g. after the view changed.
+
+    bool Update(CMandelbrotRenderer& _rRenderer, const SMandelbrotSettings& _rSettings);    // Iterates the view of _rSettings, its maximum iteration is ignored. Returns false if the view is invalid.
+
+    bool IsResolved() const;                                                        // More iterations would hardly change the image.
+
+    unsigned int GetMaxIteration() const;                                           // The maximum iteration of the image, 0 before the first Update.
+
+    double GetBoundShare() const;                                                   // Share of the pixels which are still bound.
+    double GetEscapedShare() const;                                                 // Share of the pixels which escaped in the last step.
+
+    const SMandelbrotImage& GetImage() const;
+
+private:
+
+    SMandelbrotIterationControl m_Control;
+    SMandelbrotState            m_State;
+    SMandelbrotImage            m_Image;
+    unsigned int                m_MaxIteration;
+    unsigned long long          m_NumberOfBoundPixels;
+    unsigned long long          m_NumberOfEscapedPixels;                            // Escaped in the last step.
+    double                      m_SecondsPerIteration;                              // Time per iteration of a bound pixel in the last step, 0 if there was none.
+    bool                        m_IsResolved;
+};
@@ -0,0 +1,2042 @@
+#include "CMandelbrotRenderer.h"
+
+#include "CFixedPoint.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <future>
+#include <memory>
+#include <vector>
+
+namespace
+{
+    // -----------------------------------------------------------------------------
+    // The camera of CApplication looks from a distance of 10 onto the quad,
+    // which spans 32 units in world space and -4 to 4 in UV space.
+    // -----------------------------------------------------------------------------
+    const double s_CameraDistance  = 10.0;
+    const double s_FieldOfViewY    = 60.0;
+    const double s_UVPerWorldUnit  = 8.0 / 32.0;
+    const int    s_DefaultTileSize = 32;
+
+    // -----------------------------------------------------------------------------
+    // Rectangles with fewer inner pixels are iterated instead of subdivided.
+    // -----------------------------------------------------------------------------
+    const int    s_MinSubdivisionArea = 16;
+
+    // -----------------------------------------------------------------------------
+    // The distance estimate is only a rough bound, the true distance lies
+    // within a factor of about four of it.
+    // -----------------------------------------------------------------------------
+    const double s_DefaultSupersamplingDistance = 0.5;
+
+    // -----------------------------------------------------------------------------
+    // Rows handed out at once to the workers by the color mapping.
+    // -----------------------------------------------------------------------------
+    const int    s_NumberOfRowsPerBand = 16;
+
+    const double s_IterationsPerPalette = 32.0;
+
+    // -----------------------------------------------------------------------------
+    // One histogram entry per power of two of an unsigned int.
+    // -----------------------------------------------------------------------------
+    const int    s_NumberOfHistogramEntries = 32;
+
+    // -----------------------------------------------------------------------------
+    // A pixel of the previous frame is taken over as it is if its center is
+    // closer than this to the center of the new pixel, in new pixels. Pixels
+    // handed out at once to the workers by the reprojection.
+    // -----------------------------------------------------------------------------
+    const double s_MaxReprojectionError   = 1.0 / 256.0;
+    const int    s_NumberOfPixelsPerBatch = 1024;
+
+    // -----------------------------------------------------------------------------
+    // Bits below the pixel size of the coordinates handed to the extended
+    // precision kernels, enough for the four doubles of a quad-double.
+    // -----------------------------------------------------------------------------
+    const int    s_NumberOfPreciseGuardBits = 256;
+
+    // -----------------------------------------------------------------------------
+    // Single precision is what the shader uses. It is good enough as long as
+    // the pixels are a few hundred float epsilons apart.
+    // -----------------------------------------------------------------------------
+    const double s_MinSinglePrecisionPixelSize       = 256.0 * 1.1920929e-7;
+    const double s_MinDoublePrecisionPixelSize       = 256.0 * 2.220446e-16;
+    const double s_MinDoubleDoublePrecisionPixelSize = 256.0 * 4.9303807e-32;
+    const double s_MinQuadDoublePrecisionPixelSize   = 256.0 * 1.2154327e-63;
+
+    // -----------------------------------------------------------------------------
+    // Double-double only beats perturbation with this many double lanes, i.e.
+    // AVX-512. Quad-double is always more than ten times slower.
+    // -----------------------------------------------------------------------------
+    const int    s_MinDoubleDoubleLanes = 8;
+
+    // -----------------------------------------------------------------------------
+
+    double GetMagnitude(const SMandelbrotSettings& _rSettings)
+    {
+        return std::max(2.0, std::max(std::fabs(_rSettings.m_Center[0] + _rSettings.m_CenterOffset[0]) + 0.5 * _rSettings.m_PixelSize * _rSettings.m_Width, std::fabs(_rSettings.m_Center[1] + _rSettings.m_CenterOffset[1]) + _rSettings.m_PixelSize * (0.5 * _rSettings.m_Height + std::fabs(_rSettings.m_RowOffset))));
+    }
+
+    // -----------------------------------------------------------------------------
+    // The real part of the left column and the imaginary part of the top row
+    // of the image, of the larger image for a band.
+    // -----------------------------------------------------------------------------
+    double GetLeft(const SMandelbrotSettings& _rSettings)
+    {
+        return _rSettings.m_Center[0] + _rSettings.m_CenterOffset[0] - 0.5 * _rSettings.m_PixelSize * (_rSettings.m_Width - 1);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    double GetTop(const SMandelbrotSettings& _rSettings)
+    {
+        return _rSettings.m_Center[1] + _rSettings.m_CenterOffset[1] + _rSettings.m_PixelSize * (0.5 * (_rSettings.m_Height - 1) - _rSettings.m_RowOffset);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool IsSinglePrecisionSufficient(const SMandelbrotSettings& _rSettings)
+    {
+        return _rSettings.m_PixelSize >= s_MinSinglePrecisionPixelSize * GetMagnitude(_rSettings);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool IsDoublePrecisionSufficient(const SMandelbrotSettings& _rSettings)
+    {
+        return _rSettings.m_PixelSize >= s_MinDoublePrecisionPixelSize * GetMagnitude(_rSettings);
+    }
+
+    // -----------------------------------------------------------------------------
+    // Only z^2 + c has pixels for Advance, the subdivision, the extended
+    // precisions and perturbation.
+    // -----------------------------------------------------------------------------
+    bool IsQuadraticMandelbrot(const SMandelbrotSettings& _rSettings)
+    {
+        return _rSettings.m_Fractal == SFractal::Mandelbrot && _rSettings.m_Exponent == 2;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool IsSameView(const SMandelbrotSettings& _rLeft, const SMandelbrotSettings& _rRight)
+    {
+        return _rLeft.m_Width            == _rRight.m_Width
+            && _rLeft.m_Height           == _rRight.m_Height
+            && _rLeft.m_Center[0]        == _rRight.m_Center[0]
+            && _rLeft.m_Center[1]        == _rRight.m_Center[1]
+            && _rLeft.m_PreciseCenter[0] == _rRight.m_PreciseCenter[0]
+            && _rLeft.m_PreciseCenter[1] == _rRight.m_PreciseCenter[1]
+            && _rLeft.m_PixelSize        == _rRight.m_PixelSize
+            && _rLeft.m_RowOffset        == _rRight.m_RowOffset
+            && _rLeft.m_FirstRow         == _rRight.m_FirstRow
+            && _rLeft.m_CenterOffset[0]  == _rRight.m_CenterOffset[0]
+            && _rLeft.m_CenterOffset[1]  == _rRight.m_CenterOffset[1];
+    }
+
+    // -----------------------------------------------------------------------------
+
+    long long FloorDivide(long long _Value, long long _Divisor)
+    {
+        long long Quotient = _Value / _Divisor;
+
+        return (_Value % _Divisor != 0 && (_Value < 0) != (_Divisor < 0)) ? Quotient - 1 : Quotient;
+    }
+
+    // -----------------------------------------------------------------------------
+    // Where a row or a column of a view lies in the previous frame.
+    // -----------------------------------------------------------------------------
+    struct SReprojection
+    {
+        int   m_Nearest;                        // The closest previous pixel, -1 if it is outside.
+        int   m_Min;                            // The previous pixel before it, -1 if it or the one after it is outside.
+        float m_Blend;                          // Distance to m_Min in previous pixels.
+        bool  m_IsExact;                        // Closer to m_Nearest than the maximum offset.
+    };
+
+    SReprojection GetReprojection(double _Position, int _NumberOfPixels, double _MaxOffset)
+    {
+        SReprojection Reprojection = { -1, -1, 0.0f, false };
+
+        double Nearest = std::floor(_Position + 0.5);
+        double Min     = std::floor(_Position);
+
+        if (Nearest >= 0.0 && Nearest < _NumberOfPixels)
+        {
+            Reprojection.m_Nearest = static_cast<int>(Nearest);
+            Reprojection.m_IsExact = std::fabs(_Position - Nearest) <= _MaxOffset;
+        }
+
+        if (Min >= 0.0 && Min + 1.0 < _NumberOfPixels)
+        {
+            Reprojection.m_Min   = static_cast<int>(Min);
+            Reprojection.m_Blend = static_cast<float>(_Position - Min);
+        }
+
+        return Reprojection;
+    }
+
+    // -----------------------------------------------------------------------------
+    // The normalized iteration count n + 1 - log2(log2 |z|) / log2(d) of a
+    // pixel which escaped in iteration n with the squared magnitude |z|^2,
+    // where d is the exponent. It grows continuously from one iteration to the
+    // next, -1 marks bound pixels.
+    // -----------------------------------------------------------------------------
+    float GetSmoothIteration(const SMandelbrotSettings& _rSettings, unsigned int _Iteration, double _Magnitude)
+    {
+        if (_Iteration >= _rSettings.m_MaxIteration) return -1.0f;
+
+        float Smooth = static_cast<float>(_Iteration) + 1.0f - std::log2(0.5f * std::log2(static_cast<float>(_Magnitude))) / std::log2(static_cast<float>(_rSettings.m_Exponent));
+
+        return std::max(Smooth, 0.0f);
+    }
+
+    // -----------------------------------------------------------------------------
+    // Adds the indices of all pixels on the border of the rectangle, which
+    // includes _MaxX and _MaxY.
+    // -----------------------------------------------------------------------------
+    void GetBorderPixels(int _Width, int _MinX, int _MinY, int _MaxX, int _MaxY, std::vector<unsigned int>* _pIndicesOfPixels)
+    {
+        for (int X = _MinX; X <= _MaxX; ++X)
+        {
+            _pIndicesOfPixels->push_back(_MinY * _Width + X);
+
+            if (_MaxY > _MinY) _pIndicesOfPixels->push_back(_MaxY * _Width + X);
+        }
+
+        for (int Y = _MinY + 1; Y < _MaxY; ++Y)
+        {
+            _pIndicesOfPixels->push_back(Y * _Width + _MinX);
+
+            if (_MaxX > _MinX) _pIndicesOfPixels->push_back(Y * _Width + _MaxX);
+        }
+    }
+
+    // -----------------------------------------------------------------------------
+    // Mariani-Silver subdivision of a rectangle whose border is already in the
+    // image, _MaxX and _MaxY are part of the border. A rectangle with a bound
+    // border is bound inside, because neither the set nor the points bound for
+    // n iterations enclose escaping points. Only the border pixels are tested
+    // though, not the lines between them. With SSubdivision::Uniform every
+    // rectangle with a single iteration count on its border is filled. All
+    // other rectangles are split in two along their longer side.
+    //
+    // _rComputePixels(const unsigned int* _pIndicesOfPixels, int _NumberOfPixels)
+    // writes the iterations of the given pixels into the image.
+    // -----------------------------------------------------------------------------
+    template <typename TComputePixels>
+    void SubdivideRectangle(const SMandelbrotSettings& _rSettings, int _MinX, int _MinY, int _MaxX, int _MaxY, TComputePixels& _rComputePixels, std::vector<unsigned int>* _pIndicesOfPixels, SMandelbrotImage* _pImage, unsigned long long* _pNumberOfFilledPixels)
+    {
+        if (_MaxX - _MinX < 2 || _MaxY - _MinY < 2) return;
+
+        const int Width = _rSettings.m_Width;
+
+        unsigned int* pIterations       = _pImage->m_Iterations.data();
+        float*        pSmoothIterations = _pImage->m_SmoothIterations.data();
+
+        unsigned int Value = pIterations[_MinY * Width + _MinX];
+
+        bool IsUniform = _rSettings.m_Subdivision == SSubdivision::Uniform || Value == _rSettings.m_MaxIteration;
+
+        for (int X = _MinX; X <= _MaxX && IsUniform; ++X)
+        {
+            IsUniform = pIterations[_MinY * Width + X] == Value && pIterations[_MaxY * Width + X] == Value;
+        }
+
+        for (int Y = _MinY + 1; Y < _MaxY && IsUniform; ++Y)
+        {
+            IsUniform = pIterations[Y * Width + _MinX] == Value && pIterations[Y * Width + _MaxX] == Value;
+        }
+
+        // -----------------------------------------------------------------------------
+        // Filled pixels share the smooth iteration of the corner, which is -1 for
+        // bound rectangles.
+        // -----------------------------------------------------------------------------
+        if (IsUniform)
+        {
+            float Smooth = pSmoothIterations[_MinY * Width + _MinX];
+
+            for (int Y = _MinY + 1; Y < _MaxY; ++Y)
+            {
+                std::fill(pIterations       + Y * Width + _MinX + 1, pIterations       + Y * Width + _MaxX, Value);
+                std::fill(pSmoothIterations + Y * Width + _MinX + 1, pSmoothIterations + Y * Width + _MaxX, Smooth);
+            }
+
+            *_pNumberOfFilledPixels += static_cast<unsigned long long>(_MaxX - _MinX - 1) * (_MaxY - _MinY - 1);
+
+            return;
+        }
+
+        _pIndicesOfPixels->clear();
+
+        if ((_MaxX - _MinX - 1) * (_MaxY - _MinY - 1) <= s_MinSubdivisionArea)
+        {
+            for (int Y = _MinY + 1; Y < _MaxY; ++Y)
+            {
+                for (int X = _MinX + 1; X < _MaxX; ++X)
+                {
+                    _pIndicesOfPixels->push_back(Y * Width + X);
+                }
+            }
+
+            _rComputePixels(_pIndicesOfPixels->data(), static_cast<int>(_pIndicesOfPixels->size()));
+
+            return;
+        }
+
+        if (_MaxX - _MinX >= _MaxY - _MinY)
+        {
+            int SplitX = (_MinX + _MaxX) / 2;
+
+            for (int Y = _MinY + 1; Y < _MaxY; ++Y)
+            {
+                _pIndicesOfPixels->push_back(Y * Width + SplitX);
+            }
+
+            _rComputePixels(_pIndicesOfPixels->data(), static_cast<int>(_pIndicesOfPixels->size()));
+
+            SubdivideRectangle(_rSettings, _MinX, _MinY, SplitX, _MaxY, _rComputePixels, _pIndicesOfPixels, _pImage, _pNumberOfFilledPixels);
+            SubdivideRectangle(_rSettings, SplitX, _MinY, _MaxX, _MaxY, _rComputePixels, _pIndicesOfPixels, _pImage, _pNumberOfFilledPixels);
+        }
+        else
+        {
+            int SplitY = (_MinY + _MaxY) / 2;
+
+            for (int X = _MinX + 1; X < _MaxX; ++X)
+            {
+                _pIndicesOfPixels->push_back(SplitY * Width + X);
+            }
+
+            _rComputePixels(_pIndicesOfPixels->data(), static_cast<int>(_pIndicesOfPixels->size()));
+
+            SubdivideRectangle(_rSettings, _MinX, _MinY, _MaxX, SplitY, _rComputePixels, _pIndicesOfPixels, _pImage, _pNumberOfFilledPixels);
+            SubdivideRectangle(_rSettings, _MinX, SplitY, _MaxX, _MaxY, _rComputePixels, _pIndicesOfPixels, _pImage, _pNumberOfFilledPixels);
+        }
+    }
+
+    // -----------------------------------------------------------------------------
+    // Computes the border of a tile and subdivides it, see SubdivideRectangle.
+    // Returns the number of filled pixels.
+    // -----------------------------------------------------------------------------
+    template <typename TComputePixels>
+    unsigned long long SubdivideTile(const SMandelbrotSettings& _rSettings, int _MinX, int _MinY, int _MaxX, int _MaxY, TComputePixels& _rComputePixels, SMandelbrotImage* _pImage)
+    {
+        thread_local std::vector<unsigned int> s_IndicesOfPixels;
+
+        unsigned long long NumberOfFilledPixels = 0;
+
+        s_IndicesOfPixels.clear();
+
+        GetBorderPixels(_rSettings.m_Width, _MinX, _MinY, _MaxX - 1, _MaxY - 1, &s_IndicesOfPixels);
+
+        _rComputePixels(s_IndicesOfPixels.data(), static_cast<int>(s_IndicesOfPixels.size()));
+
+        SubdivideRectangle(_rSettings, _MinX, _MinY, _MaxX - 1, _MaxY - 1, _rComputePixels, &s_IndicesOfPixels, _pImage, &NumberOfFilledPixels);
+
+        return NumberOfFilledPixels;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    unsigned char GetColorChannel(float _Value)
+    {
+        return static_cast<unsigned char>(std::min(std::max(_Value, 0.0f), 1.0f) * 255.0f + 0.5f);
+    }
+
+    // -----------------------------------------------------------------------------
+    // Blends the colors of supersampled pixels with the black of their bound
+    // samples.
+    // -----------------------------------------------------------------------------
+    void ApplyCoverage(const float* _pCoverage, int _NumberOfPixels, unsigned char* _pPixels)
+    {
+        for (int IndexOfPixel = 0; IndexOfPixel < _NumberOfPixels; ++IndexOfPixel)
+        {
+            float Coverage = _pCoverage[IndexOfPixel];
+
+            if (Coverage >= 1.0f) continue;
+
+            unsigned char* pPixel = &_pPixels[IndexOfPixel * 4];
+
+            pPixel[0] = static_cast<unsigned char>(pPixel[0] * Coverage + 0.5f);
+            pPixel[1] = static_cast<unsigned char>(pPixel[1] * Coverage + 0.5f);
+            pPixel[2] = static_cast<unsigned char>(pPixel[2] * Coverage + 0.5f);
+        }
+    }
+
+    // -----------------------------------------------------------------------------
+    // The pixel counters of SMandelbrotFrameStatistics of a band of rows.
+    // -----------------------------------------------------------------------------
+    struct SPixelCounters
+    {
+        unsigned long long m_NumberOfIterations;
+        unsigned long long m_NumberOfEscapedPixels;
+        unsigned long long m_Histogram[s_NumberOfHistogramEntries];
+    };
+
+    int GetHistogramEntry(unsigned int _Iteration)
+    {
+        int Entry = 0;
+
+        while (_Iteration >>= 1) ++Entry;
+
+        return Entry;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void CountPixels(const unsigned int* _pIterations, size_t _NumberOfPixels, unsigned int _MaxIteration, SPixelCounters* _pCounters)
+    {
+        for (size_t IndexOfPixel = 0; IndexOfPixel < _NumberOfPixels; ++IndexOfPixel)
+        {
+            unsigned int Iteration = _pIterations[IndexOfPixel];
+
+            _pCounters->m_NumberOfIterations += Iteration;
+
+            if (Iteration >= _MaxIteration) continue;
+
+            _pCounters->m_NumberOfEscapedPixels += 1;
+            _pCounters->m_Histogram[GetHistogramEntry(Iteration)] += 1;
+        }
+    }
+} // namespace
+
+// -----------------------------------------------------------------------------
+// Makes a public method a frame of the statistics. Methods which fall back to
+// Render stay a single frame.
+// -----------------------------------------------------------------------------
+
+class CMandelbrotRenderer::CFrameScope
+{
+public:
+
+    CFrameScope(CMandelbrotRenderer* _pRenderer, const SMandelbrotSettings& _rSettings, const SMandelbrotImage& _rImage)
+        : m_pRenderer(_pRenderer)
+        , m_rImage(_rImage)
+    {
+        m_pRenderer->BeginFrame(_rSettings);
+    }
+
+    ~CFrameScope()
+    {
+        m_pRenderer->EndFrame(m_rImage);
+    }
+
+    CFrameScope(const CFrameScope&) = delete;
+    CFrameScope& operator = (const CFrameScope&) = delete;
+
+private:
+
+    CMandelbrotRenderer*    m_pRenderer;
+    const SMandelbrotImage& m_rImage;
+};
+
+// -----------------------------------------------------------------------------
+
+void GetMandelbrotSettings(int _Width, int _Height, const PSPerObjectConstants& _rConstants, SMandelbrotSettings* _pSettings)
+{
+    const double Pi = 3.14159265358979323846;
+
+    double VisibleHeight = 2.0 * s_CameraDistance * std::tan(s_FieldOfViewY * 0.5 * Pi / 180.0) * s_UVPerWorldUnit;
+
+    _pSettings->m_Width        = _Width;
+    _pSettings->m_Height       = _Height;
+    _pSettings->m_Center[0]    = 0.0;
+    _pSettings->m_Center[1]    = 0.0;
+    _pSettings->m_PreciseCenter[0].clear();
+    _pSettings->m_PreciseCenter[1].clear();
+    _pSettings->m_PixelSize    = VisibleHeight / static_cast<double>(_Height);
+    _pSettings->m_RowOffset    = 0.0;
+    _pSettings->m_FirstRow     = 0;
+    _pSettings->m_CenterOffset[0] = 0.0;
+    _pSettings->m_CenterOffset[1] = 0.0;
+    _pSettings->m_Fractal      = SFractal::Mandelbrot;
+    _pSettings->m_Exponent     = 2;
+    _pSettings->m_JuliaC[0]    = 0.0;
+    _pSettings->m_JuliaC[1]    = 0.0;
+    _pSettings->m_Color[0]     = _rConstants.m_PSColor[0];
+    _pSettings->m_Color[1]     = _rConstants.m_PSColor[1];
+    _pSettings->m_Color[2]     = _rConstants.m_PSColor[2];
+    _pSettings->m_MaxIteration = _rConstants.m_PSMaxIteration;
+    _pSettings->m_TileSize     = s_DefaultTileSize;
+
+    _pSettings->m_IsInteriorChecked       = true;
+    _pSettings->m_Subdivision             = SSubdivision::Off;
+    _pSettings->m_IsPerturbationPreferred = true;
+    _pSettings->m_Supersampling           = 1;
+    _pSettings->m_SupersamplingDistance   = s_DefaultSupersamplingDistance;
+}
+
+// -----------------------------------------------------------------------------
+// The cheapest arithmetic whose rounding stays far below the pixel size.
+// -----------------------------------------------------------------------------
+
+SMandelbrotPrecision::EMode GetMandelbrotPrecision(const SMandelbrotSettings& _rSettings)
+{
+    if (IsSinglePrecisionSufficient(_rSettings)) return SMandelbrotPrecision::Single;
+    if (IsDoublePrecisionSufficient(_rSettings)) return SMandelbrotPrecision::Double;
+
+    if (!IsQuadraticMandelbrot(_rSettings)) return SMandelbrotPrecision::Double;
+
+    double Magnitude = GetMagnitude(_rSettings);
+
+    bool IsDoubleDoubleCheaper = GetMandelbrotKernel().m_NumberOfDoubleLanes >= s_MinDoubleDoubleLanes;
+
+    if (_rSettings.m_PixelSize >= s_MinDoubleDoublePrecisionPixelSize * Magnitude && (IsDoubleDoubleCheaper || !_rSettings.m_IsPerturbationPreferred))
+    {
+        return SMandelbrotPrecision::DoubleDouble;
+    }
+
+    if (_rSettings.m_PixelSize >= s_MinQuadDoublePrecisionPixelSize * Magnitude && !_rSettings.m_IsPerturbationPreferred)
+    {
+        return SMandelbrotPrecision::QuadDouble;
+    }
+
+    return SMandelbrotPrecision::Perturbation;
+}
+
+// -----------------------------------------------------------------------------
+
+bool IsMandelbrotCenterValid(const SMandelbrotSettings& _rSettings)
+{
+    CFixedPoint Coordinate(CFixedPoint::GetNumberOfLimbs(s_NumberOfPreciseGuardBits));
+
+    for (int Axis = 0; Axis < 2; ++Axis)
+    {
+        if (!_rSettings.m_PreciseCenter[Axis].empty() && !Coordinate.SetFromString(_rSettings.m_PreciseCenter[Axis].c_str())) return false;
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+void GetMandelbrotPalette(const float (*_pStops)[3], int _NumberOfStops, int _NumberOfColors, SMandelbrotPalette* _pPalette)
+{
+    int NumberOfColors = 1;
+
+    while (NumberOfColors < _NumberOfColors) NumberOfColors *= 2;
+
+    _pPalette->m_Colors.resize(NumberOfColors);
+
+    for (int IndexOfColor = 0; IndexOfColor < NumberOfColors; ++IndexOfColor)
+    {
+        double Position = static_cast<double>(IndexOfColor) * _NumberOfStops / NumberOfColors;
+
+        int    IndexOfStop = static_cast<int>(Position);
+        double Blend       = Position - IndexOfStop;
+
+        const float* pFrom = _pStops[IndexOfStop];
+        const float* pTo   = _pStops[(IndexOfStop + 1) % _NumberOfStops];
+
+        unsigned int Color = 0xFF000000u;
+
+        for (int IndexOfChannel = 0; IndexOfChannel < 3; ++IndexOfChannel)
+        {
+            float Channel = static_cast<float>(pFrom[IndexOfChannel] + (pTo[IndexOfChannel] - pFrom[IndexOfChannel]) * Blend);
+
+            Color |= static_cast<unsigned int>(GetColorChannel(Channel)) << (8 * IndexOfChannel);
+        }
+
+        _pPalette->m_Colors[IndexOfColor] = Color;
+    }
+
+    _pPalette->m_Density = static_cast<float>(NumberOfColors / s_IterationsPerPalette);
+    _pPalette->m_Offset  = 0.0f;
+}
+
+// -----------------------------------------------------------------------------
+
+bool WriteMandelbrotStatistics(const SMandelbrotFrameStatistics& _rStatistics, const char* _pPath)
+{
+    FILE* pFile = std::fopen(_pPath, "w");
+
+    if (pFile == nullptr) return false;
+
+    const SMandelbrotInteriorStatistics& rInterior = _rStatistics.m_InteriorStatistics;
+
+    std::fprintf(pFile, "{\n");
+    std::fprintf(pFile, "    \"width\": %d,\n", _rStatistics.m_Width);
+    std::fprintf(pFile, "    \"height\": %d,\n", _rStatistics.m_Height);
+    std::fprintf(pFile, "    \"max_iteration\": %u,\n", _rStatistics.m_MaxIteration);
+    std::fprintf(pFile, "    \"seconds\": %.9g,\n", _rStatistics.m_Seconds);
+    std::fprintf(pFile, "    \"iterations\": %llu,\n", _rStatistics.m_NumberOfIterations);
+    std::fprintf(pFile, "    \"escaped_pixels\": %llu,\n", _rStatistics.m_NumberOfEscapedPixels);
+    std::fprintf(pFile, "    \"bound_pixels\": %llu,\n", _rStatistics.m_NumberOfBoundPixels);
+    std::fprintf(pFile, "    \"histogram\": [");
+
+    for (size_t IndexOfEntry = 0; IndexOfEntry < _rStatistics.m_Histogram.size(); ++IndexOfEntry)
+    {
+        std::fprintf(pFile, "%s%llu", IndexOfEntry > 0 ? ", " : "", _rStatistics.m_Histogram[IndexOfEntry]);
+    }
+
+    std::fprintf(pFile, "],\n");
+    std::fprintf(pFile, "    \"bulb_pixels\": %llu,\n", rInterior.m_NumberOfBulbPixels);
+    std::fprintf(pFile, "    \"bulb_iterations\": %llu,\n", rInterior.m_BulbIterations);
+    std::fprintf(pFile, "    \"periodic_pixels\": %llu,\n", rInterior.m_NumberOfPeriodicPixels);
+    std::fprintf(pFile, "    \"periodic_iterations\": %llu,\n", rInterior.m_PeriodicIterations);
+    std::fprintf(pFile, "    \"filled_pixels\": %llu,\n", _rStatistics.m_NumberOfFilledPixels);
+    std::fprintf(pFile, "    \"reprojected_pixels\": %llu,\n", _rStatistics.m_NumberOfReprojectedPixels);
+    std::fprintf(pFile, "    \"supersampled_pixels\": %llu,\n", _rStatistics.m_NumberOfSupersampledPixels);
+    std::fprintf(pFile, "    \"rebases\": %u,\n", _rStatistics.m_NumberOfRebases);
+    std::fprintf(pFile, "    \"passes\": [");
+
+    for (size_t IndexOfPass = 0; IndexOfPass < _rStatistics.m_Passes.size(); ++IndexOfPass)
+    {
+        const SMandelbrotPassStatistics& rPass = _rStatistics.m_Passes[IndexOfPass];
+
+        std::fprintf(pFile, "%s\n        {\n", IndexOfPass > 0 ? "," : "");
+        std::fprintf(pFile, "            \"name\": \"%s\",\n", rPass.m_pName);
+        std::fprintf(pFile, "            \"seconds\": %.9g,\n", rPass.m_Seconds);
+        std::fprintf(pFile, "            \"threads\": [");
+
+        for (size_t IndexOfThread = 0; IndexOfThread < rPass.m_Threads.size(); ++IndexOfThread)
+        {
+            const SMandelbrotThreadStatistics& rThread = rPass.m_Threads[IndexOfThread];
+
+            std::fprintf(pFile, "%s\n                { \"busy_seconds\": %.9g, \"idle_seconds\": %.9g, \"tiles\": %u, \"stolen_tiles\": %u }", IndexOfThread > 0 ? "," : "", rThread.m_BusySeconds, rThread.m_IdleSeconds, rThread.m_NumberOfTiles, rThread.m_NumberOfStolenTiles);
+        }
+
+        std::fprintf(pFile, "\n            ],\n");
+        std::fprintf(pFile, "            \"tile_seconds\": [");
+
+        for (size_t IndexOfTile = 0; IndexOfTile < rPass.m_TileSeconds.size(); ++IndexOfTile)
+        {
+            std::fprintf(pFile, "%s%.6g", IndexOfTile > 0 ? ", " : "", rPass.m_TileSeconds[IndexOfTile]);
+        }
+
+        std::fprintf(pFile, "]\n        }");
+    }
+
+    std::fprintf(pFile, "\n    ]\n}\n");
+
+    bool IsWritten = std::ferror(pFile) == 0;
+
+    return std::fclose(pFile) == 0 && IsWritten;
+}
+
+// -----------------------------------------------------------------------------
+
+CMandelbrotRenderer::CMandelbrotRenderer(int _NumberOfThreads)
+    : m_pOwnScheduler(new CTileScheduler(_NumberOfThreads))
+    , m_rScheduler(*m_pOwnScheduler)
+    , m_ReferenceOrbit()
+    , m_pSharedReferenceOrbit()
+    , m_pReferenceOrbit(&m_ReferenceOrbit)
+    , m_NumberOfRebases(0)
+    , m_NumberOfFilledPixels(0)
+    , m_NumberOfReprojectedPixels(0)
+    , m_NumberOfSupersampledPixels(0)
+    , m_InteriorStatistics()
+    , m_ThreadInteriorStatistics(m_rScheduler.GetNumberOfThreads())
+    , m_IsFrameStatisticsEnabled(false)
+    , m_FrameDepth(0)
+    , m_FrameStart()
+    , m_FrameStatistics()
+{
+}
+
+// -----------------------------------------------------------------------------
+
+CMandelbrotRenderer::CMandelbrotRenderer(CTileScheduler& _rScheduler)
+    : m_pOwnScheduler()
+    , m_rScheduler(_rScheduler)
+    , m_ReferenceOrbit()
+    , m_pSharedReferenceOrbit()
+    , m_pReferenceOrbit(&m_ReferenceOrbit)
+    , m_NumberOfRebases(0)
+    , m_NumberOfFilledPixels(0)
+    , m_NumberOfReprojectedPixels(0)
+    , m_NumberOfSupersampledPixels(0)
+    , m_InteriorStatistics()
+    , m_ThreadInteriorStatistics(m_rScheduler.GetNumberOfThreads())
+    , m_IsFrameStatisticsEnabled(false)
+    , m_FrameDepth(0)
+    , m_FrameStart()
+    , m_FrameStatistics()
+{
+}
+
+// -----------------------------------------------------------------------------
+
+CMandelbrotRenderer::~CMandelbrotRenderer()
+{
+}
+
+// -----------------------------------------------------------------------------
+
+int CMandelbrotRenderer::GetNumberOfThreads() const
+{
+    return m_rScheduler.GetNumberOfThreads();
+}
+
+// -----------------------------------------------------------------------------
+
+bool CMandelbrotRenderer::Render(const SMandelbrotSettings& _rSettings, SMandelbrotImage* _pImage)
+{
+    CFrameScope Frame(this, _rSettings, *_pImage);
+
+    if (_rSettings.m_Width <= 0 || _rSettings.m_Height <= 0 || _rSettings.m_TileSize <= 0) return false;
+
+    if (!IsMandelbrotCenterValid(_rSettings)) return false;
+
+    if (GetFractalIterateRow(GetMandelbrotKernel(), true, _rSettings.m_Fractal, _rSettings.m_Exponent) == nullptr) return false;
+
+    size_t NumberOfPixels = static_cast<size_t>(_rSettings.m_Width) * static_cast<size_t>(_rSettings.m_Height);
+
+    _pImage->m_Width  = _rSettings.m_Width;
+    _pImage->m_Height = _rSettings.m_Height;
+
+    _pImage->m_Iterations.resize(NumberOfPixels);
+    _pImage->m_SmoothIterations.resize(NumberOfPixels);
+    _pImage->m_Pixels.resize(NumberOfPixels * 4);
+    _pImage->m_Coverage.clear();
+
+    int NumberOfTilesX = (_rSettings.m_Width  + _rSettings.m_TileSize - 1) / _rSettings.m_TileSize;
+    int NumberOfTilesY = (_rSettings.m_Height + _rSettings.m_TileSize - 1) / _rSettings.m_TileSize;
+
+    ResetInteriorStatistics();
+
+    m_NumberOfFilledPixels       = 0;
+    m_NumberOfSupersampledPixels = 0;
+
+    SMandelbrotPrecision::EMode Precision = GetMandelbrotPrecision(_rSettings);
+
+    const SMandelbrotKernel& rKernel = GetMandelbrotKernel();
+
+    // -----------------------------------------------------------------------------
+    // Below the resolution of double precision only the reference orbit is
+    // computed with arbitrary precision, the pixels use perturbation.
+    // -----------------------------------------------------------------------------
+    if (Precision == SMandelbrotPrecision::Perturbation)
+    {
+        // -----------------------------------------------------------------------------
+        // A shared orbit is only read, so several renderers can use it at once.
+        // -----------------------------------------------------------------------------
+        if (m_pSharedReferenceOrbit != nullptr && m_pSharedReferenceOrbit->IsUpToDate(_rSettings))
+        {
+            m_pReferenceOrbit = m_pSharedReferenceOrbit.get();
+        }
+        else
+        {
+            if (!m_ReferenceOrbit.Update(_rSettings)) return false;
+
+            m_pReferenceOrbit = &m_ReferenceOrbit;
+        }
+
+        m_NumberOfRebases = 0;
+
+        RunTiles("perturbation", NumberOfTilesX * NumberOfTilesY, [&](int _Tile, int)
+        {
+            RenderTilePerturbation(_rSettings, _Tile, _pImage);
+        });
+
+        return true;
+    }
+
+    // -----------------------------------------------------------------------------
+    // The extended precisions get c from the exact center, the subdivision is
+    // not available for them.
+    // -----------------------------------------------------------------------------
+    if (Precision == SMandelbrotPrecision::DoubleDouble || Precision == SMandelbrotPrecision::QuadDouble)
+    {
+        FIterateRow pIterateRow = Precision == SMandelbrotPrecision::DoubleDouble ? rKernel.m_pIterateRowDoubleDouble : rKernel.m_pIterateRowQuadDouble;
+
+        UpdatePreciseCoordinates(_rSettings);
+
+        RunTiles("iterate", NumberOfTilesX * NumberOfTilesY, [&](int _Tile, int _Thread)
+        {
+            RenderTile(_rSettings, pIterateRow, true, false, _Tile, &m_ThreadInteriorStatistics[_Thread], _pImage);
+        });
+
+        MergeInteriorStatistics();
+
+        return true;
+    }
+
+    bool IsSinglePrecision = Precision == SMandelbrotPrecision::Single;
+    bool IsSupersampled    = _rSettings.m_Supersampling > 1;
+
+    // -----------------------------------------------------------------------------
+    // The subdivision iterates scattered pixels, which the kernels for
+    // progressive rendering pack into their lanes. It does not estimate
+    // distances for the supersampling.
+    // -----------------------------------------------------------------------------
+    if (_rSettings.m_Subdivision != SSubdivision::Off && IsQuadraticMandelbrot(_rSettings) && !IsSupersampled)
+    {
+        FAdvancePixels pAdvancePixels = IsSinglePrecision ? rKernel.m_pAdvancePixelsFloat : rKernel.m_pAdvancePixelsDouble;
+
+        RunTiles("subdivide", NumberOfTilesX * NumberOfTilesY, [&](int _Tile, int _Thread)
+        {
+            RenderTileSubdivided(_rSettings, pAdvancePixels, _Tile, &m_ThreadInteriorStatistics[_Thread], _pImage);
+        });
+    }
+    else
+    {
+        FIterateRow pIterateRow = GetFractalIterateRow(rKernel, !IsSinglePrecision, _rSettings.m_Fractal, _rSettings.m_Exponent);
+
+        if (IsSupersampled) m_Distances.resize(NumberOfPixels);
+
+        RunTiles("iterate", NumberOfTilesX * NumberOfTilesY, [&](int _Tile, int _Thread)
+        {
+            RenderTile(_rSettings, pIterateRow, false, IsSupersampled, _Tile, &m_ThreadInteriorStatistics[_Thread], _pImage);
+        });
+
+        // -----------------------------------------------------------------------------
+        // Whether a pixel is supersampled depends on its neighbours, so the
+        // supersampling starts once all tiles are done.
+        // -----------------------------------------------------------------------------
+        if (IsSupersampled)
+        {
+            _pImage->m_Coverage.assign(NumberOfPixels, 1.0f);
+
+            RunTiles("supersample", NumberOfTilesX * NumberOfTilesY, [&](int _Tile, int)
+            {
+                SupersampleTile(_rSettings, pIterateRow, _Tile, _pImage);
+            });
+        }
+    }
+
+    MergeInteriorStatistics();
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool CMandelbrotRenderer::Advance(const SMandelbrotSettings& _rSettings, SMandelbrotState* _pState, SMandelbrotImage* _pImage)
+{
+    CFrameScope Frame(this, _rSettings, *_pImage);
+
+    if (_rSettings.m_Width <= 0 || _rSettings.m_Height <= 0 || _rSettings.m_TileSize <= 0) return false;
+
+    if (!IsMandelbrotCenterValid(_rSettings)) return false;
+
+    // -----------------------------------------------------------------------------
+    // Deep zooms iterate differences to a reference orbit which changes with
+    // the maximum iteration or extended precision numbers which do not fit
+    // into SMandelbrotPixel, so they can not be continued. The same holds for
+    // the other fractals, which have no kernels for single pixels.
+    // -----------------------------------------------------------------------------
+    if (!IsDoublePrecisionSufficient(_rSettings) || !IsQuadraticMandelbrot(_rSettings))
+    {
+        _pState->m_Settings.m_Width = 0;
+
+        _pState->m_BoundPixels.clear();
+
+        return Render(_rSettings, _pImage);
+    }
+
+    size_t NumberOfPixels = static_cast<size_t>(_rSettings.m_Width) * static_cast<size_t>(_rSettings.m_Height);
+
+    int NumberOfTilesX = (_rSettings.m_Width  + _rSettings.m_TileSize - 1) / _rSettings.m_TileSize;
+    int NumberOfTilesY = (_rSettings.m_Height + _rSettings.m_TileSize - 1) / _rSettings.m_TileSize;
+
+    // -----------------------------------------------------------------------------
+    // Start over if the view changed or the maximum iteration went down. Only
+    // the bound pixels are written to the image, unless the image or the color
+    // is new.
+    // -----------------------------------------------------------------------------
+    bool IsRestart = !IsSameView(_rSettings, _pState->m_Settings) || _rSettings.m_TileSize != _pState->m_Settings.m_TileSize || _rSettings.m_MaxIteration < _pState->m_Settings.m_MaxIteration;
+
+    bool IsColorChanged = IsRestart || _pImage->m_Width != _rSettings.m_Width || _pImage->m_Height != _rSettings.m_Height
+        || _rSettings.m_Color[0] != _pState->m_Settings.m_Color[0]
+        || _rSettings.m_Color[1] != _pState->m_Settings.m_Color[1]
+        || _rSettings.m_Color[2] != _pState->m_Settings.m_Color[2];
+
+    if (IsRestart)
+    {
+        _pState->m_BoundPixels.resize(NumberOfTilesX * NumberOfTilesY);
+    }
+
+    _pState->m_Settings = _rSettings;
+
+    _pImage->m_Width  = _rSettings.m_Width;
+    _pImage->m_Height = _rSettings.m_Height;
+
+    _pImage->m_Iterations.resize(NumberOfPixels);
+    _pImage->m_SmoothIterations.resize(NumberOfPixels);
+    _pImage->m_Pixels.resize(NumberOfPixels * 4);
+    _pImage->m_Coverage.clear();
+
+    const SMandelbrotKernel& rKernel = GetMandelbrotKernel();
+
+    FAdvancePixels pAdvancePixels = IsSinglePrecisionSufficient(_rSettings) ? rKernel.m_pAdvancePixelsFloat : rKernel.m_pAdvancePixelsDouble;
+
+    ResetInteriorStatistics();
+
+    m_NumberOfFilledPixels = 0;
+
+    RunTiles("advance", NumberOfTilesX * NumberOfTilesY, [&](int _Tile, int _Thread)
+    {
+        AdvanceTile(_rSettings, pAdvancePixels, _Tile, IsRestart, IsColorChanged, &m_ThreadInteriorStatistics[_Thread], _pState, _pImage);
+    });
+
+    MergeInteriorStatistics();
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool CMandelbrotRenderer::RenderBands(const SMandelbrotSettings& _rSettings, int _NumberOfRowsPerBand, const FBandFunction& _rFunction)
+{
+    if (_rSettings.m_Width <= 0 || _rSettings.m_Height <= 0 || _NumberOfRowsPerBand <= 0) return false;
+
+    // -----------------------------------------------------------------------------
+    // Every band is rendered as an image of its own which keeps the center of
+    // the whole image, so deep zooms iterate all bands against one reference
+    // orbit. While the workers render a band into one image, the previous band
+    // in the other image is handed to _rFunction on a thread of its own.
+    // -----------------------------------------------------------------------------
+    SMandelbrotImage  Bands[2];
+    std::future<bool> Consumer;
+
+    SMandelbrotSettings BandSettings = _rSettings;
+
+    for (int FirstRow = 0, IndexOfBand = 0; FirstRow < _rSettings.m_Height; FirstRow += _NumberOfRowsPerBand, ++IndexOfBand)
+    {
+        SMandelbrotImage& rBand = Bands[IndexOfBand % 2];
+
+        BandSettings.m_Height    = std::min(_NumberOfRowsPerBand, _rSettings.m_Height - FirstRow);
+        BandSettings.m_RowOffset = _rSettings.m_RowOffset + 0.5 * (BandSettings.m_Height - _rSettings.m_Height);
+        BandSettings.m_FirstRow  = _rSettings.m_FirstRow + FirstRow;
+
+        if (!Render(BandSettings, &rBand)) return false;
+
+        if (Consumer.valid() && !Consumer.get()) return false;
+
+        Consumer = std::async(std::launch::async, [&_rFunction, &rBand, FirstRow]() { return _rFunction(rBand, FirstRow); });
+    }
+
+    return Consumer.get();
+}
+
+// -----------------------------------------------------------------------------
+
+bool CMandelbrotRenderer::RenderCached(const SMandelbrotSettings& _rSettings, CMandelbrotTileCache* _pCache, SMandelbrotImage* _pImage)
+{
+    CFrameScope Frame(this, _rSettings, *_pImage);
+
+    if (_rSettings.m_Width <= 0 || _rSettings.m_Height <= 0 || _rSettings.m_TileSize <= 0) return false;
+
+    if (!IsMandelbrotCenterValid(_rSettings)) return false;
+
+    // -----------------------------------------------------------------------------
+    // Deep zooms have no fixed pixel grid, their pixels are relative to the
+    // precise center. The tiles only hold the Mandelbrot set.
+    // -----------------------------------------------------------------------------
+    if (!IsDoublePrecisionSufficient(_rSettings) || !IsQuadraticMandelbrot(_rSettings)) return Render(_rSettings, _pImage);
+
+    const long long TileSize = CMandelbrotTileCache::s_TileSize;
+
+    int    Level         = CMandelbrotTileCache::GetLevel(_rSettings.m_PixelSize);
+    double TilePixelSize = CMandelbrotTileCache::GetPixelSize(Level);
+
+    double Left = GetLeft(_rSettings);
+    double Top  = GetTop(_rSettings);
+
+    // -----------------------------------------------------------------------------
+    // Every pixel of the view takes the pixel of the level it lies in. Pixel
+    // (X, Y) of the level has its center at ((X + 0.5) * TilePixelSize, (Y +
+    // 0.5) * TilePixelSize).
+    // -----------------------------------------------------------------------------
+    long long MinX = static_cast<long long>(std::floor(Left / TilePixelSize));
+    long long MaxX = static_cast<long long>(std::floor((Left + _rSettings.m_PixelSize * (_rSettings.m_Width - 1)) / TilePixelSize));
+    long long MinY = static_cast<long long>(std::floor((Top - _rSettings.m_PixelSize * (_rSettings.m_FirstRow + _rSettings.m_Height - 1)) / TilePixelSize));
+    long long MaxY = static_cast<long long>(std::floor((Top - _rSettings.m_PixelSize * _rSettings.m_FirstRow) / TilePixelSize));
+
+    long long MinTileX = FloorDivide(MinX, TileSize);
+    long long MaxTileX = FloorDivide(MaxX, TileSize);
+    long long MinTileY = FloorDivide(MinY, TileSize);
+    long long MaxTileY = FloorDivide(MaxY, TileSize);
+
+    int NumberOfTilesX = static_cast<int>(MaxTileX - MinTileX + 1);
+    int NumberOfTilesY = static_cast<int>(MaxTileY - MinTileY + 1);
+
+    std::vector<std::shared_ptr<const SMandelbrotTile>> Tiles(NumberOfTilesX * NumberOfTilesY);
+
+    SMandelbrotInteriorStatistics InteriorStatistics = SMandelbrotInteriorStatistics();
+    unsigned long long            NumberOfFilledPixels = 0;
+
+    for (int IndexOfTile = 0; IndexOfTile < NumberOfTilesX * NumberOfTilesY; ++IndexOfTile)
+    {
+        long long TileX = MinTileX + IndexOfTile % NumberOfTilesX;
+        long long TileY = MinTileY + IndexOfTile / NumberOfTilesX;
+
+        SMandelbrotSettings TileSettings = _rSettings;
+
+        TileSettings.m_Width     = static_cast<int>(TileSize);
+        TileSettings.m_Height    = static_cast<int>(TileSize);
+        TileSettings.m_Center[0] = (TileX * TileSize + 0.5 * TileSize) * TilePixelSize;
+        TileSettings.m_Center[1] = (TileY * TileSize + 0.5 * TileSize) * TilePixelSize;
+        TileSettings.m_PixelSize = TilePixelSize;
+        TileSettings.m_RowOffset = 0.0;
+        TileSettings.m_FirstRow  = 0;
+
+        TileSettings.m_CenterOffset[0] = 0.0;
+        TileSettings.m_CenterOffset[1] = 0.0;
+
+        TileSettings.m_Supersampling = 1;
+
+        TileSettings.m_PreciseCenter[0].clear();
+        TileSettings.m_PreciseCenter[1].clear();
+
+        SMandelbrotTileKey Key = { Level, TileX, TileY, _rSettings.m_MaxIteration, GetMandelbrotPrecision(TileSettings), TileSettings.m_Subdivision, TileSettings.m_IsInteriorChecked };
+
+        Tiles[IndexOfTile] = _pCache->Find(Key);
+
+        if (Tiles[IndexOfTile] != nullptr) continue;
+
+        // -----------------------------------------------------------------------------
+        // A missing tile is rendered on all workers and moved into the cache.
+        // -----------------------------------------------------------------------------
+        SMandelbrotImage TileImage;
+
+        Render(TileSettings, &TileImage);
+
+        const SMandelbrotInteriorStatistics& rTileStatistics = GetInteriorStatistics();
+
+        InteriorStatistics.m_NumberOfBulbPixels     += rTileStatistics.m_NumberOfBulbPixels;
+        InteriorStatistics.m_NumberOfPeriodicPixels += rTileStatistics.m_NumberOfPeriodicPixels;
+        InteriorStatistics.m_BulbIterations         += rTileStatistics.m_BulbIterations;
+        InteriorStatistics.m_PeriodicIterations     += rTileStatistics.m_PeriodicIterations;
+
+        NumberOfFilledPixels += GetNumberOfFilledPixels();
+
+        std::shared_ptr<SMandelbrotTile> pTile = std::make_shared<SMandelbrotTile>();
+
+        pTile->m_Key = Key;
+
+        pTile->m_Iterations.swap(TileImage.m_Iterations);
+        pTile->m_SmoothIterations.swap(TileImage.m_SmoothIterations);
+
+        _pCache->Insert(pTile);
+
+        Tiles[IndexOfTile] = pTile;
+    }
+
+    m_InteriorStatistics   = InteriorStatistics;
+    m_NumberOfFilledPixels = NumberOfFilledPixels;
+
+    // -----------------------------------------------------------------------------
+    // Copy the pixels of the tiles into the image, in bands over all workers.
+    // -----------------------------------------------------------------------------
+    size_t NumberOfPixels = static_cast<size_t>(_rSettings.m_Width) * static_cast<size_t>(_rSettings.m_Height);
+
+    _pImage->m_Width  = _rSettings.m_Width;
+    _pImage->m_Height = _rSettings.m_Height;
+
+    _pImage->m_Iterations.resize(NumberOfPixels);
+    _pImage->m_SmoothIterations.resize(NumberOfPixels);
+    _pImage->m_Pixels.resize(NumberOfPixels * 4);
+    _pImage->m_Coverage.clear();
+
+    int NumberOfBands = (_rSettings.m_Height + s_NumberOfRowsPerBand - 1) / s_NumberOfRowsPerBand;
+
+    RunTiles("compose", NumberOfBands, [&](int _Band, int)
+    {
+        int FirstY = _Band * s_NumberOfRowsPerBand;
+        int LastY  = std::min(FirstY + s_NumberOfRowsPerBand, _rSettings.m_Height);
+
+        for (int Y = FirstY; Y < LastY; ++Y)
+        {
+            long long LevelY = static_cast<long long>(std::floor((Top - _rSettings.m_PixelSize * (_rSettings.m_FirstRow + Y)) / TilePixelSize));
+            long long TileY  = FloorDivide(LevelY, TileSize);
+
+            size_t IndexOfRow = static_cast<size_t>(TileSize - 1 - (LevelY - TileY * TileSize)) * TileSize;
+
+            size_t IndexOfPixel = static_cast<size_t>(Y) * _rSettings.m_Width;
+
+            for (int X = 0; X < _rSettings.m_Width; ++X, ++IndexOfPixel)
+            {
+                long long LevelX = static_cast<long long>(std::floor((Left + _rSettings.m_PixelSize * X) / TilePixelSize));
+                long long TileX  = FloorDivide(LevelX, TileSize);
+
+                const SMandelbrotTile& rTile = *Tiles[(TileY - MinTileY) * NumberOfTilesX + (TileX - MinTileX)];
+
+                size_t IndexInTile = IndexOfRow + static_cast<size_t>(LevelX - TileX * TileSize);
+
+                _pImage->m_Iterations[IndexOfPixel]       = rTile.m_Iterations[IndexInTile];
+                _pImage->m_SmoothIterations[IndexOfPixel] = rTile.m_SmoothIterations[IndexInTile];
+            }
+
+            WriteColors(_rSettings, static_cast<size_t>(Y) * _rSettings.m_Width, _rSettings.m_Width, _pImage);
+        }
+    });
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool CMandelbrotRenderer::Reproject(const SMandelbrotSettings& _rSettings, const SMandelbrotSettings& _rPreviousSettings, const SMandelbrotImage& _rPreviousImage, SMandelbrotImage* _pImage)
+{
+    CFrameScope Frame(this, _rSettings, *_pImage);
+
+    if (_rSettings.m_Width <= 0 || _rSettings.m_Height <= 0 || _rSettings.m_TileSize <= 0) return false;
+
+    if (!IsMandelbrotCenterValid(_rSettings)) return false;
+
+    m_NumberOfReprojectedPixels = 0;
+
+    // -----------------------------------------------------------------------------
+    // Iterations of a different arithmetic are not reused. Deep zooms are not
+    // reprojected at all, their pixels are iterated with numbers which do not
+    // fit into SMandelbrotPixel. The uncovered pixels are iterated with the
+    // kernels of the Mandelbrot set.
+    // -----------------------------------------------------------------------------
+    SMandelbrotPrecision::EMode Precision = GetMandelbrotPrecision(_rSettings);
+
+    bool IsReusable = Precision <= SMandelbrotPrecision::Double
+        && IsQuadraticMandelbrot(_rSettings)
+        && IsQuadraticMandelbrot(_rPreviousSettings)
+        && Precision == GetMandelbrotPrecision(_rPreviousSettings)
+        && _rPreviousImage.m_Width  == _rPreviousSettings.m_Width
+        && _rPreviousImage.m_Height == _rPreviousSettings.m_Height
+        && _rPreviousImage.m_Width  > 0
+        && _rPreviousImage.m_Height > 0
+        && &_rPreviousImage != _pImage;
+
+    if (!IsReusable) return Render(_rSettings, _pImage);
+
+    size_t NumberOfPixels = static_cast<size_t>(_rSettings.m_Width) * static_cast<size_t>(_rSettings.m_Height);
+
+    _pImage->m_Width  = _rSettings.m_Width;
+    _pImage->m_Height = _rSettings.m_Height;
+
+    _pImage->m_Iterations.resize(NumberOfPixels);
+    _pImage->m_SmoothIterations.resize(NumberOfPixels);
+    _pImage->m_Pixels.resize(NumberOfPixels * 4);
+    _pImage->m_Coverage.clear();
+
+    double Left = GetLeft(_rSettings);
+    double Top  = GetTop(_rSettings);
+
+    double PreviousLeft = GetLeft(_rPreviousSettings);
+    double PreviousTop  = GetTop(_rPreviousSettings);
+
+    // -----------------------------------------------------------------------------
+    // Column X of the view lies at OffsetX + X * Scale in pixels of the previous
+    // frame, row Y at OffsetY + Y * Scale. Both are looked up only once.
+    // -----------------------------------------------------------------------------
+    double Scale     = _rSettings.m_PixelSize / _rPreviousSettings.m_PixelSize;
+    double OffsetX   = (Left - PreviousLeft) / _rPreviousSettings.m_PixelSize;
+    double OffsetY   = (PreviousTop - Top) / _rPreviousSettings.m_PixelSize;
+    double MaxOffset = s_MaxReprojectionError * Scale;
+
+    std::vector<SReprojection> Columns(_rSettings.m_Width);
+    std::vector<SReprojection> Rows(_rSettings.m_Height);
+
+    for (int X = 0; X < _rSettings.m_Width;  ++X) Columns[X] = GetReprojection(OffsetX + Scale * X, _rPreviousSettings.m_Width,  MaxOffset);
+    for (int Y = 0; Y < _rSettings.m_Height; ++Y) Rows[Y]    = GetReprojection(OffsetY + Scale * Y, _rPreviousSettings.m_Height, MaxOffset);
+
+    int          PreviousWidth        = _rPreviousSettings.m_Width;
+    unsigned int PreviousMaxIteration = _rPreviousSettings.m_MaxIteration;
+
+    bool IsBoundReusable = _rSettings.m_MaxIteration <= PreviousMaxIteration;
+
+    // -----------------------------------------------------------------------------
+    // Every band collects the pixels which are not covered by the previous
+    // frame and those whose previous neighbours disagree.
+    // -----------------------------------------------------------------------------
+    int NumberOfBands = (_rSettings.m_Height + s_NumberOfRowsPerBand - 1) / s_NumberOfRowsPerBand;
+
+    std::vector<std::vector<unsigned int>> NewPixels(NumberOfBands);
+    std::vector<std::vector<unsigned int>> UncertainPixels(NumberOfBands);
+
+    RunTiles("reproject", NumberOfBands, [&](int _Band, int)
+    {
+        int FirstY = _Band * s_NumberOfRowsPerBand;
+        int LastY  = std::min(FirstY + s_NumberOfRowsPerBand, _rSettings.m_Height);
+
+        for (int Y = FirstY; Y < LastY; ++Y)
+        {
+            const SReprojection& rRow = Rows[Y];
+
+            size_t IndexOfPixel = static_cast<size_t>(Y) * _rSettings.m_Width;
+
+            unsigned int* pIterations       = &_pImage->m_Iterations[IndexOfPixel];
+            float*        pSmoothIterations = &_pImage->m_SmoothIterations[IndexOfPixel];
+
+            for (int X = 0; X < _rSettings.m_Width; ++X)
+            {
+                const SReprojection& rColumn = Columns[X];
+
+                if (rRow.m_Nearest < 0 || rColumn.m_Nearest < 0)
+                {
+                    NewPixels[_Band].push_back(static_cast<unsigned int>(IndexOfPixel + X));
+
+                    continue;
+                }
+
+                unsigned int Iteration;
+                float        Smooth;
+
+                if (rRow.m_IsExact && rColumn.m_IsExact)
+                {
+                    // -----------------------------------------------------------------------------
+                    // The same point as before, e.g. after a pan by whole pixels.
+                    // -----------------------------------------------------------------------------
+                    size_t IndexOfPreviousPixel = static_cast<size_t>(rRow.m_Nearest) * PreviousWidth + rColumn.m_Nearest;
+
+                    Iteration = _rPreviousImage.m_Iterations[IndexOfPreviousPixel];
+                    Smooth    = _rPreviousImage.m_SmoothIterations[IndexOfPreviousPixel];
+                }
+                else
+                {
+                    // -----------------------------------------------------------------------------
+                    // In between four previous pixels. If all of them are bound
+                    // or escaped at most one iteration apart, the pixel most
+                    // likely does the same. The smooth iteration is continuous
+                    // there and is interpolated.
+                    // -----------------------------------------------------------------------------
+                    if (rRow.m_Min < 0 || rColumn.m_Min < 0)
+                    {
+                        UncertainPixels[_Band].push_back(static_cast<unsigned int>(IndexOfPixel + X));
+
+                        continue;
+                    }
+
+                    size_t IndexOfPreviousPixel = static_cast<size_t>(rRow.m_Min) * PreviousWidth + rColumn.m_Min;
+
+                    const unsigned int* pPreviousIterations       = &_rPreviousImage.m_Iterations[IndexOfPreviousPixel];
+                    const float*        pPreviousSmoothIterations = &_rPreviousImage.m_SmoothIterations[IndexOfPreviousPixel];
+
+                    unsigned int MinIteration = std::min(std::min(pPreviousIterations[0], pPreviousIterations[1]), std::min(pPreviousIterations[PreviousWidth], pPreviousIterations[PreviousWidth + 1]));
+                    unsigned int MaxIteration = std::max(std::max(pPreviousIterations[0], pPreviousIterations[1]), std::max(pPreviousIterations[PreviousWidth], pPreviousIterations[PreviousWidth + 1]));
+
+                    if (MaxIteration - MinIteration > 1 || (MaxIteration != MinIteration && MaxIteration >= PreviousMaxIteration))
+                    {
+                        UncertainPixels[_Band].push_back(static_cast<unsigned int>(IndexOfPixel + X));
+
+                        continue;
+                    }
+
+                    float Upper = pPreviousSmoothIterations[0]             + (pPreviousSmoothIterations[1]                 - pPreviousSmoothIterations[0])             * rColumn.m_Blend;
+                    float Lower = pPreviousSmoothIterations[PreviousWidth] + (pPreviousSmoothIterations[PreviousWidth + 1] - pPreviousSmoothIterations[PreviousWidth]) * rColumn.m_Blend;
+
+                    Iteration = pPreviousIterations[(rRow.m_Blend < 0.5f ? 0 : PreviousWidth) + (rColumn.m_Blend < 0.5f ? 0 : 1)];
+                    Smooth    = Upper + (Lower - Upper) * rRow.m_Blend;
+                }
+
+                // -----------------------------------------------------------------------------
+                // A bound pixel stays bound only if the maximum iteration did
+                // not grow.
+                // -----------------------------------------------------------------------------
+                if (Iteration >= PreviousMaxIteration && !IsBoundReusable)
+                {
+                    UncertainPixels[_Band].push_back(static_cast<unsigned int>(IndexOfPixel + X));
+
+                    continue;
+                }
+
+                if (Iteration >= PreviousMaxIteration || Iteration >= _rSettings.m_MaxIteration)
+                {
+                    Iteration = _rSettings.m_MaxIteration;
+                    Smooth    = -1.0f;
+                }
+
+                pIterations[X]       = Iteration;
+                pSmoothIterations[X] = Smooth;
+            }
+
+            WriteColors(_rSettings, IndexOfPixel, _rSettings.m_Width, _pImage);
+        }
+    });
+
+    // -----------------------------------------------------------------------------
+    // The newly exposed pixels are handed out first, then the uncertain ones.
+    // Every worker processes its batches in this order.
+    // -----------------------------------------------------------------------------
+    std::vector<unsigned int> IndicesOfPixels;
+
+    for (const std::vector<unsigned int>& rPixels : NewPixels)       IndicesOfPixels.insert(IndicesOfPixels.end(), rPixels.begin(), rPixels.end());
+    for (const std::vector<unsigned int>& rPixels : UncertainPixels) IndicesOfPixels.insert(IndicesOfPixels.end(), rPixels.begin(), rPixels.end());
+
+    m_NumberOfReprojectedPixels = NumberOfPixels - IndicesOfPixels.size();
+
+    const SMandelbrotKernel& rKernel = GetMandelbrotKernel();
+
+    FAdvancePixels pAdvancePixels = Precision == SMandelbrotPrecision::Single ? rKernel.m_pAdvancePixelsFloat : rKernel.m_pAdvancePixelsDouble;
+
+    int NumberOfBatches = static_cast<int>((IndicesOfPixels.size() + s_NumberOfPixelsPerBatch - 1) / s_NumberOfPixelsPerBatch);
+
+    ResetInteriorStatistics();
+
+    m_NumberOfFilledPixels = 0;
+
+    RunTiles("iterate", NumberOfBatches, [&](int _Batch, int _Thread)
+    {
+        size_t First = static_cast<size_t>(_Batch) * s_NumberOfPixelsPerBatch;
+        size_t Last  = std::min(First + s_NumberOfPixelsPerBatch, IndicesOfPixels.size());
+
+        thread_local std::vector<SMandelbrotPixel> s_Pixels;
+
+        s_Pixels.resize(Last - First);
+
+        // -----------------------------------------------------------------------------
+        // c is rounded exactly like in RenderTile, so the iterated pixels match
+        // a full rendering of the view.
+        // -----------------------------------------------------------------------------
+        for (size_t IndexOfPixel = First; IndexOfPixel < Last; ++IndexOfPixel)
+        {
+            int X = static_cast<int>(IndicesOfPixels[IndexOfPixel] % _rSettings.m_Width);
+            int Y = static_cast<int>(IndicesOfPixels[IndexOfPixel] / _rSettings.m_Width);
+
+            int MinX = X - X % _rSettings.m_TileSize;
+
+            SMandelbrotPixel Pixel = { { (Left + _rSettings.m_PixelSize * MinX) + _rSettings.m_PixelSize * (X - MinX), Top - _rSettings.m_PixelSize * (_rSettings.m_FirstRow + Y) }, { 0.0, 0.0 }, 0, 0, IndicesOfPixels[IndexOfPixel] };
+
+            s_Pixels[IndexOfPixel - First] = Pixel;
+        }
+
+        pAdvancePixels(s_Pixels.data(), static_cast<int>(s_Pixels.size()), _rSettings.m_MaxIteration, _rSettings.m_IsInteriorChecked, &m_ThreadInteriorStatistics[_Thread]);
+
+        for (const SMandelbrotPixel& rPixel : s_Pixels)
+        {
+            unsigned int Iteration = rPixel.m_IsEscaped ? rPixel.m_Iteration : _rSettings.m_MaxIteration;
+
+            _pImage->m_Iterations[rPixel.m_IndexOfPixel] = Iteration;
+            _pImage->m_SmoothIterations[rPixel.m_IndexOfPixel] = GetSmoothIteration(_rSettings, Iteration, rPixel.m_Z[0] * rPixel.m_Z[0] + rPixel.m_Z[1] * rPixel.m_Z[1]);
+
+            WriteColors(_rSettings, rPixel.m_IndexOfPixel, 1, _pImage);
+        }
+    });
+
+    MergeInteriorStatistics();
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+void CMandelbrotRenderer::MapColors(const SMandelbrotPalette& _rPalette, SMandelbrotImage* _pImage)
+{
+    if (_rPalette.m_Colors.empty() || _pImage->m_SmoothIterations.empty()) return;
+
+    // -----------------------------------------------------------------------------
+    // The offset is wrapped into the palette, so the index is never negative.
+    // -----------------------------------------------------------------------------
+    float NumberOfColors = static_cast<float>(_rPalette.m_Colors.size());
+
+    SMandelbrotColorMap ColorMap;
+
+    ColorMap.m_pColors = _rPalette.m_Colors.data();
+    ColorMap.m_Mask    = static_cast<unsigned int>(_rPalette.m_Colors.size() - 1);
+    ColorMap.m_Density = _rPalette.m_Density;
+    ColorMap.m_Offset  = _rPalette.m_Offset - NumberOfColors * std::floor(_rPalette.m_Offset / NumberOfColors);
+
+    FMapColors pMapColors = GetMandelbrotKernel().m_pMapColors;
+
+    int NumberOfBands = (_pImage->m_Height + s_NumberOfRowsPerBand - 1) / s_NumberOfRowsPerBand;
+
+    m_rScheduler.Run(NumberOfBands, [&](int _Band, int)
+    {
+        int MinY = _Band * s_NumberOfRowsPerBand;
+        int MaxY = std::min(MinY + s_NumberOfRowsPerBand, _pImage->m_Height);
+
+        size_t IndexOfPixel = static_cast<size_t>(MinY) * _pImage->m_Width;
+
+        pMapColors(ColorMap, &_pImage->m_SmoothIterations[IndexOfPixel], (MaxY - MinY) * _pImage->m_Width, &_pImage->m_Pixels[IndexOfPixel * 4]);
+
+        if (!_pImage->m_Coverage.empty())
+        {
+            ApplyCoverage(&_pImage->m_Coverage[IndexOfPixel], (MaxY - MinY) * _pImage->m_Width, &_pImage->m_Pixels[IndexOfPixel * 4]);
+        }
+    });
+}
+
+// -----------------------------------------------------------------------------
+
+bool CMandelbrotRenderer::PrepareReferenceOrbit(const SMandelbrotSettings& _rSettings)
+{
+    return m_ReferenceOrbit.Update(_rSettings);
+}
+
+// -----------------------------------------------------------------------------
+
+void CMandelbrotRenderer::SetSharedReferenceOrbit(const std::shared_ptr<const CReferenceOrbit>& _rpReferenceOrbit)
+{
+    m_pSharedReferenceOrbit = _rpReferenceOrbit;
+}
+
+// -----------------------------------------------------------------------------
+
+unsigned int CMandelbrotRenderer::GetNumberOfRebases() const
+{
+    return m_NumberOfRebases;
+}
+
+// -----------------------------------------------------------------------------
+
+const SMandelbrotInteriorStatistics& CMandelbrotRenderer::GetInteriorStatistics() const
+{
+    return m_InteriorStatistics;
+}
+
+// -----------------------------------------------------------------------------
+
+unsigned long long CMandelbrotRenderer::GetNumberOfFilledPixels() const
+{
+    return m_NumberOfFilledPixels;
+}
+
+// -----------------------------------------------------------------------------
+
+unsigned long long CMandelbrotRenderer::GetNumberOfReprojectedPixels() const
+{
+    return m_NumberOfReprojectedPixels;
+}
+
+// -----------------------------------------------------------------------------
+
+unsigned long long CMandelbrotRenderer::GetNumberOfSupersampledPixels() const
+{
+    return m_NumberOfSupersampledPixels;
+}
+
+// -----------------------------------------------------------------------------
+
+void CMandelbrotRenderer::EnableFrameStatistics(bool _IsEnabled)
+{
+    m_IsFrameStatisticsEnabled = _IsEnabled;
+}
+
+// -----------------------------------------------------------------------------
+
+const SMandelbrotFrameStatistics& CMandelbrotRenderer::GetFrameStatistics() const
+{
+    return m_FrameStatistics;
+}
+
+// -----------------------------------------------------------------------------
+
+void CMandelbrotRenderer::BeginFrame(const SMandelbrotSettings& _rSettings)
+{
+    if (m_FrameDepth++ > 0 || !m_IsFrameStatisticsEnabled) return;
+
+    m_FrameStart = std::chrono::steady_clock::now();
+
+    m_FrameStatistics = SMandelbrotFrameStatistics();
+
+    m_FrameStatistics.m_Width        = _rSettings.m_Width;
+    m_FrameStatistics.m_Height       = _rSettings.m_Height;
+    m_FrameStatistics.m_MaxIteration = _rSettings.m_MaxIteration;
+}
+
+// -----------------------------------------------------------------------------
+
+void CMandelbrotRenderer::EndFrame(const SMandelbrotImage& _rImage)
+{
+    if (--m_FrameDepth > 0 || !m_IsFrameStatisticsEnabled) return;
+
+    SMandelbrotFrameStatistics& rStatistics = m_FrameStatistics;
+
+    rStatistics.m_Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_FrameStart).count();
+
+    rStatistics.m_InteriorStatistics         = m_InteriorStatistics;
+    rStatistics.m_NumberOfFilledPixels       = m_NumberOfFilledPixels;
+    rStatistics.m_NumberOfReprojectedPixels  = m_NumberOfReprojectedPixels;
+    rStatistics.m_NumberOfSupersampledPixels = m_NumberOfSupersampledPixels;
+    rStatistics.m_NumberOfRebases            = m_NumberOfRebases;
+
+    // -----------------------------------------------------------------------------
+    // The pixels are counted in bands over all workers after the frame was
+    // timed. A frame which failed left no image of its size behind.
+    // -----------------------------------------------------------------------------
+    if (_rImage.m_Width != rStatistics.m_Width || _rImage.m_Height != rStatistics.m_Height || _rImage.m_Iterations.size() != static_cast<size_t>(_rImage.m_Width) * _rImage.m_Height) return;
+
+    int NumberOfBands = (_rImage.m_Height + s_NumberOfRowsPerBand - 1) / s_NumberOfRowsPerBand;
+
+    std::vector<SPixelCounters> Counters(NumberOfBands, SPixelCounters());
+
+    m_rScheduler.Run(NumberOfBands, [&](int _Band, int)
+    {
+        int MinY = _Band * s_NumberOfRowsPerBand;
+        int MaxY = std::min(MinY + s_NumberOfRowsPerBand, _rImage.m_Height);
+
+        size_t IndexOfPixel = static_cast<size_t>(MinY) * _rImage.m_Width;
+
+        CountPixels(&_rImage.m_Iterations[IndexOfPixel], static_cast<size_t>(MaxY - MinY) * _rImage.m_Width, rStatistics.m_MaxIteration, &Counters[_Band]);
+    });
+
+    unsigned long long Histogram[s_NumberOfHistogramEntries] = {};
+
+    for (const SPixelCounters& rCounters : Counters)
+    {
+        rStatistics.m_NumberOfIterations    += rCounters.m_NumberOfIterations;
+        rStatistics.m_NumberOfEscapedPixels += rCounters.m_NumberOfEscapedPixels;
+
+        for (int IndexOfEntry = 0; IndexOfEntry < s_NumberOfHistogramEntries; ++IndexOfEntry)
+        {
+            Histogram[IndexOfEntry] += rCounters.m_Histogram[IndexOfEntry];
+        }
+    }
+
+    rStatistics.m_NumberOfBoundPixels = _rImage.m_Iterations.size() - rStatistics.m_NumberOfEscapedPixels;
+
+    // -----------------------------------------------------------------------------
+    // The histogram ends with the entry of the last iteration a pixel can
+    // escape in.
+    // -----------------------------------------------------------------------------
+    int NumberOfEntries = GetHistogramEntry(std::max(rStatistics.m_MaxIteration, 1u) - 1) + 1;
+
+    rStatistics.m_Histogram.assign(Histogram, Histogram + NumberOfEntries);
+}
+
+// -----------------------------------------------------------------------------
+
+void CMandelbrotRenderer::RunTiles(const char* _pPass, int _NumberOfTiles, const CTileScheduler::FTileFunction& _rFunction)
+{
+    if (!m_IsFrameStatisticsEnabled || m_FrameDepth == 0)
+    {
+        m_rScheduler.Run(_NumberOfTiles, _rFunction);
+
+        return;
+    }
+
+    CTileScheduler::SRunStatistics Run;
+
+    m_rScheduler.Run(_NumberOfTiles, _rFunction, &Run);
+
+    SMandelbrotPassStatistics Pass;
+
+    Pass.m_pName       = _pPass;
+    Pass.m_Seconds     = Run.m_Seconds;
+    Pass.m_TileSeconds = Run.m_TileSeconds;
+
+    Pass.m_Threads.resize(Run.m_Threads.size());
+
+    for (size_t IndexOfThread = 0; IndexOfThread < Run.m_Threads.size(); ++IndexOfThread)
+    {
+        const CTileScheduler::SThreadStatistics& rThread = Run.m_Threads[IndexOfThread];
+
+        SMandelbrotThreadStatistics& rPassThread = Pass.m_Threads[IndexOfThread];
+
+        rPassThread.m_BusySeconds         = rThread.m_BusySeconds;
+        rPassThread.m_IdleSeconds         = std::max(Run.m_Seconds - rThread.m_BusySeconds, 0.0);
+        rPassThread.m_NumberOfTiles       = rThread.m_NumberOfTiles;
+        rPassThread.m_NumberOfStolenTiles = rThread.m_NumberOfStolenTiles;
+    }
+
+    m_FrameStatistics.m_Passes.push_back(std::move(Pass));
+}
+
+// -----------------------------------------------------------------------------
+
+void CMandelbrotRenderer::UpdatePreciseCoordinates(const SMandelbrotSettings& _rSettings)
+{
+    int NumberOfTilesX = (_rSettings.m_Width + _rSettings.m_TileSize - 1) / _rSettings.m_TileSize;
+
+    // -----------------------------------------------------------------------------
+    // The offsets to the center are exact in the fixed point numbers, which
+    // have room for all bits of the smallest of them.
+    // -----------------------------------------------------------------------------
+    int NumberOfFractionBits = static_cast<int>(std::ceil(-std::log2(_rSettings.m_PixelSize))) + s_NumberOfPreciseGuardBits;
+    int NumberOfLimbs        = CFixedPoint::GetNumberOfLimbs(std::max(NumberOfFractionBits, s_NumberOfPreciseGuardBits));
+
+    CFixedPoint Center[2] = { CFixedPoint(NumberOfLimbs), CFixedPoint(NumberOfLimbs) };
+    CFixedPoint Coordinate(NumberOfLimbs);
+
+    for (int Axis = 0; Axis < 2; ++Axis)
+    {
+        if (_rSettings.m_PreciseCenter[Axis].empty() || !Center[Axis].SetFromString(_rSettings.m_PreciseCenter[Axis].c_str()))
+        {
+            Center[Axis] = CFixedPoint(_rSettings.m_Center[Axis], NumberOfLimbs);
+        }
+    }
+
+    m_PreciseColumns.resize(4 * NumberOfTilesX);
+    m_PreciseRows.resize(4 * _rSettings.m_Height);
+
+    for (int TileX = 0; TileX < NumberOfTilesX; ++TileX)
+    {
+        double Offset = _rSettings.m_CenterOffset[0] + _rSettings.m_PixelSize * (TileX * _rSettings.m_TileSize - 0.5 * (_rSettings.m_Width - 1));
+
+        CFixedPoint::Add(Center[0], CFixedPoint(Offset, NumberOfLimbs), &Coordinate);
+
+        Coordinate.ToDoubles(&m_PreciseColumns[4 * TileX], 4);
+    }
+
+    for (int Y = 0; Y < _rSettings.m_Height; ++Y)
+    {
+        double Offset = _rSettings.m_CenterOffset[1] + _rSettings.m_PixelSize * (0.5 * (_rSettings.m_Height - 1) - _rSettings.m_RowOffset - (_rSettings.m_FirstRow + Y));
+
+        CFixedPoint::Add(Center[1], CFixedPoint(Offset, NumberOfLimbs), &Coordinate);
+
+        Coordinate.ToDoubles(&m_PreciseRows[4 * Y], 4);
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+void CMandelbrotRenderer::RenderTile(const SMandelbrotSettings& _rSettings, FIterateRow _pIterateRow, bool _IsPrecise, bool _IsDistanceEstimated, int _Tile, SMandelbrotInteriorStatistics* _pStatistics, SMandelbrotImage* _pImage)
+{
+    int NumberOfTilesX = (_rSettings.m_Width + _rSettings.m_TileSize - 1) / _rSettings.m_TileSize;
+
+    int MinX = (_Tile % NumberOfTilesX) * _rSettings.m_TileSize;
+    int MinY = (_Tile / NumberOfTilesX) * _rSettings.m_TileSize;
+    int MaxX = std::min(MinX + _rSettings.m_TileSize, _rSettings.m_Width);
+    int MaxY = std::min(MinY + _rSettings.m_TileSize, _rSettings.m_Height);
+
+    // -----------------------------------------------------------------------------
+    // Row 0 is the top of the image, so the imaginary part decreases with y
+    // like the V coordinate of the quad.
+    // -----------------------------------------------------------------------------
+    double Left = GetLeft(_rSettings);
+    double Top  = GetTop(_rSettings);
+
+    SMandelbrotRow Row = SMandelbrotRow();
+
+    Row.m_X                 = Left + _rSettings.m_PixelSize * MinX;
+    Row.m_StepX             = _rSettings.m_PixelSize;
+    Row.m_NumberOfPixels    = MaxX - MinX;
+    Row.m_MaxIteration      = _rSettings.m_MaxIteration;
+    Row.m_IsInteriorChecked = _rSettings.m_IsInteriorChecked;
+    Row.m_JuliaC[0]         = _rSettings.m_JuliaC[0];
+    Row.m_JuliaC[1]         = _rSettings.m_JuliaC[1];
+
+    if (_IsPrecise)
+    {
+        const double* pParts = &m_PreciseColumns[4 * (_Tile % NumberOfTilesX)];
+
+        Row.m_X = pParts[0];
+
+        std::copy(pParts + 1, pParts + 4, Row.m_XLow);
+    }
+
+    for (int Y = MinY; Y < MaxY; ++Y)
+    {
+        size_t IndexOfPixel = static_cast<size_t>(Y) * _rSettings.m_Width + MinX;
+
+        Row.m_Y          = Top - _rSettings.m_PixelSize * (_rSettings.m_FirstRow + Y);
+        Row.m_pDistances = _IsDistanceEstimated ? &m_Distances[IndexOfPixel] : nullptr;
+
+        if (_IsPrecise)
+        {
+            const double* pParts = &m_PreciseRows[4 * Y];
+
+            Row.m_Y = pParts[0];
+
+            std::copy(pParts + 1, pParts + 4, Row.m_YLow);
+        }
+
+        unsigned int* pIterations       = &_pImage->m_Iterations[IndexOfPixel];
+        float*        pSmoothIterations = &_pImage->m_SmoothIterations[IndexOfPixel];
+
+        // -----------------------------------------------------------------------------
+        // The kernel leaves the squared magnitudes in the smooth iterations.
+        // -----------------------------------------------------------------------------
+        _pIterateRow(Row, pIterations, pSmoothIterations, _pStatistics);
+
+        for (int X = 0; X < MaxX - MinX; ++X)
+        {
+            pSmoothIterations[X] = GetSmoothIteration(_rSettings, pIterations[X], pSmoothIterations[X]);
+        }
+
+        WriteColors(_rSettings, IndexOfPixel, MaxX - MinX, _pImage);
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+void CMandelbrotRenderer::SupersampleTile(const SMandelbrotSettings& _rSettings, FIterateRow _pIterateRow, int _Tile, SMandelbrotImage* _pImage)
+{
+    int NumberOfTilesX = (_rSettings.m_Width + _rSettings.m_TileSize - 1) / _rSettings.m_TileSize;
+
+    int MinX = (_Tile % NumberOfTilesX) * _rSettings.m_TileSize;
+    int MinY = (_Tile / NumberOfTilesX) * _rSettings.m_TileSize;
+    int MaxX = std::min(MinX + _rSettings.m_TileSize, _rSettings.m_Width);
+    int MaxY = std::min(MinY + _rSettings.m_TileSize, _rSettings.m_Height);
+
+    int    NumberOfSamples = _rSettings.m_Supersampling;
+    double SampleSize      = _rSettings.m_PixelSize / NumberOfSamples;
+
+    double Left = GetLeft(_rSettings);
+    double Top  = GetTop(_rSettings);
+
+    unsigned char Color[3] =
+    {
+        GetColorChannel(_rSettings.m_Color[0]),
+        GetColorChannel(_rSettings.m_Color[1]),
+        GetColorChannel(_rSettings.m_Color[2]),
+    };
+
+    SMandelbrotRow Row = SMandelbrotRow();
+
+    Row.m_StepX             = SampleSize;
+    Row.m_MaxIteration      = _rSettings.m_MaxIteration;
+    Row.m_IsInteriorChecked = _rSettings.m_IsInteriorChecked;
+    Row.m_JuliaC[0]         = _rSettings.m_JuliaC[0];
+    Row.m_JuliaC[1]         = _rSettings.m_JuliaC[1];
+
+    SMandelbrotInteriorStatistics Statistics = SMandelbrotInteriorStatistics();
+
+    thread_local std::vector<unsigned int> s_Iterations;
+    thread_local std::vector<float>        s_Magnitudes;
+    thread_local std::vector<unsigned int> s_NumberOfEscapedSamples;
+    thread_local std::vector<float>        s_SmoothIterations;
+
+    unsigned long long NumberOfSupersampledPixels = 0;
+
+    const unsigned int* pIterations = _pImage->m_Iterations.data();
+
+    auto IsEscaped = [&](int _X, int _Y)
+    {
+        return pIterations[static_cast<size_t>(_Y) * _rSettings.m_Width + _X] < _rSettings.m_MaxIteration;
+    };
+
+    for (int Y = MinY; Y < MaxY; ++Y)
+    {
+        size_t IndexOfRow = static_cast<size_t>(Y) * _rSettings.m_Width;
+
+        // -----------------------------------------------------------------------------
+        // A pixel is supersampled if the boundary may pass through it, i.e. it
+        // escaped close to the set or a neighbour is on the other side.
+        // -----------------------------------------------------------------------------
+        auto IsSupersampled = [&](int _X)
+        {
+            bool IsPixelEscaped = IsEscaped(_X, Y);
+
+            if (IsPixelEscaped && !(m_Distances[IndexOfRow + _X] >= _rSettings.m_SupersamplingDistance)) return true;
+
+            return (_X > 0                        && IsEscaped(_X - 1, Y) != IsPixelEscaped)
+                || (_X < _rSettings.m_Width - 1  && IsEscaped(_X + 1, Y) != IsPixelEscaped)
+                || (Y  > 0                        && IsEscaped(_X, Y - 1) != IsPixelEscaped)
+                || (Y  < _rSettings.m_Height - 1 && IsEscaped(_X, Y + 1) != IsPixelEscaped);
+        };
+
+        for (int FirstX = MinX; FirstX < MaxX; )
+        {
+            if (!IsSupersampled(FirstX))
+            {
+                ++FirstX;
+
+                continue;
+            }
+
+            int EndX = FirstX + 1;
+
+            while (EndX < MaxX && IsSupersampled(EndX)) ++EndX;
+
+            // -----------------------------------------------------------------------------
+            // The run is iterated as one row of samples per sample row, the samples
+            // lie in the centers of a regular grid over each pixel.
+            // -----------------------------------------------------------------------------
+            int NumberOfPixels = EndX - FirstX;
+
+            Row.m_NumberOfPixels = NumberOfPixels * NumberOfSamples;
+            Row.m_X              = Left + _rSettings.m_PixelSize * (FirstX - 0.5) + 0.5 * SampleSize;
+
+            s_Iterations.resize(Row.m_NumberOfPixels);
+            s_Magnitudes.resize(Row.m_NumberOfPixels);
+
+            s_NumberOfEscapedSamples.assign(NumberOfPixels, 0);
+            s_SmoothIterations.assign(NumberOfPixels, 0.0f);
+
+            for (int SampleY = 0; SampleY < NumberOfSamples; ++SampleY)
+            {
+                Row.m_Y = Top - _rSettings.m_PixelSize * (_rSettings.m_FirstRow + Y - 0.5) - (SampleY + 0.5) * SampleSize;
+
+                _pIterateRow(Row, s_Iterations.data(), s_Magnitudes.data(), &Statistics);
+
+                for (int IndexOfSample = 0; IndexOfSample < Row.m_NumberOfPixels; ++IndexOfSample)
+                {
+                    if (s_Iterations[IndexOfSample] >= _rSettings.m_MaxIteration) continue;
+
+                    int IndexOfPixel = IndexOfSample / NumberOfSamples;
+
+                    s_NumberOfEscapedSamples[IndexOfPixel] += 1;
+                    s_SmoothIterations[IndexOfPixel]       += GetSmoothIteration(_rSettings, s_Iterations[IndexOfSample], s_Magnitudes[IndexOfSample]);
+                }
+            }
+
+            for (int IndexOfPixel = 0; IndexOfPixel < NumberOfPixels; ++IndexOfPixel)
+            {
+                size_t IndexOfImagePixel = IndexOfRow + FirstX + IndexOfPixel;
+
+                unsigned int NumberOfEscapedSamples = s_NumberOfEscapedSamples[IndexOfPixel];
+
+                float Coverage = static_cast<float>(NumberOfEscapedSamples) / (NumberOfSamples * NumberOfSamples);
+
+                _pImage->m_Coverage[IndexOfImagePixel]         = Coverage;
+                _pImage->m_SmoothIterations[IndexOfImagePixel] = NumberOfEscapedSamples > 0 ? s_SmoothIterations[IndexOfPixel] / NumberOfEscapedSamples : -1.0f;
+
+                unsigned char* pPixel = &_pImage->m_Pixels[IndexOfImagePixel * 4];
+
+                pPixel[0] = static_cast<unsigned char>(Color[0] * Coverage + 0.5f);
+                pPixel[1] = static_cast<unsigned char>(Color[1] * Coverage + 0.5f);
+                pPixel[2] = static_cast<unsigned char>(Color[2] * Coverage + 0.5f);
+                pPixel[3] = 255;
+            }
+
+            NumberOfSupersampledPixels += NumberOfPixels;
+
+            FirstX = EndX;
+        }
+    }
+
+    m_NumberOfSupersampledPixels += NumberOfSupersampledPixels;
+}
+
+// -----------------------------------------------------------------------------
+
+void CMandelbrotRenderer::RenderTileSubdivided(const SMandelbrotSettings& _rSettings, FAdvancePixels _pAdvancePixels, int _Tile, SMandelbrotInteriorStatistics* _pStatistics, SMandelbrotImage* _pImage)
+{
+    int NumberOfTilesX = (_rSettings.m_Width + _rSettings.m_TileSize - 1) / _rSettings.m_TileSize;
+
+    int MinX = (_Tile % NumberOfTilesX) * _rSettings.m_TileSize;
+    int MinY = (_Tile / NumberOfTilesX) * _rSettings.m_TileSize;
+    int MaxX = std::min(MinX + _rSettings.m_TileSize, _rSettings.m_Width);
+    int MaxY = std::min(MinY + _rSettings.m_TileSize, _rSettings.m_Height);
+
+    double Left = GetLeft(_rSettings);
+    double Top  = GetTop(_rSettings);
+
+    double TileLeft = Left + _rSettings.m_PixelSize * MinX;
+
+    thread_local std::vector<SMandelbrotPixel> s_Pixels;
+
+    auto ComputePixels = [&](const unsigned int* _pIndicesOfPixels, int _NumberOfPixels)
+    {
+        s_Pixels.resize(_NumberOfPixels);
+
+        for (int IndexOfPixel = 0; IndexOfPixel < _NumberOfPixels; ++IndexOfPixel)
+        {
+            int X = static_cast<int>(_pIndicesOfPixels[IndexOfPixel] % _rSettings.m_Width);
+            int Y = static_cast<int>(_pIndicesOfPixels[IndexOfPixel] / _rSettings.m_Width);
+
+            SMandelbrotPixel Pixel = { { TileLeft + _rSettings.m_PixelSize * (X - MinX), Top - _rSettings.m_PixelSize * (_rSettings.m_FirstRow + Y) }, { 0.0, 0.0 }, 0, 0, _pIndicesOfPixels[IndexOfPixel] };
+
+            s_Pixels[IndexOfPixel] = Pixel;
+        }
+
+        _pAdvancePixels(s_Pixels.data(), _NumberOfPixels, _rSettings.m_MaxIteration, _rSettings.m_IsInteriorChecked, _pStatistics);
+
+        for (const SMandelbrotPixel& rPixel : s_Pixels)
+        {
+            unsigned int Iteration = rPixel.m_IsEscaped ? rPixel.m_Iteration : _rSettings.m_MaxIteration;
+
+            _pImage->m_Iterations[rPixel.m_IndexOfPixel] = Iteration;
+            _pImage->m_SmoothIterations[rPixel.m_IndexOfPixel] = GetSmoothIteration(_rSettings, Iteration, rPixel.m_Z[0] * rPixel.m_Z[0] + rPixel.m_Z[1] * rPixel.m_Z[1]);
+        }
+    };
+
+    m_NumberOfFilledPixels += SubdivideTile(_rSettings, MinX, MinY, MaxX, MaxY, ComputePixels, _pImage);
+
+    for (int Y = MinY; Y < MaxY; ++Y)
+    {
+        WriteColors(_rSettings, static_cast<size_t>(Y) * _rSettings.m_Width + MinX, MaxX - MinX, _pImage);
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+void CMandelbrotRenderer::AdvanceTile(const SMandelbrotSettings& _rSettings, FAdvancePixels _pAdvancePixels, int _Tile, bool _IsRestart, bool _IsColorChanged, SMandelbrotInteriorStatistics* _pStatistics, SMandelbrotState* _pState, SMandelbrotImage* _pImage)
+{
+    int NumberOfTilesX = (_rSettings.m_Width + _rSettings.m_TileSize - 1) / _rSettings.m_TileSize;
+
+    int MinX = (_Tile % NumberOfTilesX) * _rSettings.m_TileSize;
+    int MinY = (_Tile / NumberOfTilesX) * _rSettings.m_TileSize;
+    int MaxX = std::min(MinX + _rSettings.m_TileSize, _rSettings.m_Width);
+    int MaxY = std::min(MinY + _rSettings.m_TileSize, _rSettings.m_Height);
+
+    double Left = GetLeft(_rSettings);
+    double Top  = GetTop(_rSettings);
+
+    std::vector<SMandelbrotPixel>& rBoundPixels = _pState->m_BoundPixels[_Tile];
+
+    if (_IsRestart)
+    {
+        rBoundPixels.clear();
+
+        // -----------------------------------------------------------------------------
+        // c is rounded exactly like in RenderTile, so both give the same image.
+        // -----------------------------------------------------------------------------
+        double TileLeft = Left + _rSettings.m_PixelSize * MinX;
+
+        for (int Y = MinY; Y < MaxY; ++Y)
+        {
+            for (int X = MinX; X < MaxX; ++X)
+            {
+                SMandelbrotPixel Pixel = { { TileLeft + _rSettings.m_PixelSize * (X - MinX), Top - _rSettings.m_PixelSize * (_rSettings.m_FirstRow + Y) }, { 0.0, 0.0 }, 0, 0, static_cast<unsigned int>(Y * _rSettings.m_Width + X) };
+
+                rBoundPixels.push_back(Pixel);
+            }
+        }
+    }
+
+    if (!rBoundPixels.empty())
+    {
+        _pAdvancePixels(rBoundPixels.data(), static_cast<int>(rBoundPixels.size()), _rSettings.m_MaxIteration, _rSettings.m_IsInteriorChecked, _pStatistics);
+    }
+
+    // -----------------------------------------------------------------------------
+    // Write the pixels of this call and drop the escaped ones from the list, so
+    // the next call only iterates pixels which are still bound. Bound pixels
+    // were black before and stay black.
+    // -----------------------------------------------------------------------------
+    size_t NumberOfBoundPixels = 0;
+
+    for (const SMandelbrotPixel& rPixel : rBoundPixels)
+    {
+        if (rPixel.m_IsEscaped)
+        {
+            _pImage->m_Iterations[rPixel.m_IndexOfPixel] = rPixel.m_Iteration;
+            _pImage->m_SmoothIterations[rPixel.m_IndexOfPixel] = GetSmoothIteration(_rSettings, rPixel.m_Iteration, rPixel.m_Z[0] * rPixel.m_Z[0] + rPixel.m_Z[1] * rPixel.m_Z[1]);
+
+            if (!_IsColorChanged) WriteColors(_rSettings, rPixel.m_IndexOfPixel, 1, _pImage);
+        }
+        else
+        {
+            _pImage->m_Iterations[rPixel.m_IndexOfPixel] = _rSettings.m_MaxIteration;
+            _pImage->m_SmoothIterations[rPixel.m_IndexOfPixel] = -1.0f;
+
+            rBoundPixels[NumberOfBoundPixels++] = rPixel;
+        }
+    }
+
+    rBoundPixels.resize(NumberOfBoundPixels);
+
+    if (!_IsColorChanged) return;
+
+    for (int Y = MinY; Y < MaxY; ++Y)
+    {
+        WriteColors(_rSettings, static_cast<size_t>(Y) * _rSettings.m_Width + MinX, MaxX - MinX, _pImage);
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+void CMandelbrotRenderer::RenderTilePerturbation(const SMandelbrotSettings& _rSettings, int _Tile, SMandelbrotImage* _pImage)
+{
+    int NumberOfTilesX = (_rSettings.m_Width + _rSettings.m_TileSize - 1) / _rSettings.m_TileSize;
+
+    int MinX = (_Tile % NumberOfTilesX) * _rSettings.m_TileSize;
+    int MinY = (_Tile / NumberOfTilesX) * _rSettings.m_TileSize;
+    int MaxX = std::min(MinX + _rSettings.m_TileSize, _rSettings.m_Width);
+    int MaxY = std::min(MinY + _rSettings.m_TileSize, _rSettings.m_Height);
+
+    FIteratePerturbation pIteratePerturbation = GetMandelbrotKernel().m_pIteratePerturbation;
+
+    // -----------------------------------------------------------------------------
+    // The kernel gets dc of the pixels, a tile holds at most as many pixels
+    // as the subdivision passes at once.
+    // -----------------------------------------------------------------------------
+    size_t NumberOfPixels = static_cast<size_t>(MaxX - MinX) * static_cast<size_t>(MaxY - MinY);
+
+    std::vector<double>       DCXs(NumberOfPixels);
+    std::vector<double>       DCYs(NumberOfPixels);
+    std::vector<double>       Magnitudes(NumberOfPixels);
+    std::vector<unsigned int> Iterations(NumberOfPixels);
+
+    SMandelbrotPerturbation Perturbation;
+
+    Perturbation.m_pOrbit       = m_pReferenceOrbit->GetPoints();
+    Perturbation.m_OrbitLength  = m_pReferenceOrbit->GetLength();
+    Perturbation.m_pDCX         = DCXs.data();
+    Perturbation.m_pDCY         = DCYs.data();
+    Perturbation.m_MaxIteration = _rSettings.m_MaxIteration;
+
+    unsigned int NumberOfRebases = 0;
+
+    auto ComputePixels = [&](const unsigned int* _pIndicesOfPixels, int _NumberOfPixels)
+    {
+        for (int IndexOfPixel = 0; IndexOfPixel < _NumberOfPixels; ++IndexOfPixel)
+        {
+            int X = static_cast<int>(_pIndicesOfPixels[IndexOfPixel] % _rSettings.m_Width);
+            int Y = static_cast<int>(_pIndicesOfPixels[IndexOfPixel] / _rSettings.m_Width);
+
+            DCXs[IndexOfPixel] = _rSettings.m_CenterOffset[0] + (X - 0.5 * (_rSettings.m_Width  - 1)) * _rSettings.m_PixelSize;
+            DCYs[IndexOfPixel] = _rSettings.m_CenterOffset[1] + (0.5 * (_rSettings.m_Height - 1) - _rSettings.m_RowOffset - (_rSettings.m_FirstRow + Y)) * _rSettings.m_PixelSize;
+        }
+
+        Perturbation.m_NumberOfPixels = _NumberOfPixels;
+
+        pIteratePerturbation(Perturbation, Iterations.data(), Magnitudes.data(), &NumberOfRebases);
+
+        for (int IndexOfPixel = 0; IndexOfPixel < _NumberOfPixels; ++IndexOfPixel)
+        {
+            _pImage->m_Iterations[_pIndicesOfPixels[IndexOfPixel]] = Iterations[IndexOfPixel];
+            _pImage->m_SmoothIterations[_pIndicesOfPixels[IndexOfPixel]] = GetSmoothIteration(_rSettings, Iterations[IndexOfPixel], Magnitudes[IndexOfPixel]);
+        }
+    };
+
+    if (_rSettings.m_Subdivision != SSubdivision::Off)
+    {
+        m_NumberOfFilledPixels += SubdivideTile(_rSettings, MinX, MinY, MaxX, MaxY, ComputePixels, _pImage);
+    }
+    else
+    {
+        std::vector<unsigned int> IndicesOfPixels;
+
+        IndicesOfPixels.reserve(NumberOfPixels);
+
+        for (int Y = MinY; Y < MaxY; ++Y)
+        {
+            for (int X = MinX; X < MaxX; ++X) IndicesOfPixels.push_back(static_cast<unsigned int>(static_cast<size_t>(Y) * _rSettings.m_Width + X));
+        }
+
+        ComputePixels(IndicesOfPixels.data(), static_cast<int>(IndicesOfPixels.size()));
+    }
+
+    for (int Y = MinY; Y < MaxY; ++Y)
+    {
+        WriteColors(_rSettings, static_cast<size_t>(Y) * _rSettings.m_Width + MinX, MaxX - MinX, _pImage);
+    }
+
+    m_NumberOfRebases += NumberOfRebases;
+}
+
+// -----------------------------------------------------------------------------
+
+void CMandelbrotRenderer::ResetInteriorStatistics()
+{
+    m_InteriorStatistics = SMandelbrotInteriorStatistics();
+
+    std::fill(m_ThreadInteriorStatistics.begin(), m_ThreadInteriorStatistics.end(), SMandelbrotInteriorStatistics());
+}
+
+// -----------------------------------------------------------------------------
+
+void CMandelbrotRenderer::MergeInteriorStatistics()
+{
+    for (const SMandelbrotInteriorStatistics& rStatistics : m_ThreadInteriorStatistics)
+    {
+        m_InteriorStatistics.m_NumberOfBulbPixels     += rStatistics.m_NumberOfBulbPixels;
+        m_InteriorStatistics.m_NumberOfPeriodicPixels += rStatistics.m_NumberOfPeriodicPixels;
+        m_InteriorStatistics.m_BulbIterations         += rStatistics.m_BulbIterations;
+        m_InteriorStatistics.m_PeriodicIterations     += rStatistics.m_PeriodicIterations;
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+void CMandelbrotRenderer::WriteColors(const SMandelbrotSettings& _rSettings, size_t _IndexOfPixel, int _NumberOfPixels, SMandelbrotImage* _pImage)
+{
+    unsigned char Color[4] =
+    {
+        GetColorChannel(_rSettings.m_Color[0]),
+        GetColorChannel(_rSettings.m_Color[1]),
+        GetColorChannel(_rSettings.m_Color[2]),
+        255,
+    };
+
+    for (size_t IndexOfPixel = _IndexOfPixel; IndexOfPixel < _IndexOfPixel + _NumberOfPixels; ++IndexOfPixel)
+    {
+        unsigned int Iteration = _pImage->m_Iterations[IndexOfPixel];
+
+        // -----------------------------------------------------------------------------
+        // Like PSMain escaped pixels get the color, bound pixels are black.
+        // -----------------------------------------------------------------------------
+        unsigned char* pPixel = &_pImage->m_Pixels[IndexOfPixel * 4];
+
+        bool IsEscaped = Iteration < _rSettings.m_MaxIteration;
+
+        pPixel[0] = IsEscaped ? Color[0] : 0;
+        pPixel[1] = IsEscaped ? Color[1] : 0;
+        pPixel[2] = IsEscaped ? Color[2] : 0;
+        pPixel[3] = 255;
+    }
+}
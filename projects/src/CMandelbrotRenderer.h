@@ -0,0 +1,110 @@
+#pragma once
+
+#include "CMandelbrotTileCache.h"
+#include "CReferenceOrbit.h"
+#include "CTileScheduler.h"
+#include "MandelbrotKernel.h"
+#include "SMandelbrotSettings.h"
+
+#include <memory>
+
+// -----------------------------------------------------------------------------
+// Computes the escape time image of mandelbrot.fx on the CPU. The image is
+// split into tiles which are distributed over all cores by a work stealing
+// scheduler. Views beyond double precision are rendered with double-double
+// or quad-double arithmetic or with perturbation against a reference orbit of
+// the center, see GetMandelbrotPrecision.
+//
+// Renderers which work at the same time may share a scheduler and a reference
+// orbit, so they neither run more threads than cores nor compute the same
+// orbit twice.
+// -----------------------------------------------------------------------------
+
+class CMandelbrotRenderer
+{
+public:
+
+    typedef std::function<bool(const SMandelbrotImage& _rBand, int _FirstRow)> FBandFunction;
+
+public:
+
+    explicit CMandelbrotRenderer(int _NumberOfThreads = 0);
+    explicit CMandelbrotRenderer(CTileScheduler& _rScheduler);                         // Runs on a scheduler shared with other renderers, which has to outlive it.
+    ~CMandelbrotRenderer();
+
+    CMandelbrotRenderer(const CMandelbrotRenderer&) = delete;
+    CMandelbrotRenderer& operator = (const CMandelbrotRenderer&) = delete;
+
+public:
+
+    int GetNumberOfThreads() const;
+
+    bool Render(const SMandelbrotSettings& _rSettings, SMandelbrotImage* _pImage);
+    bool Advance(const SMandelbrotSettings& _rSettings, SMandelbrotState* _pState, SMandelbrotImage* _pImage);       // _pImage has to be the image of the last call with _pState.
+
+    bool RenderCached(const SMandelbrotSettings& _rSettings, CMandelbrotTileCache* _pCache, SMandelbrotImage* _pImage);   // Composes the image of cached tiles and renders only the missing ones.
+
+    bool RenderBands(const SMandelbrotSettings& _rSettings, int _NumberOfRowsPerBand, const FBandFunction& _rFunction);  // Hands every band of rows to _rFunction while the next one is rendered, so at most two bands exist at a time.
+
+    bool Reproject(const SMandelbrotSettings& _rSettings, const SMandelbrotSettings& _rPreviousSettings, const SMandelbrotImage& _rPreviousImage, SMandelbrotImage* _pImage);   // Warps the previous frame into the view and iterates only the pixels it does not cover reliably.
+
+    void MapColors(const SMandelbrotPalette& _rPalette, SMandelbrotImage* _pImage);                                     // Replaces the pixels of a rendered image without iterating again.
+
+    bool PrepareReferenceOrbit(const SMandelbrotSettings& _rSettings);                                                  // Computes the orbit of the center ahead, so later views with the same center and a larger pixel size or fewer iterations reuse it. Returns false if the center is no decimal number.
+
+    void SetSharedReferenceOrbit(const std::shared_ptr<const CReferenceOrbit>& _rpReferenceOrbit);                       // Deep zooms use this orbit instead of their own as long as it serves the view, nullptr drops it.
+
+    unsigned int GetNumberOfRebases() const;
+
+    const SMandelbrotInteriorStatistics& GetInteriorStatistics() const;                                                 // Of the last Render or Advance, of the last band for RenderBands.
+
+    unsigned long long GetNumberOfFilledPixels() const;                                                                 // Pixels of the last Render which were filled by the subdivision.
+
+    unsigned long long GetNumberOfReprojectedPixels() const;                                                            // Pixels of the last Reproject which were taken from the previous frame.
+
+    unsigned long long GetNumberOfSupersampledPixels() const;                                                           // Pixels of the last Render which were supersampled.
+
+    void EnableFrameStatistics(bool _IsEnabled);                                                                        // Off by default, counting the pixels costs one more pass over the image.
+
+    const SMandelbrotFrameStatistics& GetFrameStatistics() const;                                                       // Of the last Render, Advance, RenderCached or Reproject, of the last band for RenderBands.
+
+private:
+
+    class CFrameScope;
+
+private:
+
+    std::unique_ptr<CTileScheduler>            m_pOwnScheduler;                 // nullptr if the scheduler is shared.
+    CTileScheduler&                            m_rScheduler;
+    CReferenceOrbit                            m_ReferenceOrbit;                // Reused as long as the center does not change.
+    std::shared_ptr<const CReferenceOrbit>     m_pSharedReferenceOrbit;
+    const CReferenceOrbit*                     m_pReferenceOrbit;               // The orbit of the current deep zoom, the own or the shared one.
+    std::atomic<unsigned int>                  m_NumberOfRebases;               // Glitched pixels rebased onto the start of the orbit in the last deep zoom.
+    std::atomic<unsigned long long>            m_NumberOfFilledPixels;
+    std::atomic<unsigned long long>            m_NumberOfReprojectedPixels;
+    std::atomic<unsigned long long>            m_NumberOfSupersampledPixels;
+    SMandelbrotInteriorStatistics              m_InteriorStatistics;
+    std::vector<SMandelbrotInteriorStatistics> m_ThreadInteriorStatistics;      // One per worker, merged into m_InteriorStatistics after each frame.
+    std::vector<double>                        m_PreciseColumns;                // Real part of the left pixel of every tile column as four doubles, for the extended precisions.
+    std::vector<double>                        m_PreciseRows;                   // Imaginary part of every row as four doubles.
+    std::vector<float>                         m_Distances;                     // Distance estimate of every pixel of the last supersampled Render.
+    bool                                       m_IsFrameStatisticsEnabled;
+    int                                        m_FrameDepth;                    // Frames in progress, the other methods fall back to Render within their frame.
+    std::chrono::steady_clock::time_point      m_FrameStart;
+    SMandelbrotFrameStatistics                 m_FrameStatistics;
+
+private:
+
+    void BeginFrame(const SMandelbrotSettings& _rSettings);
+    void EndFrame(const SMandelbrotImage& _rImage);
+    void RunTiles(const char* _pPass, int _NumberOfTiles, const CTileScheduler::FTileFunction& _rFunction);        // Runs the tiles on the scheduler and adds the pass to the frame statistics.
+    void UpdatePreciseCoordinates(const SMandelbrotSettings& _rSettings);
+    void RenderTile(const SMandelbrotSettings& _rSettings, FIterateRow _pIterateRow, bool _IsPrecise, bool _IsDistanceEstimated, int _Tile, SMandelbrotInteriorStatistics* _pStatistics, SMandelbrotImage* _pImage);
+    void SupersampleTile(const SMandelbrotSettings& _rSettings, FIterateRow _pIterateRow, int _Tile, SMandelbrotImage* _pImage);
+    void RenderTileSubdivided(const SMandelbrotSettings& _rSettings, FAdvancePixels _pAdvancePixels, int _Tile, SMandelbrotInteriorStatistics* _pStatistics, SMandelbrotImage* _pImage);
+    void AdvanceTile(const SMandelbrotSettings& _rSettings, FAdvancePixels _pAdvancePixels, int _Tile, bool _IsRestart, bool _IsColorChanged, SMandelbrotInteriorStatistics* _pStatistics, SMandelbrotState* _pState, SMandelbrotImage* _pImage);
+    void RenderTilePerturbation(const SMandelbrotSettings& _rSettings, int _Tile, SMandelbrotImage* _pImage);
+    void ResetInteriorStatistics();
+    void MergeInteriorStatistics();
+    void WriteColors(const SMandelbrotSettings& _rSettings, size_t _IndexOfPixel, int _NumberOfPixels, SMandelbrotImage* _pImage);
+};
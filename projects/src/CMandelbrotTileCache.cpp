@@ -0,0 +1,341 @@
+#include "CMandelbrotTileCache.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+
+namespace
+{
+    // -----------------------------------------------------------------------------
+    // A tile of level 0 spans 4 units, which is the diameter of the set.
+    // -----------------------------------------------------------------------------
+    const double s_LevelZeroPixelSize = 4.0 / CMandelbrotTileCache::s_TileSize;
+
+    // -----------------------------------------------------------------------------
+    // The start of a tile file, the iterations and the smooth iterations of all
+    // pixels follow.
+    // -----------------------------------------------------------------------------
+    const uint32_t s_FileMagic   = 0x4C49544Du;     // "MTIL"
+    const uint32_t s_FileVersion = 2;
+
+    struct SFileHeader
+    {
+        uint32_t m_Magic;
+        uint32_t m_Version;
+        int32_t  m_TileSize;
+        int32_t  m_Level;
+        int64_t  m_X;
+        int64_t  m_Y;
+        uint32_t m_MaxIteration;
+        uint32_t m_Precision;
+        uint32_t m_Subdivision;
+        uint32_t m_IsInteriorChecked;
+    };
+
+    // -----------------------------------------------------------------------------
+
+    SFileHeader GetFileHeader(const SMandelbrotTileKey& _rKey)
+    {
+        SFileHeader Header;
+
+        Header.m_Magic             = s_FileMagic;
+        Header.m_Version           = s_FileVersion;
+        Header.m_TileSize          = CMandelbrotTileCache::s_TileSize;
+        Header.m_Level             = _rKey.m_Level;
+        Header.m_X                 = _rKey.m_X;
+        Header.m_Y                 = _rKey.m_Y;
+        Header.m_MaxIteration      = _rKey.m_MaxIteration;
+        Header.m_Precision         = static_cast<uint32_t>(_rKey.m_Precision);
+        Header.m_Subdivision       = static_cast<uint32_t>(_rKey.m_Subdivision);
+        Header.m_IsInteriorChecked = _rKey.m_IsInteriorChecked ? 1 : 0;
+
+        return Header;
+    }
+} // namespace
+
+// -----------------------------------------------------------------------------
+
+bool SMandelbrotTileKey::operator < (const SMandelbrotTileKey& _rOther) const
+{
+    if (m_Level        != _rOther.m_Level)        return m_Level        < _rOther.m_Level;
+    if (m_X            != _rOther.m_X)            return m_X            < _rOther.m_X;
+    if (m_Y            != _rOther.m_Y)            return m_Y            < _rOther.m_Y;
+    if (m_MaxIteration != _rOther.m_MaxIteration) return m_MaxIteration < _rOther.m_MaxIteration;
+    if (m_Precision    != _rOther.m_Precision)    return m_Precision    < _rOther.m_Precision;
+    if (m_Subdivision  != _rOther.m_Subdivision)  return m_Subdivision  < _rOther.m_Subdivision;
+
+    return m_IsInteriorChecked < _rOther.m_IsInteriorChecked;
+}
+
+// -----------------------------------------------------------------------------
+
+int CMandelbrotTileCache::GetLevel(double _PixelSize)
+{
+    return static_cast<int>(std::floor(std::log2(s_LevelZeroPixelSize / _PixelSize) + 0.5));
+}
+
+// -----------------------------------------------------------------------------
+
+double CMandelbrotTileCache::GetPixelSize(int _Level)
+{
+    return std::ldexp(s_LevelZeroPixelSize, -_Level);
+}
+
+// -----------------------------------------------------------------------------
+
+void CMandelbrotTileCache::AlignSettings(SMandelbrotSettings* _pSettings)
+{
+    double PixelSize = GetPixelSize(GetLevel(_pSettings->m_PixelSize));
+
+    // -----------------------------------------------------------------------------
+    // The pixel centers of level L lie at (n + 0.5) * PixelSize.
+    // -----------------------------------------------------------------------------
+    double Left = _pSettings->m_Center[0] + _pSettings->m_CenterOffset[0] - 0.5 * PixelSize * (_pSettings->m_Width  - 1);
+    double Top  = _pSettings->m_Center[1] + _pSettings->m_CenterOffset[1] + PixelSize * (0.5 * (_pSettings->m_Height - 1) - _pSettings->m_RowOffset);
+
+    Left = (std::floor(Left / PixelSize) + 0.5) * PixelSize;
+    Top  = (std::floor(Top  / PixelSize) + 0.5) * PixelSize;
+
+    _pSettings->m_PixelSize = PixelSize;
+    _pSettings->m_Center[0] = Left + 0.5 * PixelSize * (_pSettings->m_Width  - 1);
+    _pSettings->m_Center[1] = Top  - PixelSize * (0.5 * (_pSettings->m_Height - 1) - _pSettings->m_RowOffset);
+
+    _pSettings->m_CenterOffset[0] = 0.0;
+    _pSettings->m_CenterOffset[1] = 0.0;
+
+    _pSettings->m_PreciseCenter[0].clear();
+    _pSettings->m_PreciseCenter[1].clear();
+}
+
+// -----------------------------------------------------------------------------
+
+CMandelbrotTileCache::CMandelbrotTileCache(size_t _MaxNumberOfBytes, const std::string& _rDirectory)
+    : m_MaxNumberOfBytes(_MaxNumberOfBytes)
+    , m_NumberOfBytes(0)
+    , m_Directory(_rDirectory)
+    , m_Tiles()
+    , m_TileMap()
+    , m_NumberOfMemoryHits(0)
+    , m_NumberOfDiskHits(0)
+    , m_NumberOfMisses(0)
+{
+}
+
+// -----------------------------------------------------------------------------
+
+CMandelbrotTileCache::~CMandelbrotTileCache()
+{
+}
+
+// -----------------------------------------------------------------------------
+
+std::shared_ptr<const SMandelbrotTile> CMandelbrotTileCache::Find(const SMandelbrotTileKey& _rKey)
+{
+    CTileMap::iterator Entry = m_TileMap.find(_rKey);
+
+    if (Entry != m_TileMap.end())
+    {
+        m_Tiles.splice(m_Tiles.begin(), m_Tiles, Entry->second);
+
+        ++m_NumberOfMemoryHits;
+
+        return *Entry->second;
+    }
+
+    if (!m_Directory.empty())
+    {
+        std::shared_ptr<SMandelbrotTile> pTile = std::make_shared<SMandelbrotTile>();
+
+        if (Load(_rKey, pTile.get()))
+        {
+            AddToMemory(pTile);
+
+            ++m_NumberOfDiskHits;
+
+            return pTile;
+        }
+    }
+
+    ++m_NumberOfMisses;
+
+    return nullptr;
+}
+
+// -----------------------------------------------------------------------------
+
+void CMandelbrotTileCache::Insert(const std::shared_ptr<const SMandelbrotTile>& _rTile)
+{
+    if (!m_Directory.empty()) Store(*_rTile);
+
+    AddToMemory(_rTile);
+}
+
+// -----------------------------------------------------------------------------
+
+void CMandelbrotTileCache::Clear()
+{
+    m_Tiles.clear();
+    m_TileMap.clear();
+
+    m_NumberOfBytes = 0;
+}
+
+// -----------------------------------------------------------------------------
+
+size_t CMandelbrotTileCache::GetNumberOfBytes() const
+{
+    return m_NumberOfBytes;
+}
+
+// -----------------------------------------------------------------------------
+
+size_t CMandelbrotTileCache::GetNumberOfTiles() const
+{
+    return m_Tiles.size();
+}
+
+// -----------------------------------------------------------------------------
+
+unsigned long long CMandelbrotTileCache::GetNumberOfMemoryHits() const
+{
+    return m_NumberOfMemoryHits;
+}
+
+// -----------------------------------------------------------------------------
+
+unsigned long long CMandelbrotTileCache::GetNumberOfDiskHits() const
+{
+    return m_NumberOfDiskHits;
+}
+
+// -----------------------------------------------------------------------------
+
+unsigned long long CMandelbrotTileCache::GetNumberOfMisses() const
+{
+    return m_NumberOfMisses;
+}
+
+// -----------------------------------------------------------------------------
+
+void CMandelbrotTileCache::AddToMemory(const std::shared_ptr<const SMandelbrotTile>& _rTile)
+{
+    CTileMap::iterator Entry = m_TileMap.find(_rTile->m_Key);
+
+    if (Entry != m_TileMap.end())
+    {
+        m_NumberOfBytes -= GetNumberOfBytes(**Entry->second);
+
+        m_Tiles.erase(Entry->second);
+        m_TileMap.erase(Entry);
+    }
+
+    m_Tiles.push_front(_rTile);
+
+    m_TileMap[_rTile->m_Key] = m_Tiles.begin();
+
+    m_NumberOfBytes += GetNumberOfBytes(*_rTile);
+
+    // -----------------------------------------------------------------------------
+    // Drop the least recently used tiles, but never the new one.
+    // -----------------------------------------------------------------------------
+    while (m_NumberOfBytes > m_MaxNumberOfBytes && m_Tiles.size() > 1)
+    {
+        const SMandelbrotTile& rLastTile = *m_Tiles.back();
+
+        m_NumberOfBytes -= GetNumberOfBytes(rLastTile);
+
+        m_TileMap.erase(rLastTile.m_Key);
+        m_Tiles.pop_back();
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+std::string CMandelbrotTileCache::GetPath(const SMandelbrotTileKey& _rKey) const
+{
+    char Name[128];
+
+    std::snprintf(Name, sizeof(Name), "%d_%lld_%lld_%u_%d_%d_%d.tile", _rKey.m_Level, _rKey.m_X, _rKey.m_Y, _rKey.m_MaxIteration, static_cast<int>(_rKey.m_Precision), static_cast<int>(_rKey.m_Subdivision), _rKey.m_IsInteriorChecked ? 1 : 0);
+
+    return m_Directory + "/" + Name;
+}
+
+// -----------------------------------------------------------------------------
+
+bool CMandelbrotTileCache::Load(const SMandelbrotTileKey& _rKey, SMandelbrotTile* _pTile) const
+{
+    FILE* pFile = std::fopen(GetPath(_rKey).c_str(), "rb");
+
+    if (pFile == nullptr) return false;
+
+    SFileHeader Expected = GetFileHeader(_rKey);
+    SFileHeader Header;
+
+    size_t NumberOfPixels = static_cast<size_t>(s_TileSize) * s_TileSize;
+
+    _pTile->m_Key = _rKey;
+
+    _pTile->m_Iterations.resize(NumberOfPixels);
+    _pTile->m_SmoothIterations.resize(NumberOfPixels);
+
+    bool IsValid = std::fread(&Header, sizeof(Header), 1, pFile) == 1
+        && Header.m_Magic             == Expected.m_Magic
+        && Header.m_Version           == Expected.m_Version
+        && Header.m_TileSize          == Expected.m_TileSize
+        && Header.m_Level             == Expected.m_Level
+        && Header.m_X                 == Expected.m_X
+        && Header.m_Y                 == Expected.m_Y
+        && Header.m_MaxIteration      == Expected.m_MaxIteration
+        && Header.m_Precision         == Expected.m_Precision
+        && Header.m_Subdivision       == Expected.m_Subdivision
+        && Header.m_IsInteriorChecked == Expected.m_IsInteriorChecked
+        && std::fread(_pTile->m_Iterations.data(),       sizeof(unsigned int), NumberOfPixels, pFile) == NumberOfPixels
+        && std::fread(_pTile->m_SmoothIterations.data(), sizeof(float),        NumberOfPixels, pFile) == NumberOfPixels;
+
+    std::fclose(pFile);
+
+    return IsValid;
+}
+
+// -----------------------------------------------------------------------------
+
+bool CMandelbrotTileCache::Store(const SMandelbrotTile& _rTile) const
+{
+    std::string Path = GetPath(_rTile.m_Key);
+
+    // -----------------------------------------------------------------------------
+    // Write to a temporary file first, so an interrupted run never leaves a
+    // half written tile behind.
+    // -----------------------------------------------------------------------------
+    std::string TemporaryPath = Path + ".tmp";
+
+    FILE* pFile = std::fopen(TemporaryPath.c_str(), "wb");
+
+    if (pFile == nullptr) return false;
+
+    SFileHeader Header = GetFileHeader(_rTile.m_Key);
+
+    bool IsWritten = std::fwrite(&Header, sizeof(Header), 1, pFile) == 1
+        && std::fwrite(_rTile.m_Iterations.data(),       sizeof(unsigned int), _rTile.m_Iterations.size(),       pFile) == _rTile.m_Iterations.size()
+        && std::fwrite(_rTile.m_SmoothIterations.data(), sizeof(float),        _rTile.m_SmoothIterations.size(), pFile) == _rTile.m_SmoothIterations.size();
+
+    IsWritten = std::fclose(pFile) == 0 && IsWritten;
+
+    std::remove(Path.c_str());
+
+    if (!IsWritten || std::rename(TemporaryPath.c_str(), Path.c_str()) != 0)
+    {
+        std::remove(TemporaryPath.c_str());
+
+        return false;
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+size_t CMandelbrotTileCache::GetNumberOfBytes(const SMandelbrotTile& _rTile)
+{
+    return sizeof(SMandelbrotTile) + _rTile.m_Iterations.size() * sizeof(unsigned int) + _rTile.m_SmoothIterations.size() * sizeof(float);
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "SMandelbrotSettings.h"
+
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// Identifies a tile of the quadtree over the complex plane. A tile of level L
+// has s_TileSize x s_TileSize pixels of CMandelbrotTileCache::GetPixelSize(L)
+// and its four children are the tiles (L + 1, 2 X + 0..1, 2 Y + 0..1). Y grows
+// with the imaginary part.
+// -----------------------------------------------------------------------------
+
+struct SMandelbrotTileKey
+{
+    int                         m_Level;
+    long long                   m_X;
+    long long                   m_Y;
+    unsigned int                m_MaxIteration;
+    SMandelbrotPrecision::EMode m_Precision;
+    SSubdivision::EMode         m_Subdivision;
+    bool                        m_IsInteriorChecked;
+
+    bool operator < (const SMandelbrotTileKey& _rOther) const;
+};
+
+struct SMandelbrotTile
+{
+    SMandelbrotTileKey         m_Key;
+    std::vector<unsigned int>  m_Iterations;        // Row 0 is the top of the tile, see SMandelbrotImage.
+    std::vector<float>         m_SmoothIterations;
+};
+
+// -----------------------------------------------------------------------------
+// Keeps rendered tiles in memory up to a budget and drops the least recently
+// used ones beyond it. With a directory every new tile is also written to
+// disk and tiles missing in memory are read from there, so a later run starts
+// with the tiles of the previous ones. The directory has to exist.
+//
+// Tiles are handed out as shared pointers, so a tile dropped from the cache
+// stays valid as long as it is used. The cache itself is not thread safe.
+// -----------------------------------------------------------------------------
+
+class CMandelbrotTileCache
+{
+public:
+
+    static const int s_TileSize = 256;
+
+public:
+
+    static int    GetLevel(double _PixelSize);                              // The level whose pixel size is closest to _PixelSize.
+    static double GetPixelSize(int _Level);
+    static void   AlignSettings(SMandelbrotSettings* _pSettings);           // Snaps the view onto the pixel grid of its level, so it is composed of tiles without resampling.
+
+public:
+
+    explicit CMandelbrotTileCache(size_t _MaxNumberOfBytes, const std::string& _rDirectory = std::string());
+    ~CMandelbrotTileCache();
+
+public:
+
+    std::shared_ptr<const SMandelbrotTile> Find(const SMandelbrotTileKey& _rKey);
+    void Insert(const std::shared_ptr<const SMandelbrotTile>& _rTile);
+
+    void Clear();                                                           // Only clears the memory, the tiles on disk stay.
+
+    size_t GetNumberOfBytes() const;
+    size_t GetNumberOfTiles() const;
+
+    unsigned long long GetNumberOfMemoryHits() const;
+    unsigned long long GetNumberOfDiskHits() const;
+    unsigned long long GetNumberOfMisses() const;
+
+private:
+
+    typedef std::list<std::shared_ptr<const SMandelbrotTile>> CTileList;
+    typedef std::map<SMandelbrotTileKey, CTileList::iterator> CTileMap;
+
+private:
+
+    size_t             m_MaxNumberOfBytes;
+    size_t             m_NumberOfBytes;
+    std::string        m_Directory;
+    CTileList          m_Tiles;                                             // Most recently used first.
+    CTileMap           m_TileMap;
+    unsigned long long m_NumberOfMemoryHits;
+    unsigned long long m_NumberOfDiskHits;
+    unsigned long long m_NumberOfMisses;
+
+private:
+
+    void AddToMemory(const std::shared_ptr<const SMandelbrotTile>& _rTile);
+
+    std::string GetPath(const SMandelbrotTileKey& _rKey) const;
+
+    bool Load(const SMandelbrotTileKey& _rKey, SMandelbrotTile* _pTile) const;
+    bool Store(const SMandelbrotTile& _rTile) const;
+
+    static size_t GetNumberOfBytes(const SMandelbrotTile& _rTile);
+};
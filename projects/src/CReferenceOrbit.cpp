@@ -0,0 +1,146 @@
+#include "CReferenceOrbit.h"
+
+#include "CFixedPoint.h"
+
+#include <cmath>
+#include <cstdio>
+
+namespace
+{
+    // -----------------------------------------------------------------------------
+    // Bits beyond the pixel size, so the rounding of the orbit stays far below
+    // the distance of two pixels even after many iterations.
+    // -----------------------------------------------------------------------------
+    const int s_NumberOfGuardBits = 64;
+
+    // -----------------------------------------------------------------------------
+
+    std::string GetCenterText(const SMandelbrotSettings& _rSettings, int _Axis)
+    {
+        if (!_rSettings.m_PreciseCenter[_Axis].empty()) return _rSettings.m_PreciseCenter[_Axis];
+
+        char Text[64];
+
+        std::snprintf(Text, sizeof(Text), "%.17f", _rSettings.m_Center[_Axis]);
+
+        return Text;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    int GetRequiredFractionBits(const SMandelbrotSettings& _rSettings)
+    {
+        int NumberOfFractionBits = static_cast<int>(std::ceil(-std::log2(_rSettings.m_PixelSize))) + s_NumberOfGuardBits;
+
+        return NumberOfFractionBits < s_NumberOfGuardBits ? s_NumberOfGuardBits : NumberOfFractionBits;
+    }
+} // namespace
+
+// -----------------------------------------------------------------------------
+
+CReferenceOrbit::CReferenceOrbit()
+    : m_MaxIteration(0)
+    , m_NumberOfFractionBits(0)
+{
+}
+
+// -----------------------------------------------------------------------------
+
+bool CReferenceOrbit::Update(const SMandelbrotSettings& _rSettings)
+{
+    if (IsUpToDate(_rSettings)) return true;
+
+    std::string Center[2] = { GetCenterText(_rSettings, 0), GetCenterText(_rSettings, 1) };
+
+    int NumberOfFractionBits = GetRequiredFractionBits(_rSettings);
+
+    int NumberOfLimbs = CFixedPoint::GetNumberOfLimbs(NumberOfFractionBits);
+
+    CFixedPoint CX(NumberOfLimbs);
+    CFixedPoint CY(NumberOfLimbs);
+
+    CFixedPoint* pCoordinates[2] = { &CX, &CY };
+
+    for (int Axis = 0; Axis < 2; ++Axis)
+    {
+        if (!pCoordinates[Axis]->SetFromString(Center[Axis].c_str())) return false;
+    }
+
+    CFixedPoint ZX(NumberOfLimbs);
+    CFixedPoint ZY(NumberOfLimbs);
+    CFixedPoint X2(NumberOfLimbs);
+    CFixedPoint Y2(NumberOfLimbs);
+    CFixedPoint XY(NumberOfLimbs);
+
+    m_Points.clear();
+    m_Points.reserve(2 * (static_cast<size_t>(_rSettings.m_MaxIteration) + 1));
+
+    m_Points.push_back(0.0);
+    m_Points.push_back(0.0);
+
+    for (unsigned int Iteration = 0; Iteration < _rSettings.m_MaxIteration; ++Iteration)
+    {
+        CFixedPoint::Mul(ZX, ZX, &X2);
+        CFixedPoint::Mul(ZY, ZY, &Y2);
+        CFixedPoint::Mul(ZX, ZY, &XY);
+
+        CFixedPoint::Sub(X2, Y2, &ZX);
+        CFixedPoint::Add(ZX, CX, &ZX);
+        CFixedPoint::Add(XY, XY, &ZY);
+        CFixedPoint::Add(ZY, CY, &ZY);
+
+        double X = ZX.ToDouble();
+        double Y = ZY.ToDouble();
+
+        m_Points.push_back(X);
+        m_Points.push_back(Y);
+
+        // -----------------------------------------------------------------------------
+        // An escaped reference is no problem, the pixels rebase onto Z[0] once
+        // they reach the end of the orbit.
+        // -----------------------------------------------------------------------------
+        if (X * X + Y * Y > 4.0) break;
+    }
+
+    m_Center[0]            = Center[0];
+    m_Center[1]            = Center[1];
+    m_MaxIteration         = _rSettings.m_MaxIteration;
+    m_NumberOfFractionBits = NumberOfFractionBits;
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool CReferenceOrbit::IsUpToDate(const SMandelbrotSettings& _rSettings) const
+{
+    // -----------------------------------------------------------------------------
+    // The orbit is kept if it was computed for the same center with at least
+    // the required precision and iterations. Zooming into a fixed point only
+    // pays for the orbit once.
+    // -----------------------------------------------------------------------------
+    if (_rSettings.m_MaxIteration > m_MaxIteration || GetRequiredFractionBits(_rSettings) > m_NumberOfFractionBits) return false;
+
+    return GetCenterText(_rSettings, 0) == m_Center[0] && GetCenterText(_rSettings, 1) == m_Center[1];
+}
+
+// -----------------------------------------------------------------------------
+
+int CReferenceOrbit::GetLength() const
+{
+    return static_cast<int>(m_Points.size() / 2);
+}
+
+// -----------------------------------------------------------------------------
+
+const double* CReferenceOrbit::GetPoints() const
+{
+    return m_Points.data();
+}
+
+// -----------------------------------------------------------------------------
+
+int CReferenceOrbit::GetNumberOfFractionBits() const
+{
+    return m_NumberOfFractionBits;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "SMandelbrotSettings.h"
+
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// The orbit Z[n+1] = Z[n]^2 + C of the center of the view, computed with as
+// many bits as the pixel size requires and stored in double precision. The
+// pixels of a deep zoom only iterate their difference to this orbit.
+// -----------------------------------------------------------------------------
+
+class CReferenceOrbit
+{
+public:
+
+    CReferenceOrbit();
+
+public:
+
+    bool Update(const SMandelbrotSettings& _rSettings);                  // Returns false if the center is no decimal number, the orbit stays as it was then.
+
+    bool IsUpToDate(const SMandelbrotSettings& _rSettings) const;       // Whether the orbit serves the view without an update.
+
+    int GetLength() const;
+    const double* GetPoints() const;
+    int GetNumberOfFractionBits() const;
+
+private:
+
+    std::string         m_Center[2];                    // The center the orbit was computed for.
+    unsigned int        m_MaxIteration;
+    int                 m_NumberOfFractionBits;
+    std::vector<double> m_Points;                       // Real and imaginary part of Z[0], Z[1], ...
+};
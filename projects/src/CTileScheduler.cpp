@@ -0,0 +1,278 @@
+#include "CTileScheduler.h"
+
+#include <algorithm>
+
+namespace
+{
+    int GetDefaultNumberOfThreads(int _NumberOfThreads)
+    {
+        if (_NumberOfThreads > 0) return _NumberOfThreads;
+
+        int NumberOfCores = static_cast<int>(std::thread::hardware_concurrency());
+
+        return NumberOfCores > 0 ? NumberOfCores : 1;
+    }
+} // namespace
+
+// -----------------------------------------------------------------------------
+
+CTileScheduler::CTileScheduler(int _NumberOfThreads)
+    : m_NumberOfThreads(GetDefaultNumberOfThreads(_NumberOfThreads))
+    , m_Threads()
+    , m_IsShuttingDown(false)
+    , m_Runs()
+    , m_FreeRuns()
+{
+    for (int IndexOfThread = 1; IndexOfThread < m_NumberOfThreads; ++IndexOfThread)
+    {
+        m_Threads.emplace_back(&CTileScheduler::WorkerMain, this, IndexOfThread);
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+CTileScheduler::~CTileScheduler()
+{
+    {
+        std::lock_guard<std::mutex> Lock(m_Mutex);
+
+        m_IsShuttingDown = true;
+    }
+
+    m_StartCondition.notify_all();
+
+    for (std::thread& rThread : m_Threads)
+    {
+        rThread.join();
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+int CTileScheduler::GetNumberOfThreads() const
+{
+    return m_NumberOfThreads;
+}
+
+// -----------------------------------------------------------------------------
+
+void CTileScheduler::Run(int _NumberOfTiles, const FTileFunction& _rFunction, SRunStatistics* _pStatistics)
+{
+    auto Start = std::chrono::steady_clock::now();
+
+    if (_pStatistics != nullptr)
+    {
+        _pStatistics->m_Seconds = 0.0;
+
+        _pStatistics->m_TileSeconds.assign(_NumberOfTiles > 0 ? _NumberOfTiles : 0, 0.0f);
+        _pStatistics->m_Threads.assign(m_NumberOfThreads, SThreadStatistics());
+    }
+
+    if (_NumberOfTiles <= 0) return;
+
+    std::unique_ptr<SRun> pRun;
+
+    {
+        std::lock_guard<std::mutex> Lock(m_Mutex);
+
+        if (!m_FreeRuns.empty())
+        {
+            pRun = std::move(m_FreeRuns.back());
+
+            m_FreeRuns.pop_back();
+        }
+    }
+
+    if (pRun == nullptr)
+    {
+        pRun.reset(new SRun());
+
+        pRun->m_Queues = std::vector<SQueue>(m_NumberOfThreads);
+    }
+
+    // -----------------------------------------------------------------------------
+    // Deal the tiles round robin, so neighboured tiles which usually cost the
+    // same end up on different workers and every queue keeps the order of the
+    // tiles. No worker sees the run before it is added to m_Runs.
+    // -----------------------------------------------------------------------------
+    for (int IndexOfThread = 0; IndexOfThread < m_NumberOfThreads; ++IndexOfThread)
+    {
+        std::deque<int>& rTiles = pRun->m_Queues[IndexOfThread].m_Tiles;
+
+        for (int IndexOfTile = IndexOfThread; IndexOfTile < _NumberOfTiles; IndexOfTile += m_NumberOfThreads)
+        {
+            rTiles.push_back(IndexOfTile);
+        }
+    }
+
+    pRun->m_pFunction             = &_rFunction;
+    pRun->m_pStatistics           = _pStatistics;
+    pRun->m_NumberOfActiveThreads = 1;
+    pRun->m_HasTiles              = true;
+
+    {
+        std::lock_guard<std::mutex> Lock(m_Mutex);
+
+        m_Runs.push_back(pRun.get());
+    }
+
+    m_StartCondition.notify_all();
+
+    ProcessTiles(*pRun, 0);
+
+    std::unique_lock<std::mutex> Lock(m_Mutex);
+
+    // -----------------------------------------------------------------------------
+    // Once the caller found no tile left, no worker joins the run anymore. Wait
+    // until the workers in it left, they might still process the last tiles.
+    // -----------------------------------------------------------------------------
+    m_DoneCondition.wait(Lock, [&] { return pRun->m_NumberOfActiveThreads == 0; });
+
+    m_Runs.erase(std::find(m_Runs.begin(), m_Runs.end(), pRun.get()));
+
+    m_FreeRuns.push_back(std::move(pRun));
+
+    if (_pStatistics != nullptr)
+    {
+        _pStatistics->m_Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+void CTileScheduler::WorkerMain(int _Thread)
+{
+    for (;;)
+    {
+        SRun* pRun = nullptr;
+
+        {
+            std::unique_lock<std::mutex> Lock(m_Mutex);
+
+            m_StartCondition.wait(Lock, [&] { return m_IsShuttingDown || (pRun = FindRun()) != nullptr; });
+
+            if (m_IsShuttingDown) return;
+
+            ++pRun->m_NumberOfActiveThreads;
+        }
+
+        ProcessTiles(*pRun, _Thread);
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+void CTileScheduler::ProcessTiles(SRun& _rRun, int _Thread)
+{
+    const FTileFunction& rFunction = *_rRun.m_pFunction;
+
+    SRunStatistics* pRunStatistics = _rRun.m_pStatistics;
+
+    SThreadStatistics Statistics = SThreadStatistics();
+
+    for (;;)
+    {
+        int  Tile;
+        bool IsStolen = false;
+
+        if (!PopTile(_rRun, _Thread, &Tile))
+        {
+            if (!StealTile(_rRun, _Thread, &Tile)) break;
+
+            IsStolen = true;
+        }
+
+        if (pRunStatistics == nullptr)
+        {
+            rFunction(Tile, _Thread);
+
+            continue;
+        }
+
+        auto Start = std::chrono::steady_clock::now();
+
+        rFunction(Tile, _Thread);
+
+        double Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+
+        pRunStatistics->m_TileSeconds[Tile] = static_cast<float>(Seconds);
+
+        Statistics.m_BusySeconds         += Seconds;
+        Statistics.m_NumberOfTiles       += 1;
+        Statistics.m_NumberOfStolenTiles += IsStolen ? 1 : 0;
+    }
+
+    {
+        std::lock_guard<std::mutex> Lock(m_Mutex);
+
+        if (pRunStatistics != nullptr)
+        {
+            SThreadStatistics& rStatistics = pRunStatistics->m_Threads[_Thread];
+
+            rStatistics.m_BusySeconds         += Statistics.m_BusySeconds;
+            rStatistics.m_NumberOfTiles       += Statistics.m_NumberOfTiles;
+            rStatistics.m_NumberOfStolenTiles += Statistics.m_NumberOfStolenTiles;
+        }
+
+        _rRun.m_HasTiles = false;
+
+        --_rRun.m_NumberOfActiveThreads;
+    }
+
+    m_DoneCondition.notify_all();
+}
+
+// -----------------------------------------------------------------------------
+
+CTileScheduler::SRun* CTileScheduler::FindRun() const
+{
+    for (SRun* pRun : m_Runs)
+    {
+        if (pRun->m_HasTiles) return pRun;
+    }
+
+    return nullptr;
+}
+
+// -----------------------------------------------------------------------------
+
+bool CTileScheduler::PopTile(SRun& _rRun, int _Thread, int* _pTile)
+{
+    SQueue& rQueue = _rRun.m_Queues[_Thread];
+
+    std::lock_guard<std::mutex> Lock(rQueue.m_Mutex);
+
+    if (rQueue.m_Tiles.empty()) return false;
+
+    *_pTile = rQueue.m_Tiles.front();
+
+    rQueue.m_Tiles.pop_front();
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool CTileScheduler::StealTile(SRun& _rRun, int _Thread, int* _pTile)
+{
+    // -----------------------------------------------------------------------------
+    // Steal from the back of the victim's queue. The owner works on the front,
+    // so both rarely touch the same tiles and the victim keeps its order.
+    // -----------------------------------------------------------------------------
+    for (int Offset = 1; Offset < m_NumberOfThreads; ++Offset)
+    {
+        SQueue& rQueue = _rRun.m_Queues[(_Thread + Offset) % m_NumberOfThreads];
+
+        std::lock_guard<std::mutex> Lock(rQueue.m_Mutex);
+
+        if (rQueue.m_Tiles.empty()) continue;
+
+        *_pTile = rQueue.m_Tiles.back();
+
+        rQueue.m_Tiles.pop_back();
+
+        return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// Distributes the tiles of an image over all cores. Every worker owns a queue
+// of tiles and processes it front to back. A worker whose queue ran dry steals
+// tiles from the back of the other queues, so a few expensive tiles on the
+// boundary of the set do not leave the remaining cores idle.
+//
+// Several threads may call Run at the same time, e.g. frames rendered on
+// threads of their own. The calling thread only works on its own run, while
+// a worker joins the oldest run with tiles left, so the workers move on to the
+// next run as soon as the tiles of the last one run out.
+//
+// A run can be timed per tile and per worker, so an uneven distribution of the
+// work shows up in its statistics.
+// -----------------------------------------------------------------------------
+
+class CTileScheduler
+{
+public:
+
+    typedef std::function<void(int _Tile, int _Thread)> FTileFunction;
+
+    struct SThreadStatistics
+    {
+        double       m_BusySeconds;             // Time spent in the tile function.
+        unsigned int m_NumberOfTiles;           // Tiles processed, including the stolen ones.
+        unsigned int m_NumberOfStolenTiles;     // Tiles taken from the queue of another worker.
+    };
+
+    struct SRunStatistics
+    {
+        double                         m_Seconds;           // Wall time of the run.
+        std::vector<float>             m_TileSeconds;       // Wall time of every tile.
+        std::vector<SThreadStatistics> m_Threads;           // One per worker, a worker was idle for the rest of m_Seconds.
+    };
+
+public:
+
+    explicit CTileScheduler(int _NumberOfThreads = 0);
+    ~CTileScheduler();
+
+    CTileScheduler(const CTileScheduler&) = delete;
+    CTileScheduler& operator = (const CTileScheduler&) = delete;
+
+public:
+
+    int GetNumberOfThreads() const;
+
+    void Run(int _NumberOfTiles, const FTileFunction& _rFunction, SRunStatistics* _pStatistics = nullptr);        // The caller is thread 0 of the run, the statistics are optional.
+
+private:
+
+    struct SQueue
+    {
+        std::mutex      m_Mutex;
+        std::deque<int> m_Tiles;
+    };
+
+    struct SRun
+    {
+        std::vector<SQueue>  m_Queues;                  // One tile queue per worker.
+        const FTileFunction* m_pFunction;
+        SRunStatistics*      m_pStatistics;             // Every worker only writes its own thread and the tiles it processes.
+        int                  m_NumberOfActiveThreads;   // Workers currently taking part in the run, guarded by m_Mutex.
+        bool                 m_HasTiles;                // Cleared by the first worker which finds no tile left, guarded by m_Mutex.
+    };
+
+private:
+
+    int                                m_NumberOfThreads;       // Number of workers including the thread calling Run.
+    std::vector<std::thread>           m_Threads;               // The background workers, the calling thread is worker 0.
+
+    std::mutex                         m_Mutex;
+    std::condition_variable            m_StartCondition;        // Signaled when a new run starts or the scheduler shuts down.
+    std::condition_variable            m_DoneCondition;         // Signaled when a worker leaves a run.
+    bool                               m_IsShuttingDown;
+
+    std::vector<SRun*>                 m_Runs;                  // The runs in progress in the order of their start.
+    std::vector<std::unique_ptr<SRun>> m_FreeRuns;              // Finished runs, their queues are reused by the next one.
+
+private:
+
+    void WorkerMain(int _Thread);
+    void ProcessTiles(SRun& _rRun, int _Thread);
+
+    SRun* FindRun() const;                                      // The oldest run with tiles left, m_Mutex has to be locked.
+
+    bool PopTile(SRun& _rRun, int _Thread, int* _pTile);
+    bool StealTile(SRun& _rRun, int _Thread, int* _pTile);
+};
@@ -0,0 +1,281 @@
+#include "MandelbrotKernel.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define MANDELBROT_X86 1
+#else
+#define MANDELBROT_X86 0
+#endif
+
+#if MANDELBROT_X86 && (defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define MANDELBROT_SSE2 1
+#else
+#define MANDELBROT_SSE2 0
+#endif
+
+#if MANDELBROT_X86
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+#if MANDELBROT_SSE2
+#include <emmintrin.h>
+#endif
+
+#include "MandelbrotKernelTemplate.h"
+
+// -----------------------------------------------------------------------------
+// Kernels of the other instruction sets, they live in their own translation
+// units which are compiled with the matching target flags.
+// -----------------------------------------------------------------------------
+
+const SMandelbrotKernel* GetMandelbrotKernelAVX2();
+const SMandelbrotKernel* GetMandelbrotKernelAVX512();
+
+namespace
+{
+    template <typename T>
+    struct SScalar
+    {
+        typedef T TReal;
+
+        static const int  s_NumberOfLanes = 1;
+        static const bool s_IsMulAddFused = false;
+
+        T m_Value;
+
+        static SScalar Broadcast(T _Value)                                   { return { _Value }; }
+        static SScalar Load(const T* _pValues)                               { return { *_pValues }; }
+        static void Store(SScalar _A, T* _pValues)                           { *_pValues = _A.m_Value; }
+        static SScalar Add(SScalar _A, SScalar _B)                           { return { _A.m_Value + _B.m_Value }; }
+        static SScalar Sub(SScalar _A, SScalar _B)                           { return { _A.m_Value - _B.m_Value }; }
+        static SScalar Mul(SScalar _A, SScalar _B)                           { return { _A.m_Value * _B.m_Value }; }
+        static SScalar MulAdd(SScalar _A, SScalar _B, SScalar _C)            { return { _A.m_Value * _B.m_Value + _C.m_Value }; }
+        static unsigned int GreaterMask(SScalar _A, SScalar _B)              { return _A.m_Value > _B.m_Value ? 1u : 0u; }
+    };
+
+    const SMandelbrotKernel s_ScalarKernel = { "scalar", 1, 1, &IterateRow<SScalar<float>>, &IterateRow<SScalar<double>>, &IterateRow<SDoubleDouble<SScalar<double>>>, &IterateRow<SQuadDouble<SScalar<double>>>, &AdvancePixels<SScalar<float>>, &AdvancePixels<SScalar<double>>, &IteratePerturbation<SScalar<double>>, &MapColors, SFractalKernels<SScalar<float>>::s_IterateRows, SFractalKernels<SScalar<double>>::s_IterateRows };
+
+#if MANDELBROT_SSE2
+    struct SFloat4
+    {
+        typedef float TReal;
+
+        static const int s_NumberOfLanes = 4;
+
+        __m128 m_Value;
+
+        static SFloat4 Broadcast(float _Value)                               { return { _mm_set1_ps(_Value) }; }
+        static SFloat4 Load(const float* _pValues)                           { return { _mm_load_ps(_pValues) }; }
+        static void Store(SFloat4 _A, float* _pValues)                       { _mm_store_ps(_pValues, _A.m_Value); }
+        static SFloat4 Add(SFloat4 _A, SFloat4 _B)                           { return { _mm_add_ps(_A.m_Value, _B.m_Value) }; }
+        static SFloat4 Sub(SFloat4 _A, SFloat4 _B)                           { return { _mm_sub_ps(_A.m_Value, _B.m_Value) }; }
+        static SFloat4 Mul(SFloat4 _A, SFloat4 _B)                           { return { _mm_mul_ps(_A.m_Value, _B.m_Value) }; }
+        static SFloat4 MulAdd(SFloat4 _A, SFloat4 _B, SFloat4 _C)            { return { _mm_add_ps(_mm_mul_ps(_A.m_Value, _B.m_Value), _C.m_Value) }; }
+        static unsigned int GreaterMask(SFloat4 _A, SFloat4 _B)              { return static_cast<unsigned int>(_mm_movemask_ps(_mm_cmpgt_ps(_A.m_Value, _B.m_Value))); }
+    };
+
+    struct SDouble2
+    {
+        typedef double TReal;
+
+        static const int  s_NumberOfLanes = 2;
+        static const bool s_IsMulAddFused = false;
+
+        __m128d m_Value;
+
+        static SDouble2 Broadcast(double _Value)                             { return { _mm_set1_pd(_Value) }; }
+        static SDouble2 Load(const double* _pValues)                         { return { _mm_load_pd(_pValues) }; }
+        static void Store(SDouble2 _A, double* _pValues)                     { _mm_store_pd(_pValues, _A.m_Value); }
+        static SDouble2 Add(SDouble2 _A, SDouble2 _B)                        { return { _mm_add_pd(_A.m_Value, _B.m_Value) }; }
+        static SDouble2 Sub(SDouble2 _A, SDouble2 _B)                        { return { _mm_sub_pd(_A.m_Value, _B.m_Value) }; }
+        static SDouble2 Mul(SDouble2 _A, SDouble2 _B)                        { return { _mm_mul_pd(_A.m_Value, _B.m_Value) }; }
+        static SDouble2 MulAdd(SDouble2 _A, SDouble2 _B, SDouble2 _C)        { return { _mm_add_pd(_mm_mul_pd(_A.m_Value, _B.m_Value), _C.m_Value) }; }
+        static unsigned int GreaterMask(SDouble2 _A, SDouble2 _B)            { return static_cast<unsigned int>(_mm_movemask_pd(_mm_cmpgt_pd(_A.m_Value, _B.m_Value))); }
+    };
+
+    // -----------------------------------------------------------------------------
+    // SSE2 has no gather, so only the four palette colors are loaded one by one.
+    // The indices, the selection of black and the store are done at once.
+    // -----------------------------------------------------------------------------
+
+    void MapColorsSSE2(const SMandelbrotColorMap& _rColorMap, const float* _pSmoothIterations, int _NumberOfPixels, unsigned char* _pPixels)
+    {
+        const __m128  Density = _mm_set1_ps(_rColorMap.m_Density);
+        const __m128  Offset  = _mm_set1_ps(_rColorMap.m_Offset);
+        const __m128  Zero    = _mm_setzero_ps();
+        const __m128i Mask    = _mm_set1_epi32(static_cast<int>(_rColorMap.m_Mask));
+        const __m128i Black   = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+
+        const unsigned int* pColors = _rColorMap.m_pColors;
+
+        alignas(16) int Indices[4];
+
+        int IndexOfPixel = 0;
+
+        for (; IndexOfPixel + 4 <= _NumberOfPixels; IndexOfPixel += 4)
+        {
+            __m128  Smooth = _mm_loadu_ps(_pSmoothIterations + IndexOfPixel);
+            __m128i Index  = _mm_and_si128(_mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(Smooth, Density), Offset)), Mask);
+
+            _mm_store_si128(reinterpret_cast<__m128i*>(Indices), Index);
+
+            __m128i Color   = _mm_setr_epi32(static_cast<int>(pColors[Indices[0]]), static_cast<int>(pColors[Indices[1]]), static_cast<int>(pColors[Indices[2]]), static_cast<int>(pColors[Indices[3]]));
+            __m128i IsBound = _mm_castps_si128(_mm_cmplt_ps(Smooth, Zero));
+
+            Color = _mm_or_si128(_mm_and_si128(IsBound, Black), _mm_andnot_si128(IsBound, Color));
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(_pPixels + IndexOfPixel * 4), Color);
+        }
+
+        MapColors(_rColorMap, _pSmoothIterations + IndexOfPixel, _NumberOfPixels - IndexOfPixel, _pPixels + IndexOfPixel * 4);
+    }
+
+    const SMandelbrotKernel s_SSE2Kernel = { "sse2", 4, 2, &IterateRow<SFloat4>, &IterateRow<SDouble2>, &IterateRow<SDoubleDouble<SDouble2>>, &IterateRow<SQuadDouble<SDouble2>>, &AdvancePixels<SFloat4>, &AdvancePixels<SDouble2>, &IteratePerturbation<SDouble2>, &MapColorsSSE2, SFractalKernels<SFloat4>::s_IterateRows, SFractalKernels<SDouble2>::s_IterateRows };
+#endif
+
+    // -----------------------------------------------------------------------------
+
+#if MANDELBROT_X86
+    void GetCPUID(int _Leaf, unsigned int* _pRegisters)
+    {
+#if defined(_MSC_VER)
+        int Registers[4];
+
+        __cpuidex(Registers, _Leaf, 0);
+
+        for (int Index = 0; Index < 4; ++Index) _pRegisters[Index] = static_cast<unsigned int>(Registers[Index]);
+#else
+        __cpuid_count(_Leaf, 0, _pRegisters[0], _pRegisters[1], _pRegisters[2], _pRegisters[3]);
+#endif
+    }
+
+    // -----------------------------------------------------------------------------
+
+    unsigned long long GetEnabledStateMask()
+    {
+#if defined(_MSC_VER)
+        return _xgetbv(0);
+#else
+        unsigned int Low;
+        unsigned int High;
+
+        __asm__ volatile ("xgetbv" : "=a" (Low), "=d" (High) : "c" (0));
+
+        return (static_cast<unsigned long long>(High) << 32) | Low;
+#endif
+    }
+#endif
+
+    // -----------------------------------------------------------------------------
+
+    void GetSupportedInstructionSets(bool* _pHasAVX2, bool* _pHasAVX512)
+    {
+        *_pHasAVX2   = false;
+        *_pHasAVX512 = false;
+
+#if MANDELBROT_X86
+        unsigned int Registers[4];
+
+        GetCPUID(0, Registers);
+
+        if (Registers[0] < 7) return;
+
+        GetCPUID(1, Registers);
+
+        bool HasFMA     = (Registers[2] & (1u << 12)) != 0;
+        bool HasXSAVE   = (Registers[2] & (1u << 27)) != 0;
+        bool HasAVX     = (Registers[2] & (1u << 28)) != 0;
+
+        if (!HasFMA || !HasXSAVE || !HasAVX) return;
+
+        // -----------------------------------------------------------------------------
+        // The OS has to save the YMM (and ZMM) registers on a context switch.
+        // -----------------------------------------------------------------------------
+        unsigned long long StateMask = GetEnabledStateMask();
+
+        if ((StateMask & 0x6) != 0x6) return;
+
+        GetCPUID(7, Registers);
+
+        *_pHasAVX2   = (Registers[1] & (1u <<  5)) != 0;
+        *_pHasAVX512 = (Registers[1] & (1u << 16)) != 0 && (StateMask & 0xE0) == 0xE0;
+#endif
+    }
+
+    // -----------------------------------------------------------------------------
+
+    const SMandelbrotKernel* SelectMandelbrotKernel()
+    {
+        const char* pName = std::getenv("MANDELBROT_KERNEL");
+
+        if (pName != nullptr)
+        {
+            const SMandelbrotKernel* pKernel = GetMandelbrotKernel(pName);
+
+            if (pKernel != nullptr) return pKernel;
+        }
+
+        bool HasAVX2;
+        bool HasAVX512;
+
+        GetSupportedInstructionSets(&HasAVX2, &HasAVX512);
+
+        const SMandelbrotKernel* pKernel = nullptr;
+
+        if (HasAVX512)                       pKernel = GetMandelbrotKernelAVX512();
+        if (pKernel == nullptr && HasAVX2)   pKernel = GetMandelbrotKernelAVX2();
+
+#if MANDELBROT_SSE2
+        if (pKernel == nullptr) pKernel = &s_SSE2Kernel;
+#endif
+
+        return pKernel != nullptr ? pKernel : &s_ScalarKernel;
+    }
+} // namespace
+
+// -----------------------------------------------------------------------------
+
+const SMandelbrotKernel& GetMandelbrotKernel()
+{
+    static const SMandelbrotKernel* s_pKernel = SelectMandelbrotKernel();
+
+    return *s_pKernel;
+}
+
+// -----------------------------------------------------------------------------
+
+const SMandelbrotKernel* GetMandelbrotKernel(const char* _pName)
+{
+    bool HasAVX2;
+    bool HasAVX512;
+
+    GetSupportedInstructionSets(&HasAVX2, &HasAVX512);
+
+    if (std::strcmp(_pName, "scalar") == 0) return &s_ScalarKernel;
+
+#if MANDELBROT_SSE2
+    if (std::strcmp(_pName, "sse2") == 0) return &s_SSE2Kernel;
+#endif
+
+    if (std::strcmp(_pName, "avx2")   == 0 && HasAVX2)   return GetMandelbrotKernelAVX2();
+    if (std::strcmp(_pName, "avx512") == 0 && HasAVX512) return GetMandelbrotKernelAVX512();
+
+    return nullptr;
+}
+
+// -----------------------------------------------------------------------------
+
+FIterateRow GetFractalIterateRow(const SMandelbrotKernel& _rKernel, bool _IsDoublePrecision, SFractal::EType _Type, int _Exponent)
+{
+    if (_Type < 0 || _Type >= SFractal::NumberOfTypes || _Exponent < SFractal::s_MinExponent || _Exponent > SFractal::s_MaxExponent) return nullptr;
+
+    const FIterateRow* pIterateRows = _IsDoublePrecision ? _rKernel.m_pIterateRowFractalDouble : _rKernel.m_pIterateRowFractalFloat;
+
+    return pIterateRows[_Type * SFractal::s_NumberOfExponents + _Exponent - SFractal::s_MinExponent];
+}
@@ -0,0 +1,178 @@
+#pragma once
+
+// -----------------------------------------------------------------------------
+// The escape time fractals z = z^n + c the row kernels are instantiated for.
+// Every exponent has kernels of its own, z^2 of the Mandelbrot set is the one
+// of the shader and the only one with extended precision kernels.
+// -----------------------------------------------------------------------------
+
+struct SFractal
+{
+    enum EType
+    {
+        Mandelbrot,                             // z starts at 0 and c is the pixel.
+        Julia,                                  // z starts at the pixel and c is the same for all pixels.
+        NumberOfTypes,
+    };
+
+    static const int s_MinExponent       = 2;
+    static const int s_MaxExponent       = 8;
+    static const int s_NumberOfExponents = s_MaxExponent - s_MinExponent + 1;
+};
+
+// -----------------------------------------------------------------------------
+// A horizontal run of pixels handed to the escape time kernel. Pixel i of the
+// run is p = (m_X + i * m_StepX) + m_Y * i, which is c for the Mandelbrot set
+// and the start of z for Julia sets. The double-double and quad-double
+// kernels add the low parts to m_X and m_Y, the others ignore them.
+// -----------------------------------------------------------------------------
+
+struct SMandelbrotRow
+{
+    double       m_X;                           // Real part of the first pixel.
+    double       m_XLow[3];                     // Rest of the real part below the precision of m_X.
+    double       m_StepX;                       // Distance of two neighboured pixels.
+    double       m_Y;                           // Imaginary part of all pixels.
+    double       m_YLow[3];
+    double       m_JuliaC[2];                   // c of the Julia kernels.
+    int          m_NumberOfPixels;
+    unsigned int m_MaxIteration;
+    bool         m_IsInteriorChecked;           // Stop pixels early which are provably bound.
+    float*       m_pDistances;                  // Optional, gets the distance estimate to the set of every escaped pixel in units of m_StepX and 0 for bound pixels.
+};
+
+// -----------------------------------------------------------------------------
+// Counts the pixels the interior checks stopped early and the iterations this
+// saved compared to running them up to the maximum iteration. The kernels
+// add to it.
+// -----------------------------------------------------------------------------
+
+struct SMandelbrotInteriorStatistics
+{
+    unsigned long long m_NumberOfBulbPixels;        // Pixels in the main cardioid or the period 2 bulb, which are not iterated at all.
+    unsigned long long m_NumberOfPeriodicPixels;    // Pixels whose orbit ran into a cycle.
+    unsigned long long m_BulbIterations;            // Iterations saved by the cardioid and bulb test.
+    unsigned long long m_PeriodicIterations;        // Iterations saved by the cycle detection.
+};
+
+// -----------------------------------------------------------------------------
+// Writes for every pixel of the row the iteration in which the pixel escaped
+// or m_MaxIteration if it is bound. _pMagnitudes gets the squared magnitude of
+// the first z outside, which is needed for the smooth iteration count, or 0
+// for bound pixels.
+// -----------------------------------------------------------------------------
+
+typedef void (*FIterateRow)(const SMandelbrotRow& _rRow, unsigned int* _pIterations, float* _pMagnitudes, SMandelbrotInteriorStatistics* _pStatistics);
+
+// -----------------------------------------------------------------------------
+// The iteration state of a single pixel, so it can be continued when the
+// maximum iteration grows. m_Z is z[m_Iteration] while the pixel is bound. An
+// escaped pixel keeps the iteration it escaped in and the first z outside. A
+// pixel whose orbit ran into a cycle keeps a point of the cycle.
+// -----------------------------------------------------------------------------
+
+struct SMandelbrotPixel
+{
+    double       m_C[2];
+    double       m_Z[2];
+    unsigned int m_Iteration;
+    unsigned int m_IsEscaped;
+    unsigned int m_IndexOfPixel;                // Position of the pixel in the image.
+};
+
+// -----------------------------------------------------------------------------
+// Continues the pixels until they escape or reach _MaxIteration. Only bound
+// pixels may be passed.
+// -----------------------------------------------------------------------------
+
+typedef void (*FAdvancePixels)(SMandelbrotPixel* _pPixels, int _NumberOfPixels, unsigned int _MaxIteration, bool _IsInteriorChecked, SMandelbrotInteriorStatistics* _pStatistics);
+
+// -----------------------------------------------------------------------------
+// Pixels of a deep zoom iterated as the difference d to a reference orbit Z,
+// which starts at d = 0 and adds dc, the distance of the pixel to the center
+// of the orbit:
+//
+//    d[n+1] = 2 Z[n] d[n] + d[n]^2 + dc
+//
+// The pixel is z = Z + d. A pixel whose z gets smaller than its d has lost
+// all information to the cancellation in Z + d (a glitch). It rebases, i.e.
+// continues with d = z on Z[0] = 0. This also keeps pixels going after the
+// end of an escaped reference orbit.
+// -----------------------------------------------------------------------------
+
+struct SMandelbrotPerturbation
+{
+    const double* m_pOrbit;                     // Real and imaginary part of Z[0], Z[1], ..., Z[0] is 0.
+    int           m_OrbitLength;
+    const double* m_pDCX;                       // Real part of dc of every pixel.
+    const double* m_pDCY;                       // Imaginary part of dc of every pixel.
+    int           m_NumberOfPixels;
+    unsigned int  m_MaxIteration;
+};
+
+// -----------------------------------------------------------------------------
+// Writes for every pixel the iteration in which it escaped or m_MaxIteration
+// and the squared magnitude of the first z outside or 0. The rebases are
+// added to _pNumberOfRebases.
+// -----------------------------------------------------------------------------
+
+typedef void (*FIteratePerturbation)(const SMandelbrotPerturbation& _rPerturbation, unsigned int* _pIterations, double* _pMagnitudes, unsigned int* _pNumberOfRebases);
+
+// -----------------------------------------------------------------------------
+// Maps smooth iteration counts onto a palette. Escaped pixels get the color
+// m_pColors[floor(Smooth * m_Density + m_Offset) & m_Mask], pixels with a
+// negative count are bound and get black. The colors are written as RGBA
+// bytes like SMandelbrotImage::m_Pixels, which needs no alignment.
+// -----------------------------------------------------------------------------
+
+struct SMandelbrotColorMap
+{
+    const unsigned int* m_pColors;              // RGBA with 8 bits per channel, red in the lowest byte.
+    unsigned int        m_Mask;                 // Number of colors minus 1, the number of colors is a power of two.
+    float               m_Density;              // Palette colors per iteration.
+    float               m_Offset;               // Palette colors to skip, at least 0.
+};
+
+typedef void (*FMapColors)(const SMandelbrotColorMap& _rColorMap, const float* _pSmoothIterations, int _NumberOfPixels, unsigned char* _pPixels);
+
+// -----------------------------------------------------------------------------
+// The kernels of an instruction set. There is one row kernel per precision,
+// the double-double and quad-double ones iterate as many pixels at once as the
+// double one. The row kernels of the other fractals are picked with
+// GetFractalIterateRow.
+// -----------------------------------------------------------------------------
+
+struct SMandelbrotKernel
+{
+    const char*          m_pName;                    // Name of the instruction set, e.g. "avx2".
+    int                  m_NumberOfFloatLanes;       // Pixels iterated at once in single precision.
+    int                  m_NumberOfDoubleLanes;      // Pixels iterated at once in double precision.
+    FIterateRow          m_pIterateRowFloat;
+    FIterateRow          m_pIterateRowDouble;
+    FIterateRow          m_pIterateRowDoubleDouble;  // About 32 significant digits.
+    FIterateRow          m_pIterateRowQuadDouble;    // About 64 significant digits.
+    FAdvancePixels       m_pAdvancePixelsFloat;
+    FAdvancePixels       m_pAdvancePixelsDouble;
+    FIteratePerturbation m_pIteratePerturbation;     // Iterates as many pixels at once as the double kernels.
+    FMapColors           m_pMapColors;
+    const FIterateRow*   m_pIterateRowFractalFloat;  // Row kernels per type and exponent of SFractal.
+    const FIterateRow*   m_pIterateRowFractalDouble;
+};
+
+// -----------------------------------------------------------------------------
+// Returns the fastest kernel the executing CPU supports. The choice is made
+// once at runtime and can be overridden with the environment variable
+// MANDELBROT_KERNEL (scalar, sse2, avx2, avx512).
+// -----------------------------------------------------------------------------
+
+const SMandelbrotKernel& GetMandelbrotKernel();
+
+const SMandelbrotKernel* GetMandelbrotKernel(const char* _pName);
+
+// -----------------------------------------------------------------------------
+// The row kernel of a fractal in float or double precision, nullptr if there
+// is none for the exponent. The Mandelbrot set with exponent 2 gets the same
+// kernel as m_pIterateRowFloat or m_pIterateRowDouble.
+// -----------------------------------------------------------------------------
+
+FIterateRow GetFractalIterateRow(const SMandelbrotKernel& _rKernel, bool _IsDoublePrecision, SFractal::EType _Type, int _Exponent);
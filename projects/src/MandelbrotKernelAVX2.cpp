@@ -0,0 +1,111 @@
+#include "MandelbrotKernel.h"
+
+// -----------------------------------------------------------------------------
+// This translation unit is compiled for AVX2 and FMA, either by the
+// EnableEnhancedInstructionSet setting of the project or by the target pragma
+// below. Its kernel is only used if the CPU supports both.
+// -----------------------------------------------------------------------------
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx2,fma"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+#endif
+
+#include <immintrin.h>
+
+#include "MandelbrotKernelTemplate.h"
+
+namespace
+{
+    struct SFloat8
+    {
+        typedef float TReal;
+
+        static const int s_NumberOfLanes = 8;
+
+        __m256 m_Value;
+
+        static SFloat8 Broadcast(float _Value)                               { return { _mm256_set1_ps(_Value) }; }
+        static SFloat8 Load(const float* _pValues)                           { return { _mm256_load_ps(_pValues) }; }
+        static void Store(SFloat8 _A, float* _pValues)                       { _mm256_store_ps(_pValues, _A.m_Value); }
+        static SFloat8 Add(SFloat8 _A, SFloat8 _B)                           { return { _mm256_add_ps(_A.m_Value, _B.m_Value) }; }
+        static SFloat8 Sub(SFloat8 _A, SFloat8 _B)                           { return { _mm256_sub_ps(_A.m_Value, _B.m_Value) }; }
+        static SFloat8 Mul(SFloat8 _A, SFloat8 _B)                           { return { _mm256_mul_ps(_A.m_Value, _B.m_Value) }; }
+        static SFloat8 MulAdd(SFloat8 _A, SFloat8 _B, SFloat8 _C)            { return { _mm256_fmadd_ps(_A.m_Value, _B.m_Value, _C.m_Value) }; }
+        static unsigned int GreaterMask(SFloat8 _A, SFloat8 _B)              { return static_cast<unsigned int>(_mm256_movemask_ps(_mm256_cmp_ps(_A.m_Value, _B.m_Value, _CMP_GT_OQ))); }
+    };
+
+    struct SDouble4
+    {
+        typedef double TReal;
+
+        static const int  s_NumberOfLanes = 4;
+        static const bool s_IsMulAddFused = true;
+
+        __m256d m_Value;
+
+        static SDouble4 Broadcast(double _Value)                             { return { _mm256_set1_pd(_Value) }; }
+        static SDouble4 Load(const double* _pValues)                         { return { _mm256_load_pd(_pValues) }; }
+        static void Store(SDouble4 _A, double* _pValues)                     { _mm256_store_pd(_pValues, _A.m_Value); }
+        static SDouble4 Add(SDouble4 _A, SDouble4 _B)                        { return { _mm256_add_pd(_A.m_Value, _B.m_Value) }; }
+        static SDouble4 Sub(SDouble4 _A, SDouble4 _B)                        { return { _mm256_sub_pd(_A.m_Value, _B.m_Value) }; }
+        static SDouble4 Mul(SDouble4 _A, SDouble4 _B)                        { return { _mm256_mul_pd(_A.m_Value, _B.m_Value) }; }
+        static SDouble4 MulAdd(SDouble4 _A, SDouble4 _B, SDouble4 _C)        { return { _mm256_fmadd_pd(_A.m_Value, _B.m_Value, _C.m_Value) }; }
+        static unsigned int GreaterMask(SDouble4 _A, SDouble4 _B)            { return static_cast<unsigned int>(_mm256_movemask_pd(_mm256_cmp_pd(_A.m_Value, _B.m_Value, _CMP_GT_OQ))); }
+    };
+
+    // -----------------------------------------------------------------------------
+
+    void MapColorsAVX2(const SMandelbrotColorMap& _rColorMap, const float* _pSmoothIterations, int _NumberOfPixels, unsigned char* _pPixels)
+    {
+        const __m256  Density = _mm256_set1_ps(_rColorMap.m_Density);
+        const __m256  Offset  = _mm256_set1_ps(_rColorMap.m_Offset);
+        const __m256  Zero    = _mm256_setzero_ps();
+        const __m256i Mask    = _mm256_set1_epi32(static_cast<int>(_rColorMap.m_Mask));
+        const __m256i Black   = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+
+        const int* pColors = reinterpret_cast<const int*>(_rColorMap.m_pColors);
+
+        int IndexOfPixel = 0;
+
+        for (; IndexOfPixel + 8 <= _NumberOfPixels; IndexOfPixel += 8)
+        {
+            __m256  Smooth  = _mm256_loadu_ps(_pSmoothIterations + IndexOfPixel);
+            __m256i Index   = _mm256_and_si256(_mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(Smooth, Density), Offset)), Mask);
+            __m256i Color   = _mm256_i32gather_epi32(pColors, Index, 4);
+            __m256  IsBound = _mm256_cmp_ps(Smooth, Zero, _CMP_LT_OQ);
+
+            Color = _mm256_blendv_epi8(Color, Black, _mm256_castps_si256(IsBound));
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(_pPixels + IndexOfPixel * 4), Color);
+        }
+
+        MapColors(_rColorMap, _pSmoothIterations + IndexOfPixel, _NumberOfPixels - IndexOfPixel, _pPixels + IndexOfPixel * 4);
+    }
+
+    const SMandelbrotKernel s_Kernel = { "avx2", 8, 4, &IterateRow<SFloat8>, &IterateRow<SDouble4>, &IterateRow<SDoubleDouble<SDouble4>>, &IterateRow<SQuadDouble<SDouble4>>, &AdvancePixels<SFloat8>, &AdvancePixels<SDouble4>, &IteratePerturbation<SDouble4>, &MapColorsAVX2, SFractalKernels<SFloat8>::s_IterateRows, SFractalKernels<SDouble4>::s_IterateRows };
+} // namespace
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+const SMandelbrotKernel* GetMandelbrotKernelAVX2()
+{
+    return &s_Kernel;
+}
+
+#else
+
+const SMandelbrotKernel* GetMandelbrotKernelAVX2()
+{
+    return nullptr;
+}
+
+#endif
@@ -0,0 +1,109 @@
+#include "MandelbrotKernel.h"
+
+// -----------------------------------------------------------------------------
+// This translation unit is compiled for AVX-512F, either by the
+// EnableEnhancedInstructionSet setting of the project or by the target pragma
+// below. Its kernel is only used if the CPU supports it.
+// -----------------------------------------------------------------------------
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx512f"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+#endif
+
+#include <immintrin.h>
+
+#include "MandelbrotKernelTemplate.h"
+
+namespace
+{
+    struct SFloat16
+    {
+        typedef float TReal;
+
+        static const int s_NumberOfLanes = 16;
+
+        __m512 m_Value;
+
+        static SFloat16 Broadcast(float _Value)                              { return { _mm512_set1_ps(_Value) }; }
+        static SFloat16 Load(const float* _pValues)                          { return { _mm512_load_ps(_pValues) }; }
+        static void Store(SFloat16 _A, float* _pValues)                      { _mm512_store_ps(_pValues, _A.m_Value); }
+        static SFloat16 Add(SFloat16 _A, SFloat16 _B)                        { return { _mm512_add_ps(_A.m_Value, _B.m_Value) }; }
+        static SFloat16 Sub(SFloat16 _A, SFloat16 _B)                        { return { _mm512_sub_ps(_A.m_Value, _B.m_Value) }; }
+        static SFloat16 Mul(SFloat16 _A, SFloat16 _B)                        { return { _mm512_mul_ps(_A.m_Value, _B.m_Value) }; }
+        static SFloat16 MulAdd(SFloat16 _A, SFloat16 _B, SFloat16 _C)        { return { _mm512_fmadd_ps(_A.m_Value, _B.m_Value, _C.m_Value) }; }
+        static unsigned int GreaterMask(SFloat16 _A, SFloat16 _B)            { return static_cast<unsigned int>(_mm512_cmp_ps_mask(_A.m_Value, _B.m_Value, _CMP_GT_OQ)); }
+    };
+
+    struct SDouble8
+    {
+        typedef double TReal;
+
+        static const int  s_NumberOfLanes = 8;
+        static const bool s_IsMulAddFused = true;
+
+        __m512d m_Value;
+
+        static SDouble8 Broadcast(double _Value)                             { return { _mm512_set1_pd(_Value) }; }
+        static SDouble8 Load(const double* _pValues)                         { return { _mm512_load_pd(_pValues) }; }
+        static void Store(SDouble8 _A, double* _pValues)                     { _mm512_store_pd(_pValues, _A.m_Value); }
+        static SDouble8 Add(SDouble8 _A, SDouble8 _B)                        { return { _mm512_add_pd(_A.m_Value, _B.m_Value) }; }
+        static SDouble8 Sub(SDouble8 _A, SDouble8 _B)                        { return { _mm512_sub_pd(_A.m_Value, _B.m_Value) }; }
+        static SDouble8 Mul(SDouble8 _A, SDouble8 _B)                        { return { _mm512_mul_pd(_A.m_Value, _B.m_Value) }; }
+        static SDouble8 MulAdd(SDouble8 _A, SDouble8 _B, SDouble8 _C)        { return { _mm512_fmadd_pd(_A.m_Value, _B.m_Value, _C.m_Value) }; }
+        static unsigned int GreaterMask(SDouble8 _A, SDouble8 _B)            { return static_cast<unsigned int>(_mm512_cmp_pd_mask(_A.m_Value, _B.m_Value, _CMP_GT_OQ)); }
+    };
+
+    // -----------------------------------------------------------------------------
+
+    void MapColorsAVX512(const SMandelbrotColorMap& _rColorMap, const float* _pSmoothIterations, int _NumberOfPixels, unsigned char* _pPixels)
+    {
+        const __m512  Density = _mm512_set1_ps(_rColorMap.m_Density);
+        const __m512  Offset  = _mm512_set1_ps(_rColorMap.m_Offset);
+        const __m512  Zero    = _mm512_setzero_ps();
+        const __m512i Mask    = _mm512_set1_epi32(static_cast<int>(_rColorMap.m_Mask));
+        const __m512i Black   = _mm512_set1_epi32(static_cast<int>(0xFF000000u));
+
+        int IndexOfPixel = 0;
+
+        for (; IndexOfPixel + 16 <= _NumberOfPixels; IndexOfPixel += 16)
+        {
+            __m512    Smooth  = _mm512_loadu_ps(_pSmoothIterations + IndexOfPixel);
+            __m512i   Index   = _mm512_and_si512(_mm512_cvttps_epi32(_mm512_add_ps(_mm512_mul_ps(Smooth, Density), Offset)), Mask);
+            __m512i   Color   = _mm512_i32gather_epi32(Index, _rColorMap.m_pColors, 4);
+            __mmask16 IsBound = _mm512_cmp_ps_mask(Smooth, Zero, _CMP_LT_OQ);
+
+            Color = _mm512_mask_mov_epi32(Color, IsBound, Black);
+
+            _mm512_storeu_si512(_pPixels + IndexOfPixel * 4, Color);
+        }
+
+        MapColors(_rColorMap, _pSmoothIterations + IndexOfPixel, _NumberOfPixels - IndexOfPixel, _pPixels + IndexOfPixel * 4);
+    }
+
+    const SMandelbrotKernel s_Kernel = { "avx512", 16, 8, &IterateRow<SFloat16>, &IterateRow<SDouble8>, &IterateRow<SDoubleDouble<SDouble8>>, &IterateRow<SQuadDouble<SDouble8>>, &AdvancePixels<SFloat16>, &AdvancePixels<SDouble8>, &IteratePerturbation<SDouble8>, &MapColorsAVX512, SFractalKernels<SFloat16>::s_IterateRows, SFractalKernels<SDouble8>::s_IterateRows };
+} // namespace
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+const SMandelbrotKernel* GetMandelbrotKernelAVX512()
+{
+    return &s_Kernel;
+}
+
+#else
+
+const SMandelbrotKernel* GetMandelbrotKernelAVX512()
+{
+    return nullptr;
+}
+
+#endif
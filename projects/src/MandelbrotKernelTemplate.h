@@ -0,0 +1,1175 @@
+#pragma once
+
+#include "MandelbrotKernel.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+// -----------------------------------------------------------------------------
+// The escape time loop shared by all instruction sets. It is only included by
+// the kernel translation units, which compile it with their own target flags.
+// Everything lives in an anonymous namespace, so the linker never merges the
+// copies of different instruction sets.
+//
+// TVector is the numeric policy of the loop, a vector of float or double lanes
+// or one of the extended precision vectors below. It has to provide:
+//
+//    TReal, s_NumberOfLanes
+//    Broadcast(TReal), Load(const TReal*), Store(TVector, TReal*)
+//    Add(a, b), Sub(a, b), Mul(a, b), MulAdd(a, b, c) = a * b + c
+//    GreaterMask(a, b) = bit i set if lane i of a is greater than lane i of b
+//
+// Double vectors used for SDoubleDouble and SQuadDouble also provide
+// s_IsMulAddFused, i.e. whether MulAdd rounds only once.
+// -----------------------------------------------------------------------------
+
+namespace
+{
+    // -----------------------------------------------------------------------------
+    // Points inside the main cardioid or the period 2 bulb never escape, see
+    // https://en.wikipedia.org/wiki/Plotting_algorithms_for_the_Mandelbrot_set.
+    // -----------------------------------------------------------------------------
+
+    inline bool IsInMainCardioidOrBulb(double _X, double _Y)
+    {
+        double Y2 = _Y * _Y;
+        double Q  = (_X - 0.25) * (_X - 0.25) + Y2;
+
+        if (Q * (Q + (_X - 0.25)) <= 0.25 * Y2) return true;
+
+        return (_X + 1.0) * (_X + 1.0) + Y2 <= 0.0625;
+    }
+
+    // -----------------------------------------------------------------------------
+    // Two z of an orbit closer than this are taken as the same point, i.e. the
+    // orbit ran into a cycle and the pixel is bound. Orbits of bound pixels end up
+    // repeating exactly in the precision of TReal, so a few epsilons are enough.
+    // -----------------------------------------------------------------------------
+
+    template <typename TReal>
+    TReal GetPeriodicityTolerance()
+    {
+        return TReal(16) * std::numeric_limits<TReal>::epsilon() * std::numeric_limits<TReal>::epsilon();
+    }
+
+    // -----------------------------------------------------------------------------
+    // Error free transformations, see Shewchuk, Adaptive Precision Floating-Point
+    // Arithmetic and Fast Robust Geometric Predicates. The result is the rounded
+    // value and *_pError what the rounding lost. The kernels are compiled
+    // without implicit FMA for them, see CMakeLists.txt.
+    // -----------------------------------------------------------------------------
+
+    template <typename TDouble>
+    TDouble TwoSum(TDouble _A, TDouble _B, TDouble* _pError)
+    {
+        TDouble Sum = TDouble::Add(_A, _B);
+        TDouble B   = TDouble::Sub(Sum, _A);
+
+        *_pError = TDouble::Add(TDouble::Sub(_A, TDouble::Sub(Sum, B)), TDouble::Sub(_B, B));
+
+        return Sum;
+    }
+
+    template <typename TDouble>
+    TDouble QuickTwoSum(TDouble _A, TDouble _B, TDouble* _pError)       // Requires |_A| >= |_B|.
+    {
+        TDouble Sum = TDouble::Add(_A, _B);
+
+        *_pError = TDouble::Sub(_B, TDouble::Sub(Sum, _A));
+
+        return Sum;
+    }
+
+    template <typename TDouble>
+    TDouble TwoProduct(TDouble _A, TDouble _B, TDouble* _pError)
+    {
+        TDouble Product = TDouble::Mul(_A, _B);
+
+        if (TDouble::s_IsMulAddFused)
+        {
+            *_pError = TDouble::MulAdd(_A, _B, TDouble::Sub(TDouble::Broadcast(0.0), Product));
+        }
+        else
+        {
+            // -----------------------------------------------------------------------------
+            // Dekker: split both factors into halves of 26 bits, whose products
+            // are exact.
+            // -----------------------------------------------------------------------------
+            const TDouble Splitter = TDouble::Broadcast(134217729.0);
+
+            TDouble TA = TDouble::Mul(Splitter, _A);
+            TDouble TB = TDouble::Mul(Splitter, _B);
+            TDouble AH = TDouble::Sub(TA, TDouble::Sub(TA, _A));
+            TDouble BH = TDouble::Sub(TB, TDouble::Sub(TB, _B));
+            TDouble AL = TDouble::Sub(_A, AH);
+            TDouble BL = TDouble::Sub(_B, BH);
+
+            TDouble Error = TDouble::Sub(TDouble::Mul(AH, BH), Product);
+
+            Error = TDouble::Add(Error, TDouble::Mul(AH, BL));
+            Error = TDouble::Add(Error, TDouble::Mul(AL, BH));
+
+            *_pError = TDouble::Add(Error, TDouble::Mul(AL, BL));
+        }
+
+        return Product;
+    }
+
+    // -----------------------------------------------------------------------------
+    // A vector of double-double numbers, the unevaluated sum of two doubles
+    // with 106 significant bits. Additions are the fast variant which is exact
+    // relative to the larger operand, enough for orbits which stay below 2.
+    // Comparisons only look at the high part.
+    // -----------------------------------------------------------------------------
+
+    template <typename TDouble>
+    struct SDoubleDouble
+    {
+        typedef double TReal;
+
+        static const int s_NumberOfLanes = TDouble::s_NumberOfLanes;
+
+        TDouble m_High;
+        TDouble m_Low;
+
+        static SDoubleDouble Broadcast(double _Value)                        { return { TDouble::Broadcast(_Value), TDouble::Broadcast(0.0) }; }
+        static SDoubleDouble Load(const double* _pValues)                    { return { TDouble::Load(_pValues), TDouble::Broadcast(0.0) }; }
+        static void Store(SDoubleDouble _A, double* _pValues)                { TDouble::Store(_A.m_High, _pValues); }
+
+        static SDoubleDouble Add(SDoubleDouble _A, SDoubleDouble _B)
+        {
+            SDoubleDouble Result;
+
+            TDouble Error;
+            TDouble Sum = TwoSum(_A.m_High, _B.m_High, &Error);
+
+            Error = TDouble::Add(Error, TDouble::Add(_A.m_Low, _B.m_Low));
+
+            Result.m_High = QuickTwoSum(Sum, Error, &Result.m_Low);
+
+            return Result;
+        }
+
+        static SDoubleDouble Sub(SDoubleDouble _A, SDoubleDouble _B)
+        {
+            const TDouble Zero = TDouble::Broadcast(0.0);
+
+            SDoubleDouble Negated = { TDouble::Sub(Zero, _B.m_High), TDouble::Sub(Zero, _B.m_Low) };
+
+            return Add(_A, Negated);
+        }
+
+        static SDoubleDouble Mul(SDoubleDouble _A, SDoubleDouble _B)
+        {
+            SDoubleDouble Result;
+
+            TDouble Error;
+            TDouble Product = TwoProduct(_A.m_High, _B.m_High, &Error);
+
+            Error = TDouble::Add(Error, TDouble::Add(TDouble::Mul(_A.m_High, _B.m_Low), TDouble::Mul(_A.m_Low, _B.m_High)));
+
+            Result.m_High = QuickTwoSum(Product, Error, &Result.m_Low);
+
+            return Result;
+        }
+
+        static SDoubleDouble MulAdd(SDoubleDouble _A, SDoubleDouble _B, SDoubleDouble _C)    { return Add(Mul(_A, _B), _C); }
+        static unsigned int GreaterMask(SDoubleDouble _A, SDoubleDouble _B)                  { return TDouble::GreaterMask(_A.m_High, _B.m_High); }
+    };
+
+    // -----------------------------------------------------------------------------
+    // A vector of quad-double numbers, the unevaluated sum of four doubles with
+    // about 212 significant bits. Additions and multiplications are the sloppy
+    // variants of Hida, Li and Bailey, Library for Double-Double and
+    // Quad-Double Arithmetic, with a renormalization that has no branches.
+    // -----------------------------------------------------------------------------
+
+    template <typename TDouble>
+    struct SQuadDouble
+    {
+        typedef double TReal;
+
+        static const int s_NumberOfLanes = TDouble::s_NumberOfLanes;
+
+        TDouble m_Parts[4];
+
+        static SQuadDouble Broadcast(double _Value)
+        {
+            const TDouble Zero = TDouble::Broadcast(0.0);
+
+            return { { TDouble::Broadcast(_Value), Zero, Zero, Zero } };
+        }
+
+        static SQuadDouble Load(const double* _pValues)
+        {
+            const TDouble Zero = TDouble::Broadcast(0.0);
+
+            return { { TDouble::Load(_pValues), Zero, Zero, Zero } };
+        }
+
+        static void Store(SQuadDouble _A, double* _pValues)
+        {
+            TDouble::Store(_A.m_Parts[0], _pValues);
+        }
+
+        static void ThreeSum(TDouble* _pA, TDouble* _pB, TDouble* _pC)
+        {
+            TDouble Error1;
+            TDouble Error2;
+            TDouble Sum = TwoSum(*_pA, *_pB, &Error1);
+
+            *_pA = TwoSum(*_pC, Sum, &Error2);
+            *_pB = TwoSum(Error1, Error2, _pC);
+        }
+
+        static void ThreeSum2(TDouble* _pA, TDouble* _pB, TDouble _C)
+        {
+            TDouble Error1;
+            TDouble Error2;
+            TDouble Sum = TwoSum(*_pA, *_pB, &Error1);
+
+            *_pA = TwoSum(_C, Sum, &Error2);
+            *_pB = TDouble::Add(Error1, Error2);
+        }
+
+        // -----------------------------------------------------------------------------
+        // Sums the five parts from the smallest on and compacts the errors from
+        // the largest on.
+        // -----------------------------------------------------------------------------
+        static SQuadDouble Renormalize(TDouble _C0, TDouble _C1, TDouble _C2, TDouble _C3, TDouble _C4)
+        {
+            TDouble E1;
+            TDouble E2;
+            TDouble E3;
+            TDouble E4;
+
+            TDouble Sum = TwoSum(_C3, _C4, &E4);
+
+            Sum = TwoSum(_C2, Sum, &E3);
+            Sum = TwoSum(_C1, Sum, &E2);
+            Sum = TwoSum(_C0, Sum, &E1);
+
+            SQuadDouble Result;
+
+            TDouble Rest;
+
+            Result.m_Parts[0] = QuickTwoSum(Sum, E1, &Rest);
+            Result.m_Parts[1] = TwoSum(Rest, E2, &Rest);
+            Result.m_Parts[2] = TwoSum(Rest, E3, &Rest);
+            Result.m_Parts[3] = TDouble::Add(Rest, E4);
+
+            return Result;
+        }
+
+        static SQuadDouble Add(SQuadDouble _A, SQuadDouble _B)
+        {
+            TDouble T0;
+            TDouble T1;
+            TDouble T2;
+            TDouble T3;
+
+            TDouble S0 = TwoSum(_A.m_Parts[0], _B.m_Parts[0], &T0);
+            TDouble S1 = TwoSum(_A.m_Parts[1], _B.m_Parts[1], &T1);
+            TDouble S2 = TwoSum(_A.m_Parts[2], _B.m_Parts[2], &T2);
+            TDouble S3 = TwoSum(_A.m_Parts[3], _B.m_Parts[3], &T3);
+
+            S1 = TwoSum(S1, T0, &T0);
+
+            ThreeSum(&S2, &T0, &T1);
+            ThreeSum2(&S3, &T0, T2);
+
+            T0 = TDouble::Add(TDouble::Add(T0, T1), T3);
+
+            return Renormalize(S0, S1, S2, S3, T0);
+        }
+
+        static SQuadDouble Sub(SQuadDouble _A, SQuadDouble _B)
+        {
+            const TDouble Zero = TDouble::Broadcast(0.0);
+
+            SQuadDouble Negated;
+
+            for (int IndexOfPart = 0; IndexOfPart < 4; ++IndexOfPart) Negated.m_Parts[IndexOfPart] = TDouble::Sub(Zero, _B.m_Parts[IndexOfPart]);
+
+            return Add(_A, Negated);
+        }
+
+        static SQuadDouble Mul(SQuadDouble _A, SQuadDouble _B)
+        {
+            const TDouble* pA = _A.m_Parts;
+            const TDouble* pB = _B.m_Parts;
+
+            TDouble Q0;
+            TDouble Q1;
+            TDouble Q2;
+            TDouble Q3;
+            TDouble Q4;
+            TDouble Q5;
+            TDouble T0;
+            TDouble T1;
+
+            TDouble P0 = TwoProduct(pA[0], pB[0], &Q0);
+            TDouble P1 = TwoProduct(pA[0], pB[1], &Q1);
+            TDouble P2 = TwoProduct(pA[1], pB[0], &Q2);
+            TDouble P3 = TwoProduct(pA[0], pB[2], &Q3);
+            TDouble P4 = TwoProduct(pA[1], pB[1], &Q4);
+            TDouble P5 = TwoProduct(pA[2], pB[0], &Q5);
+
+            ThreeSum(&P1, &P2, &Q0);
+
+            // -----------------------------------------------------------------------------
+            // (S0, S1, S2) = (P2, Q1, Q2) + (P3, P4, P5)
+            // -----------------------------------------------------------------------------
+            ThreeSum(&P2, &Q1, &Q2);
+            ThreeSum(&P3, &P4, &P5);
+
+            TDouble S0 = TwoSum(P2, P3, &T0);
+            TDouble S1 = TwoSum(Q1, P4, &T1);
+            TDouble S2 = TDouble::Add(Q2, P5);
+
+            S1 = TwoSum(S1, T0, &T0);
+            S2 = TDouble::Add(S2, TDouble::Add(T0, T1));
+
+            // -----------------------------------------------------------------------------
+            // The terms of the order eps^3.
+            // -----------------------------------------------------------------------------
+            TDouble Rest = TDouble::Mul(pA[0], pB[3]);
+
+            Rest = TDouble::MulAdd(pA[1], pB[2], Rest);
+            Rest = TDouble::MulAdd(pA[2], pB[1], Rest);
+            Rest = TDouble::MulAdd(pA[3], pB[0], Rest);
+            Rest = TDouble::Add(Rest, TDouble::Add(TDouble::Add(Q0, Q3), TDouble::Add(Q4, Q5)));
+
+            S1 = TDouble::Add(S1, Rest);
+
+            return Renormalize(P0, P1, S0, S1, S2);
+        }
+
+        static SQuadDouble MulAdd(SQuadDouble _A, SQuadDouble _B, SQuadDouble _C)            { return Add(Mul(_A, _B), _C); }
+        static unsigned int GreaterMask(SQuadDouble _A, SQuadDouble _B)                      { return TDouble::GreaterMask(_A.m_Parts[0], _B.m_Parts[0]); }
+    };
+
+    // -----------------------------------------------------------------------------
+    // How IterateRow gets c into the lanes of a numeric policy. Float and double
+    // lanes take the rounded c, so all kernels of these precisions produce the
+    // same image as before. The extended precisions add the low parts of the
+    // row and leave out the cardioid and bulb test, which is done in double.
+    // -----------------------------------------------------------------------------
+
+    template <typename TVector>
+    struct SNumericPolicy
+    {
+        typedef typename TVector::TReal TReal;
+
+        static const bool s_IsBulbChecked = true;
+
+        static TVector LoadX(const SMandelbrotRow& _rRow, int _First)
+        {
+            alignas(64) TReal CXs[TVector::s_NumberOfLanes];
+
+            for (int Lane = 0; Lane < TVector::s_NumberOfLanes; ++Lane)
+            {
+                CXs[Lane] = TReal(_rRow.m_X + _rRow.m_StepX * (_First + Lane));
+            }
+
+            return TVector::Load(CXs);
+        }
+
+        static TVector LoadY(const SMandelbrotRow& _rRow)
+        {
+            return TVector::Broadcast(TReal(_rRow.m_Y));
+        }
+
+        static TReal GetPeriodicityTolerance()
+        {
+            return ::GetPeriodicityTolerance<TReal>();
+        }
+    };
+
+    template <typename TDouble>
+    struct SNumericPolicy<SDoubleDouble<TDouble>>
+    {
+        typedef SDoubleDouble<TDouble> TVector;
+
+        static const bool s_IsBulbChecked = false;
+
+        static TVector LoadX(const SMandelbrotRow& _rRow, int _First)
+        {
+            alignas(64) double Offsets[TVector::s_NumberOfLanes];
+
+            for (int Lane = 0; Lane < TVector::s_NumberOfLanes; ++Lane)
+            {
+                Offsets[Lane] = _rRow.m_StepX * (_First + Lane);
+            }
+
+            TVector X = { TDouble::Broadcast(_rRow.m_X), TDouble::Broadcast(_rRow.m_XLow[0]) };
+
+            return TVector::Add(X, TVector::Load(Offsets));
+        }
+
+        static TVector LoadY(const SMandelbrotRow& _rRow)
+        {
+            return { TDouble::Broadcast(_rRow.m_Y), TDouble::Broadcast(_rRow.m_YLow[0]) };
+        }
+
+        static double GetPeriodicityTolerance()
+        {
+            return 16.0 * std::ldexp(1.0, -208);
+        }
+    };
+
+    template <typename TDouble>
+    struct SNumericPolicy<SQuadDouble<TDouble>>
+    {
+        typedef SQuadDouble<TDouble> TVector;
+
+        static const bool s_IsBulbChecked = false;
+
+        static TVector LoadX(const SMandelbrotRow& _rRow, int _First)
+        {
+            alignas(64) double Offsets[TVector::s_NumberOfLanes];
+
+            for (int Lane = 0; Lane < TVector::s_NumberOfLanes; ++Lane)
+            {
+                Offsets[Lane] = _rRow.m_StepX * (_First + Lane);
+            }
+
+            TVector X = { { TDouble::Broadcast(_rRow.m_X), TDouble::Broadcast(_rRow.m_XLow[0]), TDouble::Broadcast(_rRow.m_XLow[1]), TDouble::Broadcast(_rRow.m_XLow[2]) } };
+
+            return TVector::Add(X, TVector::Load(Offsets));
+        }
+
+        static TVector LoadY(const SMandelbrotRow& _rRow)
+        {
+            return { { TDouble::Broadcast(_rRow.m_Y), TDouble::Broadcast(_rRow.m_YLow[0]), TDouble::Broadcast(_rRow.m_YLow[1]), TDouble::Broadcast(_rRow.m_YLow[2]) } };
+        }
+
+        static double GetPeriodicityTolerance()
+        {
+            return 16.0 * std::ldexp(1.0, -418);
+        }
+    };
+
+    // -----------------------------------------------------------------------------
+    // z^TExponent as a chain of complex squarings and multiplications by z which
+    // is unrolled at compile time, e.g. z^5 = ((z^2)^2) z.
+    // -----------------------------------------------------------------------------
+
+    template <int TExponent>
+    struct SComplexPower
+    {
+        template <typename TVector>
+        static void Get(TVector _X, TVector _Y, TVector* _pX, TVector* _pY)
+        {
+            TVector X;
+            TVector Y;
+
+            SComplexPower<TExponent / 2>::Get(_X, _Y, &X, &Y);
+
+            *_pX = TVector::Sub(TVector::Mul(X, X), TVector::Mul(Y, Y));
+            *_pY = TVector::Mul(TVector::Add(X, X), Y);
+
+            if (TExponent % 2 != 0)
+            {
+                X = *_pX;
+                Y = *_pY;
+
+                *_pX = TVector::Sub(TVector::Mul(X, _X), TVector::Mul(Y, _Y));
+                *_pY = TVector::MulAdd(X, _Y, TVector::Mul(Y, _X));
+            }
+        }
+    };
+
+    template <>
+    struct SComplexPower<1>
+    {
+        template <typename TVector>
+        static void Get(TVector _X, TVector _Y, TVector* _pX, TVector* _pY)
+        {
+            *_pX = _X;
+            *_pY = _Y;
+        }
+    };
+
+    // -----------------------------------------------------------------------------
+    // The formula IterateRow iterates, see SFractal. Step computes z = z^n + c
+    // and the squares X2 and Y2 of the parts of the new z, which the escape
+    // test needs anyway. z^2 takes the squares of the last step instead of
+    // multiplying again. StepDerivative computes the derivative of the next z
+    // with respect to the pixel, n z^(n-1) dz (+ 1 for the Mandelbrot set),
+    // from the current z. The cardioid and the bulb only exist for z^2 + c.
+    // -----------------------------------------------------------------------------
+
+    template <int TExponent, bool TIsJulia>
+    struct SFormula
+    {
+        static const bool s_IsJulia       = TIsJulia;
+        static const bool s_IsBulbChecked = false;
+
+        template <typename TVector>
+        static void Step(TVector* _pZX, TVector* _pZY, TVector* _pX2, TVector* _pY2, TVector _CX, TVector _CY)
+        {
+            TVector X;
+            TVector Y;
+
+            SComplexPower<TExponent>::Get(*_pZX, *_pZY, &X, &Y);
+
+            *_pZX = TVector::Add(X, _CX);
+            *_pZY = TVector::Add(Y, _CY);
+            *_pX2 = TVector::Mul(*_pZX, *_pZX);
+            *_pY2 = TVector::Mul(*_pZY, *_pZY);
+        }
+
+        template <typename TVector>
+        static void StepDerivative(TVector _ZX, TVector _ZY, TVector* _pDX, TVector* _pDY, TVector _One)
+        {
+            TVector X;
+            TVector Y;
+
+            SComplexPower<TExponent - 1>::Get(_ZX, _ZY, &X, &Y);
+
+            TVector Exponent = TVector::Broadcast(typename TVector::TReal(TExponent));
+            TVector DX       = TVector::Sub(TVector::Mul(X, *_pDX), TVector::Mul(Y, *_pDY));
+            TVector DY       = TVector::MulAdd(X, *_pDY, TVector::Mul(Y, *_pDX));
+
+            *_pDX = TIsJulia ? TVector::Mul(Exponent, DX) : TVector::MulAdd(Exponent, DX, _One);
+            *_pDY = TVector::Mul(Exponent, DY);
+        }
+    };
+
+    template <bool TIsJulia>
+    struct SFormula<2, TIsJulia>
+    {
+        static const bool s_IsJulia       = TIsJulia;
+        static const bool s_IsBulbChecked = !TIsJulia;
+
+        template <typename TVector>
+        static void Step(TVector* _pZX, TVector* _pZY, TVector* _pX2, TVector* _pY2, TVector _CX, TVector _CY)
+        {
+            *_pZY = TVector::MulAdd(TVector::Add(*_pZX, *_pZX), *_pZY, _CY);
+            *_pZX = TVector::Add(TVector::Sub(*_pX2, *_pY2), _CX);
+            *_pX2 = TVector::Mul(*_pZX, *_pZX);
+            *_pY2 = TVector::Mul(*_pZY, *_pZY);
+        }
+
+        template <typename TVector>
+        static void StepDerivative(TVector _ZX, TVector _ZY, TVector* _pDX, TVector* _pDY, TVector _One)
+        {
+            TVector DX = TVector::Sub(TVector::Mul(_ZX, *_pDX), TVector::Mul(_ZY, *_pDY));
+            TVector DY = TVector::MulAdd(_ZX, *_pDY, TVector::Mul(_ZY, *_pDX));
+
+            *_pDX = TIsJulia ? TVector::Add(DX, DX) : TVector::Add(TVector::Add(DX, DX), _One);
+            *_pDY = TVector::Add(DY, DY);
+        }
+    };
+
+    typedef SFormula<2, false> SMandelbrotFormula;
+
+    // -----------------------------------------------------------------------------
+    // With TIsInteriorChecked pixels in the cardioid or the bulb are not iterated
+    // at all and the orbit is compared against a saved z, which is moved forward
+    // at iterations 1, 2, 4, 8, ... (Brent). Every cycle is found this way, once
+    // the distance between the saved z and the current one exceeds its period.
+    // With TIsDistanceEstimated the derivative of z is iterated along, which
+    // gives the distance of escaped pixels to the boundary of the set.
+    // -----------------------------------------------------------------------------
+
+    template <typename TVector, typename TFormula, bool TIsInteriorChecked, bool TIsDistanceEstimated>
+    void IterateRow(const SMandelbrotRow& _rRow, unsigned int* _pIterations, float* _pMagnitudes, SMandelbrotInteriorStatistics* _pStatistics)
+    {
+        typedef typename TVector::TReal TReal;
+        typedef SNumericPolicy<TVector> TPolicy;
+
+        const bool IsBulbChecked = TIsInteriorChecked && TPolicy::s_IsBulbChecked && TFormula::s_IsBulbChecked;
+
+        const int NumberOfLanes = TVector::s_NumberOfLanes;
+
+        alignas(64) TReal Magnitudes[NumberOfLanes];
+        unsigned int      Iterations[NumberOfLanes];
+        float             EscapeMagnitudes[NumberOfLanes];
+        alignas(64) TReal DerivativesX[NumberOfLanes];
+        alignas(64) TReal DerivativesY[NumberOfLanes];
+        float             Distances[NumberOfLanes];
+
+        // -----------------------------------------------------------------------------
+        // Once |z| > max(2, |c|), |z^n + c| >= |z|^n - |c| > |z| (|z|^(n-1) - 1) > |z|
+        // for every n >= 2 and the orbit escapes. The Mandelbrot set has no point
+        // with |c| > 2, but a Julia c might be outside and needs the larger radius.
+        // -----------------------------------------------------------------------------
+        double JuliaMagnitude = _rRow.m_JuliaC[0] * _rRow.m_JuliaC[0] + _rRow.m_JuliaC[1] * _rRow.m_JuliaC[1];
+
+        const TVector Bailout   = TVector::Broadcast(TReal(TFormula::s_IsJulia && JuliaMagnitude > 4.0 ? JuliaMagnitude : 4.0));
+        const TVector One       = TVector::Broadcast(TReal(1));
+        const TVector Tolerance = TVector::Broadcast(TPolicy::GetPeriodicityTolerance());
+        const TVector PY        = TPolicy::LoadY(_rRow);
+        const TVector JuliaCX   = TVector::Broadcast(TReal(_rRow.m_JuliaC[0]));
+        const TVector JuliaCY   = TVector::Broadcast(TReal(_rRow.m_JuliaC[1]));
+        const TVector CY        = TFormula::s_IsJulia ? JuliaCY : PY;
+
+        for (int First = 0; First < _rRow.m_NumberOfPixels; First += NumberOfLanes)
+        {
+            int NumberOfPixels = _rRow.m_NumberOfPixels - First < NumberOfLanes ? _rRow.m_NumberOfPixels - First : NumberOfLanes;
+
+            unsigned int ActiveMask = NumberOfPixels < 32 ? (1u << NumberOfPixels) - 1u : ~0u;
+
+            // -----------------------------------------------------------------------------
+            // Lanes behind the end of the row are iterated too, but never active.
+            // -----------------------------------------------------------------------------
+            for (int Lane = 0; Lane < NumberOfLanes; ++Lane)
+            {
+                double CX = _rRow.m_X + _rRow.m_StepX * (First + Lane);
+
+                Iterations[Lane]       = _rRow.m_MaxIteration;
+                EscapeMagnitudes[Lane] = 0.0f;
+                Distances[Lane]        = 0.0f;
+
+                if (IsBulbChecked && Lane < NumberOfPixels && IsInMainCardioidOrBulb(CX, _rRow.m_Y))
+                {
+                    ActiveMask &= ~(1u << Lane);
+
+                    _pStatistics->m_NumberOfBulbPixels += 1;
+                    _pStatistics->m_BulbIterations     += _rRow.m_MaxIteration;
+                }
+            }
+
+            TVector PX     = TPolicy::LoadX(_rRow, First);
+            TVector Zero   = TVector::Broadcast(TReal(0));
+            TVector CX     = TFormula::s_IsJulia ? JuliaCX : PX;
+            TVector ZX     = TFormula::s_IsJulia ? PX : Zero;
+            TVector ZY     = TFormula::s_IsJulia ? PY : Zero;
+            TVector X2     = TFormula::s_IsJulia ? TVector::Mul(ZX, ZX) : Zero;
+            TVector Y2     = TFormula::s_IsJulia ? TVector::Mul(ZY, ZY) : Zero;
+            TVector SavedX = ZX;
+            TVector SavedY = ZY;
+            TVector DX     = TFormula::s_IsJulia ? One : Zero;
+            TVector DY     = Zero;
+
+            unsigned int NextSave = 1;
+
+            // -----------------------------------------------------------------------------
+            // z = z^n + c, the escape test compares the squared magnitude against the
+            // squared bailout radius instead of taking the length of z.
+            // -----------------------------------------------------------------------------
+            for (unsigned int Iteration = 0; Iteration < _rRow.m_MaxIteration && ActiveMask != 0; ++Iteration)
+            {
+                if (TIsDistanceEstimated) TFormula::StepDerivative(ZX, ZY, &DX, &DY, One);
+
+                TFormula::Step(&ZX, &ZY, &X2, &Y2, CX, CY);
+
+                unsigned int EscapedMask = TVector::GreaterMask(TVector::Add(X2, Y2), Bailout) & ActiveMask;
+
+                if (EscapedMask != 0)
+                {
+                    TVector::Store(TVector::Add(X2, Y2), Magnitudes);
+
+                    if (TIsDistanceEstimated)
+                    {
+                        TVector::Store(DX, DerivativesX);
+                        TVector::Store(DY, DerivativesY);
+                    }
+
+                    for (int Lane = 0; Lane < NumberOfLanes; ++Lane)
+                    {
+                        if (((EscapedMask >> Lane) & 1u) == 0) continue;
+
+                        Iterations[Lane]       = Iteration;
+                        EscapeMagnitudes[Lane] = static_cast<float>(Magnitudes[Lane]);
+
+                        // -----------------------------------------------------------------------------
+                        // The exterior distance estimate |z| log |z| / (2 |dz|), in pixels.
+                        // -----------------------------------------------------------------------------
+                        if (TIsDistanceEstimated)
+                        {
+                            double Magnitude  = static_cast<double>(Magnitudes[Lane]);
+                            double Derivative = static_cast<double>(DerivativesX[Lane]) * DerivativesX[Lane] + static_cast<double>(DerivativesY[Lane]) * DerivativesY[Lane];
+
+                            Distances[Lane] = static_cast<float>(0.25 * std::sqrt(Magnitude / Derivative) * std::log(Magnitude) / _rRow.m_StepX);
+                        }
+                    }
+
+                    ActiveMask &= ~EscapedMask;
+                }
+
+                if (!TIsInteriorChecked) continue;
+
+                TVector DeltaX = TVector::Sub(ZX, SavedX);
+                TVector DeltaY = TVector::Sub(ZY, SavedY);
+
+                unsigned int PeriodicMask = TVector::GreaterMask(Tolerance, TVector::MulAdd(DeltaX, DeltaX, TVector::Mul(DeltaY, DeltaY))) & ActiveMask;
+
+                if (PeriodicMask != 0)
+                {
+                    for (int Lane = 0; Lane < NumberOfLanes; ++Lane)
+                    {
+                        if (((PeriodicMask >> Lane) & 1u) == 0) continue;
+
+                        _pStatistics->m_NumberOfPeriodicPixels += 1;
+                        _pStatistics->m_PeriodicIterations     += _rRow.m_MaxIteration - Iteration - 1;
+                    }
+
+                    ActiveMask &= ~PeriodicMask;
+                }
+
+                if (Iteration + 1 == NextSave)
+                {
+                    SavedX = ZX;
+                    SavedY = ZY;
+
+                    NextSave *= 2;
+                }
+            }
+
+            for (int Lane = 0; Lane < NumberOfPixels; ++Lane)
+            {
+                _pIterations[First + Lane] = Iterations[Lane];
+                _pMagnitudes[First + Lane] = EscapeMagnitudes[Lane];
+
+                if (TIsDistanceEstimated) _rRow.m_pDistances[First + Lane] = Distances[Lane];
+            }
+        }
+    }
+
+    template <typename TVector, typename TFormula = SMandelbrotFormula>
+    void IterateRow(const SMandelbrotRow& _rRow, unsigned int* _pIterations, float* _pMagnitudes, SMandelbrotInteriorStatistics* _pStatistics)
+    {
+        if (_rRow.m_pDistances != nullptr)
+        {
+            if (_rRow.m_IsInteriorChecked)
+            {
+                IterateRow<TVector, TFormula, true, true>(_rRow, _pIterations, _pMagnitudes, _pStatistics);
+            }
+            else
+            {
+                IterateRow<TVector, TFormula, false, true>(_rRow, _pIterations, _pMagnitudes, _pStatistics);
+            }
+        }
+        else if (_rRow.m_IsInteriorChecked)
+        {
+            IterateRow<TVector, TFormula, true, false>(_rRow, _pIterations, _pMagnitudes, _pStatistics);
+        }
+        else
+        {
+            IterateRow<TVector, TFormula, false, false>(_rRow, _pIterations, _pMagnitudes, _pStatistics);
+        }
+    }
+
+    // -----------------------------------------------------------------------------
+    // The row kernels of all fractals for a vector type, instantiated once for
+    // every exponent in the order of SMandelbrotKernel::m_pIterateRowFractalFloat.
+    // -----------------------------------------------------------------------------
+
+    template <typename TVector>
+    struct SFractalKernels
+    {
+        static const FIterateRow s_IterateRows[SFractal::NumberOfTypes * SFractal::s_NumberOfExponents];
+    };
+
+    template <typename TVector>
+    const FIterateRow SFractalKernels<TVector>::s_IterateRows[SFractal::NumberOfTypes * SFractal::s_NumberOfExponents] =
+    {
+        &IterateRow<TVector, SFormula<2, false>>,
+        &IterateRow<TVector, SFormula<3, false>>,
+        &IterateRow<TVector, SFormula<4, false>>,
+        &IterateRow<TVector, SFormula<5, false>>,
+        &IterateRow<TVector, SFormula<6, false>>,
+        &IterateRow<TVector, SFormula<7, false>>,
+        &IterateRow<TVector, SFormula<8, false>>,
+        &IterateRow<TVector, SFormula<2, true>>,
+        &IterateRow<TVector, SFormula<3, true>>,
+        &IterateRow<TVector, SFormula<4, true>>,
+        &IterateRow<TVector, SFormula<5, true>>,
+        &IterateRow<TVector, SFormula<6, true>>,
+        &IterateRow<TVector, SFormula<7, true>>,
+        &IterateRow<TVector, SFormula<8, true>>,
+    };
+
+    // -----------------------------------------------------------------------------
+    // Same loop as IterateRow, but the lanes are packed with arbitrary pixels which
+    // start at their own z and iteration. A lane leaves the loop when its pixel
+    // escapes or reaches _MaxIteration. Pixels found in the interior are set to
+    // _MaxIteration and stay bound.
+    // -----------------------------------------------------------------------------
+
+    template <typename TVector, bool TIsInteriorChecked>
+    void AdvancePixels(SMandelbrotPixel* _pPixels, int _NumberOfPixels, unsigned int _MaxIteration, SMandelbrotInteriorStatistics* _pStatistics)
+    {
+        typedef typename TVector::TReal TReal;
+
+        const int NumberOfLanes = TVector::s_NumberOfLanes;
+
+        alignas(64) TReal CXs[NumberOfLanes];
+        alignas(64) TReal CYs[NumberOfLanes];
+        alignas(64) TReal ZXs[NumberOfLanes];
+        alignas(64) TReal ZYs[NumberOfLanes];
+        unsigned int      Remaining[NumberOfLanes];
+
+        const TVector Four      = TVector::Broadcast(TReal(4));
+        const TVector Tolerance = TVector::Broadcast(GetPeriodicityTolerance<TReal>());
+
+        for (int First = 0; First < _NumberOfPixels; First += NumberOfLanes)
+        {
+            int NumberOfPixels = _NumberOfPixels - First < NumberOfLanes ? _NumberOfPixels - First : NumberOfLanes;
+
+            SMandelbrotPixel* pPixels = _pPixels + First;
+
+            unsigned int ActiveMask = 0;
+
+            for (int Lane = 0; Lane < NumberOfLanes; ++Lane)
+            {
+                bool IsUsed = Lane < NumberOfPixels;
+
+                CXs[Lane]       = IsUsed ? TReal(pPixels[Lane].m_C[0]) : TReal(0);
+                CYs[Lane]       = IsUsed ? TReal(pPixels[Lane].m_C[1]) : TReal(0);
+                ZXs[Lane]       = IsUsed ? TReal(pPixels[Lane].m_Z[0]) : TReal(0);
+                ZYs[Lane]       = IsUsed ? TReal(pPixels[Lane].m_Z[1]) : TReal(0);
+                Remaining[Lane] = IsUsed ? _MaxIteration - pPixels[Lane].m_Iteration : 0;
+
+                if (Remaining[Lane] == 0) continue;
+
+                if (TIsInteriorChecked && IsInMainCardioidOrBulb(pPixels[Lane].m_C[0], pPixels[Lane].m_C[1]))
+                {
+                    pPixels[Lane].m_Iteration = _MaxIteration;
+
+                    _pStatistics->m_NumberOfBulbPixels += 1;
+                    _pStatistics->m_BulbIterations     += Remaining[Lane];
+
+                    continue;
+                }
+
+                ActiveMask |= 1u << Lane;
+            }
+
+            TVector CX     = TVector::Load(CXs);
+            TVector CY     = TVector::Load(CYs);
+            TVector ZX     = TVector::Load(ZXs);
+            TVector ZY     = TVector::Load(ZYs);
+            TVector X2     = TVector::Mul(ZX, ZX);
+            TVector Y2     = TVector::Mul(ZY, ZY);
+            TVector SavedX = ZX;
+            TVector SavedY = ZY;
+
+            unsigned int Step     = 0;
+            unsigned int NextSave = 1;
+
+            while (ActiveMask != 0)
+            {
+                // -----------------------------------------------------------------------------
+                // Run until the next active lane reaches the maximum iteration.
+                // -----------------------------------------------------------------------------
+                unsigned int NextStop = ~0u;
+
+                for (int Lane = 0; Lane < NumberOfLanes; ++Lane)
+                {
+                    if (((ActiveMask >> Lane) & 1u) && Remaining[Lane] < NextStop) NextStop = Remaining[Lane];
+                }
+
+                for (; Step < NextStop && ActiveMask != 0; ++Step)
+                {
+                    ZY = TVector::MulAdd(TVector::Add(ZX, ZX), ZY, CY);
+                    ZX = TVector::Add(TVector::Sub(X2, Y2), CX);
+                    X2 = TVector::Mul(ZX, ZX);
+                    Y2 = TVector::Mul(ZY, ZY);
+
+                    unsigned int EscapedMask = TVector::GreaterMask(TVector::Add(X2, Y2), Four) & ActiveMask;
+
+                    if (EscapedMask != 0)
+                    {
+                        TVector::Store(ZX, ZXs);
+                        TVector::Store(ZY, ZYs);
+
+                        for (int Lane = 0; Lane < NumberOfLanes; ++Lane)
+                        {
+                            if (((EscapedMask >> Lane) & 1u) == 0) continue;
+
+                            pPixels[Lane].m_Z[0]       = ZXs[Lane];
+                            pPixels[Lane].m_Z[1]       = ZYs[Lane];
+                            pPixels[Lane].m_Iteration += Step;
+                            pPixels[Lane].m_IsEscaped  = 1;
+                        }
+
+                        ActiveMask &= ~EscapedMask;
+                    }
+
+                    if (!TIsInteriorChecked) continue;
+
+                    TVector DX = TVector::Sub(ZX, SavedX);
+                    TVector DY = TVector::Sub(ZY, SavedY);
+
+                    unsigned int PeriodicMask = TVector::GreaterMask(Tolerance, TVector::MulAdd(DX, DX, TVector::Mul(DY, DY))) & ActiveMask;
+
+                    if (PeriodicMask != 0)
+                    {
+                        TVector::Store(ZX, ZXs);
+                        TVector::Store(ZY, ZYs);
+
+                        for (int Lane = 0; Lane < NumberOfLanes; ++Lane)
+                        {
+                            if (((PeriodicMask >> Lane) & 1u) == 0) continue;
+
+                            pPixels[Lane].m_Z[0]      = ZXs[Lane];
+                            pPixels[Lane].m_Z[1]      = ZYs[Lane];
+                            pPixels[Lane].m_Iteration = _MaxIteration;
+
+                            _pStatistics->m_NumberOfPeriodicPixels += 1;
+                            _pStatistics->m_PeriodicIterations     += Remaining[Lane] - Step - 1;
+                        }
+
+                        ActiveMask &= ~PeriodicMask;
+                    }
+
+                    if (Step + 1 == NextSave)
+                    {
+                        SavedX = ZX;
+                        SavedY = ZY;
+
+                        NextSave *= 2;
+                    }
+                }
+
+                if (ActiveMask == 0) break;
+
+                // -----------------------------------------------------------------------------
+                // Lanes which reached the maximum keep their z for the next call.
+                // -----------------------------------------------------------------------------
+                TVector::Store(ZX, ZXs);
+                TVector::Store(ZY, ZYs);
+
+                for (int Lane = 0; Lane < NumberOfLanes; ++Lane)
+                {
+                    if (((ActiveMask >> Lane) & 1u) == 0 || Remaining[Lane] != Step) continue;
+
+                    pPixels[Lane].m_Z[0]      = ZXs[Lane];
+                    pPixels[Lane].m_Z[1]      = ZYs[Lane];
+                    pPixels[Lane].m_Iteration = _MaxIteration;
+
+                    ActiveMask &= ~(1u << Lane);
+                }
+            }
+        }
+    }
+
+    // -----------------------------------------------------------------------------
+
+    template <typename TVector>
+    void AdvancePixels(SMandelbrotPixel* _pPixels, int _NumberOfPixels, unsigned int _MaxIteration, bool _IsInteriorChecked, SMandelbrotInteriorStatistics* _pStatistics)
+    {
+        if (_IsInteriorChecked)
+        {
+            AdvancePixels<TVector, true>(_pPixels, _NumberOfPixels, _MaxIteration, _pStatistics);
+        }
+        else
+        {
+            AdvancePixels<TVector, false>(_pPixels, _NumberOfPixels, _MaxIteration, _pStatistics);
+        }
+    }
+
+    // -----------------------------------------------------------------------------
+    // The lanes start at the same point of the reference orbit and move on
+    // together, so the point is broadcast. Once a lane rebases they go apart
+    // and the points are collected per lane, as the policies have no gather,
+    // until all active lanes are at the same point again. The arithmetic keeps
+    // the order of the scalar formula, so the lanes round like it as long as
+    // the instruction set does not fuse.
+    // -----------------------------------------------------------------------------
+
+    template <typename TVector>
+    void IteratePerturbation(const SMandelbrotPerturbation& _rPerturbation, unsigned int* _pIterations, double* _pMagnitudes, unsigned int* _pNumberOfRebases)
+    {
+        const int NumberOfLanes = TVector::s_NumberOfLanes;
+
+        const double* pOrbit    = _rPerturbation.m_pOrbit;
+        const int     LastIndex = _rPerturbation.m_OrbitLength - 1;
+
+        alignas(64) double DCXs[NumberOfLanes];
+        alignas(64) double DCYs[NumberOfLanes];
+        alignas(64) double RXs[NumberOfLanes];          // Z[n] of every lane.
+        alignas(64) double RYs[NumberOfLanes];
+        alignas(64) double NextRXs[NumberOfLanes];      // Z[n+1] of every lane.
+        alignas(64) double NextRYs[NumberOfLanes];
+        alignas(64) double DXs[NumberOfLanes];
+        alignas(64) double DYs[NumberOfLanes];
+        alignas(64) double ZXs[NumberOfLanes];
+        alignas(64) double ZYs[NumberOfLanes];
+        alignas(64) double Magnitudes[NumberOfLanes];
+        int                IndicesOfReference[NumberOfLanes];
+
+        const TVector Four = TVector::Broadcast(4.0);
+
+        for (int First = 0; First < _rPerturbation.m_NumberOfPixels; First += NumberOfLanes)
+        {
+            int NumberOfPixels = _rPerturbation.m_NumberOfPixels - First < NumberOfLanes ? _rPerturbation.m_NumberOfPixels - First : NumberOfLanes;
+
+            unsigned int ActiveMask = 0;
+
+            for (int Lane = 0; Lane < NumberOfLanes; ++Lane)
+            {
+                bool IsUsed = Lane < NumberOfPixels;
+
+                DCXs[Lane] = IsUsed ? _rPerturbation.m_pDCX[First + Lane] : 0.0;
+                DCYs[Lane] = IsUsed ? _rPerturbation.m_pDCY[First + Lane] : 0.0;
+
+                if (!IsUsed) continue;
+
+                _pIterations[First + Lane] = _rPerturbation.m_MaxIteration;
+                _pMagnitudes[First + Lane] = 0.0;
+
+                ActiveMask |= 1u << Lane;
+            }
+
+            TVector DCX = TVector::Load(DCXs);
+            TVector DCY = TVector::Load(DCYs);
+            TVector DX  = TVector::Broadcast(0.0);
+            TVector DY  = TVector::Broadcast(0.0);
+
+            int IndexOfReference = 0;                   // Of all lanes, -1 while they are apart.
+
+            for (unsigned int Iteration = 0; Iteration < _rPerturbation.m_MaxIteration && ActiveMask != 0; ++Iteration)
+            {
+                TVector RX;
+                TVector RY;
+                TVector NextRX;
+                TVector NextRY;
+
+                if (IndexOfReference >= 0)
+                {
+                    const double* pPoint = pOrbit + 2 * IndexOfReference;
+
+                    RX     = TVector::Broadcast(pPoint[0]);
+                    RY     = TVector::Broadcast(pPoint[1]);
+                    NextRX = TVector::Broadcast(pPoint[2]);
+                    NextRY = TVector::Broadcast(pPoint[3]);
+
+                    ++IndexOfReference;
+                }
+                else
+                {
+                    for (int Lane = 0; Lane < NumberOfLanes; ++Lane)
+                    {
+                        const double* pPoint = pOrbit + 2 * IndicesOfReference[Lane];
+
+                        RXs[Lane]     = pPoint[0];
+                        RYs[Lane]     = pPoint[1];
+                        NextRXs[Lane] = pPoint[2];
+                        NextRYs[Lane] = pPoint[3];
+
+                        if ((ActiveMask >> Lane) & 1u) ++IndicesOfReference[Lane];
+                    }
+
+                    RX     = TVector::Load(RXs);
+                    RY     = TVector::Load(RYs);
+                    NextRX = TVector::Load(NextRXs);
+                    NextRY = TVector::Load(NextRYs);
+                }
+
+                // -----------------------------------------------------------------------------
+                // 2 (RX DX - RY DY) + (DX^2 - DY^2) + dcx and
+                // 2 (RX DY + RY DX) + 2 DX DY + dcy
+                // -----------------------------------------------------------------------------
+                TVector Real      = TVector::Sub(TVector::Mul(RX, DX), TVector::Mul(RY, DY));
+                TVector Imaginary = TVector::Add(TVector::Mul(RX, DY), TVector::Mul(RY, DX));
+
+                TVector NextDX = TVector::Add(TVector::Add(TVector::Add(Real, Real), TVector::Sub(TVector::Mul(DX, DX), TVector::Mul(DY, DY))), DCX);
+                TVector NextDY = TVector::Add(TVector::Add(TVector::Add(Imaginary, Imaginary), TVector::Mul(TVector::Add(DX, DX), DY)), DCY);
+
+                DX = NextDX;
+                DY = NextDY;
+
+                TVector ZX = TVector::Add(NextRX, DX);
+                TVector ZY = TVector::Add(NextRY, DY);
+
+                TVector Magnitude = TVector::Add(TVector::Mul(ZX, ZX), TVector::Mul(ZY, ZY));
+
+                unsigned int EscapedMask = TVector::GreaterMask(Magnitude, Four) & ActiveMask;
+
+                if (EscapedMask != 0)
+                {
+                    TVector::Store(Magnitude, Magnitudes);
+
+                    for (int Lane = 0; Lane < NumberOfLanes; ++Lane)
+                    {
+                        if (((EscapedMask >> Lane) & 1u) == 0) continue;
+
+                        _pIterations[First + Lane] = Iteration;
+                        _pMagnitudes[First + Lane] = Magnitudes[Lane];
+
+                        if (IndexOfReference < 0) IndicesOfReference[Lane] = 0;     // Keeps the lane reading inside the orbit.
+                    }
+
+                    ActiveMask &= ~EscapedMask;
+                }
+
+                // -----------------------------------------------------------------------------
+                // Rebase the glitched lanes and those at the end of the orbit.
+                // -----------------------------------------------------------------------------
+                unsigned int RebaseMask = TVector::GreaterMask(TVector::Add(TVector::Mul(DX, DX), TVector::Mul(DY, DY)), Magnitude);
+
+                if (IndexOfReference == LastIndex)
+                {
+                    RebaseMask = ActiveMask;
+                }
+                else if (IndexOfReference < 0)
+                {
+                    for (int Lane = 0; Lane < NumberOfLanes; ++Lane)
+                    {
+                        if (IndicesOfReference[Lane] == LastIndex) RebaseMask |= 1u << Lane;
+                    }
+                }
+
+                RebaseMask &= ActiveMask;
+
+                if (RebaseMask == 0) continue;
+
+                TVector::Store(ZX, ZXs);
+                TVector::Store(ZY, ZYs);
+                TVector::Store(DX, DXs);
+                TVector::Store(DY, DYs);
+
+                if (IndexOfReference >= 0)
+                {
+                    for (int Lane = 0; Lane < NumberOfLanes; ++Lane) IndicesOfReference[Lane] = (ActiveMask >> Lane) & 1u ? IndexOfReference : 0;
+                }
+
+                for (int Lane = 0; Lane < NumberOfLanes; ++Lane)
+                {
+                    if (((RebaseMask >> Lane) & 1u) == 0) continue;
+
+                    DXs[Lane] = ZXs[Lane];
+                    DYs[Lane] = ZYs[Lane];
+
+                    IndicesOfReference[Lane] = 0;
+
+                    ++*_pNumberOfRebases;
+                }
+
+                DX = TVector::Load(DXs);
+                DY = TVector::Load(DYs);
+
+                // -----------------------------------------------------------------------------
+                // The lanes are together again if all active ones rebased.
+                // -----------------------------------------------------------------------------
+                IndexOfReference = RebaseMask == ActiveMask ? 0 : -1;
+            }
+        }
+    }
+
+    // -----------------------------------------------------------------------------
+    // Scalar color mapping, the vector versions use it for the pixels behind
+    // the last full vector.
+    // -----------------------------------------------------------------------------
+
+    inline void MapColors(const SMandelbrotColorMap& _rColorMap, const float* _pSmoothIterations, int _NumberOfPixels, unsigned char* _pPixels)
+    {
+        const unsigned int Black = 0xFF000000u;
+
+        for (int IndexOfPixel = 0; IndexOfPixel < _NumberOfPixels; ++IndexOfPixel)
+        {
+            float Smooth = _pSmoothIterations[IndexOfPixel];
+            float Index  = Smooth * _rColorMap.m_Density + _rColorMap.m_Offset;
+
+            unsigned int Color = Smooth < 0.0f ? Black : _rColorMap.m_pColors[static_cast<unsigned int>(static_cast<int>(Index)) & _rColorMap.m_Mask];
+
+            std::memcpy(_pPixels + IndexOfPixel * 4, &Color, 4);
+        }
+    }
+} // namespace
@@ -0,0 +1,169 @@
+#pragma once
+
+#include "MandelbrotKernel.h"
+#include "SPSConstantsMandelbrot.h"
+
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// How the CPU renderer may skip pixels by filling rectangles whose border has
+// a single iteration count (Mariani-Silver).
+// -----------------------------------------------------------------------------
+
+struct SSubdivision
+{
+    enum EMode
+    {
+        Off,                                    // Every pixel is iterated.
+        Bound,                                  // Only rectangles with a bound border are filled. Differs from Off only where a filament thinner than a pixel slips between two border pixels.
+        Uniform,                                // Every rectangle with a uniform border is filled. Faster, but may miss whole details inside the rectangle.
+    };
+};
+
+// -----------------------------------------------------------------------------
+// The arithmetic the CPU renderer iterates a view with. It is chosen per frame
+// from the pixel size, see GetMandelbrotPrecision. Fractals other than the
+// Mandelbrot set with exponent 2 are iterated in single or double precision.
+// -----------------------------------------------------------------------------
+
+struct SMandelbrotPrecision
+{
+    enum EMode
+    {
+        Single,                                 // Float like the shader.
+        Double,
+        DoubleDouble,                           // Sums of two doubles, down to pixels of about 1e-29.
+        QuadDouble,                             // Sums of four doubles, down to pixels of about 1e-61.
+        Perturbation,                           // Double differences to a reference orbit with arbitrary precision.
+    };
+};
+
+// -----------------------------------------------------------------------------
+// The input of the CPU renderer. It carries the same values as the
+// PSPerObjectConstants of the shader plus the part of the complex plane which
+// is visible, i.e. the UV mapping of the quad in CApplication.
+// -----------------------------------------------------------------------------
+
+struct SMandelbrotSettings
+{
+    int                 m_Width;                       // Width of the image in pixels.
+    int                 m_Height;                      // Height of the image in pixels.
+    double              m_Center[2];                   // Real and imaginary part of the point in the center of the image.
+    std::string         m_PreciseCenter[2];            // Optional decimal digits of m_Center for deep zooms beyond double precision.
+    double              m_PixelSize;                   // Distance of two neighboured pixels in the complex plane.
+    double              m_RowOffset;                   // Together with m_FirstRow the rows the center of the image lies below m_Center, so the bands of a larger image share its center and reference orbit.
+    int                 m_FirstRow;                    // The row of the larger image a band starts with. The pixels get the coordinates of their rows in the larger image, so the bands match it bit for bit.
+    double              m_CenterOffset[2];             // The center of the image minus m_Center, so the frames of an animation share the center and reference orbit of a keyframe.
+    SFractal::EType     m_Fractal;                     // Iterates z^m_Exponent + c, the Mandelbrot set with exponent 2 is the one of the shader.
+    int                 m_Exponent;                    // From SFractal::s_MinExponent to SFractal::s_MaxExponent.
+    double              m_JuliaC[2];                   // Real and imaginary part of c of a Julia set.
+    float               m_Color[3];                    // Color of the escaped pixels, see PSPerObjectConstants::m_PSColor.
+    unsigned int        m_MaxIteration;                // See PSPerObjectConstants::m_PSMaxIteration.
+    int                 m_TileSize;                    // Edge length of the square tiles handed out to the workers.
+    bool                m_IsInteriorChecked;           // Skip pixels in the main cardioid or the period 2 bulb and stop orbits which run into a cycle.
+    SSubdivision::EMode m_Subdivision;                 // Filling of uniform rectangles, only used for the Mandelbrot set with exponent 2 and not by CMandelbrotRenderer::Advance and the extended precisions.
+    bool                m_IsPerturbationPreferred;     // Use perturbation beyond double precision wherever it is cheaper than double-double and quad-double, otherwise only beyond quad-double.
+    int                 m_Supersampling;               // Samples per pixel along each axis for the pixels near the boundary, 1 turns antialiasing off. Only used by CMandelbrotRenderer::Render in single and double precision.
+    double              m_SupersamplingDistance;       // Escaped pixels closer to the boundary than this many pixels are supersampled, see SMandelbrotRow::m_pDistances.
+};
+
+// -----------------------------------------------------------------------------
+// The output of the CPU renderer.
+// -----------------------------------------------------------------------------
+
+struct SMandelbrotImage
+{
+    int                        m_Width;
+    int                        m_Height;
+    std::vector<unsigned int>  m_Iterations;        // The iteration in which a pixel escaped or m_MaxIteration if it is bound.
+    std::vector<float>         m_SmoothIterations;  // The continuous iteration count of escaped pixels, -1 for bound pixels.
+    std::vector<unsigned char> m_Pixels;            // RGBA with 8 bits per channel, the same colors as PSMain in mandelbrot.fx.
+    std::vector<float>         m_Coverage;          // Empty unless supersampled. Then the share of escaped samples of every pixel, which scales its color. Supersampled pixels have the mean smooth iteration count of their escaped samples.
+};
+
+// -----------------------------------------------------------------------------
+// Colors SMandelbrotImage::m_SmoothIterations, see CMandelbrotRenderer::MapColors.
+// -----------------------------------------------------------------------------
+
+struct SMandelbrotPalette
+{
+    std::vector<unsigned int> m_Colors;             // RGBA with 8 bits per channel and red in the lowest byte, the number of colors is a power of two.
+    float                     m_Density;            // Palette colors per iteration.
+    float                     m_Offset;             // Palette colors to skip, changing it cycles the palette.
+};
+
+// -----------------------------------------------------------------------------
+// Keeps the iteration state of every pixel between two renderings of the same
+// view, so raising the maximum iteration only continues the bound pixels.
+// -----------------------------------------------------------------------------
+
+struct SMandelbrotState
+{
+    SMandelbrotSettings                        m_Settings;      // The view the pixels belong to, m_Width == 0 if there is none.
+    std::vector<std::vector<SMandelbrotPixel>> m_BoundPixels;   // Per tile the pixels which did not escape yet, escaped pixels only live in the image.
+
+    SMandelbrotState() : m_Settings(), m_BoundPixels() { m_Settings.m_Width = 0; }
+};
+
+// -----------------------------------------------------------------------------
+// Where the time of a frame of the CPU renderer went. A frame runs one or more
+// passes over its tiles on all workers, see CMandelbrotRenderer::
+// GetFrameStatistics.
+// -----------------------------------------------------------------------------
+
+struct SMandelbrotThreadStatistics
+{
+    double       m_BusySeconds;                 // Time spent on tiles.
+    double       m_IdleSeconds;                 // Rest of the pass, waiting for the other workers or for a wake up.
+    unsigned int m_NumberOfTiles;
+    unsigned int m_NumberOfStolenTiles;         // Tiles taken from the queue of another worker.
+};
+
+struct SMandelbrotPassStatistics
+{
+    const char*                              m_pName;               // What the pass did, e.g. "iterate" or "supersample".
+    double                                   m_Seconds;
+    std::vector<float>                       m_TileSeconds;         // Wall time of every tile of the pass.
+    std::vector<SMandelbrotThreadStatistics> m_Threads;             // One per worker.
+};
+
+struct SMandelbrotFrameStatistics
+{
+    int                                    m_Width;
+    int                                    m_Height;
+    unsigned int                           m_MaxIteration;
+    double                                 m_Seconds;                       // Wall time of the frame.
+    unsigned long long                     m_NumberOfIterations;            // Sum of the iterations of all pixels, bound pixels count m_MaxIteration. The interior test, the subdivision, the tile cache and the reprojection skip part of them.
+    unsigned long long                     m_NumberOfEscapedPixels;
+    unsigned long long                     m_NumberOfBoundPixels;
+    std::vector<unsigned long long>        m_Histogram;                     // Escaped pixels per power of two, entry k counts the iterations from 2^k to 2^(k+1) - 1 and entry 0 also 0.
+    SMandelbrotInteriorStatistics          m_InteriorStatistics;
+    unsigned long long                     m_NumberOfFilledPixels;
+    unsigned long long                     m_NumberOfReprojectedPixels;
+    unsigned long long                     m_NumberOfSupersampledPixels;
+    unsigned int                           m_NumberOfRebases;
+    std::vector<SMandelbrotPassStatistics> m_Passes;                        // In the order they ran.
+};
+
+// -----------------------------------------------------------------------------
+
+void GetMandelbrotSettings(int _Width, int _Height, const PSPerObjectConstants& _rConstants, SMandelbrotSettings* _pSettings);
+
+SMandelbrotPrecision::EMode GetMandelbrotPrecision(const SMandelbrotSettings& _rSettings);
+
+bool IsMandelbrotCenterValid(const SMandelbrotSettings& _rSettings);                // Whether the precise center, if any, consists of decimal numbers.
+
+// -----------------------------------------------------------------------------
+// Blends the given colors into a cyclic palette with at least _NumberOfColors
+// entries. It runs through all colors once every 32 iterations.
+// -----------------------------------------------------------------------------
+
+void GetMandelbrotPalette(const float (*_pStops)[3], int _NumberOfStops, int _NumberOfColors, SMandelbrotPalette* _pPalette);
+
+// -----------------------------------------------------------------------------
+// Dumps the statistics of a frame as a JSON object, so the load of the workers
+// and the distribution of the iterations can be looked at in other tools.
+// -----------------------------------------------------------------------------
+
+bool WriteMandelbrotStatistics(const SMandelbrotFrameStatistics& _rStatistics, const char* _pPath);
@@ -2,7 +2,7 @@
 
 #include "CApplication.h"
 
-void main()
+int main()
 {
     CApplication Application;
 
@@ -0,0 +1,137 @@
+#include "CImageWriter.h"
+#include "CMandelbrotAnimation.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// -----------------------------------------------------------------------------
+// Renders a zoom animation into numbered images.
+//
+//    mandelbrot_animation [Keyframes.txt] [Width] [Height]
+//                         [Output, e.g. frame%04d.png] [Threads]
+//                         [Coloring: flat, smooth]
+//
+// Every line of the keyframe file holds a keyframe as
+//
+//    Frame CenterReal CenterImaginary PixelSize MaxIteration
+//
+// with the center in as many digits as the zoom needs. Lines starting with #
+// are skipped.
+// -----------------------------------------------------------------------------
+
+namespace
+{
+    bool ReadKeyframes(const char* _pPath, std::vector<SMandelbrotKeyframe>* _pKeyframes)
+    {
+        FILE* pFile = std::fopen(_pPath, "r");
+
+        if (pFile == nullptr) return false;
+
+        char Line[4096];
+        char Real[2048];
+        char Imaginary[2048];
+
+        while (std::fgets(Line, sizeof(Line), pFile) != nullptr)
+        {
+            if (Line[0] == '#') continue;
+
+            SMandelbrotKeyframe Keyframe;
+
+            if (std::sscanf(Line, "%d %2047s %2047s %lf %u", &Keyframe.m_Frame, Real, Imaginary, &Keyframe.m_PixelSize, &Keyframe.m_MaxIteration) != 5) continue;
+
+            Keyframe.m_Center[0] = Real;
+            Keyframe.m_Center[1] = Imaginary;
+
+            _pKeyframes->push_back(Keyframe);
+        }
+
+        std::fclose(pFile);
+
+        return true;
+    }
+} // namespace
+
+// -----------------------------------------------------------------------------
+
+int main(int _Argc, char** _ppArgv)
+{
+    const char* pKeyframesPath = _Argc > 1 ? _ppArgv[1] : "keyframes.txt";
+    int         Width          = _Argc > 2 ? std::atoi(_ppArgv[2]) : 640;
+    int         Height         = _Argc > 3 ? std::atoi(_ppArgv[3]) : 360;
+    const char* pPattern       = _Argc > 4 ? _ppArgv[4] : "frame%04d.png";
+    int         Threads        = _Argc > 5 ? std::atoi(_ppArgv[5]) : 0;
+    bool        IsSmooth       = _Argc > 6 && std::strcmp(_ppArgv[6], "smooth") == 0;
+
+    std::vector<SMandelbrotKeyframe> Keyframes;
+
+    CMandelbrotAnimation Animation(Threads);
+
+    if (!ReadKeyframes(pKeyframesPath, &Keyframes) || !Animation.SetKeyframes(Keyframes))
+    {
+        std::fprintf(stderr, "Could not read the keyframes of %s\n", pKeyframesPath);
+
+        return 1;
+    }
+
+    PSPerObjectConstants Constants;
+
+    Constants.m_PSColor[0]     = 0.95f; //R
+    Constants.m_PSColor[1]     = 0.25f; //G
+    Constants.m_PSColor[2]     = 0.0f;  //B
+    Constants.m_PSMaxIteration = Keyframes[0].m_MaxIteration;
+
+    SMandelbrotSettings Settings;
+
+    GetMandelbrotSettings(Width, Height, Constants, &Settings);
+
+    // -----------------------------------------------------------------------------
+    // The palette is built once for all frames.
+    // -----------------------------------------------------------------------------
+    const float Stops[4][3] =
+    {
+        { 0.25f, 0.25f, 0.0f },
+        { 0.55f, 0.25f, 0.0f },
+        { 0.75f, 0.25f, 0.0f },
+        { 0.95f, 0.25f, 0.0f },
+    };
+
+    SMandelbrotPalette Palette;
+
+    GetMandelbrotPalette(Stops, 4, 1024, &Palette);
+
+    std::printf("Rendering %d frames of %d x %d on %d threads per frame (%s)\n", Animation.GetNumberOfFrames(), Width, Height, Animation.GetNumberOfThreads(), GetMandelbrotKernel().m_pName);
+
+    auto Start = std::chrono::steady_clock::now();
+
+    // -----------------------------------------------------------------------------
+    // Runs on the main thread while the next frames are rendered.
+    // -----------------------------------------------------------------------------
+    auto WriteFrame = [&](const SMandelbrotImage& _rImage, int _Frame)
+    {
+        char Path[1024];
+
+        std::snprintf(Path, sizeof(Path), pPattern, _Frame);
+
+        CImageWriter Writer;
+
+        if (!Writer.Open(Path, _rImage.m_Width, _rImage.m_Height) || !Writer.WriteRows(_rImage.m_Pixels.data(), _rImage.m_Height) || !Writer.Close())
+        {
+            std::fprintf(stderr, "Could not write %s\n", Path);
+
+            return false;
+        }
+
+        double Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+
+        std::printf("Frame %d written to %s, %.2f frames/s\n", _Frame, Path, (_Frame + 1) / Seconds);
+        std::fflush(stdout);
+
+        return true;
+    };
+
+    if (!Animation.Render(Settings, IsSmooth ? &Palette : nullptr, WriteFrame)) return 1;
+
+    return 0;
+}
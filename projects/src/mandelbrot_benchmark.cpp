@@ -0,0 +1,412 @@
+#include "CMandelbrotRenderer.h"
+#include "CReferenceOrbit.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// Measures the CPU renderer on fixed views, so its speed can be compared
+// across machines and releases.
+//
+//    mandelbrot_benchmark [Output.json] [Suite: quick, full] [MaxThreads]
+//                         [Repetitions]
+//
+// Every view is rendered at several sizes and maximum iterations with 1, 2,
+// 4, ... up to MaxThreads workers. The quick suite only takes the smallest
+// size and maximum iteration of every view. A case is rendered once to warm
+// up and then timed as often as given, the median of the times counts.
+//
+// The interior check and the subdivision are turned off, so every counted
+// iteration is computed and the iterations per second of different views
+// can be compared. Speedup and efficiency relate a case to the same case on
+// one worker.
+//
+// Before timing, every view beyond double precision is rendered once in its
+// smallest case and checked against perturbation, which only needs double
+// arithmetic. If more pixels differ than the rounding of either explains,
+// nothing is timed and the benchmark returns 1.
+// -----------------------------------------------------------------------------
+
+namespace
+{
+    struct SBenchmarkView
+    {
+        const char*  m_pName;
+        const char*  m_pCenter[2];              // Decimal digits of the real and imaginary part of the center.
+        double       m_Height;                  // Height of the view in the complex plane, the pixel size follows from the image height.
+        unsigned int m_MaxIterations[3];        // The quick suite only takes the first one.
+    };
+
+    struct SBenchmarkCase
+    {
+        const SBenchmarkView* m_pView;
+        int                   m_Width;
+        int                   m_Height;
+        unsigned int          m_MaxIteration;
+    };
+
+    struct SBenchmarkRun
+    {
+        int                 m_NumberOfThreads;
+        unsigned long long  m_NumberOfIterations;
+        std::vector<double> m_Seconds;          // One per repetition.
+        double              m_MedianSeconds;
+        double              m_MeanSeconds;
+        double              m_MinSeconds;
+        double              m_Deviation;        // Standard deviation of the seconds.
+    };
+
+    // -----------------------------------------------------------------------------
+    // The minibrot is the one of period 998 in the seahorse valley, centered
+    // at its nucleus. Its view needs more than double precision.
+    // -----------------------------------------------------------------------------
+    const SBenchmarkView s_Views[] =
+    {
+        { "full",      { "-0.75",   "0.0"    }, 2.5,    {  256, 1024,  4096 } },
+        { "seahorse",  { "-0.7453", "0.1127" }, 0.0065, { 1024, 4096, 16384 } },
+        { "elephant",  { "0.285",   "0.012"  }, 0.02,   { 1024, 4096, 16384 } },
+        { "minibrot",  { "-0.743643887037158870778064543493642575047", "0.1318259042053122928210973548747672652629" }, 2.5e-14, { 4096, 16384, 65536 } },
+    };
+
+    const int s_Sizes[][2] = { { 640, 360 }, { 1280, 720 }, { 1920, 1080 } };
+
+    const char* const s_pPrecisionNames[] = { "single", "double", "double-double", "quad-double", "perturbation" };     // See SMandelbrotPrecision.
+
+    // -----------------------------------------------------------------------------
+    // Double-double and perturbation round differently, so single pixels
+    // close to the boundary escape in different iterations. Broken extended
+    // precision arithmetic changes a large part of the image.
+    // -----------------------------------------------------------------------------
+    const double s_MaxDifferingPixelShare = 0.01;
+
+    // -----------------------------------------------------------------------------
+
+    void GetBenchmarkSettings(const SBenchmarkCase& _rCase, SMandelbrotSettings* _pSettings)
+    {
+        PSPerObjectConstants Constants;
+
+        Constants.m_PSColor[0]     = 0.95f; //R
+        Constants.m_PSColor[1]     = 0.25f; //G
+        Constants.m_PSColor[2]     = 0.0f;  //B
+        Constants.m_PSMaxIteration = _rCase.m_MaxIteration;
+
+        GetMandelbrotSettings(_rCase.m_Width, _rCase.m_Height, Constants, _pSettings);
+
+        _pSettings->m_Center[0]         = std::atof(_rCase.m_pView->m_pCenter[0]);
+        _pSettings->m_Center[1]         = std::atof(_rCase.m_pView->m_pCenter[1]);
+        _pSettings->m_PreciseCenter[0]  = _rCase.m_pView->m_pCenter[0];
+        _pSettings->m_PreciseCenter[1]  = _rCase.m_pView->m_pCenter[1];
+        _pSettings->m_PixelSize         = _rCase.m_pView->m_Height / _rCase.m_Height;
+        _pSettings->m_IsInteriorChecked = false;
+        _pSettings->m_Subdivision       = SSubdivision::Off;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void RunCase(CMandelbrotRenderer& _rRenderer, const SBenchmarkCase& _rCase, int _NumberOfRepetitions, SBenchmarkRun* _pRun)
+    {
+        SMandelbrotSettings Settings;
+        SMandelbrotImage    Image;
+
+        GetBenchmarkSettings(_rCase, &Settings);
+
+        // -----------------------------------------------------------------------------
+        // The warm up faults in the image and computes the reference orbit of
+        // deep views, which the timed renderings of the same view reuse just
+        // like the frames of an interactive zoom.
+        // -----------------------------------------------------------------------------
+        _rRenderer.Render(Settings, &Image);
+
+        _pRun->m_NumberOfThreads    = _rRenderer.GetNumberOfThreads();
+        _pRun->m_NumberOfIterations = 0;
+
+        for (unsigned int Iterations : Image.m_Iterations) _pRun->m_NumberOfIterations += Iterations;
+
+        _pRun->m_Seconds.clear();
+
+        for (int IndexOfRepetition = 0; IndexOfRepetition < _NumberOfRepetitions; ++IndexOfRepetition)
+        {
+            auto Start = std::chrono::steady_clock::now();
+
+            _rRenderer.Render(Settings, &Image);
+
+            _pRun->m_Seconds.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count());
+        }
+
+        std::vector<double> Sorted = _pRun->m_Seconds;
+
+        std::sort(Sorted.begin(), Sorted.end());
+
+        size_t Middle = Sorted.size() / 2;
+
+        double Sum       = 0.0;
+        double SumSquare = 0.0;
+
+        for (double Seconds : Sorted)
+        {
+            Sum       += Seconds;
+            SumSquare += Seconds * Seconds;
+        }
+
+        double Mean = Sum / Sorted.size();
+
+        _pRun->m_MedianSeconds = Sorted.size() % 2 != 0 ? Sorted[Middle] : 0.5 * (Sorted[Middle - 1] + Sorted[Middle]);
+        _pRun->m_MeanSeconds   = Mean;
+        _pRun->m_MinSeconds    = Sorted.front();
+        _pRun->m_Deviation     = std::sqrt(std::max(SumSquare / Sorted.size() - Mean * Mean, 0.0));
+    }
+
+    // -----------------------------------------------------------------------------
+    // Iterates every pixel of the view against the reference orbit of its
+    // center, one row at a time on the calling thread.
+    // -----------------------------------------------------------------------------
+
+    bool GetPerturbationIterations(const SMandelbrotSettings& _rSettings, std::vector<unsigned int>* _pIterations)
+    {
+        CReferenceOrbit ReferenceOrbit;
+
+        if (!ReferenceOrbit.Update(_rSettings)) return false;
+
+        std::vector<double> DCXs(_rSettings.m_Width);
+        std::vector<double> DCYs(_rSettings.m_Width);
+        std::vector<double> Magnitudes(_rSettings.m_Width);
+
+        SMandelbrotPerturbation Perturbation;
+
+        Perturbation.m_pOrbit         = ReferenceOrbit.GetPoints();
+        Perturbation.m_OrbitLength    = ReferenceOrbit.GetLength();
+        Perturbation.m_pDCX           = DCXs.data();
+        Perturbation.m_pDCY           = DCYs.data();
+        Perturbation.m_NumberOfPixels = _rSettings.m_Width;
+        Perturbation.m_MaxIteration   = _rSettings.m_MaxIteration;
+
+        unsigned int NumberOfRebases = 0;
+
+        _pIterations->resize(static_cast<size_t>(_rSettings.m_Width) * _rSettings.m_Height);
+
+        for (int X = 0; X < _rSettings.m_Width; ++X)
+        {
+            DCXs[X] = (X - 0.5 * (_rSettings.m_Width - 1)) * _rSettings.m_PixelSize;
+        }
+
+        for (int Y = 0; Y < _rSettings.m_Height; ++Y)
+        {
+            std::fill(DCYs.begin(), DCYs.end(), (0.5 * (_rSettings.m_Height - 1) - Y) * _rSettings.m_PixelSize);
+
+            GetMandelbrotKernel().m_pIteratePerturbation(Perturbation, &(*_pIterations)[static_cast<size_t>(Y) * _rSettings.m_Width], Magnitudes.data(), &NumberOfRebases);
+        }
+
+        return true;
+    }
+
+    // -----------------------------------------------------------------------------
+    // Renders the case like the timed runs do and compares the iterations to
+    // perturbation. Views in single or double precision pass, perturbation
+    // is no independent check for them.
+    // -----------------------------------------------------------------------------
+
+    bool CheckCase(CMandelbrotRenderer& _rRenderer, const SBenchmarkCase& _rCase)
+    {
+        SMandelbrotSettings Settings;
+        SMandelbrotImage    Image;
+
+        GetBenchmarkSettings(_rCase, &Settings);
+
+        SMandelbrotPrecision::EMode Precision = GetMandelbrotPrecision(Settings);
+
+        if (Precision == SMandelbrotPrecision::Single || Precision == SMandelbrotPrecision::Double) return true;
+
+        std::vector<unsigned int> ReferenceIterations;
+
+        if (!_rRenderer.Render(Settings, &Image) || !GetPerturbationIterations(Settings, &ReferenceIterations)) return false;
+
+        unsigned long long Checksum            = 0;
+        unsigned long long ReferenceChecksum   = 0;
+        size_t             NumberOfDifferences = 0;
+
+        for (size_t IndexOfPixel = 0; IndexOfPixel < ReferenceIterations.size(); ++IndexOfPixel)
+        {
+            Checksum          += Image.m_Iterations[IndexOfPixel];
+            ReferenceChecksum += ReferenceIterations[IndexOfPixel];
+
+            if (Image.m_Iterations[IndexOfPixel] != ReferenceIterations[IndexOfPixel]) ++NumberOfDifferences;
+        }
+
+        double DifferingShare = static_cast<double>(NumberOfDifferences) / ReferenceIterations.size();
+
+        std::printf("%-9s %4d x %4d %6u iterations: %s checksum %llu, perturbation %llu, %.3f%% of the pixels differ\n", _rCase.m_pView->m_pName, _rCase.m_Width, _rCase.m_Height, _rCase.m_MaxIteration, s_pPrecisionNames[Precision], Checksum, ReferenceChecksum, 100.0 * DifferingShare);
+        std::fflush(stdout);
+
+        return DifferingShare <= s_MaxDifferingPixelShare;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    double GetMegaIterationsPerSecond(const SBenchmarkRun& _rRun)
+    {
+        return _rRun.m_MedianSeconds > 0.0 ? _rRun.m_NumberOfIterations / _rRun.m_MedianSeconds * 1e-6 : 0.0;
+    }
+
+    // -----------------------------------------------------------------------------
+    // Writes one object per case and thread count. The cases keep their order,
+    // so two files of the same suite can be compared line by line.
+    // -----------------------------------------------------------------------------
+
+    bool WriteResults(const char* _pPath, const char* _pSuite, int _NumberOfRepetitions, const std::vector<SBenchmarkCase>& _rCases, const std::vector<std::vector<SBenchmarkRun>>& _rRuns)
+    {
+        FILE* pFile = std::fopen(_pPath, "w");
+
+        if (pFile == nullptr) return false;
+
+        std::fprintf(pFile, "{\n");
+        std::fprintf(pFile, "    \"suite\": \"%s\",\n", _pSuite);
+        std::fprintf(pFile, "    \"kernel\": \"%s\",\n", GetMandelbrotKernel().m_pName);
+        std::fprintf(pFile, "    \"hardware_threads\": %u,\n", std::thread::hardware_concurrency());
+        std::fprintf(pFile, "    \"repetitions\": %d,\n", _NumberOfRepetitions);
+        std::fprintf(pFile, "    \"runs\": [");
+
+        bool IsFirst = true;
+
+        for (size_t IndexOfCase = 0; IndexOfCase < _rCases.size(); ++IndexOfCase)
+        {
+            const SBenchmarkCase& rCase = _rCases[IndexOfCase];
+
+            SMandelbrotSettings Settings;
+
+            GetBenchmarkSettings(rCase, &Settings);
+
+            for (const SBenchmarkRun& rRun : _rRuns[IndexOfCase])
+            {
+                double Speedup = rRun.m_MedianSeconds > 0.0 ? _rRuns[IndexOfCase].front().m_MedianSeconds / rRun.m_MedianSeconds : 0.0;
+
+                std::fprintf(pFile, "%s\n        {\n", IsFirst ? "" : ",");
+                std::fprintf(pFile, "            \"view\": \"%s\",\n", rCase.m_pView->m_pName);
+                std::fprintf(pFile, "            \"width\": %d,\n", rCase.m_Width);
+                std::fprintf(pFile, "            \"height\": %d,\n", rCase.m_Height);
+                std::fprintf(pFile, "            \"max_iteration\": %u,\n", rCase.m_MaxIteration);
+                std::fprintf(pFile, "            \"precision\": \"%s\",\n", s_pPrecisionNames[GetMandelbrotPrecision(Settings)]);
+                std::fprintf(pFile, "            \"threads\": %d,\n", rRun.m_NumberOfThreads);
+                std::fprintf(pFile, "            \"iterations\": %llu,\n", rRun.m_NumberOfIterations);
+                std::fprintf(pFile, "            \"seconds\": [");
+
+                for (size_t IndexOfRepetition = 0; IndexOfRepetition < rRun.m_Seconds.size(); ++IndexOfRepetition)
+                {
+                    std::fprintf(pFile, "%s%.9g", IndexOfRepetition > 0 ? ", " : "", rRun.m_Seconds[IndexOfRepetition]);
+                }
+
+                std::fprintf(pFile, "],\n");
+                std::fprintf(pFile, "            \"median_seconds\": %.9g,\n", rRun.m_MedianSeconds);
+                std::fprintf(pFile, "            \"mean_seconds\": %.9g,\n", rRun.m_MeanSeconds);
+                std::fprintf(pFile, "            \"min_seconds\": %.9g,\n", rRun.m_MinSeconds);
+                std::fprintf(pFile, "            \"stddev_seconds\": %.9g,\n", rRun.m_Deviation);
+                std::fprintf(pFile, "            \"relative_stddev\": %.6g,\n", rRun.m_MeanSeconds > 0.0 ? rRun.m_Deviation / rRun.m_MeanSeconds : 0.0);
+                std::fprintf(pFile, "            \"miterations_per_second\": %.6g,\n", GetMegaIterationsPerSecond(rRun));
+                std::fprintf(pFile, "            \"speedup\": %.6g,\n", Speedup);
+                std::fprintf(pFile, "            \"efficiency\": %.6g\n", Speedup / rRun.m_NumberOfThreads);
+                std::fprintf(pFile, "        }");
+
+                IsFirst = false;
+            }
+        }
+
+        std::fprintf(pFile, "\n    ]\n}\n");
+
+        bool IsWritten = std::ferror(pFile) == 0;
+
+        return std::fclose(pFile) == 0 && IsWritten;
+    }
+} // namespace
+
+// -----------------------------------------------------------------------------
+
+int main(int _Argc, char** _ppArgv)
+{
+    const char* pPath          = _Argc > 1 ? _ppArgv[1] : "benchmark.json";
+    const char* pSuite         = _Argc > 2 ? _ppArgv[2] : "quick";
+    int         MaxThreads     = _Argc > 3 ? std::atoi(_ppArgv[3]) : 0;
+    int         Repetitions    = _Argc > 4 ? std::max(std::atoi(_ppArgv[4]), 1) : 5;
+    bool        IsFullSuite    = std::strcmp(pSuite, "full") == 0;
+
+    if (MaxThreads <= 0) MaxThreads = std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+
+    std::vector<SBenchmarkCase> Cases;
+
+    for (const SBenchmarkView& rView : s_Views)
+    {
+        for (int IndexOfSize = 0; IndexOfSize < (IsFullSuite ? 3 : 1); ++IndexOfSize)
+        {
+            for (int IndexOfMaxIteration = 0; IndexOfMaxIteration < (IsFullSuite ? 3 : 1); ++IndexOfMaxIteration)
+            {
+                SBenchmarkCase Case = { &rView, s_Sizes[IndexOfSize][0], s_Sizes[IndexOfSize][1], rView.m_MaxIterations[IndexOfMaxIteration] };
+
+                Cases.push_back(Case);
+            }
+        }
+    }
+
+    std::vector<int> ThreadCounts;
+
+    for (int Threads = 1; Threads < MaxThreads; Threads *= 2) ThreadCounts.push_back(Threads);
+
+    ThreadCounts.push_back(MaxThreads);
+
+    std::printf("Running the %s suite, %d cases on up to %d threads with %d repetitions (%s)\n", IsFullSuite ? "full" : "quick", static_cast<int>(Cases.size()), MaxThreads, Repetitions, GetMandelbrotKernel().m_pName);
+
+    // -----------------------------------------------------------------------------
+    // A wrong image is no result, so the views are checked before any is
+    // timed. The smallest case of a view takes the same path as the others.
+    // -----------------------------------------------------------------------------
+    {
+        CMandelbrotRenderer Renderer(MaxThreads);
+
+        for (const SBenchmarkView& rView : s_Views)
+        {
+            SBenchmarkCase Case = { &rView, s_Sizes[0][0], s_Sizes[0][1], rView.m_MaxIterations[0] };
+
+            if (CheckCase(Renderer, Case)) continue;
+
+            std::fprintf(stderr, "The %s view differs from its perturbation reference, the kernels compute wrong iterations\n", rView.m_pName);
+
+            return 1;
+        }
+    }
+
+    // -----------------------------------------------------------------------------
+    // All cases run on one renderer per thread count, so the workers are
+    // started once per thread count and not once per case.
+    // -----------------------------------------------------------------------------
+    std::vector<std::vector<SBenchmarkRun>> Runs(Cases.size(), std::vector<SBenchmarkRun>(ThreadCounts.size()));
+
+    for (size_t IndexOfThreadCount = 0; IndexOfThreadCount < ThreadCounts.size(); ++IndexOfThreadCount)
+    {
+        CMandelbrotRenderer Renderer(ThreadCounts[IndexOfThreadCount]);
+
+        for (size_t IndexOfCase = 0; IndexOfCase < Cases.size(); ++IndexOfCase)
+        {
+            const SBenchmarkCase& rCase = Cases[IndexOfCase];
+            SBenchmarkRun&        rRun  = Runs[IndexOfCase][IndexOfThreadCount];
+
+            RunCase(Renderer, rCase, Repetitions, &rRun);
+
+            double Speedup = Runs[IndexOfCase][0].m_MedianSeconds / rRun.m_MedianSeconds;
+
+            std::printf("%-9s %4d x %4d %6u iterations %3d threads: %9.1f Miter/s +- %4.1f%%, speedup %5.2f, efficiency %5.1f%%\n", rCase.m_pView->m_pName, rCase.m_Width, rCase.m_Height, rCase.m_MaxIteration, rRun.m_NumberOfThreads, GetMegaIterationsPerSecond(rRun), 100.0 * rRun.m_Deviation / rRun.m_MeanSeconds, Speedup, 100.0 * Speedup / rRun.m_NumberOfThreads);
+            std::fflush(stdout);
+        }
+    }
+
+    if (!WriteResults(pPath, IsFullSuite ? "full" : "quick", Repetitions, Cases, Runs))
+    {
+        std::fprintf(stderr, "Could not write %s\n", pPath);
+
+        return 1;
+    }
+
+    return 0;
+}
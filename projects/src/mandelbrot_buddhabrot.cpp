@@ -0,0 +1,83 @@
+#include "CBuddhabrotRenderer.h"
+#include "CImageWriter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+// -----------------------------------------------------------------------------
+// Renders a Buddhabrot on the CPU.
+//
+//    mandelbrot_buddhabrot [Width] [Height] [MaxIteration] [Output.ppm or .png]
+//                          [Samples] [Previews] [Threads] [MinIteration]
+//                          [Seed]
+//
+// The samples are taken in as many steps as there are previews. After every
+// step the image is written again, so the file shows the progress while the
+// density builds up.
+// -----------------------------------------------------------------------------
+
+int main(int _Argc, char** _ppArgv)
+{
+    int                Width           = _Argc > 1 ? std::atoi(_ppArgv[1]) : 800;
+    int                Height          = _Argc > 2 ? std::atoi(_ppArgv[2]) : 800;
+    unsigned int       MaxIteration    = _Argc > 3 ? static_cast<unsigned int>(std::atoi(_ppArgv[3])) : 1000;
+    const char*        pPath           = _Argc > 4 ? _ppArgv[4] : "buddhabrot.ppm";
+    unsigned long long NumberOfSamples = _Argc > 5 ? std::strtoull(_ppArgv[5], nullptr, 10) : 10000000ull;
+    int                Previews        = _Argc > 6 ? std::max(std::atoi(_ppArgv[6]), 1) : 1;
+    int                Threads         = _Argc > 7 ? std::atoi(_ppArgv[7]) : 0;
+
+    SBuddhabrotSettings Settings;
+
+    GetBuddhabrotSettings(Width, Height, MaxIteration, &Settings);
+
+    if (_Argc > 8)
+    {
+        Settings.m_MinIteration = static_cast<unsigned int>(std::atoi(_ppArgv[8]));
+    }
+
+    if (_Argc > 9)
+    {
+        Settings.m_Seed = std::strtoull(_ppArgv[9], nullptr, 10);
+    }
+
+    CBuddhabrotRenderer Renderer(Threads);
+    SMandelbrotImage    Image;
+
+    if (!Renderer.Start(Settings))
+    {
+        std::fprintf(stderr, "Invalid image size %d x %d or iterations %u to %u\n", Width, Height, Settings.m_MinIteration, MaxIteration);
+
+        return 1;
+    }
+
+    std::printf("Sampling %llu points with %u to %u iterations on %d threads (%s)\n", NumberOfSamples, Settings.m_MinIteration, MaxIteration, Renderer.GetNumberOfThreads(), GetMandelbrotKernel().m_pName);
+
+    auto Start = std::chrono::steady_clock::now();
+
+    for (int IndexOfPreview = 0; IndexOfPreview < Previews; ++IndexOfPreview)
+    {
+        unsigned long long Target = NumberOfSamples * (IndexOfPreview + 1) / Previews;
+
+        Renderer.Advance(Target - std::min(Target, Renderer.GetNumberOfSamples()));
+
+        Renderer.GetImage(&Image);
+
+        CImageWriter Writer;
+
+        if (!Writer.Open(pPath, Width, Height) || !Writer.WriteRows(Image.m_Pixels.data(), Height) || !Writer.Close())
+        {
+            std::fprintf(stderr, "Could not write %s\n", pPath);
+
+            return 1;
+        }
+
+        double Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+
+        std::printf("%llu samples, %llu orbits drawn, %.2f Msamples/s\n", Renderer.GetNumberOfSamples(), Renderer.GetNumberOfOrbits(), Renderer.GetNumberOfSamples() / Seconds * 1e-6);
+        std::fflush(stdout);
+    }
+
+    return 0;
+}
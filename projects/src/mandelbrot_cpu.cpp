@@ -0,0 +1,248 @@
+#include "CImageWriter.h"
+#include "CMandelbrotIterationController.h"
+#include "CMandelbrotRenderer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// -----------------------------------------------------------------------------
+// Headless variant of the mandelbrot example for machines without a GPU.
+//
+//    mandelbrot_cpu [Width] [Height] [MaxIteration] [Output.ppm or .png] [Threads]
+//                   [CenterReal] [CenterImaginary] [PixelSize]
+//                   [Subdivision: off, bound, uniform] [Coloring: flat, smooth]
+//                   [CacheDirectory or -] [DeepZoom: perturbation, exact]
+//                   [Exponent] [JuliaReal or -] [JuliaImaginary]
+//                   [Supersampling] [Statistics.json]
+//
+// The center is read with all its digits, so deep zooms far beyond double
+// precision can be rendered. With a cache directory the view is snapped onto
+// the tile grid and composed of the tiles stored there by earlier runs. Exact
+// deep zooms use double-double and quad-double arithmetic as far as they
+// reach instead of perturbation. The exponent selects the multibrot z^n + c
+// and with a Julia c the Julia set of it is rendered instead. Supersampling
+// is the number of samples per pixel along each axis, which only the pixels
+// near the boundary get. The statistics of the frame are dumped as JSON. A
+// maximum iteration of 0 lets CMandelbrotIterationController choose it on a
+// probe of a quarter of the size.
+// -----------------------------------------------------------------------------
+
+namespace
+{
+    const char* const s_pPrecisionNames[] = { "single", "double", "double-double", "quad-double", "perturbation" };     // See SMandelbrotPrecision.
+} // namespace
+
+// -----------------------------------------------------------------------------
+
+int main(int _Argc, char** _ppArgv)
+{
+    int          Width        = _Argc > 1 ? std::atoi(_ppArgv[1]) : 800;
+    int          Height       = _Argc > 2 ? std::atoi(_ppArgv[2]) : 600;
+    unsigned int MaxIteration = _Argc > 3 ? static_cast<unsigned int>(std::atoi(_ppArgv[3])) : 256;
+    const char*  pPath        = _Argc > 4 ? _ppArgv[4] : "mandelbrot.ppm";
+    int          Threads      = _Argc > 5 ? std::atoi(_ppArgv[5]) : 0;
+
+    PSPerObjectConstants Constants;
+
+    Constants.m_PSColor[0]     = 0.95f; //R
+    Constants.m_PSColor[1]     = 0.25f; //G
+    Constants.m_PSColor[2]     = 0.0f;  //B
+    Constants.m_PSMaxIteration = MaxIteration;
+
+    SMandelbrotSettings Settings;
+
+    GetMandelbrotSettings(Width, Height, Constants, &Settings);
+
+    if (_Argc > 7)
+    {
+        Settings.m_Center[0]        = std::atof(_ppArgv[6]);
+        Settings.m_Center[1]        = std::atof(_ppArgv[7]);
+        Settings.m_PreciseCenter[0] = _ppArgv[6];
+        Settings.m_PreciseCenter[1] = _ppArgv[7];
+
+        if (!IsMandelbrotCenterValid(Settings))
+        {
+            std::fprintf(stderr, "The center '%s %s' is no pair of decimal numbers\n", _ppArgv[6], _ppArgv[7]);
+
+            return 1;
+        }
+    }
+
+    if (_Argc > 8)
+    {
+        Settings.m_PixelSize = std::atof(_ppArgv[8]);
+    }
+
+    if (_Argc > 9)
+    {
+        if      (std::strcmp(_ppArgv[9], "bound")   == 0) Settings.m_Subdivision = SSubdivision::Bound;
+        else if (std::strcmp(_ppArgv[9], "uniform") == 0) Settings.m_Subdivision = SSubdivision::Uniform;
+        else                                              Settings.m_Subdivision = SSubdivision::Off;
+    }
+
+    const char* pCacheDirectory = _Argc > 11 && std::strcmp(_ppArgv[11], "-") != 0 ? _ppArgv[11] : nullptr;
+
+    if (_Argc > 12)
+    {
+        Settings.m_IsPerturbationPreferred = std::strcmp(_ppArgv[12], "exact") != 0;
+    }
+
+    if (_Argc > 13)
+    {
+        Settings.m_Exponent = std::atoi(_ppArgv[13]);
+    }
+
+    if (_Argc > 15 && std::strcmp(_ppArgv[14], "-") != 0)
+    {
+        Settings.m_Fractal   = SFractal::Julia;
+        Settings.m_JuliaC[0] = std::atof(_ppArgv[14]);
+        Settings.m_JuliaC[1] = std::atof(_ppArgv[15]);
+    }
+
+    if (_Argc > 16)
+    {
+        Settings.m_Supersampling = std::max(std::atoi(_ppArgv[16]), 1);
+    }
+
+    if (pCacheDirectory != nullptr) CMandelbrotTileCache::AlignSettings(&Settings);
+
+    const char* pStatisticsPath = _Argc > 17 ? _ppArgv[17] : nullptr;
+
+    CMandelbrotRenderer  Renderer(Threads);
+    CMandelbrotTileCache Cache(static_cast<size_t>(256) << 20, pCacheDirectory != nullptr ? pCacheDirectory : "");
+    SMandelbrotImage     Image;
+
+    if (MaxIteration == 0)
+    {
+        SMandelbrotIterationControl Control;
+
+        GetMandelbrotIterationControl(&Control);
+
+        Control.m_BudgetSeconds = 1e9;
+
+        CMandelbrotIterationController Controller(Control);
+
+        SMandelbrotSettings ProbeSettings = Settings;
+
+        ProbeSettings.m_Width     = std::max(Width  / 4, 1);
+        ProbeSettings.m_Height    = std::max(Height / 4, 1);
+        ProbeSettings.m_PixelSize = Settings.m_PixelSize * Width / ProbeSettings.m_Width;
+
+        Controller.Update(Renderer, ProbeSettings);
+
+        MaxIteration = Controller.GetMaxIteration();
+
+        Settings.m_MaxIteration = MaxIteration;
+
+        std::printf("Maximum iteration %u chosen, %.3f%% of the probe bound, %.3f%% escaped in the last step\n", MaxIteration, 100.0 * Controller.GetBoundShare(), 100.0 * Controller.GetEscapedShare());
+    }
+
+    Renderer.EnableFrameStatistics(pStatisticsPath != nullptr);
+
+    auto Start = std::chrono::steady_clock::now();
+
+    bool IsRendered = pCacheDirectory != nullptr ? Renderer.RenderCached(Settings, &Cache, &Image) : Renderer.Render(Settings, &Image);
+
+    if (!IsRendered)
+    {
+        std::fprintf(stderr, "Invalid image size %d x %d or exponent %d\n", Width, Height, Settings.m_Exponent);
+
+        return 1;
+    }
+
+    auto End = std::chrono::steady_clock::now();
+
+    std::printf("Rendered %d x %d with %u iterations on %d threads (%s, %s) in %.1f ms\n", Width, Height, MaxIteration, Renderer.GetNumberOfThreads(), GetMandelbrotKernel().m_pName, s_pPrecisionNames[GetMandelbrotPrecision(Settings)], std::chrono::duration<double, std::milli>(End - Start).count());
+
+    if (pCacheDirectory != nullptr)
+    {
+        std::printf("Tile cache: %llu tiles read from %s, %llu tiles rendered\n", Cache.GetNumberOfDiskHits(), pCacheDirectory, Cache.GetNumberOfMisses());
+    }
+
+    const SMandelbrotInteriorStatistics& rInterior = Renderer.GetInteriorStatistics();
+
+    // -----------------------------------------------------------------------------
+    // The slowest tile of every pass and the share of the time the workers
+    // were busy show how evenly the work was spread.
+    // -----------------------------------------------------------------------------
+    if (pStatisticsPath != nullptr)
+    {
+        const SMandelbrotFrameStatistics& rStatistics = Renderer.GetFrameStatistics();
+
+        std::printf("Frame: %llu iterations, %llu escaped and %llu bound pixels\n", rStatistics.m_NumberOfIterations, rStatistics.m_NumberOfEscapedPixels, rStatistics.m_NumberOfBoundPixels);
+
+        for (const SMandelbrotPassStatistics& rPass : rStatistics.m_Passes)
+        {
+            double MaxTileSeconds = 0.0;
+            double BusySeconds    = 0.0;
+
+            for (float TileSeconds : rPass.m_TileSeconds)                  MaxTileSeconds = std::max(MaxTileSeconds, static_cast<double>(TileSeconds));
+            for (const SMandelbrotThreadStatistics& rThread : rPass.m_Threads) BusySeconds += rThread.m_BusySeconds;
+
+            double Utilization = rPass.m_Seconds > 0.0 ? BusySeconds / (rPass.m_Seconds * rPass.m_Threads.size()) : 0.0;
+
+            std::printf("Pass %s: %.2f ms, %zu tiles, slowest tile %.2f ms, workers busy %.0f%%\n", rPass.m_pName, rPass.m_Seconds * 1e3, rPass.m_TileSeconds.size(), MaxTileSeconds * 1e3, Utilization * 100.0);
+        }
+
+        if (!WriteMandelbrotStatistics(rStatistics, pStatisticsPath))
+        {
+            std::fprintf(stderr, "Could not write %s\n", pStatisticsPath);
+
+            return 1;
+        }
+    }
+
+    // -----------------------------------------------------------------------------
+    // The palette is made of the colors CApplication cycles through. Cycling it
+    // only maps the smooth iterations again, which is timed here.
+    // -----------------------------------------------------------------------------
+    if (_Argc > 10 && std::strcmp(_ppArgv[10], "smooth") == 0)
+    {
+        const float Stops[4][3] =
+        {
+            { 0.25f, 0.25f, 0.0f },
+            { 0.55f, 0.25f, 0.0f },
+            { 0.75f, 0.25f, 0.0f },
+            { 0.95f, 0.25f, 0.0f },
+        };
+
+        const int NumberOfCycles = 16;
+
+        SMandelbrotPalette Palette;
+
+        GetMandelbrotPalette(Stops, 4, 1024, &Palette);
+
+        auto StartOfColors = std::chrono::steady_clock::now();
+
+        for (int IndexOfCycle = 0; IndexOfCycle < NumberOfCycles; ++IndexOfCycle)
+        {
+            Palette.m_Offset = static_cast<float>(IndexOfCycle * 64);
+
+            Renderer.MapColors(Palette, &Image);
+        }
+
+        auto EndOfColors = std::chrono::steady_clock::now();
+
+        std::printf("Mapped colors in %.2f ms\n", std::chrono::duration<double, std::milli>(EndOfColors - StartOfColors).count() / NumberOfCycles);
+    }
+
+    std::printf("Subdivision filled %llu pixels\n", Renderer.GetNumberOfFilledPixels());
+
+    std::printf("Supersampled %llu pixels\n", Renderer.GetNumberOfSupersampledPixels());
+
+    std::printf("Interior: %llu pixels in cardioid or bulb (%llu iterations saved), %llu periodic pixels (%llu iterations saved)\n", rInterior.m_NumberOfBulbPixels, rInterior.m_BulbIterations, rInterior.m_NumberOfPeriodicPixels, rInterior.m_PeriodicIterations);
+
+    CImageWriter Writer;
+
+    if (!Writer.Open(pPath, Width, Height) || !Writer.WriteRows(Image.m_Pixels.data(), Height) || !Writer.Close())
+    {
+        std::fprintf(stderr, "Could not write %s\n", pPath);
+
+        return 1;
+    }
+
+    return 0;
+}
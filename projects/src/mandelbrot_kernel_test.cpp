@@ -0,0 +1,143 @@
+#include "CFixedPoint.h"
+#include "MandelbrotKernel.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// Checks that the double-double and quad-double kernels of every instruction
+// set the CPU supports compute the same iterations and magnitudes as the
+// scalar kernel.
+//
+//    mandelbrot_kernel_test
+//
+// Their error free transformations only work if every product and sum is
+// rounded on its own. A compiler fusing a multiplication and an addition
+// breaks them in the kernels with FMA, the view is the minibrot of the
+// benchmark, where this changes the iterations of most pixels. Returns 1 if
+// a kernel differs.
+// -----------------------------------------------------------------------------
+
+namespace
+{
+    const char* const  s_pCenter[2]      = { "-0.743643887037158870778064543493642575047", "0.1318259042053122928210973548747672652629" };
+    const double       s_PixelSize       = 1.3888e-16;
+    const int          s_Width           = 64;
+    const int          s_Height          = 16;
+    const unsigned int s_MaxIteration    = 4096;
+    const int          s_NumberOfLimbs   = CFixedPoint::GetNumberOfLimbs(256);
+
+    const char* const  s_pKernelNames[]    = { "sse2", "avx2", "avx512" };
+    const char* const  s_pPrecisionNames[] = { "double-double", "quad-double" };
+
+    // -----------------------------------------------------------------------------
+    // Iterates the view with the row kernel of the kernel and precision, the
+    // rows are set up like CMandelbrotRenderer does for the extended precisions.
+    // -----------------------------------------------------------------------------
+
+    void IterateView(const SMandelbrotKernel& _rKernel, bool _IsQuadDouble, bool _IsInteriorChecked, std::vector<unsigned int>* _pIterations, std::vector<float>* _pMagnitudes)
+    {
+        FIterateRow pIterateRow = _IsQuadDouble ? _rKernel.m_pIterateRowQuadDouble : _rKernel.m_pIterateRowDoubleDouble;
+
+        CFixedPoint Center[2] = { CFixedPoint(s_NumberOfLimbs), CFixedPoint(s_NumberOfLimbs) };
+        CFixedPoint Coordinate(s_NumberOfLimbs);
+
+        Center[0].SetFromString(s_pCenter[0]);
+        Center[1].SetFromString(s_pCenter[1]);
+
+        double Parts[4];
+
+        SMandelbrotRow Row = SMandelbrotRow();
+
+        CFixedPoint::Add(Center[0], CFixedPoint(-0.5 * s_PixelSize * (s_Width - 1), s_NumberOfLimbs), &Coordinate);
+
+        Coordinate.ToDoubles(Parts, 4);
+
+        Row.m_X = Parts[0];
+
+        std::copy(Parts + 1, Parts + 4, Row.m_XLow);
+
+        Row.m_StepX             = s_PixelSize;
+        Row.m_NumberOfPixels    = s_Width;
+        Row.m_MaxIteration      = s_MaxIteration;
+        Row.m_IsInteriorChecked = _IsInteriorChecked;
+
+        _pIterations->assign(s_Width * s_Height, 0);
+        _pMagnitudes->assign(s_Width * s_Height, 0.0f);
+
+        SMandelbrotInteriorStatistics Statistics = SMandelbrotInteriorStatistics();
+
+        for (int Y = 0; Y < s_Height; ++Y)
+        {
+            CFixedPoint::Add(Center[1], CFixedPoint(s_PixelSize * (0.5 * (s_Height - 1) - Y), s_NumberOfLimbs), &Coordinate);
+
+            Coordinate.ToDoubles(Parts, 4);
+
+            Row.m_Y = Parts[0];
+
+            std::copy(Parts + 1, Parts + 4, Row.m_YLow);
+
+            pIterateRow(Row, &(*_pIterations)[Y * s_Width], &(*_pMagnitudes)[Y * s_Width], &Statistics);
+        }
+    }
+} // namespace
+
+// -----------------------------------------------------------------------------
+
+int main()
+{
+    const SMandelbrotKernel* pScalarKernel = GetMandelbrotKernel("scalar");
+
+    int NumberOfFailures = 0;
+
+    for (int IsQuadDouble = 0; IsQuadDouble < 2; ++IsQuadDouble)
+    {
+        for (int IsInteriorChecked = 0; IsInteriorChecked < 2; ++IsInteriorChecked)
+        {
+            std::vector<unsigned int> ScalarIterations;
+            std::vector<float>        ScalarMagnitudes;
+
+            IterateView(*pScalarKernel, IsQuadDouble != 0, IsInteriorChecked != 0, &ScalarIterations, &ScalarMagnitudes);
+
+            for (const char* pKernelName : s_pKernelNames)
+            {
+                const SMandelbrotKernel* pKernel = GetMandelbrotKernel(pKernelName);
+
+                if (pKernel == nullptr)
+                {
+                    std::printf("%-6s %-13s skipped, not supported by the CPU\n", pKernelName, s_pPrecisionNames[IsQuadDouble]);
+
+                    continue;
+                }
+
+                std::vector<unsigned int> Iterations;
+                std::vector<float>        Magnitudes;
+
+                IterateView(*pKernel, IsQuadDouble != 0, IsInteriorChecked != 0, &Iterations, &Magnitudes);
+
+                int NumberOfDifferences = 0;
+                int FirstDifference     = -1;
+
+                for (int IndexOfPixel = 0; IndexOfPixel < s_Width * s_Height; ++IndexOfPixel)
+                {
+                    if (Iterations[IndexOfPixel] == ScalarIterations[IndexOfPixel] && Magnitudes[IndexOfPixel] == ScalarMagnitudes[IndexOfPixel]) continue;
+
+                    if (FirstDifference < 0) FirstDifference = IndexOfPixel;
+
+                    ++NumberOfDifferences;
+                }
+
+                std::printf("%-6s %-13s interior check %-3s %s\n", pKernelName, s_pPrecisionNames[IsQuadDouble], IsInteriorChecked != 0 ? "on" : "off", NumberOfDifferences == 0 ? "ok" : "differs");
+
+                if (NumberOfDifferences == 0) continue;
+
+                std::fprintf(stderr, "%d of %d pixels differ from the scalar kernel, pixel %d has %u iterations instead of %u\n", NumberOfDifferences, s_Width * s_Height, FirstDifference, Iterations[FirstDifference], ScalarIterations[FirstDifference]);
+
+                ++NumberOfFailures;
+            }
+        }
+    }
+
+    return NumberOfFailures == 0 ? 0 : 1;
+}
@@ -0,0 +1,135 @@
+#include "CImageWriter.h"
+#include "CMandelbrotRenderer.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// -----------------------------------------------------------------------------
+// Offline variant of mandelbrot_cpu for posters far larger than the memory.
+//
+//    mandelbrot_offline [Width] [Height] [MaxIteration] [Output.png or .ppm]
+//                       [RowsPerBand] [Threads] [CenterReal]
+//                       [CenterImaginary] [PixelSize]
+//                       [DeepZoom: perturbation, exact]
+//
+// The image is rendered in bands of rows which are written to the file as
+// soon as they are finished, so only two bands are in memory at any time. The
+// view is set up from the same PSPerObjectConstants as the example and the
+// progress is reported in rows per second.
+// -----------------------------------------------------------------------------
+
+namespace
+{
+    const char* const s_pPrecisionNames[] = { "single", "double", "double-double", "quad-double", "perturbation" };     // See SMandelbrotPrecision.
+
+    const double s_ProgressInterval = 1.0;      // Seconds between two progress reports.
+} // namespace
+
+// -----------------------------------------------------------------------------
+
+int main(int _Argc, char** _ppArgv)
+{
+    int          Width         = _Argc > 1 ? std::atoi(_ppArgv[1]) : 16384;
+    int          Height        = _Argc > 2 ? std::atoi(_ppArgv[2]) : 16384;
+    unsigned int MaxIteration  = _Argc > 3 ? static_cast<unsigned int>(std::atoi(_ppArgv[3])) : 256;
+    const char*  pPath         = _Argc > 4 ? _ppArgv[4] : "mandelbrot.png";
+    int          RowsPerBand   = _Argc > 5 ? std::atoi(_ppArgv[5]) : 64;
+    int          Threads       = _Argc > 6 ? std::atoi(_ppArgv[6]) : 0;
+
+    PSPerObjectConstants Constants;
+
+    Constants.m_PSColor[0]     = 0.95f; //R
+    Constants.m_PSColor[1]     = 0.25f; //G
+    Constants.m_PSColor[2]     = 0.0f;  //B
+    Constants.m_PSMaxIteration = MaxIteration;
+
+    SMandelbrotSettings Settings;
+
+    GetMandelbrotSettings(Width, Height, Constants, &Settings);
+
+    if (_Argc > 8)
+    {
+        Settings.m_Center[0]        = std::atof(_ppArgv[7]);
+        Settings.m_Center[1]        = std::atof(_ppArgv[8]);
+        Settings.m_PreciseCenter[0] = _ppArgv[7];
+        Settings.m_PreciseCenter[1] = _ppArgv[8];
+
+        if (!IsMandelbrotCenterValid(Settings))
+        {
+            std::fprintf(stderr, "The center '%s %s' is no pair of decimal numbers\n", _ppArgv[7], _ppArgv[8]);
+
+            return 1;
+        }
+    }
+
+    if (_Argc > 9)
+    {
+        Settings.m_PixelSize = std::atof(_ppArgv[9]);
+    }
+
+    if (_Argc > 10)
+    {
+        Settings.m_IsPerturbationPreferred = std::strcmp(_ppArgv[10], "exact") != 0;
+    }
+
+    CImageWriter Writer;
+
+    if (RowsPerBand <= 0 || !Writer.Open(pPath, Width, Height))
+    {
+        std::fprintf(stderr, "Could not write %d x %d in bands of %d rows to %s\n", Width, Height, RowsPerBand, pPath);
+
+        return 1;
+    }
+
+    CMandelbrotRenderer Renderer(Threads);
+
+    std::printf("Rendering %d x %d with %u iterations on %d threads (%s, %s) in bands of %d rows, %.1f MB per band\n", Width, Height, MaxIteration, Renderer.GetNumberOfThreads(), GetMandelbrotKernel().m_pName, s_pPrecisionNames[GetMandelbrotPrecision(Settings)], RowsPerBand, static_cast<double>(Width) * RowsPerBand * (sizeof(unsigned int) + sizeof(float) + 4) / (1 << 20));
+
+    auto Start          = std::chrono::steady_clock::now();
+    auto LastReport     = Start;
+    int  LastReportRows = 0;
+
+    // -----------------------------------------------------------------------------
+    // Runs on the writing thread while the next band is rendered.
+    // -----------------------------------------------------------------------------
+    auto WriteBand = [&](const SMandelbrotImage& _rBand, int _FirstRow)
+    {
+        if (!Writer.WriteRows(_rBand.m_Pixels.data(), _rBand.m_Height)) return false;
+
+        int NumberOfRows = _FirstRow + _rBand.m_Height;
+
+        auto Now = std::chrono::steady_clock::now();
+
+        double Interval = std::chrono::duration<double>(Now - LastReport).count();
+
+        if (Interval >= s_ProgressInterval || NumberOfRows == Height)
+        {
+            std::printf("%d of %d rows, %.1f rows/s\n", NumberOfRows, Height, (NumberOfRows - LastReportRows) / Interval);
+            std::fflush(stdout);
+
+            LastReport     = Now;
+            LastReportRows = NumberOfRows;
+        }
+
+        return true;
+    };
+
+    bool IsRendered = Renderer.RenderBands(Settings, RowsPerBand, WriteBand);
+
+    if (!Writer.Close() || !IsRendered)
+    {
+        std::fprintf(stderr, "Could not write %s\n", pPath);
+
+        return 1;
+    }
+
+    auto End = std::chrono::steady_clock::now();
+
+    double Seconds = std::chrono::duration<double>(End - Start).count();
+
+    std::printf("Rendered %d x %d in %.2f s, %.1f rows/s, %.1f Mpixels/s\n", Width, Height, Seconds, Height / Seconds, static_cast<double>(Width) * Height / Seconds * 1e-6);
+
+    return 0;
+}
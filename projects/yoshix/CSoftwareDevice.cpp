@@ -0,0 +1,1084 @@
+#include "CSoftwareDevice.h"
+#include "SoftwareCompiler.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace
+{
+    const int s_NumberOfStartupSteps = 6;
+    const int s_VerticesPerChunk     = 256;
+    const int s_MaxShaderFloats      = 64;                  // Inputs and outputs of a vertex shader, 16 registers.
+
+    // -----------------------------------------------------------------------------
+
+    int GetEnvironmentInt(const char* _pName, int _Default)
+    {
+        const char* pValue = std::getenv(_pName);
+
+        return pValue != nullptr && *pValue != '\0' ? std::atoi(pValue) : _Default;
+    }
+
+    // -----------------------------------------------------------------------------
+    // The first %d in the path of YOSHIX_OUTPUT is replaced by the number of the
+    // frame. Every other character is taken as it is, the path is no format.
+    // -----------------------------------------------------------------------------
+
+    std::string GetOutputPath(const char* _pPattern, int _Frame)
+    {
+        std::string Path = _pPattern;
+
+        size_t Position = Path.find("%d");
+
+        if (Position != std::string::npos) Path.replace(Position, 2, std::to_string(_Frame));
+
+        return Path;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    int GetNumberOfComponents(gfx::SInputElement::EType _Type)
+    {
+        return static_cast<int>(_Type) % 4 + 1;
+    }
+
+    // -----------------------------------------------------------------------------
+    // Semantics ignore the case and a missing index means 0, so TEXCOORD
+    // matches TEXCOORD0.
+    // -----------------------------------------------------------------------------
+
+    void SplitSemantic(const char* _pSemantic, std::string* _pName, int* _pIndex)
+    {
+        size_t Length = std::strlen(_pSemantic);
+        size_t End    = Length;
+
+        while (End > 0 && std::isdigit(static_cast<unsigned char>(_pSemantic[End - 1]))) --End;
+
+        _pName->clear();
+
+        for (size_t Index = 0; Index < End; ++Index) _pName->push_back(static_cast<char>(std::toupper(static_cast<unsigned char>(_pSemantic[Index]))));
+
+        *_pIndex = End < Length ? std::atoi(_pSemantic + End) : 0;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool IsSameSemantic(const char* _pSemantic1, const char* _pSemantic2)
+    {
+        std::string Name1;
+        std::string Name2;
+        int         Index1;
+        int         Index2;
+
+        SplitSemantic(_pSemantic1, &Name1, &Index1);
+        SplitSemantic(_pSemantic2, &Name2, &Index2);
+
+        return Name1 == Name2 && Index1 == Index2;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void GetShaderContext(const SSoftwareShader& _rShader, SSoftwareConstantBuffer* const* _ppConstantBuffers, int _NumberOfConstantBuffers, SSoftwareTexture* const* _ppTextures, int _NumberOfTextures, SSoftwareShaderContext* _pContext)
+    {
+        _pContext->m_pProgram = _rShader.m_pProgram;
+
+        for (int Register = 0; Register < 16; ++Register)
+        {
+            _pContext->m_pConstantBuffers[Register] = Register < _NumberOfConstantBuffers && _ppConstantBuffers[Register] != nullptr ? _ppConstantBuffers[Register]->m_pData : nullptr;
+            _pContext->m_pTextures       [Register] = Register < _NumberOfTextures ? _ppTextures[Register] : nullptr;
+        }
+    }
+
+    // -----------------------------------------------------------------------------
+    // Runs the vertex shader on batches of as many vertices as the lane type
+    // holds. The inputs are transposed into the lanes and the outputs back
+    // into consecutive vertices. A batch at the end repeats its last vertex.
+    // -----------------------------------------------------------------------------
+
+    template <typename TFloat, typename TShader, typename TGatherInput>
+    void ShadeVertices(TShader _pShader, const SSoftwareShaderContext& _rContext, const TGatherInput& _rGatherInput, int _FirstVertex, int _LastVertex, int _NumberOfOutputs, float* _pOutputs)
+    {
+        const int NumberOfLanes = SSoftwareLanes<TFloat>::s_NumberOfLanes;
+
+        float  Input[s_MaxShaderFloats] = {};
+        float  Lanes[s_MaxShaderFloats][NumberOfLanes];
+        TFloat Inputs [s_MaxShaderFloats];
+        TFloat Outputs[s_MaxShaderFloats];
+
+        for (int FirstVertex = _FirstVertex; FirstVertex < _LastVertex; FirstVertex += NumberOfLanes)
+        {
+            int NumberOfVertices = std::min(NumberOfLanes, _LastVertex - FirstVertex);
+
+            for (int Lane = 0; Lane < NumberOfLanes; ++Lane)
+            {
+                _rGatherInput(FirstVertex + std::min(Lane, NumberOfVertices - 1), Input);
+
+                for (int IndexOfFloat = 0; IndexOfFloat < s_MaxShaderFloats; ++IndexOfFloat) Lanes[IndexOfFloat][Lane] = Input[IndexOfFloat];
+            }
+
+            for (int IndexOfFloat = 0; IndexOfFloat < s_MaxShaderFloats; ++IndexOfFloat) Inputs[IndexOfFloat] = SSoftwareLanes<TFloat>::Load(Lanes[IndexOfFloat]);
+
+            _pShader(_rContext, Inputs, Outputs);
+
+            for (int IndexOfFloat = 0; IndexOfFloat < _NumberOfOutputs; ++IndexOfFloat)
+            {
+                float Values[NumberOfLanes];
+
+                SSoftwareLanes<TFloat>::Store(Outputs[IndexOfFloat], Values);
+
+                for (int Lane = 0; Lane < NumberOfVertices; ++Lane)
+                {
+                    _pOutputs[static_cast<size_t>(FirstVertex + Lane) * _NumberOfOutputs + IndexOfFloat] = Values[Lane];
+                }
+            }
+        }
+    }
+} // namespace
+
+// -----------------------------------------------------------------------------
+
+CSoftwareDevice& CSoftwareDevice::GetInstance()
+{
+    static CSoftwareDevice s_Device;
+
+    return s_Device;
+}
+
+// -----------------------------------------------------------------------------
+
+CSoftwareDevice::CSoftwareDevice()
+    : m_Width                  (0)
+    , m_Height                 (0)
+    , m_IsRunning              (false)
+    , m_ClearColor             { 0.0f, 0.0f, 0.0f, 1.0f }
+    , m_BackBuffer             ()
+    , m_DepthBuffer            ()
+    , m_RenderState            ()
+    , m_Scheduler              (GetEnvironmentInt("YOSHIX_THREADS", 0))
+    , m_Rasterizer             (m_Scheduler)
+    , m_NumberOfLanes          (GetEnvironmentInt("YOSHIX_LANES", 8))
+    , m_IsCompilingShaders     (GetEnvironmentInt("YOSHIX_COMPILE", 0) != 0)
+    , m_VertexOutputs          ()
+    , m_UploadRing             ()
+    , m_ConstantBuffers        ()
+    , m_pOutputPath            (nullptr)
+    , m_RenderThread           ()
+    , m_Mutex                  ()
+    , m_SubmitCondition        ()
+    , m_DoneCondition          ()
+    , m_SubmittedLists         ()
+    , m_FreeLists              ()
+    , m_IsExecuting            (false)
+    , m_IsStopping             (false)
+    , m_NumberOfPresentedFrames(0)
+    , m_FrameCommands          ()
+{
+}
+
+// -----------------------------------------------------------------------------
+
+CSoftwareDevice::~CSoftwareDevice()
+{
+    for (SSoftwareCommandList* pCommandList : m_FreeLists) delete pCommandList;
+}
+
+// -----------------------------------------------------------------------------
+
+void CSoftwareDevice::Run(int _Width, int _Height, const char* _pTitle, gfx::IApplication* _pApplication)
+{
+    if (_pApplication == nullptr || _Width <= 0 || _Height <= 0) return;
+
+    int NumberOfFrames = GetEnvironmentInt("YOSHIX_FRAMES", 1);
+
+    m_pOutputPath = std::getenv("YOSHIX_OUTPUT");
+
+    m_Width     = _Width;
+    m_Height    = _Height;
+    m_IsRunning = true;
+
+    m_BackBuffer.m_Format = SSoftwareTexture::Color;
+    m_BackBuffer.m_Width  = _Width;
+    m_BackBuffer.m_Height = _Height;
+
+    m_BackBuffer.m_Colors.assign(static_cast<size_t>(_Width) * _Height, 0);
+
+    m_DepthBuffer.m_Format = SSoftwareTexture::Depth;
+    m_DepthBuffer.m_Width  = _Width;
+    m_DepthBuffer.m_Height = _Height;
+
+    ClearSoftwareDepth(&m_DepthBuffer, 1.0f);
+
+    m_RenderState.m_DepthTest       = gfx::SDepthTest::Lesser;
+    m_RenderState.m_IsWireFrame     = false;
+    m_RenderState.m_IsAlphaBlending = false;
+
+    ResetRenderTargets();
+
+    int NumberOfSteps = Startup(_pApplication);
+
+    if (NumberOfSteps < s_NumberOfStartupSteps || !_pApplication->OnResize(_Width, _Height))
+    {
+        std::fprintf(stderr, "%s: the startup of the application failed\n", _pTitle);
+
+        Shutdown(_pApplication, NumberOfSteps);
+
+        m_IsRunning = false;
+
+        return;
+    }
+
+    // -----------------------------------------------------------------------------
+    // Like the swap chain of a window, the back buffer is cleared before the
+    // application draws its frame and presented after it. Both are commands
+    // of the render thread, which may still render the last frame while the
+    // application updates the next one.
+    // -----------------------------------------------------------------------------
+    m_IsStopping              = false;
+    m_NumberOfPresentedFrames = 0;
+
+    m_RenderThread = std::thread(&CSoftwareDevice::RenderLoop, this);
+
+    auto Start = std::chrono::steady_clock::now();
+
+    int Frame = 0;
+
+    for (; m_IsRunning && (NumberOfFrames <= 0 || Frame < NumberOfFrames); ++Frame)
+    {
+        if (!_pApplication->OnUpdate()) break;
+
+        {
+            std::unique_lock<std::mutex> Lock(m_Mutex);
+
+            m_DoneCondition.wait(Lock, [&] { return m_NumberOfPresentedFrames >= Frame - 1; });
+        }
+
+        ResetRenderTargets(&m_FrameCommands);
+
+        ClearColorTarget(&m_FrameCommands, &m_BackBuffer, m_ClearColor);
+        ClearDepthTarget(&m_FrameCommands, &m_DepthBuffer, 1.0f);
+
+        SubmitCommandList(&m_FrameCommands);
+
+        if (!_pApplication->OnFrame()) break;
+
+        m_UploadRing.EndFrame(Frame);
+
+        Record(&m_FrameCommands, SSoftwareCommand::Present)->m_Value = Frame;
+
+        SubmitCommandList(&m_FrameCommands);
+    }
+
+    WaitForCommandLists();
+
+    double Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+
+    {
+        std::lock_guard<std::mutex> Lock(m_Mutex);
+
+        m_IsStopping = true;
+    }
+
+    m_SubmitCondition.notify_all();
+
+    m_RenderThread.join();
+
+    {
+        std::lock_guard<std::mutex> Lock(m_Mutex);
+
+        RetainUploads();
+    }
+
+    m_UploadRing.Reset();
+
+    if (Frame > 0)
+    {
+        std::printf("%s: %d frames of %d x %d on %d threads in %.1f ms, %.2f ms per frame\n", _pTitle, Frame, _Width, _Height, m_Scheduler.GetNumberOfThreads(), Seconds * 1e3, Seconds * 1e3 / Frame);
+    }
+
+    Shutdown(_pApplication, NumberOfSteps);
+
+    m_IsRunning = false;
+}
+
+// -----------------------------------------------------------------------------
+
+void CSoftwareDevice::Stop()
+{
+    m_IsRunning = false;
+}
+
+// -----------------------------------------------------------------------------
+
+int CSoftwareDevice::Startup(gfx::IApplication* _pApplication)
+{
+    if (!_pApplication->OnStartup              ()) return 0;
+    if (!_pApplication->OnCreateTextures       ()) return 1;
+    if (!_pApplication->OnCreateConstantBuffers()) return 2;
+    if (!_pApplication->OnCreateShader         ()) return 3;
+    if (!_pApplication->OnCreateMaterials      ()) return 4;
+    if (!_pApplication->OnCreateMeshes         ()) return 5;
+
+    return s_NumberOfStartupSteps;
+}
+
+// -----------------------------------------------------------------------------
+
+void CSoftwareDevice::Shutdown(gfx::IApplication* _pApplication, int _NumberOfSteps)
+{
+    if (_NumberOfSteps > 5) _pApplication->OnReleaseMeshes         ();
+    if (_NumberOfSteps > 4) _pApplication->OnReleaseMaterials      ();
+    if (_NumberOfSteps > 3) _pApplication->OnReleaseShader         ();
+    if (_NumberOfSteps > 2) _pApplication->OnReleaseConstantBuffers();
+    if (_NumberOfSteps > 1) _pApplication->OnReleaseTextures       ();
+    if (_NumberOfSteps > 0) _pApplication->OnShutdown              ();
+}
+
+// -----------------------------------------------------------------------------
+
+void CSoftwareDevice::SetClearColor(const float* _pColor)
+{
+    std::memcpy(m_ClearColor, _pColor, sizeof(m_ClearColor));
+}
+
+// -----------------------------------------------------------------------------
+
+void CSoftwareDevice::SetDepthTest(gfx::SDepthTest::ETest _Test)
+{
+    WaitForCommandLists();
+
+    m_RenderState.m_DepthTest = _Test;
+}
+
+// -----------------------------------------------------------------------------
+
+void CSoftwareDevice::SetWireFrame(bool _Flag)
+{
+    WaitForCommandLists();
+
+    m_RenderState.m_IsWireFrame = _Flag;
+}
+
+// -----------------------------------------------------------------------------
+
+void CSoftwareDevice::SetAlphaBlending(bool _Flag)
+{
+    WaitForCommandLists();
+
+    m_RenderState.m_IsAlphaBlending = _Flag;
+}
+
+// -----------------------------------------------------------------------------
+
+gfx::BHandle CSoftwareDevice::CreateTexture(const char* _pPath)
+{
+    std::string Path = _pPath;
+
+    std::replace(Path.begin(), Path.end(), '\\', '/');
+
+    SSoftwareTexture* pTexture = new SSoftwareTexture();
+
+    if (!LoadSoftwareTexture(Path.c_str(), pTexture))
+    {
+        std::fprintf(stderr, "Could not read the texture %s\n", Path.c_str());
+
+        delete pTexture;
+
+        return nullptr;
+    }
+
+    return pTexture;
+}
+
+// -----------------------------------------------------------------------------
+
+gfx::BHandle CSoftwareDevice::CreateTarget(SSoftwareTexture::EFormat _Format)
+{
+    SSoftwareTexture* pTexture = new SSoftwareTexture();
+
+    pTexture->m_Format = _Format;
+    pTexture->m_Width  = m_Width;
+    pTexture->m_Height = m_Height;
+
+    if (_Format == SSoftwareTexture::Color) pTexture->m_Colors.assign(static_cast<size_t>(m_Width) * m_Height, 0);
+    else                                    ClearSoftwareDepth(pTexture, 1.0f);
+
+    return pTexture;
+}
+
+// -----------------------------------------------------------------------------
+
+void CSoftwareDevice::ReleaseTexture(gfx::BHandle _pTexture)
+{
+    WaitForCommandLists();
+
+    delete static_cast<SSoftwareTexture*>(_pTexture);
+}
+
+// -----------------------------------------------------------------------------
+
+gfx::BHandle CSoftwareDevice::CreateConstantBuffer(int _NumberOfBytes)
+{
+    if (_NumberOfBytes <= 0) return nullptr;
+
+    SSoftwareConstantBuffer* pConstantBuffer = new SSoftwareConstantBuffer();
+
+    pConstantBuffer->m_NumberOfBytes = _NumberOfBytes;
+
+    pConstantBuffer->m_Data.assign((_NumberOfBytes + 15) / 16 * 4, 0.0f);
+
+    pConstantBuffer->m_pData = pConstantBuffer->m_Data.data();
+
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+
+    m_ConstantBuffers.push_back(pConstantBuffer);
+
+    return pConstantBuffer;
+}
+
+// -----------------------------------------------------------------------------
+
+void CSoftwareDevice::ReleaseConstantBuffer(gfx::BHandle _pConstantBuffer)
+{
+    WaitForCommandLists();
+
+    SSoftwareConstantBuffer* pConstantBuffer = static_cast<SSoftwareConstantBuffer*>(_pConstantBuffer);
+
+    if (pConstantBuffer == nullptr) return;
+
+    {
+        std::lock_guard<std::mutex> Lock(m_Mutex);
+
+        m_ConstantBuffers.erase(std::find(m_ConstantBuffers.begin(), m_ConstantBuffers.end(), pConstantBuffer));
+    }
+
+    delete pConstantBuffer;
+}
+
+// -----------------------------------------------------------------------------
+
+void CSoftwareDevice::UploadConstantBuffer(const void* _pData, gfx::BHandle _pConstantBuffer)
+{
+    WaitForCommandLists();
+
+    SSoftwareConstantBuffer* pConstantBuffer = static_cast<SSoftwareConstantBuffer*>(_pConstantBuffer);
+
+    if (pConstantBuffer == nullptr || _pData == nullptr) return;
+
+    pConstantBuffer->m_pData = Upload(*pConstantBuffer, _pData);
+}
+
+// -----------------------------------------------------------------------------
+
+gfx::BHandle CSoftwareDevice::CreateShader(const char* _pPath, const char* _pShaderName, bool _IsVertexShader)
+{
+    const SSoftwareShaderInfo* pInfo = m_IsCompilingShaders ? nullptr : FindSoftwareShader(_pPath, _pShaderName);
+
+    if (pInfo != nullptr && (pInfo->m_NumberOfInputs > 0) == _IsVertexShader)
+    {
+        return new SSoftwareShader{ pInfo, _IsVertexShader, nullptr };
+    }
+
+    // -----------------------------------------------------------------------------
+    // Without a native port the entry point is compiled from the effect.
+    // -----------------------------------------------------------------------------
+    SSoftwareProgram* pProgram = new SSoftwareProgram();
+
+    if (!CompileSoftwareProgram(_pPath, _pShaderName, _IsVertexShader, pProgram))
+    {
+        std::fprintf(stderr, "The %s shader %s of %s could not be compiled\n", _IsVertexShader ? "vertex" : "pixel", _pShaderName, _pPath);
+
+        delete pProgram;
+
+        return nullptr;
+    }
+
+    return new SSoftwareShader{ &pProgram->m_Info, _IsVertexShader, pProgram };
+}
+
+// -----------------------------------------------------------------------------
+
+void CSoftwareDevice::ReleaseShader(gfx::BHandle _pShader)
+{
+    WaitForCommandLists();
+
+    SSoftwareShader* pShader = static_cast<SSoftwareShader*>(_pShader);
+
+    if (pShader == nullptr) return;
+
+    delete pShader->m_pProgram;
+    delete pShader;
+}
+
+// -----------------------------------------------------------------------------
+// Like the input layout of Direct3D, the material binds every input of the
+// vertex shader to the element of the vertex with the same semantic.
+// Components the vertex does not provide are 0, w is 1.
+// -----------------------------------------------------------------------------
+
+gfx::BHandle CSoftwareDevice::CreateMaterial(const gfx::SMaterialInfo& _rMaterialInfo)
+{
+    const SSoftwareShader* pVertexShader = static_cast<const SSoftwareShader*>(_rMaterialInfo.m_pVertexShader);
+    const SSoftwareShader* pPixelShader  = static_cast<const SSoftwareShader*>(_rMaterialInfo.m_pPixelShader);
+
+    if (pVertexShader == nullptr || pPixelShader == nullptr) return nullptr;
+
+    if (pPixelShader->m_pProgram != nullptr && pPixelShader->m_pProgram->m_NumberOfInputs > pVertexShader->m_pInfo->m_NumberOfOutputs)
+    {
+        std::fprintf(stderr, "The pixel shader %s takes more than the output of the vertex shader %s\n", pPixelShader->m_pInfo->m_pShaderName, pVertexShader->m_pInfo->m_pShaderName);
+
+        return nullptr;
+    }
+
+    SSoftwareMaterial Material;
+
+    Material.m_NumberOfTextures              = std::min(std::max(_rMaterialInfo.m_NumberOfTextures, 0), 16);
+    Material.m_NumberOfVertexConstantBuffers = std::min(std::max(_rMaterialInfo.m_NumberOfVertexConstantBuffers, 0), 16);
+    Material.m_NumberOfPixelConstantBuffers  = std::min(std::max(_rMaterialInfo.m_NumberOfPixelConstantBuffers, 0), 16);
+    Material.m_pVertexShader                 = pVertexShader;
+    Material.m_pPixelShader                  = pPixelShader;
+    Material.m_VertexStride                  = 0;
+
+    for (int Index = 0; Index < 16; ++Index)
+    {
+        Material.m_pTextures             [Index] = Index < Material.m_NumberOfTextures              ? static_cast<SSoftwareTexture*>       (_rMaterialInfo.m_pTextures[Index])              : nullptr;
+        Material.m_pVertexConstantBuffers[Index] = Index < Material.m_NumberOfVertexConstantBuffers ? static_cast<SSoftwareConstantBuffer*>(_rMaterialInfo.m_pVertexConstantBuffers[Index]) : nullptr;
+        Material.m_pPixelConstantBuffers [Index] = Index < Material.m_NumberOfPixelConstantBuffers  ? static_cast<SSoftwareConstantBuffer*>(_rMaterialInfo.m_pPixelConstantBuffers[Index])  : nullptr;
+    }
+
+    int NumberOfElements = std::min(std::max(_rMaterialInfo.m_NumberOfInputElements, 0), 16);
+    int ElementOffsets[16];
+
+    for (int IndexOfElement = 0; IndexOfElement < NumberOfElements; ++IndexOfElement)
+    {
+        ElementOffsets[IndexOfElement] = Material.m_VertexStride;
+
+        Material.m_VertexStride += GetNumberOfComponents(_rMaterialInfo.m_InputElements[IndexOfElement].m_Type);
+    }
+
+    const SSoftwareShaderInfo& rVertexShader = *pVertexShader->m_pInfo;
+
+    for (int IndexOfInput = 0; IndexOfInput < rVertexShader.m_NumberOfInputs; ++IndexOfInput)
+    {
+        const SSoftwareShaderInput& rInput = rVertexShader.m_Inputs[IndexOfInput];
+
+        int IndexOfElement = 0;
+
+        while (IndexOfElement < NumberOfElements && !IsSameSemantic(rInput.m_pSemantic, _rMaterialInfo.m_InputElements[IndexOfElement].m_pName)) ++IndexOfElement;
+
+        if (IndexOfElement == NumberOfElements)
+        {
+            std::fprintf(stderr, "The material provides no %s for the vertex shader %s\n", rInput.m_pSemantic, rVertexShader.m_pShaderName);
+
+            return nullptr;
+        }
+
+        Material.m_InputOffsets[IndexOfInput] = ElementOffsets[IndexOfElement];
+        Material.m_InputSizes  [IndexOfInput] = std::min(rInput.m_NumberOfComponents, GetNumberOfComponents(_rMaterialInfo.m_InputElements[IndexOfElement].m_Type));
+    }
+
+    return new SSoftwareMaterial(Material);
+}
+
+// -----------------------------------------------------------------------------
+
+void CSoftwareDevice::ReleaseMaterial(gfx::BHandle _pMaterial)
+{
+    WaitForCommandLists();
+
+    delete static_cast<SSoftwareMaterial*>(_pMaterial);
+}
+
+// -----------------------------------------------------------------------------
+
+gfx::BHandle CSoftwareDevice::CreateMesh(const gfx::SMeshInfo& _rMeshInfo)
+{
+    const SSoftwareMaterial* pMaterial = static_cast<const SSoftwareMaterial*>(_rMeshInfo.m_pMaterial);
+
+    if (pMaterial == nullptr || _rMeshInfo.m_NumberOfVertices < 0 || _rMeshInfo.m_NumberOfIndices < 0) return nullptr;
+
+    SSoftwareMesh* pMesh = new SSoftwareMesh();
+
+    pMesh->m_NumberOfVertices = _rMeshInfo.m_NumberOfVertices;
+    pMesh->m_pMaterial        = pMaterial;
+
+    pMesh->m_Vertices.assign(_rMeshInfo.m_pVertices, _rMeshInfo.m_pVertices + static_cast<size_t>(_rMeshInfo.m_NumberOfVertices) * pMaterial->m_VertexStride);
+    pMesh->m_Indices .assign(_rMeshInfo.m_pIndices , _rMeshInfo.m_pIndices  + _rMeshInfo.m_NumberOfIndices);
+
+    return pMesh;
+}
+
+// -----------------------------------------------------------------------------
+
+void CSoftwareDevice::ReleaseMesh(gfx::BHandle _pMesh)
+{
+    WaitForCommandLists();
+
+    delete static_cast<SSoftwareMesh*>(_pMesh);
+}
+
+// -----------------------------------------------------------------------------
+
+void CSoftwareDevice::ResetRenderTargets()
+{
+    WaitForCommandLists();
+
+    m_RenderState.m_pColorTarget = &m_BackBuffer;
+    m_RenderState.m_pDepthTarget = &m_DepthBuffer;
+}
+
+// -----------------------------------------------------------------------------
+
+void CSoftwareDevice::SetRenderTargets(gfx::BHandle* _ppColorTargets, int _NumberOfColorTargets, gfx::BHandle _pDepthTarget)
+{
+    WaitForCommandLists();
+
+    if (_NumberOfColorTargets > 1)
+    {
+        std::fprintf(stderr, "Only one color target is supported, the other %d are not drawn\n", _NumberOfColorTargets - 1);
+    }
+
+    m_RenderState.m_pColorTarget = _NumberOfColorTargets > 0 ? static_cast<SSoftwareTexture*>(_ppColorTargets[0]) : nullptr;
+    m_RenderState.m_pDepthTarget = static_cast<SSoftwareTexture*>(_pDepthTarget);
+}
+
+// -----------------------------------------------------------------------------
+
+void CSoftwareDevice::ClearColorTarget(gfx::BHandle _pTexture, const float* _pColor)
+{
+    WaitForCommandLists();
+
+    SSoftwareTexture* pTexture = static_cast<SSoftwareTexture*>(_pTexture);
+
+    if (pTexture == nullptr || pTexture->m_Format != SSoftwareTexture::Color) return;
+
+    std::fill(pTexture->m_Colors.begin(), pTexture->m_Colors.end(), PackSoftwareColor(_pColor));
+}
+
+// -----------------------------------------------------------------------------
+
+void CSoftwareDevice::ClearDepthTarget(gfx::BHandle _pTexture, float _Depth)
+{
+    WaitForCommandLists();
+
+    SSoftwareTexture* pTexture = static_cast<SSoftwareTexture*>(_pTexture);
+
+    if (pTexture == nullptr || pTexture->m_Format != SSoftwareTexture::Depth) return;
+
+    ClearSoftwareDepth(pTexture, _Depth);
+}
+
+// -----------------------------------------------------------------------------
+// Every vertex of the mesh runs through the vertex shader once, then the
+// triangles are rasterized with the outputs.
+// -----------------------------------------------------------------------------
+
+void CSoftwareDevice::DrawMesh(gfx::BHandle _pMesh)
+{
+    WaitForCommandLists();
+
+    const SSoftwareMesh* pMesh = static_cast<const SSoftwareMesh*>(_pMesh);
+
+    if (pMesh == nullptr) return;
+
+    const SSoftwareMaterial&   rMaterial     = *pMesh->m_pMaterial;
+    const SSoftwareShaderInfo& rVertexShader = *rMaterial.m_pVertexShader->m_pInfo;
+
+    SSoftwareShaderContext VertexContext;
+    SSoftwareShaderContext PixelContext;
+
+    GetShaderContext(*rMaterial.m_pVertexShader, rMaterial.m_pVertexConstantBuffers, rMaterial.m_NumberOfVertexConstantBuffers, rMaterial.m_pTextures, rMaterial.m_NumberOfTextures, &VertexContext);
+    GetShaderContext(*rMaterial.m_pPixelShader , rMaterial.m_pPixelConstantBuffers , rMaterial.m_NumberOfPixelConstantBuffers , rMaterial.m_pTextures, rMaterial.m_NumberOfTextures, &PixelContext);
+
+    int VertexStride = rVertexShader.m_NumberOfOutputs;
+
+    m_VertexOutputs.resize(static_cast<size_t>(pMesh->m_NumberOfVertices) * VertexStride);
+
+    // -----------------------------------------------------------------------------
+    // The vertices are shaded in parallel chunks, each vertex only writes its
+    // own outputs.
+    // -----------------------------------------------------------------------------
+    int NumberOfChunks = (pMesh->m_NumberOfVertices + s_VerticesPerChunk - 1) / s_VerticesPerChunk;
+
+    auto GatherInput = [&](int _IndexOfVertex, float* _pInput)
+    {
+        const float* pVertex = pMesh->m_Vertices.data() + static_cast<size_t>(_IndexOfVertex) * rMaterial.m_VertexStride;
+
+        for (int IndexOfInput = 0; IndexOfInput < rVertexShader.m_NumberOfInputs; ++IndexOfInput)
+        {
+            int NumberOfComponents = rVertexShader.m_Inputs[IndexOfInput].m_NumberOfComponents;
+            int Size               = rMaterial.m_InputSizes[IndexOfInput];
+
+            for (int Component = 0; Component < NumberOfComponents; ++Component)
+            {
+                _pInput[Component] = Component < Size ? pVertex[rMaterial.m_InputOffsets[IndexOfInput] + Component] : (Component == 3 ? 1.0f : 0.0f);
+            }
+
+            _pInput += NumberOfComponents;
+        }
+    };
+
+    auto ShadeChunk = [&](int _IndexOfChunk, int)
+    {
+        int FirstVertex = _IndexOfChunk * s_VerticesPerChunk;
+        int LastVertex  = std::min(FirstVertex + s_VerticesPerChunk, pMesh->m_NumberOfVertices);
+
+        if (m_NumberOfLanes >= 8 && rVertexShader.m_pFunction8 != nullptr)
+        {
+            ShadeVertices<SSoftwareFloat8>(rVertexShader.m_pFunction8, VertexContext, GatherInput, FirstVertex, LastVertex, VertexStride, m_VertexOutputs.data());
+        }
+        else if (m_NumberOfLanes >= 4 && rVertexShader.m_pFunction4 != nullptr)
+        {
+            ShadeVertices<SSoftwareFloat4>(rVertexShader.m_pFunction4, VertexContext, GatherInput, FirstVertex, LastVertex, VertexStride, m_VertexOutputs.data());
+        }
+        else
+        {
+            ShadeVertices<float>(rVertexShader.m_pFunction, VertexContext, GatherInput, FirstVertex, LastVertex, VertexStride, m_VertexOutputs.data());
+        }
+    };
+
+    if (NumberOfChunks == 1)
+    {
+        ShadeChunk(0, 0);
+    }
+    else if (NumberOfChunks > 1)
+    {
+        m_Scheduler.Run(NumberOfChunks, ShadeChunk);
+    }
+
+    SSoftwareDraw Draw;
+
+    Draw.m_pVertices        = m_VertexOutputs.data();
+    Draw.m_NumberOfVertices = pMesh->m_NumberOfVertices;
+    Draw.m_VertexStride     = VertexStride;
+    Draw.m_pIndices         = pMesh->m_Indices.data();
+    Draw.m_NumberOfIndices  = static_cast<int>(pMesh->m_Indices.size());
+    Draw.m_pPixelShader     = rMaterial.m_pPixelShader->m_pInfo;
+    Draw.m_pPixelContext    = &PixelContext;
+    Draw.m_NumberOfLanes    = m_NumberOfLanes;
+
+    m_Rasterizer.Draw(m_RenderState, Draw);
+}
+
+// -----------------------------------------------------------------------------
+
+gfx::BHandle CSoftwareDevice::CreateCommandList()
+{
+    return new SSoftwareCommandList();
+}
+
+// -----------------------------------------------------------------------------
+
+void CSoftwareDevice::ReleaseCommandList(gfx::BHandle _pCommandList)
+{
+    delete static_cast<SSoftwareCommandList*>(_pCommandList);
+}
+
+// -----------------------------------------------------------------------------
+// The commands move to a list of the pool, so the list of the application is
+// empty and can record the next commands right away. Without a render thread,
+// e.g. during the startup, the commands run on the calling thread.
+// -----------------------------------------------------------------------------
+
+void CSoftwareDevice::SubmitCommandList(gfx::BHandle _pCommandList)
+{
+    SSoftwareCommandList* pCommandList = static_cast<SSoftwareCommandList*>(_pCommandList);
+
+    if (pCommandList == nullptr || pCommandList->m_Commands.empty()) return;
+
+    if (!m_RenderThread.joinable())
+    {
+        Execute(*pCommandList);
+
+        pCommandList->m_Commands.clear();
+
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> Lock(m_Mutex);
+
+        SSoftwareCommandList* pSubmittedList;
+
+        if (m_FreeLists.empty())
+        {
+            pSubmittedList = new SSoftwareCommandList();
+        }
+        else
+        {
+            pSubmittedList = m_FreeLists.back();
+
+            m_FreeLists.pop_back();
+        }
+
+        std::swap(pSubmittedList->m_Commands, pCommandList->m_Commands);
+
+        m_SubmittedLists.push_back(pSubmittedList);
+    }
+
+    m_SubmitCondition.notify_one();
+}
+
+// -----------------------------------------------------------------------------
+// The commands of the render thread itself call the gfx functions without a
+// list, which must not wait for the render thread.
+// -----------------------------------------------------------------------------
+
+void CSoftwareDevice::WaitForCommandLists()
+{
+    if (std::this_thread::get_id() == m_RenderThread.get_id()) return;
+
+    std::unique_lock<std::mutex> Lock(m_Mutex);
+
+    m_DoneCondition.wait(Lock, [&] { return m_SubmittedLists.empty() && !m_IsExecuting; });
+}
+
+// -----------------------------------------------------------------------------
+
+void CSoftwareDevice::SetDepthTest(gfx::BHandle _pCommandList, gfx::SDepthTest::ETest _Test)
+{
+    SSoftwareCommand* pCommand = Record(_pCommandList, SSoftwareCommand::SetDepthTest);
+
+    if (pCommand == nullptr) return;
+
+    pCommand->m_Value = _Test;
+}
+
+// -----------------------------------------------------------------------------
+
+void CSoftwareDevice::SetWireFrame(gfx::BHandle _pCommandList, bool _Flag)
+{
+    SSoftwareCommand* pCommand = Record(_pCommandList, SSoftwareCommand::SetWireFrame);
+
+    if (pCommand == nullptr) return;
+
+    pCommand->m_Value = _Flag ? 1 : 0;
+}
+
+// -----------------------------------------------------------------------------
+
+void CSoftwareDevice::SetAlphaBlending(gfx::BHandle _pCommandList, bool _Flag)
+{
+    SSoftwareCommand* pCommand = Record(_pCommandList, SSoftwareCommand::SetAlphaBlending);
+
+    if (pCommand == nullptr) return;
+
+    pCommand->m_Value = _Flag ? 1 : 0;
+}
+
+// -----------------------------------------------------------------------------
+// The data is copied into the upload ring right away, the application may
+// change it as soon as the call returns.
+// -----------------------------------------------------------------------------
+
+void CSoftwareDevice::UploadConstantBuffer(gfx::BHandle _pCommandList, const void* _pData, gfx::BHandle _pConstantBuffer)
+{
+    const SSoftwareConstantBuffer* pConstantBuffer = static_cast<const SSoftwareConstantBuffer*>(_pConstantBuffer);
+
+    if (_pCommandList == nullptr || pConstantBuffer == nullptr || _pData == nullptr) return;
+
+    SSoftwareCommand* pCommand = Record(_pCommandList, SSoftwareCommand::UploadConstantBuffer);
+
+    pCommand->m_pHandles[0] = _pConstantBuffer;
+    pCommand->m_pData       = Upload(*pConstantBuffer, _pData);
+}
+
+// -----------------------------------------------------------------------------
+
+void CSoftwareDevice::ResetRenderTargets(gfx::BHandle _pCommandList)
+{
+    Record(_pCommandList, SSoftwareCommand::ResetRenderTargets);
+}
+
+// -----------------------------------------------------------------------------
+
+void CSoftwareDevice::SetRenderTargets(gfx::BHandle _pCommandList, gfx::BHandle* _ppColorTargets, int _NumberOfColorTargets, gfx::BHandle _pDepthTarget)
+{
+    SSoftwareCommand* pCommand = Record(_pCommandList, SSoftwareCommand::SetRenderTargets);
+
+    if (pCommand == nullptr) return;
+
+    if (_NumberOfColorTargets > 1)
+    {
+        std::fprintf(stderr, "Only one color target is supported, the other %d are not drawn\n", _NumberOfColorTargets - 1);
+    }
+
+    pCommand->m_pHandles[0] = _NumberOfColorTargets > 0 ? _ppColorTargets[0] : nullptr;
+    pCommand->m_pHandles[1] = _pDepthTarget;
+}
+
+// -----------------------------------------------------------------------------
+
+void CSoftwareDevice::ClearColorTarget(gfx::BHandle _pCommandList, gfx::BHandle _pTexture, const float* _pColor)
+{
+    SSoftwareCommand* pCommand = Record(_pCommandList, SSoftwareCommand::ClearColorTarget);
+
+    if (pCommand == nullptr) return;
+
+    pCommand->m_pHandles[0] = _pTexture;
+
+    std::memcpy(pCommand->m_Values, _pColor, sizeof(pCommand->m_Values));
+}
+
+// -----------------------------------------------------------------------------
+
+void CSoftwareDevice::ClearDepthTarget(gfx::BHandle _pCommandList, gfx::BHandle _pTexture, float _Depth)
+{
+    SSoftwareCommand* pCommand = Record(_pCommandList, SSoftwareCommand::ClearDepthTarget);
+
+    if (pCommand == nullptr) return;
+
+    pCommand->m_pHandles[0] = _pTexture;
+    pCommand->m_Values[0]   = _Depth;
+}
+
+// -----------------------------------------------------------------------------
+
+void CSoftwareDevice::DrawMesh(gfx::BHandle _pCommandList, gfx::BHandle _pMesh)
+{
+    SSoftwareCommand* pCommand = Record(_pCommandList, SSoftwareCommand::DrawMesh);
+
+    if (pCommand == nullptr) return;
+
+    pCommand->m_pHandles[0] = _pMesh;
+}
+
+// -----------------------------------------------------------------------------
+
+SSoftwareCommand* CSoftwareDevice::Record(gfx::BHandle _pCommandList, SSoftwareCommand::EType _Type)
+{
+    SSoftwareCommandList* pCommandList = static_cast<SSoftwareCommandList*>(_pCommandList);
+
+    if (pCommandList == nullptr) return nullptr;
+
+    SSoftwareCommand Command = {};
+
+    Command.m_Type = _Type;
+
+    pCommandList->m_Commands.push_back(Command);
+
+    return &pCommandList->m_Commands.back();
+}
+
+// -----------------------------------------------------------------------------
+// Executes the submitted lists one after the other until Run stops the
+// thread. Executed lists go back to the pool with their storage.
+// -----------------------------------------------------------------------------
+
+void CSoftwareDevice::RenderLoop()
+{
+    std::unique_lock<std::mutex> Lock(m_Mutex);
+
+    for (;;)
+    {
+        m_SubmitCondition.wait(Lock, [&] { return !m_SubmittedLists.empty() || m_IsStopping; });
+
+        if (m_SubmittedLists.empty()) break;
+
+        SSoftwareCommandList* pCommandList = m_SubmittedLists.front();
+
+        m_SubmittedLists.pop_front();
+
+        m_IsExecuting = true;
+
+        Lock.unlock();
+
+        Execute(*pCommandList);
+
+        pCommandList->m_Commands.clear();
+
+        Lock.lock();
+
+        m_FreeLists.push_back(pCommandList);
+
+        m_IsExecuting = false;
+
+        m_DoneCondition.notify_all();
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+void CSoftwareDevice::Execute(const SSoftwareCommandList& _rCommandList)
+{
+    for (const SSoftwareCommand& rCommand : _rCommandList.m_Commands)
+    {
+        gfx::BHandle pColorTarget = rCommand.m_pHandles[0];
+
+        switch (rCommand.m_Type)
+        {
+            case SSoftwareCommand::SetDepthTest:         SetDepthTest(static_cast<gfx::SDepthTest::ETest>(rCommand.m_Value)); break;
+            case SSoftwareCommand::SetWireFrame:         SetWireFrame(rCommand.m_Value != 0); break;
+            case SSoftwareCommand::SetAlphaBlending:     SetAlphaBlending(rCommand.m_Value != 0); break;
+            case SSoftwareCommand::UploadConstantBuffer: static_cast<SSoftwareConstantBuffer*>(rCommand.m_pHandles[0])->m_pData = rCommand.m_pData; break;
+            case SSoftwareCommand::ResetRenderTargets:   ResetRenderTargets(); break;
+            case SSoftwareCommand::SetRenderTargets:     SetRenderTargets(&pColorTarget, pColorTarget != nullptr ? 1 : 0, rCommand.m_pHandles[1]); break;
+            case SSoftwareCommand::ClearColorTarget:     ClearColorTarget(rCommand.m_pHandles[0], rCommand.m_Values); break;
+            case SSoftwareCommand::ClearDepthTarget:     ClearDepthTarget(rCommand.m_pHandles[0], rCommand.m_Values[0]); break;
+            case SSoftwareCommand::DrawMesh:             DrawMesh(rCommand.m_pHandles[0]); break;
+            case SSoftwareCommand::Present:              Present(rCommand.m_Value); break;
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+void CSoftwareDevice::Present(int _Frame)
+{
+    if (m_pOutputPath != nullptr && *m_pOutputPath != '\0')
+    {
+        std::string Path = GetOutputPath(m_pOutputPath, _Frame);
+
+        if (!WriteSoftwareTexture(m_BackBuffer, Path.c_str()))
+        {
+            std::fprintf(stderr, "Could not write %s\n", Path.c_str());
+        }
+    }
+
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+
+    RetainUploads();
+
+    m_UploadRing.RetireFrame(_Frame);
+
+    m_NumberOfPresentedFrames = _Frame + 1;
+}
+
+// -----------------------------------------------------------------------------
+// Like m_Data of the constant buffer, the upload is padded with zeros to
+// whole float4 registers.
+// -----------------------------------------------------------------------------
+
+const float* CSoftwareDevice::Upload(const SSoftwareConstantBuffer& _rConstantBuffer, const void* _pData)
+{
+    int NumberOfFloats = static_cast<int>(_rConstantBuffer.m_Data.size());
+
+    float* pData = m_UploadRing.Allocate(NumberOfFloats);
+
+    std::memcpy(pData, _pData, _rConstantBuffer.m_NumberOfBytes);
+    std::memset(reinterpret_cast<char*>(pData) + _rConstantBuffer.m_NumberOfBytes, 0, NumberOfFloats * sizeof(float) - _rConstantBuffer.m_NumberOfBytes);
+
+    return pData;
+}
+
+// -----------------------------------------------------------------------------
+// Before the uploads of a frame are reclaimed, the constant buffers still
+// pointing to them get a copy of their own. Buffers uploaded only once stay
+// valid that way, it costs one copy per buffer and frame.
+// -----------------------------------------------------------------------------
+
+void CSoftwareDevice::RetainUploads()
+{
+    for (SSoftwareConstantBuffer* pConstantBuffer : m_ConstantBuffers)
+    {
+        if (pConstantBuffer->m_pData == pConstantBuffer->m_Data.data()) continue;
+
+        std::memcpy(pConstantBuffer->m_Data.data(), pConstantBuffer->m_pData, pConstantBuffer->m_Data.size() * sizeof(float));
+
+        pConstantBuffer->m_pData = pConstantBuffer->m_Data.data();
+    }
+}
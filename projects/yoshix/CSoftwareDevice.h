@@ -0,0 +1,233 @@
+#pragma once
+
+#include "yoshix.h"
+
+#include "CSoftwareRasterizer.h"
+#include "CSoftwareUploadRing.h"
+#include "CTileScheduler.h"
+#include "SoftwareProgram.h"
+#include "SoftwareShader.h"
+#include "SoftwareTexture.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// The objects behind the handles of the gfx functions. Textures and render
+// targets are SSoftwareTexture.
+// -----------------------------------------------------------------------------
+
+struct SSoftwareConstantBuffer
+{
+    int                m_NumberOfBytes;
+    std::vector<float> m_Data;                                  // Rounded up to whole float4 registers.
+    const float*       m_pData;                                 // The last upload, in the upload ring until its frame retires.
+};
+
+struct SSoftwareShader
+{
+    const SSoftwareShaderInfo* m_pInfo;
+    bool                       m_IsVertexShader;
+    SSoftwareProgram*          m_pProgram;                      // Owned, nullptr for the native ports.
+};
+
+struct SSoftwareMaterial
+{
+    int                      m_NumberOfTextures;
+    SSoftwareTexture*        m_pTextures[16];
+    int                      m_NumberOfVertexConstantBuffers;
+    SSoftwareConstantBuffer* m_pVertexConstantBuffers[16];
+    int                      m_NumberOfPixelConstantBuffers;
+    SSoftwareConstantBuffer* m_pPixelConstantBuffers[16];
+    const SSoftwareShader*   m_pVertexShader;
+    const SSoftwareShader*   m_pPixelShader;
+    int                      m_VertexStride;                    // Number of floats of a vertex of a mesh.
+    int                      m_InputOffsets[16];                // Offset of each vertex shader input in a vertex of a mesh.
+    int                      m_InputSizes[16];                  // Number of floats of each vertex shader input the mesh provides.
+};
+
+struct SSoftwareMesh
+{
+    std::vector<float>       m_Vertices;
+    std::vector<int>         m_Indices;
+    int                      m_NumberOfVertices;
+    const SSoftwareMaterial* m_pMaterial;
+};
+
+// -----------------------------------------------------------------------------
+// A command list records the draw calls of a thread. The render thread
+// executes the submitted lists in the order of their submission.
+// -----------------------------------------------------------------------------
+
+struct SSoftwareCommand
+{
+    enum EType
+    {
+        SetDepthTest,
+        SetWireFrame,
+        SetAlphaBlending,
+        UploadConstantBuffer,
+        ResetRenderTargets,
+        SetRenderTargets,
+        ClearColorTarget,
+        ClearDepthTarget,
+        DrawMesh,
+        Present,                                                // Writes the back buffer after a frame.
+    };
+
+    EType        m_Type;
+    gfx::BHandle m_pHandles[2];                                 // Constant buffer, mesh or targets of the command.
+    int          m_Value;                                       // Depth test, flag or number of the frame.
+    float        m_Values[4];                                   // Clear color or depth.
+    const float* m_pData;                                       // Uploaded data, copied into the upload ring when recorded.
+};
+
+struct SSoftwareCommandList
+{
+    std::vector<SSoftwareCommand> m_Commands;
+};
+
+// -----------------------------------------------------------------------------
+// The headless device behind the gfx functions. RunApplication renders a
+// number of frames into an in-memory back buffer instead of a window:
+//
+//   YOSHIX_FRAMES  Number of frames to render before the application is shut
+//                  down, 1 by default. 0 runs until StopApplication or until
+//                  the application returns false.
+//   YOSHIX_OUTPUT  Writes the back buffer as PPM after every frame. A %d in
+//                  the path is replaced by the number of the frame, otherwise
+//                  the file is overwritten and holds the last frame.
+//   YOSHIX_THREADS Number of threads shading the vertices and rasterizing the
+//                  tiles, 0 or unset uses all cores.
+//   YOSHIX_LANES   Widest batch native shaders run on: 8 by default, 4 for
+//                  2x2 quads of pixels and 4 vertices, 1 for single ones.
+//   YOSHIX_COMPILE Set to 1 to compile every shader from its effect. By
+//                  default only shaders without a native port are compiled.
+//
+// The application is never resized after the start and gets no key or mouse
+// events. The time of the frames is printed when the application stops. Only
+// one color target is drawn, SetRenderTargets reports any further ones.
+//
+// While the application runs, a render thread executes the command lists.
+// Any thread records into its own list and submits it without waiting, so
+// the update of the next frame overlaps the rendering of the last one. The
+// application is at most one frame ahead. The gfx functions without a list
+// wait until the submitted lists are done and run on the calling thread.
+//
+// Every upload of a constant buffer gets its own copy in the upload ring, so
+// the draws of a frame see the version uploaded before them. The copies are
+// reclaimed when the frame is presented.
+// -----------------------------------------------------------------------------
+
+class CSoftwareDevice
+{
+public:
+
+    static CSoftwareDevice& GetInstance();
+
+public:
+
+    void Run(int _Width, int _Height, const char* _pTitle, gfx::IApplication* _pApplication);
+    void Stop();
+
+    void SetClearColor(const float* _pColor);
+    void SetDepthTest(gfx::SDepthTest::ETest _Test);
+    void SetWireFrame(bool _Flag);
+    void SetAlphaBlending(bool _Flag);
+
+    gfx::BHandle CreateTexture(const char* _pPath);
+    gfx::BHandle CreateTarget(SSoftwareTexture::EFormat _Format);
+    void ReleaseTexture(gfx::BHandle _pTexture);
+
+    gfx::BHandle CreateConstantBuffer(int _NumberOfBytes);
+    void ReleaseConstantBuffer(gfx::BHandle _pConstantBuffer);
+    void UploadConstantBuffer(const void* _pData, gfx::BHandle _pConstantBuffer);
+
+    gfx::BHandle CreateShader(const char* _pPath, const char* _pShaderName, bool _IsVertexShader);
+    void ReleaseShader(gfx::BHandle _pShader);
+
+    gfx::BHandle CreateMaterial(const gfx::SMaterialInfo& _rMaterialInfo);
+    void ReleaseMaterial(gfx::BHandle _pMaterial);
+
+    gfx::BHandle CreateMesh(const gfx::SMeshInfo& _rMeshInfo);
+    void ReleaseMesh(gfx::BHandle _pMesh);
+
+    void ResetRenderTargets();
+    void SetRenderTargets(gfx::BHandle* _ppColorTargets, int _NumberOfColorTargets, gfx::BHandle _pDepthTarget);
+
+    void ClearColorTarget(gfx::BHandle _pTexture, const float* _pColor);
+    void ClearDepthTarget(gfx::BHandle _pTexture, float _Depth);
+
+    void DrawMesh(gfx::BHandle _pMesh);
+
+    gfx::BHandle CreateCommandList();
+    void ReleaseCommandList(gfx::BHandle _pCommandList);
+
+    void SubmitCommandList(gfx::BHandle _pCommandList);
+    void WaitForCommandLists();
+
+    void SetDepthTest(gfx::BHandle _pCommandList, gfx::SDepthTest::ETest _Test);
+    void SetWireFrame(gfx::BHandle _pCommandList, bool _Flag);
+    void SetAlphaBlending(gfx::BHandle _pCommandList, bool _Flag);
+
+    void UploadConstantBuffer(gfx::BHandle _pCommandList, const void* _pData, gfx::BHandle _pConstantBuffer);
+
+    void ResetRenderTargets(gfx::BHandle _pCommandList);
+    void SetRenderTargets(gfx::BHandle _pCommandList, gfx::BHandle* _ppColorTargets, int _NumberOfColorTargets, gfx::BHandle _pDepthTarget);
+
+    void ClearColorTarget(gfx::BHandle _pCommandList, gfx::BHandle _pTexture, const float* _pColor);
+    void ClearDepthTarget(gfx::BHandle _pCommandList, gfx::BHandle _pTexture, float _Depth);
+
+    void DrawMesh(gfx::BHandle _pCommandList, gfx::BHandle _pMesh);
+
+private:
+
+    CSoftwareDevice();
+    ~CSoftwareDevice();
+
+    CSoftwareDevice(const CSoftwareDevice&) = delete;
+    CSoftwareDevice& operator = (const CSoftwareDevice&) = delete;
+
+private:
+
+    int                                   m_Width;
+    int                                   m_Height;
+    bool                                  m_IsRunning;
+    float                                 m_ClearColor[4];
+    SSoftwareTexture                      m_BackBuffer;
+    SSoftwareTexture                      m_DepthBuffer;
+    SSoftwareRenderState                  m_RenderState;
+    CTileScheduler                        m_Scheduler;              // Shared by the vertex shader and the rasterizer.
+    CSoftwareRasterizer                   m_Rasterizer;
+    int                                   m_NumberOfLanes;
+    bool                                  m_IsCompilingShaders;     // Ignores the native ports.
+    std::vector<float>                    m_VertexOutputs;          // Output of the vertex shader of the current draw.
+    CSoftwareUploadRing                   m_UploadRing;
+    std::vector<SSoftwareConstantBuffer*> m_ConstantBuffers;        // The live ones, guarded by m_Mutex.
+    const char*                           m_pOutputPath;
+    std::thread                           m_RenderThread;
+    std::mutex                            m_Mutex;                  // Guards the lists and the state of the render thread.
+    std::condition_variable               m_SubmitCondition;        // Signaled when a list is submitted or the render thread stops.
+    std::condition_variable               m_DoneCondition;          // Signaled when the render thread finished a list.
+    std::deque<SSoftwareCommandList*>     m_SubmittedLists;
+    std::vector<SSoftwareCommandList*>    m_FreeLists;              // Executed lists, their storage is reused by the next submission.
+    bool                                  m_IsExecuting;
+    bool                                  m_IsStopping;
+    int                                   m_NumberOfPresentedFrames;
+    SSoftwareCommandList                  m_FrameCommands;          // Clear and present the back buffer, recorded by Run.
+
+private:
+
+    int Startup(gfx::IApplication* _pApplication);                                  // Returns the number of steps which succeeded.
+    void Shutdown(gfx::IApplication* _pApplication, int _NumberOfSteps);            // Undoes the first steps of the startup in reverse.
+
+    void RenderLoop();
+    void Execute(const SSoftwareCommandList& _rCommandList);
+    void Present(int _Frame);
+    const float* Upload(const SSoftwareConstantBuffer& _rConstantBuffer, const void* _pData);
+    void RetainUploads();
+    SSoftwareCommand* Record(gfx::BHandle _pCommandList, SSoftwareCommand::EType _Type);
+};
@@ -0,0 +1,947 @@
+#include "CSoftwareRasterizer.h"
+
+#include "SoftwareLanes.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    const int   s_SubPixelBits      = 8;
+    const int   s_SubPixelScale     = 1 << s_SubPixelBits;
+    const int   s_SubPixelHalf      = s_SubPixelScale / 2;
+    const int   s_MaxPolygonSize    = 16;               // A triangle clipped by the six planes has at most nine vertices.
+    const int   s_TrianglesPerChunk = 256;
+    const float s_DepthTolerance    = 1.0e-5f;          // Covers the rounding of the depth of a pixel against the depth range of a block.
+    const int   s_MaxShaderFloats   = 64;               // Larger pixel shader inputs are shaded pixel by pixel.
+
+    // -----------------------------------------------------------------------------
+    // The depth bounds of a block are updated without a lock. That only works
+    // if a block of the depth target is a block of the rasterizer and lies in
+    // a single tile, because the tiles are rasterized at the same time.
+    // -----------------------------------------------------------------------------
+
+    static_assert(SSoftwareTexture::s_DepthBlockSize == CSoftwareRasterizer::s_BlockSize, "Depth blocks have to match the blocks of the rasterizer");
+    static_assert(CSoftwareRasterizer::s_TileSize % CSoftwareRasterizer::s_BlockSize == 0, "Blocks must not straddle tiles");
+
+    // -----------------------------------------------------------------------------
+    // Triangles are clipped against the near and the far plane only. The
+    // planes on the sides are a guard band 16 times the size of the screen,
+    // which keeps the fixed point coordinates of the rasterizer small enough
+    // for the edge functions of a block to fit into 32 bits.
+    // -----------------------------------------------------------------------------
+
+    const float s_GuardBand = 16.0f;
+
+    const float s_ClipPlanes[][4] =
+    {
+        {  0.0f,  0.0f,  1.0f, 0.0f        },           // Near: z >= 0
+        {  0.0f,  0.0f, -1.0f, 1.0f        },           // Far: z <= w
+        {  1.0f,  0.0f,  0.0f, s_GuardBand },
+        { -1.0f,  0.0f,  0.0f, s_GuardBand },
+        {  0.0f,  1.0f,  0.0f, s_GuardBand },
+        {  0.0f, -1.0f,  0.0f, s_GuardBand },
+    };
+
+    const int s_NumberOfClipPlanes = sizeof(s_ClipPlanes) / sizeof(s_ClipPlanes[0]);
+
+    // -----------------------------------------------------------------------------
+
+    float GetPlaneDistance(const float* _pPlane, const float* _pVertex)
+    {
+        return _pPlane[0] * _pVertex[0] + _pPlane[1] * _pVertex[1] + _pPlane[2] * _pVertex[2] + _pPlane[3] * _pVertex[3];
+    }
+
+    // -----------------------------------------------------------------------------
+
+    unsigned int GetOutCode(const float* _pVertex)
+    {
+        unsigned int OutCode = 0;
+
+        for (int IndexOfPlane = 0; IndexOfPlane < s_NumberOfClipPlanes; ++IndexOfPlane)
+        {
+            if (GetPlaneDistance(s_ClipPlanes[IndexOfPlane], _pVertex) < 0.0f) OutCode |= 1u << IndexOfPlane;
+        }
+
+        return OutCode;
+    }
+
+    // -----------------------------------------------------------------------------
+    // A left edge has the triangle on its right, a top edge is horizontal with
+    // the triangle below it. The vertices run clockwise on the screen.
+    // -----------------------------------------------------------------------------
+
+    bool IsTopLeftEdge(long long _DeltaX, long long _DeltaY)
+    {
+        return _DeltaY < 0 || (_DeltaY == 0 && _DeltaX > 0);
+    }
+
+    // -----------------------------------------------------------------------------
+    // The pixels of an 8x8 block inside of the given edges, pixel (i, j) in
+    // bit j * 8 + i. Edge k is _pValues[k] + i * _pStepsX[k] + j * _pStepsY[k]
+    // at pixel (i, j) and the pixel is inside if it is not negative.
+    // -----------------------------------------------------------------------------
+
+    unsigned long long GetBlockCoverage(const int* _pValues, const int* _pStepsX, const int* _pStepsY, int _NumberOfEdges)
+    {
+        unsigned long long Coverage = 0;
+
+#if YOSHIX_SSE2
+        __m128i Left [3];
+        __m128i Right[3];
+        __m128i StepY[3];
+
+        for (int IndexOfEdge = 0; IndexOfEdge < _NumberOfEdges; ++IndexOfEdge)
+        {
+            int Value = _pValues[IndexOfEdge];
+            int StepX = _pStepsX[IndexOfEdge];
+
+            Left [IndexOfEdge] = _mm_setr_epi32(Value, Value + StepX, Value + 2 * StepX, Value + 3 * StepX);
+            Right[IndexOfEdge] = _mm_add_epi32(Left[IndexOfEdge], _mm_set1_epi32(4 * StepX));
+            StepY[IndexOfEdge] = _mm_set1_epi32(_pStepsY[IndexOfEdge]);
+        }
+
+        const __m128i MinusOne = _mm_set1_epi32(-1);
+
+        for (int Row = 0; Row < 8; ++Row)
+        {
+            __m128i LeftInside  = _mm_cmpgt_epi32(Left [0], MinusOne);
+            __m128i RightInside = _mm_cmpgt_epi32(Right[0], MinusOne);
+
+            Left [0] = _mm_add_epi32(Left [0], StepY[0]);
+            Right[0] = _mm_add_epi32(Right[0], StepY[0]);
+
+            for (int IndexOfEdge = 1; IndexOfEdge < _NumberOfEdges; ++IndexOfEdge)
+            {
+                LeftInside  = _mm_and_si128(LeftInside , _mm_cmpgt_epi32(Left [IndexOfEdge], MinusOne));
+                RightInside = _mm_and_si128(RightInside, _mm_cmpgt_epi32(Right[IndexOfEdge], MinusOne));
+
+                Left [IndexOfEdge] = _mm_add_epi32(Left [IndexOfEdge], StepY[IndexOfEdge]);
+                Right[IndexOfEdge] = _mm_add_epi32(Right[IndexOfEdge], StepY[IndexOfEdge]);
+            }
+
+            unsigned int Bits = _mm_movemask_ps(_mm_castsi128_ps(LeftInside)) | _mm_movemask_ps(_mm_castsi128_ps(RightInside)) << 4;
+
+            Coverage |= static_cast<unsigned long long>(Bits) << (8 * Row);
+        }
+#else
+        for (int Row = 0; Row < 8; ++Row)
+        {
+            for (int Column = 0; Column < 8; ++Column)
+            {
+                bool IsInside = true;
+
+                for (int IndexOfEdge = 0; IndexOfEdge < _NumberOfEdges; ++IndexOfEdge)
+                {
+                    IsInside = IsInside && _pValues[IndexOfEdge] + Column * _pStepsX[IndexOfEdge] + Row * _pStepsY[IndexOfEdge] >= 0;
+                }
+
+                if (IsInside) Coverage |= 1ull << (8 * Row + Column);
+            }
+        }
+#endif
+
+        return Coverage;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    int GetLowestBit(unsigned long long _Bits)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_ctzll(_Bits);
+#else
+        int Index = 0;
+
+        while ((_Bits & 1) == 0) { _Bits >>= 1; ++Index; }
+
+        return Index;
+#endif
+    }
+} // namespace
+
+// -----------------------------------------------------------------------------
+
+CSoftwareRasterizer::CSoftwareRasterizer(CTileScheduler& _rScheduler)
+    : m_rScheduler      (_rScheduler)
+    , m_pState          (nullptr)
+    , m_pDraw           (nullptr)
+    , m_pDepthTarget    (nullptr)
+    , m_Width           (0)
+    , m_Height          (0)
+    , m_NumberOfTilesX  (0)
+    , m_NumberOfTilesY  (0)
+    , m_NumberOfVaryings(0)
+    , m_NumberOfChunks  (0)
+    , m_Chunks          ()
+    , m_Threads         (_rScheduler.GetNumberOfThreads())
+{
+}
+
+// -----------------------------------------------------------------------------
+
+CSoftwareRasterizer::~CSoftwareRasterizer()
+{
+}
+
+// -----------------------------------------------------------------------------
+
+void CSoftwareRasterizer::Draw(const SSoftwareRenderState& _rState, const SSoftwareDraw& _rDraw)
+{
+    const SSoftwareTexture* pTarget = _rState.m_pColorTarget != nullptr ? _rState.m_pColorTarget : _rState.m_pDepthTarget;
+
+    if (pTarget == nullptr || _rDraw.m_pPixelShader == nullptr) return;
+
+    int NumberOfTriangles = _rDraw.m_NumberOfIndices / 3;
+
+    if (NumberOfTriangles == 0) return;
+
+    m_pState           = &_rState;
+    m_pDraw            = &_rDraw;
+    m_pDepthTarget     = _rState.m_DepthTest != gfx::SDepthTest::Off ? _rState.m_pDepthTarget : nullptr;
+    m_Width            = pTarget->m_Width;
+    m_Height           = pTarget->m_Height;
+    m_NumberOfTilesX   = (m_Width  + s_TileSize - 1) / s_TileSize;
+    m_NumberOfTilesY   = (m_Height + s_TileSize - 1) / s_TileSize;
+    m_NumberOfVaryings = _rDraw.m_VertexStride - 4;
+    m_NumberOfChunks   = (NumberOfTriangles + s_TrianglesPerChunk - 1) / s_TrianglesPerChunk;
+
+    if (static_cast<int>(m_Chunks.size()) < m_NumberOfChunks) m_Chunks.resize(m_NumberOfChunks);
+
+    for (SThreadData& rThread : m_Threads) rThread.m_PixelInput.resize(_rDraw.m_VertexStride);
+
+    // -----------------------------------------------------------------------------
+    // A small mesh is set up right away instead of waking up the workers.
+    // -----------------------------------------------------------------------------
+    if (m_NumberOfChunks == 1)
+    {
+        SetupChunk(0);
+    }
+    else
+    {
+        m_rScheduler.Run(m_NumberOfChunks, [this](int _IndexOfChunk, int) { SetupChunk(_IndexOfChunk); });
+    }
+
+    m_rScheduler.Run(m_NumberOfTilesX * m_NumberOfTilesY, [this](int _IndexOfTile, int _Thread) { RasterizeTile(_IndexOfTile, _Thread); });
+}
+
+// -----------------------------------------------------------------------------
+
+void CSoftwareRasterizer::SetupChunk(int _IndexOfChunk)
+{
+    SChunk& rChunk = m_Chunks[_IndexOfChunk];
+
+    rChunk.m_Primitives.clear();
+    rChunk.m_Varyings  .clear();
+    rChunk.m_Bins      .resize(m_NumberOfTilesX * m_NumberOfTilesY);
+
+    for (std::vector<int>& rBin : rChunk.m_Bins) rBin.clear();
+
+    rChunk.m_ClipVertices.resize(static_cast<size_t>(s_NumberOfClipPlanes) * s_MaxPolygonSize * m_pDraw->m_VertexStride);
+
+    int FirstIndex = _IndexOfChunk * s_TrianglesPerChunk * 3;
+    int LastIndex  = std::min(FirstIndex + s_TrianglesPerChunk * 3, m_pDraw->m_NumberOfIndices / 3 * 3);
+
+    for (int IndexOfIndex = FirstIndex; IndexOfIndex < LastIndex; IndexOfIndex += 3)
+    {
+        const int* pIndices = m_pDraw->m_pIndices + IndexOfIndex;
+
+        if (pIndices[0] < 0 || pIndices[0] >= m_pDraw->m_NumberOfVertices) continue;
+        if (pIndices[1] < 0 || pIndices[1] >= m_pDraw->m_NumberOfVertices) continue;
+        if (pIndices[2] < 0 || pIndices[2] >= m_pDraw->m_NumberOfVertices) continue;
+
+        SetupTriangle(rChunk,
+            m_pDraw->m_pVertices + static_cast<size_t>(pIndices[0]) * m_pDraw->m_VertexStride,
+            m_pDraw->m_pVertices + static_cast<size_t>(pIndices[1]) * m_pDraw->m_VertexStride,
+            m_pDraw->m_pVertices + static_cast<size_t>(pIndices[2]) * m_pDraw->m_VertexStride);
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+void CSoftwareRasterizer::SetupTriangle(SChunk& _rChunk, const float* _pVertex0, const float* _pVertex1, const float* _pVertex2)
+{
+    // -----------------------------------------------------------------------------
+    // The determinant of x, y and w has the sign of the area of the projected
+    // triangle, even if a vertex is behind the camera. Front faces run counter
+    // clockwise in clip space, which has y pointing up.
+    // -----------------------------------------------------------------------------
+    double Determinant =
+        static_cast<double>(_pVertex0[0]) * (static_cast<double>(_pVertex1[1]) * _pVertex2[3] - static_cast<double>(_pVertex2[1]) * _pVertex1[3]) -
+        static_cast<double>(_pVertex0[1]) * (static_cast<double>(_pVertex1[0]) * _pVertex2[3] - static_cast<double>(_pVertex2[0]) * _pVertex1[3]) +
+        static_cast<double>(_pVertex0[3]) * (static_cast<double>(_pVertex1[0]) * _pVertex2[1] - static_cast<double>(_pVertex2[0]) * _pVertex1[1]);
+
+    if (!(Determinant > 0.0)) return;
+
+    unsigned int OutCode0 = GetOutCode(_pVertex0);
+    unsigned int OutCode1 = GetOutCode(_pVertex1);
+    unsigned int OutCode2 = GetOutCode(_pVertex2);
+
+    const float* Polygons[2][s_MaxPolygonSize] = { { _pVertex0, _pVertex1, _pVertex2 } };
+
+    if ((OutCode0 | OutCode1 | OutCode2) == 0)
+    {
+        SetupPolygon(_rChunk, Polygons[0], 3);
+
+        return;
+    }
+
+    if ((OutCode0 & OutCode1 & OutCode2) != 0) return;
+
+    // -----------------------------------------------------------------------------
+    // Sutherland-Hodgman against the planes at least one vertex is outside of.
+    // -----------------------------------------------------------------------------
+    int    NumberOfVertices = 3;
+    int    IndexOfPolygon   = 0;
+    float* pClipVertex      = _rChunk.m_ClipVertices.data();
+    int    Stride           = m_pDraw->m_VertexStride;
+
+    for (int IndexOfPlane = 0; IndexOfPlane < s_NumberOfClipPlanes; ++IndexOfPlane)
+    {
+        if (((OutCode0 | OutCode1 | OutCode2) & (1u << IndexOfPlane)) == 0) continue;
+
+        const float*        pPlane   = s_ClipPlanes[IndexOfPlane];
+        const float* const* pInput   = Polygons[IndexOfPolygon];
+        const float**       pOutput  = Polygons[1 - IndexOfPolygon];
+        int                 NumberOfOutputVertices = 0;
+
+        for (int IndexOfVertex = 0; IndexOfVertex < NumberOfVertices; ++IndexOfVertex)
+        {
+            const float* pStart = pInput[IndexOfVertex];
+            const float* pEnd   = pInput[(IndexOfVertex + 1) % NumberOfVertices];
+
+            float StartDistance = GetPlaneDistance(pPlane, pStart);
+            float EndDistance   = GetPlaneDistance(pPlane, pEnd);
+
+            if (StartDistance >= 0.0f) pOutput[NumberOfOutputVertices++] = pStart;
+
+            if ((StartDistance >= 0.0f) != (EndDistance >= 0.0f))
+            {
+                float Interpolation = StartDistance / (StartDistance - EndDistance);
+
+                for (int IndexOfFloat = 0; IndexOfFloat < Stride; ++IndexOfFloat)
+                {
+                    pClipVertex[IndexOfFloat] = pStart[IndexOfFloat] + (pEnd[IndexOfFloat] - pStart[IndexOfFloat]) * Interpolation;
+                }
+
+                pOutput[NumberOfOutputVertices++] = pClipVertex;
+
+                pClipVertex += Stride;
+            }
+        }
+
+        NumberOfVertices = NumberOfOutputVertices;
+        IndexOfPolygon   = 1 - IndexOfPolygon;
+
+        if (NumberOfVertices < 3) return;
+    }
+
+    SetupPolygon(_rChunk, Polygons[IndexOfPolygon], NumberOfVertices);
+}
+
+// -----------------------------------------------------------------------------
+// Splits the clipped polygon into a fan of triangles, or into its edges for a
+// wire frame.
+// -----------------------------------------------------------------------------
+
+void CSoftwareRasterizer::SetupPolygon(SChunk& _rChunk, const float* const* _ppVertices, int _NumberOfVertices)
+{
+    long long X      [s_MaxPolygonSize];
+    long long Y      [s_MaxPolygonSize];
+    float     ScreenX[s_MaxPolygonSize];
+    float     ScreenY[s_MaxPolygonSize];
+    float     InvW   [s_MaxPolygonSize];
+
+    for (int IndexOfVertex = 0; IndexOfVertex < _NumberOfVertices; ++IndexOfVertex)
+    {
+        const float* pVertex = _ppVertices[IndexOfVertex];
+
+        InvW   [IndexOfVertex] = 1.0f / pVertex[3];
+        ScreenX[IndexOfVertex] = (pVertex[0] * InvW[IndexOfVertex] *  0.5f + 0.5f) * m_Width;
+        ScreenY[IndexOfVertex] = (pVertex[1] * InvW[IndexOfVertex] * -0.5f + 0.5f) * m_Height;
+        X      [IndexOfVertex] = std::llround(ScreenX[IndexOfVertex] * s_SubPixelScale);
+        Y      [IndexOfVertex] = std::llround(ScreenY[IndexOfVertex] * s_SubPixelScale);
+    }
+
+    bool IsWireFrame = m_pState->m_IsWireFrame;
+
+    int NumberOfPrimitives = IsWireFrame ? _NumberOfVertices : _NumberOfVertices - 2;
+
+    for (int IndexOfPrimitive = 0; IndexOfPrimitive < NumberOfPrimitives; ++IndexOfPrimitive)
+    {
+        SPrimitive Primitive;
+
+        int Vertices[3];
+
+        if (IsWireFrame)
+        {
+            Vertices[0] = IndexOfPrimitive;
+            Vertices[1] = (IndexOfPrimitive + 1) % _NumberOfVertices;
+
+            Primitive.m_NumberOfVertices = 2;
+            Primitive.m_InvArea          = 0.0;
+        }
+        else
+        {
+            // -----------------------------------------------------------------------------
+            // Front faces run counter clockwise on the screen, so their area is
+            // negative with y pointing down. Snapping might have flipped or
+            // collapsed the triangle. The vertices are stored clockwise.
+            // -----------------------------------------------------------------------------
+            int Vertex1 = IndexOfPrimitive + 1;
+            int Vertex2 = IndexOfPrimitive + 2;
+
+            long long Area = (X[Vertex1] - X[0]) * (Y[Vertex2] - Y[0]) - (X[Vertex2] - X[0]) * (Y[Vertex1] - Y[0]);
+
+            if (Area >= 0) continue;
+
+            Vertices[0] = 0;
+            Vertices[1] = Vertex2;
+            Vertices[2] = Vertex1;
+
+            Primitive.m_NumberOfVertices = 3;
+            Primitive.m_InvArea          = 1.0 / static_cast<double>(-Area);
+        }
+
+        float MinX = ScreenX[Vertices[0]];
+        float MaxX = ScreenX[Vertices[0]];
+        float MinY = ScreenY[Vertices[0]];
+        float MaxY = ScreenY[Vertices[0]];
+
+        Primitive.m_IndexOfVaryings = _rChunk.m_Varyings.size();
+
+        for (int IndexOfVertex = 0; IndexOfVertex < Primitive.m_NumberOfVertices; ++IndexOfVertex)
+        {
+            int          Vertex  = Vertices[IndexOfVertex];
+            const float* pVertex = _ppVertices[Vertex];
+
+            Primitive.m_X      [IndexOfVertex] = X[Vertex];
+            Primitive.m_Y      [IndexOfVertex] = Y[Vertex];
+            Primitive.m_ScreenX[IndexOfVertex] = ScreenX[Vertex];
+            Primitive.m_ScreenY[IndexOfVertex] = ScreenY[Vertex];
+            Primitive.m_Z      [IndexOfVertex] = pVertex[2] * InvW[Vertex];
+            Primitive.m_InvW   [IndexOfVertex] = InvW[Vertex];
+
+            MinX = std::min(MinX, ScreenX[Vertex]);
+            MaxX = std::max(MaxX, ScreenX[Vertex]);
+            MinY = std::min(MinY, ScreenY[Vertex]);
+            MaxY = std::max(MaxY, ScreenY[Vertex]);
+
+            for (int IndexOfVarying = 0; IndexOfVarying < m_NumberOfVaryings; ++IndexOfVarying)
+            {
+                _rChunk.m_Varyings.push_back(pVertex[4 + IndexOfVarying] * InvW[Vertex]);
+            }
+        }
+
+        // -----------------------------------------------------------------------------
+        // The bounding box is a pixel larger than needed, the edge functions
+        // decide about the pixels on its border.
+        // -----------------------------------------------------------------------------
+        Primitive.m_MinX = std::max(static_cast<int>(std::floor(MinX)) - 1, 0);
+        Primitive.m_MinY = std::max(static_cast<int>(std::floor(MinY)) - 1, 0);
+        Primitive.m_MaxX = std::min(static_cast<int>(std::floor(MaxX)) + 1, m_Width  - 1);
+        Primitive.m_MaxY = std::min(static_cast<int>(std::floor(MaxY)) + 1, m_Height - 1);
+
+        if (Primitive.m_MinX > Primitive.m_MaxX || Primitive.m_MinY > Primitive.m_MaxY)
+        {
+            _rChunk.m_Varyings.resize(Primitive.m_IndexOfVaryings);
+
+            continue;
+        }
+
+        _rChunk.m_Primitives.push_back(Primitive);
+
+        BinPrimitive(_rChunk, Primitive);
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+void CSoftwareRasterizer::BinPrimitive(SChunk& _rChunk, const SPrimitive& _rPrimitive)
+{
+    int IndexOfPrimitive = static_cast<int>(_rChunk.m_Primitives.size()) - 1;
+
+    for (int TileY = _rPrimitive.m_MinY / s_TileSize; TileY <= _rPrimitive.m_MaxY / s_TileSize; ++TileY)
+    {
+        for (int TileX = _rPrimitive.m_MinX / s_TileSize; TileX <= _rPrimitive.m_MaxX / s_TileSize; ++TileX)
+        {
+            _rChunk.m_Bins[TileY * m_NumberOfTilesX + TileX].push_back(IndexOfPrimitive);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+void CSoftwareRasterizer::RasterizeTile(int _IndexOfTile, int _Thread)
+{
+    int TileMinX = _IndexOfTile % m_NumberOfTilesX * s_TileSize;
+    int TileMinY = _IndexOfTile / m_NumberOfTilesX * s_TileSize;
+    int TileMaxX = std::min(TileMinX + s_TileSize, m_Width ) - 1;
+    int TileMaxY = std::min(TileMinY + s_TileSize, m_Height) - 1;
+
+    for (int IndexOfChunk = 0; IndexOfChunk < m_NumberOfChunks; ++IndexOfChunk)
+    {
+        const SChunk& rChunk = m_Chunks[IndexOfChunk];
+
+        for (int IndexOfPrimitive : rChunk.m_Bins[_IndexOfTile])
+        {
+            const SPrimitive& rPrimitive = rChunk.m_Primitives[IndexOfPrimitive];
+
+            int MinX = std::max(rPrimitive.m_MinX, TileMinX);
+            int MinY = std::max(rPrimitive.m_MinY, TileMinY);
+            int MaxX = std::min(rPrimitive.m_MaxX, TileMaxX);
+            int MaxY = std::min(rPrimitive.m_MaxY, TileMaxY);
+
+            if (rPrimitive.m_NumberOfVertices == 3) FillTriangle(rChunk, rPrimitive, MinX, MinY, MaxX, MaxY, _Thread);
+            else                                    DrawLine    (rChunk, rPrimitive, MinX, MinY, MaxX, MaxY, _Thread);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+// The edge function of the edge from A to B is positive for the points on
+// its right side on the screen, i.e. inside of a clockwise triangle. It is
+// evaluated exactly on the snapped coordinates, which makes the coverage of
+// two triangles sharing an edge watertight.
+//
+// Within a block the edge function only changes by multiples of 256, so
+// dividing its value at the first pixel by 256, rounding down, keeps the sign
+// of every pixel. For an edge crossing the block the quotients fit into 32
+// bits, edges which do not cross the block decide it as a whole.
+// -----------------------------------------------------------------------------
+
+void CSoftwareRasterizer::FillTriangle(const SChunk& _rChunk, const SPrimitive& _rTriangle, int _MinX, int _MinY, int _MaxX, int _MaxY, int _Thread)
+{
+    long long DeltasX[3];
+    long long DeltasY[3];
+    long long StepsX [3];
+    long long StepsY [3];
+    long long Biases [3];
+
+    for (int IndexOfEdge = 0; IndexOfEdge < 3; ++IndexOfEdge)
+    {
+        int Start = (IndexOfEdge + 1) % 3;
+        int End   = (IndexOfEdge + 2) % 3;
+
+        DeltasX[IndexOfEdge] = _rTriangle.m_X[End] - _rTriangle.m_X[Start];
+        DeltasY[IndexOfEdge] = _rTriangle.m_Y[End] - _rTriangle.m_Y[Start];
+        StepsX [IndexOfEdge] = -DeltasY[IndexOfEdge] * s_SubPixelScale;
+        StepsY [IndexOfEdge] =  DeltasX[IndexOfEdge] * s_SubPixelScale;
+        Biases [IndexOfEdge] = IsTopLeftEdge(DeltasX[IndexOfEdge], DeltasY[IndexOfEdge]) ? 0 : -1;
+    }
+
+    // -----------------------------------------------------------------------------
+    // The depth is linear on the screen, so its range on a block lies between
+    // its values at the corners of the block. It never leaves the range of
+    // the vertices inside the triangle.
+    // -----------------------------------------------------------------------------
+    double DepthStepX = 0.0;
+    double DepthStepY = 0.0;
+
+    for (int IndexOfVertex = 0; IndexOfVertex < 3; ++IndexOfVertex)
+    {
+        DepthStepX += StepsX[IndexOfVertex] * _rTriangle.m_InvArea * _rTriangle.m_Z[IndexOfVertex];
+        DepthStepY += StepsY[IndexOfVertex] * _rTriangle.m_InvArea * _rTriangle.m_Z[IndexOfVertex];
+    }
+
+    double DepthRangeX = (s_BlockSize - 1) * DepthStepX;
+    double DepthRangeY = (s_BlockSize - 1) * DepthStepY;
+
+    float MinVertexDepth = std::min(std::min(_rTriangle.m_Z[0], _rTriangle.m_Z[1]), _rTriangle.m_Z[2]);
+    float MaxVertexDepth = std::max(std::max(_rTriangle.m_Z[0], _rTriangle.m_Z[1]), _rTriangle.m_Z[2]);
+
+    bool IsLesser = m_pState->m_DepthTest == gfx::SDepthTest::Lesser;
+
+    const float* pVaryings = _rChunk.m_Varyings.data() + _rTriangle.m_IndexOfVaryings;
+
+    for (int BlockY = _MinY & ~(s_BlockSize - 1); BlockY <= _MaxY; BlockY += s_BlockSize)
+    {
+        // -----------------------------------------------------------------------------
+        // The rows of the block inside the rectangle.
+        // -----------------------------------------------------------------------------
+        int FirstRow = std::max(_MinY - BlockY, 0);
+        int LastRow  = std::min(_MaxY - BlockY, s_BlockSize - 1);
+
+        unsigned long long RowMask = (~0ull << (8 * FirstRow)) & (~0ull >> (8 * (7 - LastRow)));
+
+        for (int BlockX = _MinX & ~(s_BlockSize - 1); BlockX <= _MaxX; BlockX += s_BlockSize)
+        {
+            int FirstColumn = std::max(_MinX - BlockX, 0);
+            int LastColumn  = std::min(_MaxX - BlockX, s_BlockSize - 1);
+
+            unsigned long long ColumnMask = ((0xffu << FirstColumn) & (0xffu >> (7 - LastColumn))) * 0x0101010101010101ull;
+
+            long long PixelX = (static_cast<long long>(BlockX) << s_SubPixelBits) + s_SubPixelHalf;
+            long long PixelY = (static_cast<long long>(BlockY) << s_SubPixelBits) + s_SubPixelHalf;
+
+            long long Values[3];
+
+            int QuotientValues[3];
+            int QuotientStepsX[3];
+            int QuotientStepsY[3];
+            int NumberOfCrossingEdges = 0;
+            bool IsOutside = false;
+
+            for (int IndexOfEdge = 0; IndexOfEdge < 3 && !IsOutside; ++IndexOfEdge)
+            {
+                int Start = (IndexOfEdge + 1) % 3;
+
+                Values[IndexOfEdge] = DeltasX[IndexOfEdge] * (PixelY - _rTriangle.m_Y[Start]) - DeltasY[IndexOfEdge] * (PixelX - _rTriangle.m_X[Start]);
+
+                long long Value   = Values[IndexOfEdge] + Biases[IndexOfEdge];
+                long long Minimum = Value + std::min(StepsX[IndexOfEdge], 0LL) * 7 + std::min(StepsY[IndexOfEdge], 0LL) * 7;
+                long long Maximum = Value + std::max(StepsX[IndexOfEdge], 0LL) * 7 + std::max(StepsY[IndexOfEdge], 0LL) * 7;
+
+                if (Maximum < 0)
+                {
+                    IsOutside = true;
+                }
+                else if (Minimum < 0)
+                {
+                    QuotientValues[NumberOfCrossingEdges] = static_cast<int>(Value >> s_SubPixelBits);
+                    QuotientStepsX[NumberOfCrossingEdges] = static_cast<int>(-DeltasY[IndexOfEdge]);
+                    QuotientStepsY[NumberOfCrossingEdges] = static_cast<int>( DeltasX[IndexOfEdge]);
+
+                    ++NumberOfCrossingEdges;
+                }
+            }
+
+            if (IsOutside) continue;
+
+            unsigned long long Coverage = RowMask & ColumnMask;
+
+            if (NumberOfCrossingEdges > 0) Coverage &= GetBlockCoverage(QuotientValues, QuotientStepsX, QuotientStepsY, NumberOfCrossingEdges);
+
+            if (Coverage == 0) continue;
+
+            bool IsAccepted = false;
+
+            if (m_pDepthTarget != nullptr)
+            {
+                double Depth = 0.0;
+
+                for (int IndexOfVertex = 0; IndexOfVertex < 3; ++IndexOfVertex)
+                {
+                    Depth += Values[IndexOfVertex] * _rTriangle.m_InvArea * _rTriangle.m_Z[IndexOfVertex];
+                }
+
+                double MinDepth = Depth + std::min(DepthRangeX, 0.0) + std::min(DepthRangeY, 0.0);
+                double MaxDepth = Depth + std::max(DepthRangeX, 0.0) + std::max(DepthRangeY, 0.0);
+
+                float MinBlockDepth = std::max(static_cast<float>(MinDepth), MinVertexDepth) - s_DepthTolerance;
+                float MaxBlockDepth = std::min(static_cast<float>(MaxDepth), MaxVertexDepth) + s_DepthTolerance;
+
+                size_t IndexOfDepthBlock = static_cast<size_t>(BlockY / s_BlockSize) * m_pDepthTarget->m_NumberOfBlocksX + BlockX / s_BlockSize;
+
+                float MinTargetDepth = m_pDepthTarget->m_MinDepths[IndexOfDepthBlock];
+                float MaxTargetDepth = m_pDepthTarget->m_MaxDepths[IndexOfDepthBlock];
+
+                if (IsLesser)
+                {
+                    if (MinBlockDepth >= MaxTargetDepth) continue;
+
+                    IsAccepted = MaxBlockDepth < MinTargetDepth;
+                }
+                else
+                {
+                    if (MaxBlockDepth < MinTargetDepth || MinBlockDepth > MaxTargetDepth) continue;
+                }
+            }
+
+            // -----------------------------------------------------------------------------
+            // All pixels are depth tested before the block is shaded, no pixel
+            // of a triangle hides another one.
+            // -----------------------------------------------------------------------------
+            SThreadData& rThread = m_Threads[_Thread];
+
+            unsigned long long Visible = 0;
+
+            for (; Coverage != 0; Coverage &= Coverage - 1)
+            {
+                int Bit    = GetLowestBit(Coverage);
+                int Column = Bit & 7;
+                int Row    = Bit >> 3;
+
+                for (int IndexOfEdge = 0; IndexOfEdge < 3; ++IndexOfEdge)
+                {
+                    rThread.m_Weights[IndexOfEdge][Bit] = static_cast<float>(static_cast<double>(Values[IndexOfEdge] + Column * StepsX[IndexOfEdge] + Row * StepsY[IndexOfEdge]) * _rTriangle.m_InvArea);
+                }
+
+                float W0 = rThread.m_Weights[0][Bit];
+                float W1 = rThread.m_Weights[1][Bit];
+                float W2 = rThread.m_Weights[2][Bit];
+
+                float Z = W0 * _rTriangle.m_Z[0] + W1 * _rTriangle.m_Z[1] + W2 * _rTriangle.m_Z[2];
+
+                if (!TestDepth(BlockX + Column, BlockY + Row, Z, IsAccepted)) continue;
+
+                rThread.m_Z   [Bit] = Z;
+                rThread.m_InvW[Bit] = W0 * _rTriangle.m_InvW[0] + W1 * _rTriangle.m_InvW[1] + W2 * _rTriangle.m_InvW[2];
+
+                Visible |= 1ull << Bit;
+            }
+
+            if (Visible == 0) continue;
+
+            // -----------------------------------------------------------------------------
+            // The maximum only shrinks with the Lesser test and is recomputed,
+            // the Equal test writes the depths it found.
+            // -----------------------------------------------------------------------------
+            if (m_pDepthTarget != nullptr && IsLesser)
+            {
+                UpdateSoftwareDepthBlock(m_pDepthTarget, BlockX / s_BlockSize, BlockY / s_BlockSize);
+            }
+
+            ShadeBlock(BlockX, BlockY, Visible, pVaryings, _Thread);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Wire frames step through the pixels of the longer axis of an edge. Every
+// tile the edge overlaps walks the whole edge and keeps its own pixels.
+// -----------------------------------------------------------------------------
+
+void CSoftwareRasterizer::DrawLine(const SChunk& _rChunk, const SPrimitive& _rLine, int _MinX, int _MinY, int _MaxX, int _MaxY, int _Thread)
+{
+    const float* pVaryings = _rChunk.m_Varyings.data() + _rLine.m_IndexOfVaryings;
+
+    float DeltaX = _rLine.m_ScreenX[1] - _rLine.m_ScreenX[0];
+    float DeltaY = _rLine.m_ScreenY[1] - _rLine.m_ScreenY[0];
+
+    int NumberOfSteps = static_cast<int>(std::ceil(std::max(std::fabs(DeltaX), std::fabs(DeltaY))));
+
+    for (int Step = 0; Step <= NumberOfSteps; ++Step)
+    {
+        float Interpolation = NumberOfSteps > 0 ? static_cast<float>(Step) / NumberOfSteps : 0.0f;
+
+        int X = static_cast<int>(std::floor(_rLine.m_ScreenX[0] + DeltaX * Interpolation));
+        int Y = static_cast<int>(std::floor(_rLine.m_ScreenY[0] + DeltaY * Interpolation));
+
+        if (X < _MinX || X > _MaxX || Y < _MinY || Y > _MaxY) continue;
+
+        float Weights[2] = { 1.0f - Interpolation, Interpolation };
+
+        float Z    = Weights[0] * _rLine.m_Z   [0] + Weights[1] * _rLine.m_Z   [1];
+        float InvW = Weights[0] * _rLine.m_InvW[0] + Weights[1] * _rLine.m_InvW[1];
+
+        if (!TestDepth(X, Y, Z, false)) continue;
+
+        ShadePixel(X, Y, Z, InvW, Weights, pVaryings, 2, _Thread);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// The depth test runs before the pixel shader, none of the shaders writes
+// the depth or discards a pixel. A pixel which passes writes its depth and
+// lowers the minimum of its block, which keeps the bounds conservative.
+// -----------------------------------------------------------------------------
+
+bool CSoftwareRasterizer::TestDepth(int _X, int _Y, float _Z, bool _IsAccepted)
+{
+    if (m_pDepthTarget == nullptr) return true;
+
+    float& rDepth = m_pDepthTarget->m_Depths[static_cast<size_t>(_Y) * m_pDepthTarget->m_Width + _X];
+
+    if (!_IsAccepted)
+    {
+        bool IsVisible = m_pState->m_DepthTest == gfx::SDepthTest::Lesser ? _Z < rDepth : _Z == rDepth;
+
+        if (!IsVisible) return false;
+    }
+
+    rDepth = _Z;
+
+    float& rMinDepth = m_pDepthTarget->m_MinDepths[static_cast<size_t>(_Y / s_BlockSize) * m_pDepthTarget->m_NumberOfBlocksX + _X / s_BlockSize];
+
+    rMinDepth = std::min(rMinDepth, _Z);
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+void CSoftwareRasterizer::ShadeBlock(int _BlockX, int _BlockY, unsigned long long _Mask, const float* _pVaryings, int _Thread)
+{
+    if (m_pState->m_pColorTarget == nullptr) return;
+
+    const SSoftwareShaderInfo& rShader = *m_pDraw->m_pPixelShader;
+
+    int Pixels[8];
+
+    if (m_pDraw->m_VertexStride <= s_MaxShaderFloats && m_pDraw->m_NumberOfLanes >= 8 && rShader.m_pFunction8 != nullptr)
+    {
+        for (int Row = 0; Row < s_BlockSize; ++Row)
+        {
+            unsigned int RowMask = static_cast<unsigned int>(_Mask >> (8 * Row)) & 0xff;
+
+            if (RowMask == 0) continue;
+
+            for (int Lane = 0; Lane < 8; ++Lane) Pixels[Lane] = (RowMask & (1u << Lane)) != 0 ? 8 * Row + Lane : -1;
+
+            ShadeBatch<SSoftwareFloat8>(rShader.m_pFunction8, _BlockX, _BlockY, Pixels, _pVaryings, _Thread);
+        }
+    }
+    else if (m_pDraw->m_VertexStride <= s_MaxShaderFloats && m_pDraw->m_NumberOfLanes >= 4 && rShader.m_pFunction4 != nullptr)
+    {
+        for (int QuadY = 0; QuadY < s_BlockSize; QuadY += 2)
+        {
+            for (int QuadX = 0; QuadX < s_BlockSize; QuadX += 2)
+            {
+                bool IsVisible = false;
+
+                for (int Lane = 0; Lane < 4; ++Lane)
+                {
+                    int Bit = 8 * (QuadY + Lane / 2) + QuadX + Lane % 2;
+
+                    Pixels[Lane] = (_Mask & (1ull << Bit)) != 0 ? Bit : -1;
+
+                    IsVisible = IsVisible || Pixels[Lane] >= 0;
+                }
+
+                if (IsVisible) ShadeBatch<SSoftwareFloat4>(rShader.m_pFunction4, _BlockX, _BlockY, Pixels, _pVaryings, _Thread);
+            }
+        }
+    }
+    else
+    {
+        const SThreadData& rThread = m_Threads[_Thread];
+
+        for (; _Mask != 0; _Mask &= _Mask - 1)
+        {
+            int Bit = GetLowestBit(_Mask);
+
+            float Weights[3] = { rThread.m_Weights[0][Bit], rThread.m_Weights[1][Bit], rThread.m_Weights[2][Bit] };
+
+            ShadePixel(_BlockX + (Bit & 7), _BlockY + (Bit >> 3), rThread.m_Z[Bit], rThread.m_InvW[Bit], Weights, _pVaryings, 3, _Thread);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Interpolates the varyings of the pixels of a batch in the same order of
+// operations as ShadePixel, so both produce the same colors.
+// -----------------------------------------------------------------------------
+
+template <typename TFloat, typename TShader>
+void CSoftwareRasterizer::ShadeBatch(TShader _pShader, int _BlockX, int _BlockY, const int* _pPixels, const float* _pVaryings, int _Thread)
+{
+    const int NumberOfLanes = TFloat::s_NumberOfLanes;
+
+    const SThreadData& rThread = m_Threads[_Thread];
+
+    int FirstPixel = 0;
+
+    while (_pPixels[FirstPixel] < 0) ++FirstPixel;
+
+    float Lanes[7][NumberOfLanes];
+
+    for (int Lane = 0; Lane < NumberOfLanes; ++Lane)
+    {
+        int Bit = _pPixels[Lane] >= 0 ? _pPixels[Lane] : _pPixels[FirstPixel];
+
+        Lanes[0][Lane] = _BlockX + (Bit & 7) + 0.5f;
+        Lanes[1][Lane] = _BlockY + (Bit >> 3) + 0.5f;
+        Lanes[2][Lane] = rThread.m_Z[Bit];
+        Lanes[3][Lane] = 1.0f / rThread.m_InvW[Bit];
+        Lanes[4][Lane] = rThread.m_Weights[0][Bit];
+        Lanes[5][Lane] = rThread.m_Weights[1][Bit];
+        Lanes[6][Lane] = rThread.m_Weights[2][Bit];
+    }
+
+    TFloat Inputs[s_MaxShaderFloats];
+
+    for (int Component = 0; Component < 4; ++Component) Inputs[Component] = TFloat::Load(Lanes[Component]);
+
+    TFloat Weight0 = TFloat::Load(Lanes[4]);
+    TFloat Weight1 = TFloat::Load(Lanes[5]);
+    TFloat Weight2 = TFloat::Load(Lanes[6]);
+
+    const float* pVaryings0 = _pVaryings;
+    const float* pVaryings1 = _pVaryings + m_NumberOfVaryings;
+    const float* pVaryings2 = _pVaryings + 2 * m_NumberOfVaryings;
+
+    for (int IndexOfVarying = 0; IndexOfVarying < m_NumberOfVaryings; ++IndexOfVarying)
+    {
+        TFloat Varying = Weight0 * pVaryings0[IndexOfVarying] + Weight1 * pVaryings1[IndexOfVarying] + Weight2 * pVaryings2[IndexOfVarying];
+
+        Inputs[4 + IndexOfVarying] = Varying * Inputs[3];
+    }
+
+    TFloat Outputs[4];
+
+    _pShader(*m_pDraw->m_pPixelContext, Inputs, Outputs);
+
+    float Colors[4][NumberOfLanes];
+
+    for (int Channel = 0; Channel < 4; ++Channel) Outputs[Channel].Store(Colors[Channel]);
+
+    for (int Lane = 0; Lane < NumberOfLanes; ++Lane)
+    {
+        int Bit = _pPixels[Lane];
+
+        if (Bit < 0) continue;
+
+        float Color[4] = { Colors[0][Lane], Colors[1][Lane], Colors[2][Lane], Colors[3][Lane] };
+
+        WritePixel(_BlockX + (Bit & 7), _BlockY + (Bit >> 3), Color);
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+void CSoftwareRasterizer::ShadePixel(int _X, int _Y, float _Z, float _InvW, const float* _pWeights, const float* _pVaryings, int _NumberOfVertices, int _Thread)
+{
+    if (m_pState->m_pColorTarget == nullptr) return;
+
+    float* pInput = m_Threads[_Thread].m_PixelInput.data();
+    float  W      = 1.0f / _InvW;
+
+    pInput[0] = _X + 0.5f;
+    pInput[1] = _Y + 0.5f;
+    pInput[2] = _Z;
+    pInput[3] = W;
+
+    for (int IndexOfVarying = 0; IndexOfVarying < m_NumberOfVaryings; ++IndexOfVarying)
+    {
+        float Varying = 0.0f;
+
+        for (int IndexOfVertex = 0; IndexOfVertex < _NumberOfVertices; ++IndexOfVertex)
+        {
+            Varying += _pWeights[IndexOfVertex] * _pVaryings[IndexOfVertex * m_NumberOfVaryings + IndexOfVarying];
+        }
+
+        pInput[4 + IndexOfVarying] = Varying * W;
+    }
+
+    float Color[4];
+
+    m_pDraw->m_pPixelShader->m_pFunction(*m_pDraw->m_pPixelContext, pInput, Color);
+
+    WritePixel(_X, _Y, Color);
+}
+
+// -----------------------------------------------------------------------------
+
+void CSoftwareRasterizer::WritePixel(int _X, int _Y, float* _pColor)
+{
+    SSoftwareTexture* pColorTarget = m_pState->m_pColorTarget;
+
+    unsigned int& rColor = pColorTarget->m_Colors[static_cast<size_t>(_Y) * pColorTarget->m_Width + _X];
+
+    if (m_pState->m_IsAlphaBlending)
+    {
+        float Destination[4];
+
+        UnpackSoftwareColor(rColor, Destination);
+
+        float Alpha = std::min(std::max(_pColor[3], 0.0f), 1.0f);
+
+        for (int Channel = 0; Channel < 4; ++Channel)
+        {
+            _pColor[Channel] = _pColor[Channel] * Alpha + Destination[Channel] * (1.0f - Alpha);
+        }
+    }
+
+    rColor = PackSoftwareColor(_pColor);
+}
@@ -0,0 +1,156 @@
+#pragma once
+
+#include "yoshix.h"
+
+#include "CTileScheduler.h"
+#include "SoftwareShader.h"
+#include "SoftwareTexture.h"
+
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// The output merger state of a draw. The pixel shader only writes SV_Target0,
+// so only the first color target of gfx::SetRenderTargets is drawn to.
+// -----------------------------------------------------------------------------
+
+struct SSoftwareRenderState
+{
+    SSoftwareTexture*       m_pColorTarget;                 // Might be nullptr for a depth only pass.
+    SSoftwareTexture*       m_pDepthTarget;                 // Might be nullptr, the depth test is off then.
+    gfx::SDepthTest::ETest  m_DepthTest;
+    bool                    m_IsWireFrame;
+    bool                    m_IsAlphaBlending;              // Source alpha and inverse source alpha.
+};
+
+// -----------------------------------------------------------------------------
+// The transformed vertices of a mesh, each with the number of floats the
+// vertex shader writes, starting with SV_Position in clip space.
+// -----------------------------------------------------------------------------
+
+struct SSoftwareDraw
+{
+    const float*                  m_pVertices;
+    int                           m_NumberOfVertices;
+    int                           m_VertexStride;           // Number of floats per vertex.
+    const int*                    m_pIndices;
+    int                           m_NumberOfIndices;
+    const SSoftwareShaderInfo*    m_pPixelShader;
+    const SSoftwareShaderContext* m_pPixelContext;
+    int                           m_NumberOfLanes;          // Widest batch of pixels a native pixel shader may run on: 1, 4 or 8.
+};
+
+// -----------------------------------------------------------------------------
+// Rasterizes triangles the way Direct3D does: triangles are clipped against
+// the near and the far plane, triangles which are clockwise on the screen are
+// culled, vertices are snapped to 1/256 of a pixel and a pixel is covered if
+// its center is inside the triangle or on a top or left edge. Attributes are
+// interpolated perspective-correct, the depth linear in screen space.
+//
+// A draw runs in two parallel passes on the tile scheduler, a sort-middle
+// design. The setup pass clips, culls and projects chunks of triangles and
+// bins each of them into the screen tiles its bounding box overlaps. The
+// raster pass then hands out whole tiles: a worker owns the pixels of its
+// tile and draws the triangles of the bins of all chunks in their order, so
+// the result is the same for any number of threads. Within a tile coverage
+// is computed for 8x8 blocks: blocks outside an edge are skipped, blocks
+// inside all edges are covered completely and only the blocks on an edge
+// evaluate the edge functions per pixel with SIMD.
+//
+// Before a block is shaded its depth range on the triangle is compared with
+// the depth bounds of the block in the depth target. The block is skipped if
+// the test fails for every pixel, and the depths are not read if the test of
+// Lesser passes for every pixel.
+//
+// The visible pixels of a block are shaded together. A native pixel shader
+// runs on the rows of 8 pixels of the block or on its 2x2 quads, the lanes
+// without a visible pixel repeat one of the others. Other pixel shaders and
+// wire frames run pixel by pixel.
+// -----------------------------------------------------------------------------
+
+class CSoftwareRasterizer
+{
+public:
+
+    static const int s_TileSize  = 64;                      // Pixels along each side of a tile.
+    static const int s_BlockSize = 8;
+
+public:
+
+    explicit CSoftwareRasterizer(CTileScheduler& _rScheduler);
+    ~CSoftwareRasterizer();
+
+    CSoftwareRasterizer(const CSoftwareRasterizer&) = delete;
+    CSoftwareRasterizer& operator = (const CSoftwareRasterizer&) = delete;
+
+public:
+
+    void Draw(const SSoftwareRenderState& _rState, const SSoftwareDraw& _rDraw);
+
+private:
+
+    struct SPrimitive
+    {
+        long long m_X[3];                                   // Snapped to 1/256 of a pixel, clockwise on the screen.
+        long long m_Y[3];
+        float     m_ScreenX[3];
+        float     m_ScreenY[3];
+        float     m_Z[3];
+        float     m_InvW[3];
+        double    m_InvArea;
+        int       m_NumberOfVertices;                       // 3 for triangles, 2 for the lines of wire frames.
+        int       m_MinX;                                   // Pixels whose centers might be covered.
+        int       m_MinY;
+        int       m_MaxX;
+        int       m_MaxY;
+        size_t    m_IndexOfVaryings;                        // Varyings of the vertices divided by w in m_Varyings of the chunk.
+    };
+
+    struct SThreadData
+    {
+        std::vector<float> m_PixelInput;                    // Input of the pixel shader for a single pixel.
+        float              m_Weights[3][64];                // Barycentric weights of the pixels of the current block.
+        float              m_Z[64];
+        float              m_InvW[64];
+    };
+
+    struct SChunk
+    {
+        std::vector<SPrimitive>       m_Primitives;
+        std::vector<float>            m_Varyings;
+        std::vector<std::vector<int>> m_Bins;               // The primitives overlapping each tile.
+        std::vector<float>            m_ClipVertices;       // Vertices created by the clipper.
+    };
+
+private:
+
+    CTileScheduler&                 m_rScheduler;
+    const SSoftwareRenderState*     m_pState;
+    const SSoftwareDraw*            m_pDraw;
+    SSoftwareTexture*               m_pDepthTarget;         // nullptr if the depth test is off.
+    int                             m_Width;
+    int                             m_Height;
+    int                             m_NumberOfTilesX;
+    int                             m_NumberOfTilesY;
+    int                             m_NumberOfVaryings;
+    int                             m_NumberOfChunks;
+    std::vector<SChunk>             m_Chunks;
+    std::vector<SThreadData>        m_Threads;
+
+private:
+
+    void SetupChunk(int _IndexOfChunk);
+    void SetupTriangle(SChunk& _rChunk, const float* _pVertex0, const float* _pVertex1, const float* _pVertex2);
+    void SetupPolygon(SChunk& _rChunk, const float* const* _ppVertices, int _NumberOfVertices);
+    void BinPrimitive(SChunk& _rChunk, const SPrimitive& _rPrimitive);
+
+    void RasterizeTile(int _IndexOfTile, int _Thread);
+    void FillTriangle(const SChunk& _rChunk, const SPrimitive& _rTriangle, int _MinX, int _MinY, int _MaxX, int _MaxY, int _Thread);
+    void DrawLine(const SChunk& _rChunk, const SPrimitive& _rLine, int _MinX, int _MinY, int _MaxX, int _MaxY, int _Thread);
+    bool TestDepth(int _X, int _Y, float _Z, bool _IsAccepted);
+    void ShadeBlock(int _BlockX, int _BlockY, unsigned long long _Mask, const float* _pVaryings, int _Thread);
+    void ShadePixel(int _X, int _Y, float _Z, float _InvW, const float* _pWeights, const float* _pVaryings, int _NumberOfVertices, int _Thread);
+    void WritePixel(int _X, int _Y, float* _pColor);
+
+    template <typename TFloat, typename TShader>
+    void ShadeBatch(TShader _pShader, int _BlockX, int _BlockY, const int* _pPixels, const float* _pVaryings, int _Thread);
+};
@@ -0,0 +1,206 @@
+#include "CSoftwareUploadRing.h"
+
+// -----------------------------------------------------------------------------
+
+CSoftwareUploadRing::CSoftwareUploadRing()
+    : m_Mutex              ()
+    , m_pPage              (nullptr)
+    , m_CurrentFrame       { 0, nullptr, nullptr }
+    , m_EndedFrames        ()
+    , m_IndexOfOldestFrame (0)
+    , m_NumberOfEndedFrames(0)
+    , m_pFreePages         (nullptr)
+{
+}
+
+// -----------------------------------------------------------------------------
+
+CSoftwareUploadRing::~CSoftwareUploadRing()
+{
+    Reset();
+
+    while (m_pFreePages != nullptr)
+    {
+        SPage* pPage = m_pFreePages;
+
+        m_pFreePages = pPage->m_pNext;
+
+        delete pPage;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Threads which find the page full take the lock and the first of them
+// appends the next page. The others retry on that page.
+// -----------------------------------------------------------------------------
+
+float* CSoftwareUploadRing::Allocate(int _NumberOfFloats)
+{
+    for (;;)
+    {
+        SPage* pPage = m_pPage.load(std::memory_order_acquire);
+
+        if (pPage != nullptr && _NumberOfFloats <= s_PageSize)
+        {
+            int Offset = pPage->m_Used.fetch_add(_NumberOfFloats, std::memory_order_relaxed);
+
+            if (Offset + _NumberOfFloats <= pPage->m_Capacity) return pPage->m_pData.get() + Offset;
+        }
+
+        std::lock_guard<std::mutex> Lock(m_Mutex);
+
+        if (_NumberOfFloats > s_PageSize)
+        {
+            SPage* pLargePage = NewPage(_NumberOfFloats);
+
+            pLargePage->m_Used.store(_NumberOfFloats, std::memory_order_relaxed);
+
+            AppendPage(m_CurrentFrame, pLargePage);
+
+            return pLargePage->m_pData.get();
+        }
+
+        if (m_pPage.load(std::memory_order_relaxed) == pPage)
+        {
+            SPage* pNextPage = NewPage(s_PageSize);
+
+            AppendPage(m_CurrentFrame, pNextPage);
+
+            m_pPage.store(pNextPage, std::memory_order_release);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+void CSoftwareUploadRing::EndFrame(int _Frame)
+{
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+
+    m_CurrentFrame.m_Frame = _Frame;
+
+    if (m_NumberOfEndedFrames < s_MaxFrames)
+    {
+        m_EndedFrames[(m_IndexOfOldestFrame + m_NumberOfEndedFrames) % s_MaxFrames] = m_CurrentFrame;
+
+        ++m_NumberOfEndedFrames;
+    }
+    else
+    {
+        SFrame& rLastFrame = m_EndedFrames[(m_IndexOfOldestFrame + m_NumberOfEndedFrames - 1) % s_MaxFrames];
+
+        for (SPage* pPage = m_CurrentFrame.m_pFirstPage; pPage != nullptr; )
+        {
+            SPage* pNextPage = pPage->m_pNext;
+
+            AppendPage(rLastFrame, pPage);
+
+            pPage = pNextPage;
+        }
+
+        rLastFrame.m_Frame = _Frame;
+    }
+
+    m_CurrentFrame = { _Frame + 1, nullptr, nullptr };
+
+    m_pPage.store(nullptr, std::memory_order_release);
+}
+
+// -----------------------------------------------------------------------------
+
+void CSoftwareUploadRing::RetireFrame(int _Frame)
+{
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+
+    while (m_NumberOfEndedFrames > 0 && m_EndedFrames[m_IndexOfOldestFrame].m_Frame <= _Frame)
+    {
+        ReleasePages(m_EndedFrames[m_IndexOfOldestFrame]);
+
+        m_IndexOfOldestFrame = (m_IndexOfOldestFrame + 1) % s_MaxFrames;
+
+        --m_NumberOfEndedFrames;
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+void CSoftwareUploadRing::Reset()
+{
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+
+    for (; m_NumberOfEndedFrames > 0; --m_NumberOfEndedFrames)
+    {
+        ReleasePages(m_EndedFrames[m_IndexOfOldestFrame]);
+
+        m_IndexOfOldestFrame = (m_IndexOfOldestFrame + 1) % s_MaxFrames;
+    }
+
+    ReleasePages(m_CurrentFrame);
+
+    m_pPage.store(nullptr, std::memory_order_release);
+}
+
+// -----------------------------------------------------------------------------
+// Takes the first free page which is large enough. New pages are only
+// allocated while the pool grows.
+// -----------------------------------------------------------------------------
+
+CSoftwareUploadRing::SPage* CSoftwareUploadRing::NewPage(int _NumberOfFloats)
+{
+    for (SPage** ppPage = &m_pFreePages; *ppPage != nullptr; ppPage = &(*ppPage)->m_pNext)
+    {
+        SPage* pPage = *ppPage;
+
+        if (pPage->m_Capacity < _NumberOfFloats) continue;
+
+        *ppPage = pPage->m_pNext;
+
+        pPage->m_pNext = nullptr;
+
+        pPage->m_Used.store(0, std::memory_order_relaxed);
+
+        return pPage;
+    }
+
+    SPage* pPage = new SPage();
+
+    pPage->m_pNext    = nullptr;
+    pPage->m_Capacity = _NumberOfFloats;
+    pPage->m_pData.reset(new float[_NumberOfFloats]);
+
+    pPage->m_Used.store(0, std::memory_order_relaxed);
+
+    return pPage;
+}
+
+// -----------------------------------------------------------------------------
+
+void CSoftwareUploadRing::AppendPage(SFrame& _rFrame, SPage* _pPage)
+{
+    _pPage->m_pNext = nullptr;
+
+    if (_rFrame.m_pLastPage != nullptr)
+    {
+        _rFrame.m_pLastPage->m_pNext = _pPage;
+    }
+    else
+    {
+        _rFrame.m_pFirstPage = _pPage;
+    }
+
+    _rFrame.m_pLastPage = _pPage;
+}
+
+// -----------------------------------------------------------------------------
+
+void CSoftwareUploadRing::ReleasePages(SFrame& _rFrame)
+{
+    if (_rFrame.m_pFirstPage == nullptr) return;
+
+    _rFrame.m_pLastPage->m_pNext = m_pFreePages;
+
+    m_pFreePages = _rFrame.m_pFirstPage;
+
+    _rFrame.m_pFirstPage = nullptr;
+    _rFrame.m_pLastPage  = nullptr;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+// -----------------------------------------------------------------------------
+// Holds the constant buffer uploads of the frames in flight. Every upload is
+// suballocated from the current page by bumping its offset, so any number of
+// threads allocates without a lock until the page is full. The pages of a
+// frame are appended to a list, which goes back to the pool as a whole when
+// the frame retires.
+//
+// The pool only grows until it holds the uploads of the frames in flight,
+// afterwards the frames reuse the pages of the retired ones.
+// -----------------------------------------------------------------------------
+
+class CSoftwareUploadRing
+{
+public:
+
+    static const int s_PageSize  = 16384;                   // Floats of a page, larger uploads get a page of their own.
+    static const int s_MaxFrames = 4;                       // Ended frames not retired yet, more are merged into the last one.
+
+public:
+
+    CSoftwareUploadRing();
+    ~CSoftwareUploadRing();
+
+    CSoftwareUploadRing(const CSoftwareUploadRing&) = delete;
+    CSoftwareUploadRing& operator = (const CSoftwareUploadRing&) = delete;
+
+public:
+
+    float* Allocate(int _NumberOfFloats);                   // Thread safe, valid until the frame of the upload retires.
+
+    void EndFrame(int _Frame);                              // The uploads so far belong to _Frame, the following ones to the next frame.
+    void RetireFrame(int _Frame);                           // Reclaims the uploads of _Frame and of the frames before.
+    void Reset();                                           // Reclaims all uploads.
+
+private:
+
+    struct SPage
+    {
+        SPage*                   m_pNext;
+        int                      m_Capacity;
+        std::atomic<int>         m_Used;                    // Might exceed the capacity after a failed allocation.
+        std::unique_ptr<float[]> m_pData;
+    };
+
+    struct SFrame
+    {
+        int    m_Frame;
+        SPage* m_pFirstPage;
+        SPage* m_pLastPage;
+    };
+
+private:
+
+    std::mutex          m_Mutex;                            // Guards everything but the offset of the current page.
+    std::atomic<SPage*> m_pPage;                            // The page the current frame allocates from.
+    SFrame              m_CurrentFrame;
+    SFrame              m_EndedFrames[s_MaxFrames];
+    int                 m_IndexOfOldestFrame;
+    int                 m_NumberOfEndedFrames;
+    SPage*              m_pFreePages;
+
+private:
+
+    SPage* NewPage(int _NumberOfFloats);
+    void AppendPage(SFrame& _rFrame, SPage* _pPage);
+    void ReleasePages(SFrame& _rFrame);
+};
@@ -0,0 +1,3700 @@
+#include "SoftwareCompiler.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace
+{
+    const int s_MaxShaderFloats  = 64;                      // Inputs and outputs of a shader, 16 registers.
+    const int s_MaxCallDepth     = 32;
+    const int s_MaxMacroDepth    = 16;
+    const int s_MaxNesting       = 256;                     // Statements and expressions in each other, deeper ones would overflow the stack.
+    const int s_ConstantRegister = 1 << 24;                 // Constants are numbered from here until the program is complete.
+
+    // -----------------------------------------------------------------------------
+
+    struct SToken
+    {
+        enum EKind
+        {
+            Identifier,
+            Number,
+            Punctuator,
+            End,
+        };
+
+        EKind       m_Kind;
+        std::string m_Text;
+        int         m_Line;
+    };
+
+    typedef std::map<std::string, std::vector<SToken>> CMacroMap;
+
+    // -----------------------------------------------------------------------------
+
+    bool IsIdentifierCharacter(char _Character)
+    {
+        return std::isalnum(static_cast<unsigned char>(_Character)) || _Character == '_';
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool IsSameText(const std::string& _rText1, const char* _pText2)
+    {
+        if (_rText1.size() != std::strlen(_pText2)) return false;
+
+        for (size_t Index = 0; Index < _rText1.size(); ++Index)
+        {
+            if (std::toupper(static_cast<unsigned char>(_rText1[Index])) != std::toupper(static_cast<unsigned char>(_pText2[Index]))) return false;
+        }
+
+        return true;
+    }
+
+    // -----------------------------------------------------------------------------
+    // Skips white space and comments. Sets _pIsLineStart if a new line starts,
+    // preprocessor directives are only allowed there. Returns false at a block
+    // comment without its end, which stays at the position.
+    // -----------------------------------------------------------------------------
+
+    bool SkipSpace(const std::string& _rText, size_t* _pPosition, int* _pLine, bool* _pIsLineStart)
+    {
+        size_t& rPosition = *_pPosition;
+
+        while (rPosition < _rText.size())
+        {
+            char Character = _rText[rPosition];
+
+            if (Character == '\n')
+            {
+                ++*_pLine;
+                ++rPosition;
+
+                *_pIsLineStart = true;
+            }
+            else if (std::isspace(static_cast<unsigned char>(Character)))
+            {
+                ++rPosition;
+            }
+            else if (_rText.compare(rPosition, 2, "//") == 0)
+            {
+                while (rPosition < _rText.size() && _rText[rPosition] != '\n') ++rPosition;
+            }
+            else if (_rText.compare(rPosition, 2, "/*") == 0)
+            {
+                size_t End = _rText.find("*/", rPosition + 2);
+
+                if (End == std::string::npos) return false;
+
+                for (End += 2; rPosition < End; ++rPosition)
+                {
+                    if (_rText[rPosition] == '\n') ++*_pLine;
+                }
+            }
+            else
+            {
+                break;
+            }
+        }
+
+        return true;
+    }
+
+    // -----------------------------------------------------------------------------
+    // Reads the token at the position, which is no white space. Numbers keep
+    // their suffix, the parser decides on the type.
+    // -----------------------------------------------------------------------------
+
+    void ReadToken(const std::string& _rText, size_t* _pPosition, int _Line, SToken* _pToken)
+    {
+        static const char* const s_Punctuators[] = { "<<=", ">>=", "==", "!=", "<=", ">=", "&&", "||", "++", "--", "+=", "-=", "*=", "/=", "%=", "<<", ">>", "::" };
+
+        size_t& rPosition = *_pPosition;
+        size_t  Start     = rPosition;
+        char    Character = _rText[rPosition];
+
+        _pToken->m_Line = _Line;
+
+        if (std::isdigit(static_cast<unsigned char>(Character)) || (Character == '.' && rPosition + 1 < _rText.size() && std::isdigit(static_cast<unsigned char>(_rText[rPosition + 1]))))
+        {
+            bool IsHexadecimal = _rText.compare(rPosition, 2, "0x") == 0 || _rText.compare(rPosition, 2, "0X") == 0;
+
+            for (++rPosition; rPosition < _rText.size(); ++rPosition)
+            {
+                char Next     = _rText[rPosition];
+                char Previous = _rText[rPosition - 1];
+
+                bool IsSign = (Next == '+' || Next == '-') && (Previous == 'e' || Previous == 'E') && !IsHexadecimal;
+
+                if (!IsIdentifierCharacter(Next) && Next != '.' && !IsSign) break;
+            }
+
+            _pToken->m_Kind = SToken::Number;
+        }
+        else if (IsIdentifierCharacter(Character))
+        {
+            while (rPosition < _rText.size() && IsIdentifierCharacter(_rText[rPosition])) ++rPosition;
+
+            _pToken->m_Kind = SToken::Identifier;
+        }
+        else
+        {
+            size_t Length = 1;
+
+            for (const char* pPunctuator : s_Punctuators)
+            {
+                size_t LengthOfPunctuator = std::strlen(pPunctuator);
+
+                if (LengthOfPunctuator > Length && _rText.compare(rPosition, LengthOfPunctuator, pPunctuator) == 0) Length = LengthOfPunctuator;
+            }
+
+            rPosition += Length;
+
+            _pToken->m_Kind = SToken::Punctuator;
+        }
+
+        _pToken->m_Text = _rText.substr(Start, rPosition - Start);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void ExpandToken(const SToken& _rToken, const CMacroMap& _rMacros, int _Depth, std::vector<SToken>* _pTokens)
+    {
+        CMacroMap::const_iterator Macro = _rToken.m_Kind == SToken::Identifier && _Depth < s_MaxMacroDepth ? _rMacros.find(_rToken.m_Text) : _rMacros.end();
+
+        if (Macro == _rMacros.end())
+        {
+            _pTokens->push_back(_rToken);
+
+            return;
+        }
+
+        for (SToken Token : Macro->second)
+        {
+            Token.m_Line = _rToken.m_Line;
+
+            ExpandToken(Token, _rMacros, _Depth + 1, _pTokens);
+        }
+    }
+
+    // -----------------------------------------------------------------------------
+    // Splits the source into tokens and expands the macros. The list ends with
+    // a token of kind End.
+    // -----------------------------------------------------------------------------
+
+    bool Tokenize(const char* _pPath, const std::string& _rSource, std::vector<SToken>* _pTokens)
+    {
+        CMacroMap Macros;
+        size_t    Position    = 0;
+        int       Line        = 1;
+        bool      IsLineStart = true;
+
+        for (;;)
+        {
+            if (!SkipSpace(_rSource, &Position, &Line, &IsLineStart))
+            {
+                std::fprintf(stderr, "%s(%d): error: the comment has no end\n", _pPath, Line);
+
+                return false;
+            }
+
+            if (Position >= _rSource.size()) break;
+
+            if (_rSource[Position] != '#')
+            {
+                SToken Token;
+
+                ReadToken(_rSource, &Position, Line, &Token);
+
+                ExpandToken(Token, Macros, 0, _pTokens);
+
+                IsLineStart = false;
+
+                continue;
+            }
+
+            // -----------------------------------------------------------------------------
+            // A directive ends with its line unless the line ends with a
+            // backslash.
+            // -----------------------------------------------------------------------------
+            int         LineOfDirective = Line;
+            std::string Directive;
+
+            for (++Position; Position < _rSource.size() && _rSource[Position] != '\n'; ++Position)
+            {
+                if (_rSource[Position] == '\\' && _rSource.find_first_not_of(" \t\r", Position + 1) == _rSource.find('\n', Position))
+                {
+                    Position = _rSource.find('\n', Position);
+
+                    if (Position == std::string::npos) break;
+
+                    ++Line;
+
+                    Directive.push_back(' ');
+
+                    continue;
+                }
+
+                Directive.push_back(_rSource[Position]);
+            }
+
+            if (!IsLineStart)
+            {
+                std::fprintf(stderr, "%s(%d): error: # has to start a line\n", _pPath, LineOfDirective);
+
+                return false;
+            }
+
+            std::vector<SToken> Tokens;
+            size_t              PositionInDirective = 0;
+            int                 LineInDirective     = LineOfDirective;
+            bool                IsInDirective       = false;
+
+            for (;;)
+            {
+                if (!SkipSpace(Directive, &PositionInDirective, &LineInDirective, &IsInDirective))
+                {
+                    std::fprintf(stderr, "%s(%d): error: the comment has no end in the directive\n", _pPath, LineOfDirective);
+
+                    return false;
+                }
+
+                if (PositionInDirective >= Directive.size()) break;
+
+                Tokens.push_back(SToken());
+
+                ReadToken(Directive, &PositionInDirective, LineOfDirective, &Tokens.back());
+            }
+
+            if (Tokens.empty() || Tokens[0].m_Text == "pragma") continue;
+
+            if (Tokens[0].m_Text == "define" && Tokens.size() >= 2 && Tokens[1].m_Kind == SToken::Identifier)
+            {
+                size_t EndOfName = Directive.find(Tokens[1].m_Text) + Tokens[1].m_Text.size();
+
+                if (EndOfName < Directive.size() && Directive[EndOfName] == '(')
+                {
+                    std::fprintf(stderr, "%s(%d): error: macros with parameters are not supported\n", _pPath, LineOfDirective);
+
+                    return false;
+                }
+
+                Macros[Tokens[1].m_Text].assign(Tokens.begin() + 2, Tokens.end());
+            }
+            else if (Tokens[0].m_Text == "undef" && Tokens.size() == 2)
+            {
+                Macros.erase(Tokens[1].m_Text);
+            }
+            else
+            {
+                std::fprintf(stderr, "%s(%d): error: #%s is not supported\n", _pPath, LineOfDirective, Tokens[0].m_Text.c_str());
+
+                return false;
+            }
+        }
+
+        SToken End;
+
+        End.m_Kind = SToken::End;
+        End.m_Line = Line;
+
+        _pTokens->push_back(End);
+
+        return true;
+    }
+} // namespace
+
+// -----------------------------------------------------------------------------
+// The compiler parses the declarations of the effect once and records where
+// the bodies of the functions start. The entry point is compiled to code
+// directly while it is parsed, a call parses the body of the function again
+// in place, with its parameters bound to the registers of the arguments.
+//
+// Code is emitted for the components of vectors and matrices separately, a
+// value is the list of registers of its components. Swizzles, members and
+// most constructors and casts just pick registers and emit nothing. Literals
+// and the members of constant buffers are loaded once at the start of the
+// program.
+//
+// The depth counts the branches and loops around the code, every register
+// remembers the depth it was allocated at. A write to a register of a lower
+// depth is masked with the executing lanes, the registers of the branch
+// itself are dead in the other lanes. Lanes which return, break or continue
+// are collected in masks and removed from the executing lanes when the
+// enclosing branch ends.
+// -----------------------------------------------------------------------------
+
+namespace
+{
+    typedef SSoftwareInstruction SInstruction;
+
+    struct SType
+    {
+        enum EBase
+        {
+            Void,
+            Bool,
+            Int,
+            UInt,
+            Float,
+            Struct,
+            Texture,
+            Sampler,
+        };
+
+        EBase m_Base;
+        int   m_Rows;                                       // More than 1 for matrices.
+        int   m_Columns;
+        int   m_IndexOfStruct;
+    };
+
+    struct SMember
+    {
+        std::string m_Name;
+        SType       m_Type;
+        std::string m_Semantic;
+        int         m_Offset;                               // In floats from the start of the struct.
+    };
+
+    struct SStruct
+    {
+        std::string          m_Name;
+        std::vector<SMember> m_Members;
+        int                  m_NumberOfFloats;
+    };
+
+    struct SParameter
+    {
+        std::string m_Name;
+        SType       m_Type;
+        std::string m_Semantic;
+        bool        m_IsIn;
+        bool        m_IsOut;
+        bool        m_IsWritten;                            // Parameters the body does not write share the registers of the argument.
+    };
+
+    struct SFunction
+    {
+        std::string             m_Name;
+        SType                   m_ReturnType;
+        std::string             m_Semantic;
+        std::vector<SParameter> m_Parameters;
+        size_t                  m_IndexOfBody;              // Token of the opening brace.
+        bool                    m_IsAnalyzed;               // m_IsWritten of the parameters is known.
+    };
+
+    struct SSymbol
+    {
+        std::string      m_Name;
+        SType            m_Type;
+        std::vector<int> m_Registers;
+        bool             m_IsConstant;
+        int              m_Buffer;                          // Register of the constant buffer of a member, -1 for variables.
+        int              m_Offset;                          // In floats from the start of the constant buffer.
+        int              m_Slot;                            // Register of a texture.
+    };
+
+    struct SValue
+    {
+        SType            m_Type;
+        std::vector<int> m_Registers;
+        std::vector<int> m_Masks;                           // The masks of a comparison per component, empty for other values.
+        bool             m_IsWritable;
+        int              m_Slot;
+    };
+
+    struct SConstant
+    {
+        SInstruction::EOpcode m_Opcode;                     // Literal or one of the loads.
+        int                   m_Buffer;
+        int                   m_Offset;
+        float                 m_Value;
+    };
+
+    struct SFrame
+    {
+        const SFunction* m_pFunction;
+        size_t           m_IndexOfFirstSymbol;
+        size_t           m_IndexOfFirstLoop;
+        int              m_Depth;
+        std::vector<int> m_ReturnRegisters;
+        int              m_ReturnMask;                      // Lanes which returned in a branch.
+        int              m_ReturnMaskClear;                 // Instruction which clears the mask once it is used.
+        bool             m_IsReturnMaskUsed;
+        int              m_NumberOfReturns;
+        std::vector<int> m_ReturnJumps;
+    };
+
+    struct SLoop
+    {
+        int  m_BreakMask;
+        int  m_BreakMaskClear;
+        bool m_IsBreakMaskUsed;
+        int  m_ContinueMask;
+        int  m_ContinueMaskClear;
+        bool m_IsContinueMaskUsed;
+        int  m_NumberOfExits;
+    };
+
+    // -----------------------------------------------------------------------------
+    // Counts a statement or expression as long as it is compiled.
+    // -----------------------------------------------------------------------------
+
+    class CNesting
+    {
+    public:
+
+        explicit CNesting(int* _pNesting) : m_pNesting(_pNesting) { ++*m_pNesting; }
+        ~CNesting() { --*m_pNesting; }
+
+        CNesting(const CNesting&) = delete;
+        CNesting& operator = (const CNesting&) = delete;
+
+    private:
+
+        int* m_pNesting;
+    };
+
+    // -----------------------------------------------------------------------------
+
+    SType MakeType(SType::EBase _Base, int _Rows = 1, int _Columns = 1)
+    {
+        SType Type;
+
+        Type.m_Base          = _Base;
+        Type.m_Rows          = _Rows;
+        Type.m_Columns       = _Columns;
+        Type.m_IndexOfStruct = -1;
+
+        return Type;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool IsNumeric(const SType& _rType)
+    {
+        return _rType.m_Base == SType::Bool || _rType.m_Base == SType::Int || _rType.m_Base == SType::UInt || _rType.m_Base == SType::Float;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool IsScalar(const SType& _rType)
+    {
+        return IsNumeric(_rType) && _rType.m_Rows == 1 && _rType.m_Columns == 1;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool IsMatrix(const SType& _rType)
+    {
+        return IsNumeric(_rType) && _rType.m_Rows > 1;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool IsJump(SInstruction::EOpcode _Opcode)
+    {
+        return _Opcode == SInstruction::Jump || _Opcode == SInstruction::JumpIfNone || _Opcode == SInstruction::JumpIfAny;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    class CCompiler
+    {
+    public:
+
+        CCompiler(const char* _pPath, const std::vector<SToken>& _rTokens, SSoftwareProgram* _pProgram);
+
+    public:
+
+        bool Compile(const char* _pShaderName, bool _IsVertexShader);
+
+    private:
+
+        const char*                       m_pPath;
+        const std::vector<SToken>&        m_rTokens;
+        size_t                            m_Position;
+        bool                              m_HasError;
+        SSoftwareProgram*                 m_pProgram;
+        std::vector<SStruct>              m_Structs;
+        std::vector<SFunction>            m_Functions;
+        std::vector<SSymbol>              m_Symbols;
+        size_t                            m_NumberOfGlobals;
+        std::vector<size_t>               m_StaticGlobals;      // First token of the declarations.
+        int                               m_NextBuffer;
+        int                               m_NextTexture;
+        std::vector<SInstruction>         m_Instructions;
+        std::vector<SConstant>            m_Constants;
+        std::vector<int>                  m_RegisterDepths;
+        int                               m_NumberOfRegisters;
+        int                               m_MaxNumberOfRegisters;
+        int                               m_NumberOfMasks;
+        int                               m_MaxNumberOfMasks;
+        int                               m_Depth;
+        int                               m_Nesting;            // Statements and expressions being compiled.
+        size_t                            m_IndexOfScope;       // First symbol of the innermost block.
+        std::vector<SFrame>               m_Frames;
+        std::vector<SLoop>                m_Loops;
+
+    private:
+
+        void Error(const char* _pFormat, ...);
+        bool IsNestedTooDeep();
+
+        const SToken& GetToken(size_t _Offset = 0) const;
+        bool IsToken(const char* _pText, size_t _Offset = 0) const;
+        bool IsEnd() const;
+        bool Accept(const char* _pText);
+        bool Expect(const char* _pText);
+        bool ExpectIdentifier(std::string* _pName);
+        void SkipBalanced();
+        void SkipTo(const char* _pText);
+        void SkipModifiers();
+
+        bool GetBuiltinType(const std::string& _rName, SType* _pType) const;
+        int  FindStruct(const std::string& _rName) const;
+        bool IsTypeName(size_t _Offset = 0) const;
+        bool ParseType(SType* _pType);
+        bool ParseRegister(char _Class, int* _pSlot);
+        int  GetNumberOfFloats(const SType& _rType) const;
+        std::string GetTypeName(const SType& _rType) const;
+
+        void ParseDeclarations();
+        void ParseConstantBuffer();
+        void ParseStruct();
+        void ParseGlobal();
+        void ParseFunction(const SType& _rReturnType, const std::string& _rName);
+        void AnalyzeFunction(SFunction* _pFunction);
+        const SFunction* FindFunction(const std::string& _rName, size_t _NumberOfArguments) const;
+        const SSymbol* FindSymbol(const std::string& _rName) const;
+
+        int  Emit(SInstruction::EOpcode _Opcode, int _Destination, int _Source0 = 0, int _Source1 = 0, int _Source2 = 0, int _Parameter = 0);
+        int  AllocateRegisters(int _Count);
+        int  AllocateMask();
+        int  GetConstant(SInstruction::EOpcode _Opcode, int _Buffer, int _Offset, float _Value);
+        int  GetLiteral(float _Value);
+        bool IsLiteral(int _Register, float* _pValue) const;
+        int  EmitOperation(SInstruction::EOpcode _Opcode, int _Source0, int _Source1 = 0);
+        int  EmitSelect(int _Mask, int _True, int _False);
+        int  EmitComparison(SInstruction::EOpcode _Opcode, int _Source0, int _Source1);
+        void PatchJump(int _IndexOfJump);
+        void UseMask(int _IndexOfClear, int _Mask, bool* _pIsUsed);
+        void Store(const std::vector<int>& _rDestination, std::vector<int> _Source);
+        SValue MakeValue(const SType& _rType, const std::vector<int>& _rRegisters) const;
+        SValue MakeBool(const std::vector<int>& _rMasks);
+        SValue Convert(const SValue& _rValue, const SType& _rType);
+        int  GetMask(const SValue& _rValue, int _Component);
+        int  GetCondition(const SValue& _rValue);
+        int  GetComponent(const SValue& _rValue, int _Row, int _Column) const;
+        bool GetCommonType(const std::vector<SValue>& _rValues, SType* _pType);
+        void RestoreExecution(int _SavedMask);
+        int  GetNumberOfExits() const;
+
+        void CompileStatement();
+        void CompileBlock();
+        bool IsDeclaration() const;
+        void CompileDeclaration();
+        void CompileIf();
+        void CompileLoop();
+        void CompileReturn();
+        void CompileExit(bool _IsBreak);
+        SValue InlineFunction(const SFunction& _rFunction);
+
+        SValue CompileExpression();
+        SValue CompileConditional();
+        SValue CompileBinary(int _Level);
+        SValue CompileUnary();
+        SValue CompilePostfix();
+        SValue CompilePrimary();
+        SValue CompileSymbol(const SSymbol& _rSymbol);
+        SValue CompileOperation(const std::string& _rOperator, const SValue& _rLeft, const SValue& _rRight);
+        SValue CompileMember(const SValue& _rValue);
+        SValue CompileIndex(const SValue& _rValue);
+        SValue CompileConstructor(const SType& _rType);
+        SValue CompileCall(const std::string& _rName);
+        SValue CompileIntrinsic(const std::string& _rName, const std::vector<SValue>& _rArguments, bool* _pIsIntrinsic);
+        SValue CompileComponentWise(const std::vector<SValue>& _rArguments, SInstruction::EOpcode _Opcode);
+        SValue CompileMul(const SValue& _rLeft, const SValue& _rRight);
+        int    CompileDot(const SValue& _rLeft, const SValue& _rRight);
+        bool   ParseArguments(std::vector<SValue>* _pArguments);
+
+        bool CompileEntryPoint(const char* _pShaderName, bool _IsVertexShader);
+        void Finalize();
+    };
+} // namespace
+
+// -----------------------------------------------------------------------------
+
+namespace
+{
+    CCompiler::CCompiler(const char* _pPath, const std::vector<SToken>& _rTokens, SSoftwareProgram* _pProgram)
+        : m_pPath               (_pPath)
+        , m_rTokens             (_rTokens)
+        , m_Position            (0)
+        , m_HasError            (false)
+        , m_pProgram            (_pProgram)
+        , m_Structs             ()
+        , m_Functions           ()
+        , m_Symbols             ()
+        , m_NumberOfGlobals     (0)
+        , m_StaticGlobals       ()
+        , m_NextBuffer          (0)
+        , m_NextTexture         (0)
+        , m_Instructions        ()
+        , m_Constants           ()
+        , m_RegisterDepths      ()
+        , m_NumberOfRegisters   (0)
+        , m_MaxNumberOfRegisters(0)
+        , m_NumberOfMasks       (1)                         // Mask 0 holds the executing lanes.
+        , m_MaxNumberOfMasks    (1)
+        , m_Depth               (0)
+        , m_Nesting             (0)
+        , m_IndexOfScope        (0)
+        , m_Frames              ()
+        , m_Loops               ()
+    {
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool CCompiler::Compile(const char* _pShaderName, bool _IsVertexShader)
+    {
+        ParseDeclarations();
+
+        if (!m_HasError) CompileEntryPoint(_pShaderName, _IsVertexShader);
+
+        if (!m_HasError) Finalize();
+
+        return !m_HasError;
+    }
+
+    // -----------------------------------------------------------------------------
+    // Only the first error is printed, the following ones are likely caused by
+    // it. The parser stops at the next chance.
+    // -----------------------------------------------------------------------------
+
+    void CCompiler::Error(const char* _pFormat, ...)
+    {
+        if (m_HasError) return;
+
+        m_HasError = true;
+
+        std::fprintf(stderr, "%s(%d): error: ", m_pPath, GetToken().m_Line);
+
+        va_list Arguments;
+
+        va_start(Arguments, _pFormat);
+
+        std::vfprintf(stderr, _pFormat, Arguments);
+
+        va_end(Arguments);
+
+        std::fprintf(stderr, "\n");
+    }
+
+    // -----------------------------------------------------------------------------
+    // The recursive descent uses the stack for every statement and expression
+    // in another one, so thousands of nested parentheses would overflow it.
+    // -----------------------------------------------------------------------------
+
+    bool CCompiler::IsNestedTooDeep()
+    {
+        if (m_Nesting <= s_MaxNesting) return false;
+
+        Error("the code is nested too deep");
+
+        return true;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    const SToken& CCompiler::GetToken(size_t _Offset) const
+    {
+        return m_rTokens[std::min(m_Position + _Offset, m_rTokens.size() - 1)];
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool CCompiler::IsToken(const char* _pText, size_t _Offset) const
+    {
+        const SToken& rToken = GetToken(_Offset);
+
+        return rToken.m_Kind != SToken::End && rToken.m_Text == _pText;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool CCompiler::IsEnd() const
+    {
+        return m_HasError || GetToken().m_Kind == SToken::End;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool CCompiler::Accept(const char* _pText)
+    {
+        if (!IsToken(_pText)) return false;
+
+        ++m_Position;
+
+        return true;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool CCompiler::Expect(const char* _pText)
+    {
+        if (Accept(_pText)) return true;
+
+        Error("'%s' expected instead of '%s'", _pText, GetToken().m_Kind == SToken::End ? "end of file" : GetToken().m_Text.c_str());
+
+        return false;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool CCompiler::ExpectIdentifier(std::string* _pName)
+    {
+        if (GetToken().m_Kind != SToken::Identifier)
+        {
+            Error("name expected instead of '%s'", GetToken().m_Kind == SToken::End ? "end of file" : GetToken().m_Text.c_str());
+
+            return false;
+        }
+
+        *_pName = GetToken().m_Text;
+
+        ++m_Position;
+
+        return true;
+    }
+
+    // -----------------------------------------------------------------------------
+    // Skips from an opening parenthesis, bracket or brace to the token after
+    // the closing one.
+    // -----------------------------------------------------------------------------
+
+    void CCompiler::SkipBalanced()
+    {
+        int Nesting = 0;
+
+        do
+        {
+            const std::string& rText = GetToken().m_Text;
+
+            if (GetToken().m_Kind == SToken::Punctuator)
+            {
+                if (rText == "(" || rText == "[" || rText == "{") ++Nesting;
+                if (rText == ")" || rText == "]" || rText == "}") --Nesting;
+            }
+
+            ++m_Position;
+        }
+        while (Nesting > 0 && !IsEnd());
+
+        if (Nesting > 0) Error("unbalanced parentheses or braces");
+    }
+
+    // -----------------------------------------------------------------------------
+    // Skips to the token outside of parentheses and braces.
+    // -----------------------------------------------------------------------------
+
+    void CCompiler::SkipTo(const char* _pText)
+    {
+        while (!IsEnd() && !IsToken(_pText))
+        {
+            if (IsToken("(") || IsToken("[") || IsToken("{")) SkipBalanced();
+            else                                                 ++m_Position;
+        }
+    }
+
+    // -----------------------------------------------------------------------------
+    // Modifiers of variables and members which do not change the code of the
+    // software backend.
+    // -----------------------------------------------------------------------------
+
+    void CCompiler::SkipModifiers()
+    {
+        static const char* const s_Modifiers[] = { "const", "static", "uniform", "precise", "row_major", "column_major", "linear", "centroid", "nointerpolation", "noperspective", "sample", "inline", "extern" };
+
+        for (;;)
+        {
+            bool IsModifier = false;
+
+            for (const char* pModifier : s_Modifiers) IsModifier = IsModifier || IsToken(pModifier);
+
+            if (!IsModifier) break;
+
+            ++m_Position;
+        }
+    }
+} // namespace
+
+// -----------------------------------------------------------------------------
+// Types
+// -----------------------------------------------------------------------------
+
+namespace
+{
+    bool CCompiler::GetBuiltinType(const std::string& _rName, SType* _pType) const
+    {
+        static const struct
+        {
+            const char*  m_pName;
+            SType::EBase m_Base;
+        }
+        s_Scalars[] =
+        {
+            { "float", SType::Float },
+            { "half" , SType::Float },
+            { "double", SType::Float },
+            { "int"  , SType::Int },
+            { "uint" , SType::UInt },
+            { "dword", SType::UInt },
+            { "bool" , SType::Bool },
+        };
+
+        if (_rName == "void")                                                         { *_pType = MakeType(SType::Void);           return true; }
+        if (_rName == "Texture2D")                                                    { *_pType = MakeType(SType::Texture);        return true; }
+        if (_rName == "sampler" || _rName == "SamplerState" || _rName == "sampler2D") { *_pType = MakeType(SType::Sampler);        return true; }
+        if (_rName == "vector")                                                       { *_pType = MakeType(SType::Float, 1, 4);    return true; }
+        if (_rName == "matrix")                                                       { *_pType = MakeType(SType::Float, 4, 4);    return true; }
+
+        for (const auto& rScalar : s_Scalars)
+        {
+            size_t Length = std::strlen(rScalar.m_pName);
+
+            if (_rName.compare(0, Length, rScalar.m_pName) != 0) continue;
+
+            std::string Suffix = _rName.substr(Length);
+
+            auto IsDimension = [](char _Character) { return _Character >= '1' && _Character <= '4'; };
+
+            if (Suffix.empty())
+            {
+                *_pType = MakeType(rScalar.m_Base);
+            }
+            else if (Suffix.size() == 1 && IsDimension(Suffix[0]))
+            {
+                *_pType = MakeType(rScalar.m_Base, 1, Suffix[0] - '0');
+            }
+            else if (Suffix.size() == 3 && IsDimension(Suffix[0]) && Suffix[1] == 'x' && IsDimension(Suffix[2]))
+            {
+                *_pType = MakeType(rScalar.m_Base, Suffix[0] - '0', Suffix[2] - '0');
+            }
+            else
+            {
+                return false;
+            }
+
+            return true;
+        }
+
+        return false;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    int CCompiler::FindStruct(const std::string& _rName) const
+    {
+        for (size_t IndexOfStruct = 0; IndexOfStruct < m_Structs.size(); ++IndexOfStruct)
+        {
+            if (m_Structs[IndexOfStruct].m_Name == _rName) return static_cast<int>(IndexOfStruct);
+        }
+
+        return -1;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool CCompiler::IsTypeName(size_t _Offset) const
+    {
+        const SToken& rToken = GetToken(_Offset);
+
+        SType Type;
+
+        return rToken.m_Kind == SToken::Identifier && (GetBuiltinType(rToken.m_Text, &Type) || FindStruct(rToken.m_Text) >= 0);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool CCompiler::ParseType(SType* _pType)
+    {
+        std::string Name;
+
+        if (!ExpectIdentifier(&Name)) return false;
+
+        if (GetBuiltinType(Name, _pType))
+        {
+            if (_pType->m_Base == SType::Texture && IsToken("<")) SkipTo(">"), Expect(">");
+
+            return !m_HasError;
+        }
+
+        int IndexOfStruct = FindStruct(Name);
+
+        if (IndexOfStruct < 0)
+        {
+            --m_Position;
+
+            Error("unknown type '%s'", Name.c_str());
+
+            return false;
+        }
+
+        *_pType = MakeType(SType::Struct);
+
+        _pType->m_IndexOfStruct = IndexOfStruct;
+
+        return true;
+    }
+
+    // -----------------------------------------------------------------------------
+    // register(b0), the colon has been read.
+    // -----------------------------------------------------------------------------
+
+    bool CCompiler::ParseRegister(char _Class, int* _pSlot)
+    {
+        std::string Name;
+
+        if (!Expect("register") || !Expect("(") || !ExpectIdentifier(&Name)) return false;
+
+        if (std::tolower(static_cast<unsigned char>(Name[0])) != _Class || Name.size() < 2 || Name.find_first_not_of("0123456789", 1) != std::string::npos || std::atoi(Name.c_str() + 1) >= 16)
+        {
+            --m_Position;
+
+            Error("register %c0 to %c15 expected instead of '%s'", _Class, _Class, Name.c_str());
+
+            return false;
+        }
+
+        *_pSlot = std::atoi(Name.c_str() + 1);
+
+        SkipTo(")");
+
+        return Expect(")");
+    }
+
+    // -----------------------------------------------------------------------------
+
+    int CCompiler::GetNumberOfFloats(const SType& _rType) const
+    {
+        if (_rType.m_Base == SType::Struct) return m_Structs[_rType.m_IndexOfStruct].m_NumberOfFloats;
+
+        return IsNumeric(_rType) ? _rType.m_Rows * _rType.m_Columns : 0;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    std::string CCompiler::GetTypeName(const SType& _rType) const
+    {
+        static const char* const s_Names[] = { "void", "bool", "int", "uint", "float", "struct", "Texture2D", "sampler" };
+
+        if (_rType.m_Base == SType::Struct) return m_Structs[_rType.m_IndexOfStruct].m_Name;
+
+        std::string Name = s_Names[_rType.m_Base];
+
+        if (!IsNumeric(_rType))       return Name;
+        if (IsMatrix(_rType))         return Name + std::to_string(_rType.m_Rows) + "x" + std::to_string(_rType.m_Columns);
+        if (_rType.m_Columns > 1)     return Name + std::to_string(_rType.m_Columns);
+
+        return Name;
+    }
+} // namespace
+
+// -----------------------------------------------------------------------------
+// Declarations
+// -----------------------------------------------------------------------------
+
+namespace
+{
+    void CCompiler::ParseDeclarations()
+    {
+        while (!IsEnd())
+        {
+            if      (Accept(";"))          continue;
+            else if (IsToken("cbuffer"))   ParseConstantBuffer();
+            else if (IsToken("struct"))    ParseStruct();
+            else                           ParseGlobal();
+        }
+
+        m_NumberOfGlobals = m_Symbols.size();
+    }
+
+    // -----------------------------------------------------------------------------
+    // The members of a constant buffer are packed like in Direct3D: a member
+    // does not cross a float4 register and a matrix starts a new register,
+    // with each of its rows in a register.
+    // -----------------------------------------------------------------------------
+
+    void CCompiler::ParseConstantBuffer()
+    {
+        std::string Name;
+        int         Slot = m_NextBuffer;
+
+        Expect("cbuffer");
+        ExpectIdentifier(&Name);
+
+        if (Accept(":")) ParseRegister('b', &Slot);
+
+        m_NextBuffer = Slot + 1;
+
+        Expect("{");
+
+        int Offset = 0;
+
+        while (!IsEnd() && !Accept("}"))
+        {
+            SType Type;
+
+            SkipModifiers();
+
+            if (!ParseType(&Type)) return;
+
+            if (!IsNumeric(Type))
+            {
+                Error("the constant buffer %s may only hold scalars, vectors and matrices", Name.c_str());
+
+                return;
+            }
+
+            do
+            {
+                SSymbol Symbol;
+
+                if (!ExpectIdentifier(&Symbol.m_Name)) return;
+
+                if (IsToken("[") || IsToken(":"))
+                {
+                    Error("arrays and packoffset are not supported in constant buffers");
+
+                    return;
+                }
+
+                if (IsMatrix(Type) || Offset % 4 + Type.m_Columns > 4) Offset = (Offset + 3) / 4 * 4;
+
+                Symbol.m_Type       = Type;
+                Symbol.m_IsConstant = true;
+                Symbol.m_Buffer     = Slot;
+                Symbol.m_Offset     = Offset;
+                Symbol.m_Slot       = -1;
+
+                m_Symbols.push_back(Symbol);
+
+                Offset += 4 * (Type.m_Rows - 1) + Type.m_Columns;
+            }
+            while (Accept(","));
+
+            Expect(";");
+        }
+
+        Accept(";");
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void CCompiler::ParseStruct()
+    {
+        SStruct Struct;
+
+        Expect("struct");
+        ExpectIdentifier(&Struct.m_Name);
+        Expect("{");
+
+        Struct.m_NumberOfFloats = 0;
+
+        while (!IsEnd() && !Accept("}"))
+        {
+            SType Type;
+
+            SkipModifiers();
+
+            if (!ParseType(&Type)) return;
+
+            do
+            {
+                SMember Member;
+
+                if (!ExpectIdentifier(&Member.m_Name)) return;
+
+                if (Accept(":") && !ExpectIdentifier(&Member.m_Semantic)) return;
+
+                Member.m_Type   = Type;
+                Member.m_Offset = Struct.m_NumberOfFloats;
+
+                Struct.m_NumberOfFloats += GetNumberOfFloats(Type);
+
+                Struct.m_Members.push_back(Member);
+            }
+            while (Accept(","));
+
+            Expect(";");
+        }
+
+        Expect(";");
+
+        m_Structs.push_back(Struct);
+    }
+
+    // -----------------------------------------------------------------------------
+    // Functions, textures, samplers and static variables. The declaration of a
+    // static variable is compiled at the start of the entry point.
+    // -----------------------------------------------------------------------------
+
+    void CCompiler::ParseGlobal()
+    {
+        size_t IndexOfDeclaration = m_Position;
+        bool   IsStatic           = false;
+
+        for (size_t Offset = 0; IsToken("static", Offset) || IsToken("const", Offset) || IsToken("uniform", Offset) || IsToken("inline", Offset); ++Offset)
+        {
+            IsStatic = IsStatic || IsToken("static", Offset);
+        }
+
+        SkipModifiers();
+
+        SType       Type;
+        std::string Name;
+
+        if (!ParseType(&Type) || !ExpectIdentifier(&Name)) return;
+
+        if (Accept("("))
+        {
+            ParseFunction(Type, Name);
+        }
+        else if (Type.m_Base == SType::Texture || Type.m_Base == SType::Sampler)
+        {
+            SSymbol Symbol;
+
+            Symbol.m_Name       = Name;
+            Symbol.m_Type       = Type;
+            Symbol.m_IsConstant = true;
+            Symbol.m_Buffer     = -1;
+            Symbol.m_Offset     = 0;
+            Symbol.m_Slot       = Type.m_Base == SType::Texture ? m_NextTexture : 0;
+
+            if (Accept(":") && !ParseRegister(Type.m_Base == SType::Texture ? 't' : 's', &Symbol.m_Slot)) return;
+
+            if (Type.m_Base == SType::Texture) m_NextTexture = Symbol.m_Slot + 1;
+
+            m_Symbols.push_back(Symbol);
+
+            SkipTo(";");
+            Expect(";");
+        }
+        else if (IsStatic)
+        {
+            m_StaticGlobals.push_back(IndexOfDeclaration);
+
+            SkipTo(";");
+            Expect(";");
+        }
+        else
+        {
+            Error("the global variable '%s' has to be static or in a constant buffer", Name.c_str());
+        }
+    }
+
+    // -----------------------------------------------------------------------------
+    // The body is only skipped here, it is compiled at every call.
+    // -----------------------------------------------------------------------------
+
+    void CCompiler::ParseFunction(const SType& _rReturnType, const std::string& _rName)
+    {
+        SFunction Function;
+
+        Function.m_Name       = _rName;
+        Function.m_ReturnType = _rReturnType;
+        Function.m_IsAnalyzed = false;
+
+        bool HasParameters = !Accept(")");
+
+        if (HasParameters && IsToken("void") && IsToken(")", 1))
+        {
+            m_Position += 2;
+
+            HasParameters = false;
+        }
+
+        if (HasParameters)
+        {
+            do
+            {
+                SParameter Parameter;
+
+                Parameter.m_IsIn      = true;
+                Parameter.m_IsOut     = false;
+                Parameter.m_IsWritten = true;
+
+                if      (Accept("out"))   Parameter.m_IsIn  = false, Parameter.m_IsOut = true;
+                else if (Accept("inout")) Parameter.m_IsOut = true;
+                else                      Accept("in");
+
+                SkipModifiers();
+
+                if (!ParseType(&Parameter.m_Type) || !ExpectIdentifier(&Parameter.m_Name)) return;
+
+                if (Accept(":") && !ExpectIdentifier(&Parameter.m_Semantic)) return;
+
+                if (IsToken("=") || IsToken("["))
+                {
+                    Error("default values and arrays are not supported for parameters");
+
+                    return;
+                }
+
+                Function.m_Parameters.push_back(Parameter);
+            }
+            while (Accept(","));
+
+            if (!Expect(")")) return;
+        }
+
+        if (Accept(":") && !ExpectIdentifier(&Function.m_Semantic)) return;
+
+        if (Accept(";")) return;
+
+        if (!IsToken("{"))
+        {
+            Expect("{");
+
+            return;
+        }
+
+        Function.m_IndexOfBody = m_Position;
+
+        SkipBalanced();
+
+        m_Functions.push_back(Function);
+    }
+
+    // -----------------------------------------------------------------------------
+    // A parameter is written if its name is followed by an assignment, maybe
+    // after members and indices, if it is incremented or decremented or if it
+    // is an argument of a function which might take it as out parameter.
+    // -----------------------------------------------------------------------------
+
+    void CCompiler::AnalyzeFunction(SFunction* _pFunction)
+    {
+        static const char* const s_Assignments[] = { "=", "+=", "-=", "*=", "/=", "%=", "++", "--" };
+
+        _pFunction->m_IsAnalyzed = true;
+
+        size_t Position = m_Position;
+
+        m_Position = _pFunction->m_IndexOfBody;
+
+        SkipBalanced();
+
+        size_t IndexOfEnd = m_Position;
+
+        m_Position = Position;
+
+        for (SParameter& rParameter : _pFunction->m_Parameters)
+        {
+            rParameter.m_IsWritten = rParameter.m_IsOut;
+
+            for (size_t IndexOfToken = _pFunction->m_IndexOfBody; IndexOfToken < IndexOfEnd && !rParameter.m_IsWritten; ++IndexOfToken)
+            {
+                const SToken& rToken = m_rTokens[IndexOfToken];
+
+                if (rToken.m_Kind != SToken::Identifier || rToken.m_Text != rParameter.m_Name) continue;
+
+                const std::string& rPrevious = m_rTokens[IndexOfToken - 1].m_Text;
+
+                if (rPrevious == "++" || rPrevious == "--" || rPrevious == ".")
+                {
+                    rParameter.m_IsWritten = rPrevious != ".";
+
+                    continue;
+                }
+
+                size_t IndexOfNext = IndexOfToken + 1;
+
+                for (;;)
+                {
+                    if (m_rTokens[IndexOfNext].m_Text == "." && IndexOfNext + 2 < IndexOfEnd)
+                    {
+                        IndexOfNext += 2;
+                    }
+                    else if (m_rTokens[IndexOfNext].m_Text == "[")
+                    {
+                        int Nesting = 0;
+
+                        do
+                        {
+                            if (m_rTokens[IndexOfNext].m_Text == "[") ++Nesting;
+                            if (m_rTokens[IndexOfNext].m_Text == "]") --Nesting;
+
+                            ++IndexOfNext;
+                        }
+                        while (Nesting > 0 && IndexOfNext < IndexOfEnd);
+                    }
+                    else
+                    {
+                        break;
+                    }
+                }
+
+                for (const char* pAssignment : s_Assignments) rParameter.m_IsWritten = rParameter.m_IsWritten || m_rTokens[IndexOfNext].m_Text == pAssignment;
+
+                // -----------------------------------------------------------------------------
+                // Find the function if the parameter is a whole argument.
+                // -----------------------------------------------------------------------------
+                const std::string& rNext = m_rTokens[IndexOfNext].m_Text;
+
+                if ((rPrevious == "(" || rPrevious == ",") && (rNext == ")" || rNext == ","))
+                {
+                    int Nesting = 0;
+
+                    for (size_t IndexOfOpening = IndexOfToken; IndexOfOpening > _pFunction->m_IndexOfBody; --IndexOfOpening)
+                    {
+                        const std::string& rText = m_rTokens[IndexOfOpening - 1].m_Text;
+
+                        if (rText == ")") ++Nesting;
+
+                        if (rText == "(" && Nesting-- == 0)
+                        {
+                            for (const SFunction& rFunction : m_Functions)
+                            {
+                                rParameter.m_IsWritten = rParameter.m_IsWritten || rFunction.m_Name == m_rTokens[IndexOfOpening - 2].m_Text;
+                            }
+
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // -----------------------------------------------------------------------------
+
+    const SFunction* CCompiler::FindFunction(const std::string& _rName, size_t _NumberOfArguments) const
+    {
+        for (const SFunction& rFunction : m_Functions)
+        {
+            if (rFunction.m_Name == _rName && rFunction.m_Parameters.size() == _NumberOfArguments) return &rFunction;
+        }
+
+        return nullptr;
+    }
+
+    // -----------------------------------------------------------------------------
+    // A function sees the globals and its own parameters and variables.
+    // -----------------------------------------------------------------------------
+
+    const SSymbol* CCompiler::FindSymbol(const std::string& _rName) const
+    {
+        size_t IndexOfFirstSymbol = m_Frames.empty() ? 0 : m_Frames.back().m_IndexOfFirstSymbol;
+
+        for (size_t IndexOfSymbol = m_Symbols.size(); IndexOfSymbol > IndexOfFirstSymbol; --IndexOfSymbol)
+        {
+            if (m_Symbols[IndexOfSymbol - 1].m_Name == _rName) return &m_Symbols[IndexOfSymbol - 1];
+        }
+
+        for (size_t IndexOfSymbol = std::min(m_NumberOfGlobals, IndexOfFirstSymbol); IndexOfSymbol > 0; --IndexOfSymbol)
+        {
+            if (m_Symbols[IndexOfSymbol - 1].m_Name == _rName) return &m_Symbols[IndexOfSymbol - 1];
+        }
+
+        return nullptr;
+    }
+} // namespace
+
+// -----------------------------------------------------------------------------
+// Code
+// -----------------------------------------------------------------------------
+
+namespace
+{
+    int CCompiler::Emit(SInstruction::EOpcode _Opcode, int _Destination, int _Source0, int _Source1, int _Source2, int _Parameter)
+    {
+        SInstruction Instruction = {};
+
+        Instruction.m_Opcode      = _Opcode;
+        Instruction.m_Destination = _Destination;
+        Instruction.m_Sources[0]  = _Source0;
+        Instruction.m_Sources[1]  = _Source1;
+        Instruction.m_Sources[2]  = _Source2;
+        Instruction.m_Parameter   = _Parameter;
+
+        m_Instructions.push_back(Instruction);
+
+        return static_cast<int>(m_Instructions.size()) - 1;
+    }
+
+    // -----------------------------------------------------------------------------
+    // Registers and masks are allocated like a stack, a statement releases the
+    // ones of its temporary values when it ends.
+    // -----------------------------------------------------------------------------
+
+    int CCompiler::AllocateRegisters(int _Count)
+    {
+        int Register = m_NumberOfRegisters;
+
+        m_NumberOfRegisters += _Count;
+
+        m_MaxNumberOfRegisters = std::max(m_MaxNumberOfRegisters, m_NumberOfRegisters);
+
+        if (m_RegisterDepths.size() < static_cast<size_t>(m_NumberOfRegisters)) m_RegisterDepths.resize(m_NumberOfRegisters);
+
+        for (int Index = Register; Index < m_NumberOfRegisters; ++Index) m_RegisterDepths[Index] = m_Depth;
+
+        return Register;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    int CCompiler::AllocateMask()
+    {
+        m_MaxNumberOfMasks = std::max(m_MaxNumberOfMasks, m_NumberOfMasks + 1);
+
+        return m_NumberOfMasks++;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    int CCompiler::GetConstant(SInstruction::EOpcode _Opcode, int _Buffer, int _Offset, float _Value)
+    {
+        for (size_t IndexOfConstant = 0; IndexOfConstant < m_Constants.size(); ++IndexOfConstant)
+        {
+            const SConstant& rConstant = m_Constants[IndexOfConstant];
+
+            if (rConstant.m_Opcode == _Opcode && rConstant.m_Buffer == _Buffer && rConstant.m_Offset == _Offset && std::memcmp(&rConstant.m_Value, &_Value, sizeof(_Value)) == 0)
+            {
+                return s_ConstantRegister + static_cast<int>(IndexOfConstant);
+            }
+        }
+
+        m_Constants.push_back(SConstant{ _Opcode, _Buffer, _Offset, _Value });
+
+        return s_ConstantRegister + static_cast<int>(m_Constants.size()) - 1;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    int CCompiler::GetLiteral(float _Value)
+    {
+        return GetConstant(SInstruction::Literal, 0, 0, _Value);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool CCompiler::IsLiteral(int _Register, float* _pValue) const
+    {
+        if (_Register < s_ConstantRegister || m_Constants[_Register - s_ConstantRegister].m_Opcode != SInstruction::Literal) return false;
+
+        *_pValue = m_Constants[_Register - s_ConstantRegister].m_Value;
+
+        return true;
+    }
+
+    // -----------------------------------------------------------------------------
+    // Operations on literals are folded, with the float arithmetic the
+    // program would use.
+    // -----------------------------------------------------------------------------
+
+    int CCompiler::EmitOperation(SInstruction::EOpcode _Opcode, int _Source0, int _Source1)
+    {
+        float Value0;
+        float Value1 = 0.0f;
+
+        bool IsUnary = _Opcode >= SInstruction::Negate && _Opcode <= SInstruction::Truncate;
+
+        if (IsLiteral(_Source0, &Value0) && (IsUnary || IsLiteral(_Source1, &Value1)))
+        {
+            switch (_Opcode)
+            {
+                case SInstruction::Add:        return GetLiteral(Value0 + Value1);
+                case SInstruction::Subtract:   return GetLiteral(Value0 - Value1);
+                case SInstruction::Multiply:   return GetLiteral(Value0 * Value1);
+                case SInstruction::Divide:     return GetLiteral(Value0 / Value1);
+                case SInstruction::Minimum:    return GetLiteral(Value0 < Value1 ? Value0 : Value1);
+                case SInstruction::Maximum:    return GetLiteral(Value0 > Value1 ? Value0 : Value1);
+                case SInstruction::Negate:     return GetLiteral(-Value0);
+                case SInstruction::Absolute:   return GetLiteral(std::fabs(Value0));
+                case SInstruction::SquareRoot: return GetLiteral(std::sqrt(Value0));
+                case SInstruction::Floor:      return GetLiteral(std::floor(Value0));
+                case SInstruction::Truncate:   return GetLiteral(std::trunc(Value0));
+                default:                       break;
+            }
+        }
+
+        int Register = AllocateRegisters(1);
+
+        Emit(_Opcode, Register, _Source0, _Source1);
+
+        return Register;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    int CCompiler::EmitSelect(int _Mask, int _True, int _False)
+    {
+        if (_True == _False) return _True;
+
+        int Register = AllocateRegisters(1);
+
+        Emit(SInstruction::Select, Register, _True, _False, _Mask);
+
+        return Register;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    int CCompiler::EmitComparison(SInstruction::EOpcode _Opcode, int _Source0, int _Source1)
+    {
+        int Mask = AllocateMask();
+
+        Emit(_Opcode, Mask, _Source0, _Source1);
+
+        return Mask;
+    }
+
+    // -----------------------------------------------------------------------------
+    // Lets a jump continue at the next instruction to be emitted.
+    // -----------------------------------------------------------------------------
+
+    void CCompiler::PatchJump(int _IndexOfJump)
+    {
+        m_Instructions[_IndexOfJump].m_Parameter = static_cast<int>(m_Instructions.size());
+    }
+
+    // -----------------------------------------------------------------------------
+    // The masks of returns, breaks and continues are cleared by a placeholder
+    // at the start of their function or loop, which becomes a clear with the
+    // first use.
+    // -----------------------------------------------------------------------------
+
+    void CCompiler::UseMask(int _IndexOfClear, int _Mask, bool* _pIsUsed)
+    {
+        if (*_pIsUsed) return;
+
+        m_Instructions[_IndexOfClear].m_Opcode      = SInstruction::MaskClear;
+        m_Instructions[_IndexOfClear].m_Destination = _Mask;
+
+        *_pIsUsed = true;
+    }
+
+    // -----------------------------------------------------------------------------
+    // Writes a value to registers. Sources which are overwritten before they
+    // are read are copied first, e.g. for v.xy = v.yx.
+    // -----------------------------------------------------------------------------
+
+    void CCompiler::Store(const std::vector<int>& _rDestination, std::vector<int> _Source)
+    {
+        bool IsOverlapping = false;
+
+        for (size_t Index = 0; Index < _Source.size(); ++Index)
+        {
+            for (size_t IndexOfDestination = 0; IndexOfDestination < Index; ++IndexOfDestination)
+            {
+                IsOverlapping = IsOverlapping || _Source[Index] == _rDestination[IndexOfDestination];
+            }
+        }
+
+        if (IsOverlapping)
+        {
+            for (int& rSource : _Source)
+            {
+                int Register = AllocateRegisters(1);
+
+                Emit(SInstruction::Move, Register, rSource);
+
+                rSource = Register;
+            }
+        }
+
+        for (size_t Index = 0; Index < _rDestination.size(); ++Index)
+        {
+            if (_rDestination[Index] == _Source[Index]) continue;
+
+            Emit(m_RegisterDepths[_rDestination[Index]] < m_Depth ? SInstruction::MoveMasked : SInstruction::Move, _rDestination[Index], _Source[Index]);
+        }
+    }
+
+    // -----------------------------------------------------------------------------
+
+    SValue CCompiler::MakeValue(const SType& _rType, const std::vector<int>& _rRegisters) const
+    {
+        SValue Value;
+
+        Value.m_Type       = _rType;
+        Value.m_Registers  = _rRegisters;
+        Value.m_IsWritable = false;
+        Value.m_Slot       = -1;
+
+        return Value;
+    }
+
+    // -----------------------------------------------------------------------------
+    // Booleans are 1 or 0 in their registers. The masks are kept for
+    // conditions, which then need no comparison.
+    // -----------------------------------------------------------------------------
+
+    SValue CCompiler::MakeBool(const std::vector<int>& _rMasks)
+    {
+        std::vector<int> Registers;
+
+        for (int Mask : _rMasks) Registers.push_back(EmitSelect(Mask, GetLiteral(1.0f), GetLiteral(0.0f)));
+
+        SValue Value = MakeValue(MakeType(SType::Bool, 1, static_cast<int>(_rMasks.size())), Registers);
+
+        Value.m_Masks = _rMasks;
+
+        return Value;
+    }
+
+    // -----------------------------------------------------------------------------
+    // Implicit and explicit conversions: scalars are replicated, vectors and
+    // matrices are truncated and floats are truncated to integers.
+    // -----------------------------------------------------------------------------
+
+    SValue CCompiler::Convert(const SValue& _rValue, const SType& _rType)
+    {
+        const SType& rFrom = _rValue.m_Type;
+
+        if (rFrom.m_Base == SType::Struct && _rType.m_Base == SType::Struct && rFrom.m_IndexOfStruct == _rType.m_IndexOfStruct) return _rValue;
+
+        if (rFrom.m_Base == _rType.m_Base && !IsNumeric(rFrom) && rFrom.m_Base != SType::Struct) return _rValue;
+
+        int NumberOfFloats = GetNumberOfFloats(_rType);
+
+        std::vector<int> Registers;
+
+        if (IsScalar(rFrom) && (IsNumeric(_rType) || _rType.m_Base == SType::Struct))
+        {
+            Registers.assign(NumberOfFloats, _rValue.m_Registers[0]);
+
+            if (_rType.m_Base == SType::Struct) return MakeValue(_rType, Registers);
+        }
+        else if (IsNumeric(rFrom) && IsScalar(_rType))
+        {
+            Registers.push_back(_rValue.m_Registers[0]);
+        }
+        else if (IsMatrix(rFrom) && IsMatrix(_rType) && _rType.m_Rows <= rFrom.m_Rows && _rType.m_Columns <= rFrom.m_Columns)
+        {
+            for (int Row = 0; Row < _rType.m_Rows; ++Row)
+            {
+                for (int Column = 0; Column < _rType.m_Columns; ++Column) Registers.push_back(_rValue.m_Registers[Row * rFrom.m_Columns + Column]);
+            }
+        }
+        else if (IsNumeric(rFrom) && IsNumeric(_rType) && !IsMatrix(rFrom) && !IsMatrix(_rType) && _rType.m_Columns <= rFrom.m_Columns)
+        {
+            Registers.assign(_rValue.m_Registers.begin(), _rValue.m_Registers.begin() + _rType.m_Columns);
+        }
+        else if (IsNumeric(rFrom) && IsNumeric(_rType) && NumberOfFloats == GetNumberOfFloats(rFrom))
+        {
+            Registers = _rValue.m_Registers;
+        }
+        else
+        {
+            Error("cannot convert from %s to %s", GetTypeName(rFrom).c_str(), GetTypeName(_rType).c_str());
+
+            return MakeValue(_rType, std::vector<int>(NumberOfFloats, GetLiteral(0.0f)));
+        }
+
+        if ((_rType.m_Base == SType::Int || _rType.m_Base == SType::UInt) && rFrom.m_Base == SType::Float)
+        {
+            for (int& rRegister : Registers) rRegister = EmitOperation(SInstruction::Truncate, rRegister);
+        }
+        else if (_rType.m_Base == SType::Bool && rFrom.m_Base != SType::Bool)
+        {
+            for (int& rRegister : Registers) rRegister = EmitSelect(EmitComparison(SInstruction::NotEqual, rRegister, GetLiteral(0.0f)), GetLiteral(1.0f), GetLiteral(0.0f));
+        }
+
+        SValue Value = MakeValue(_rType, Registers);
+
+        if (_rType.m_Base == SType::Bool && rFrom.m_Base == SType::Bool && _rValue.m_Masks.size() == Registers.size()) Value.m_Masks = _rValue.m_Masks;
+
+        return Value;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    int CCompiler::GetMask(const SValue& _rValue, int _Component)
+    {
+        if (!_rValue.m_Masks.empty()) return _rValue.m_Masks[std::min<int>(_Component, static_cast<int>(_rValue.m_Masks.size()) - 1)];
+
+        int Register = _rValue.m_Registers[std::min<int>(_Component, static_cast<int>(_rValue.m_Registers.size()) - 1)];
+
+        return EmitComparison(SInstruction::NotEqual, Register, GetLiteral(0.0f));
+    }
+
+    // -----------------------------------------------------------------------------
+    // The mask of a scalar condition. The 1 or 0 of a comparison right before
+    // is not needed then.
+    // -----------------------------------------------------------------------------
+
+    int CCompiler::GetCondition(const SValue& _rValue)
+    {
+        if (!IsScalar(_rValue.m_Type))
+        {
+            Error("a condition has to be a scalar instead of %s", GetTypeName(_rValue.m_Type).c_str());
+
+            return 0;
+        }
+
+        if (_rValue.m_Masks.size() == 1 && !m_Instructions.empty())
+        {
+            const SInstruction& rLast = m_Instructions.back();
+
+            if (rLast.m_Opcode == SInstruction::Select && rLast.m_Destination == _rValue.m_Registers[0]) m_Instructions.pop_back();
+        }
+
+        return GetMask(_rValue, 0);
+    }
+
+    // -----------------------------------------------------------------------------
+    // Scalars are replicated to every component.
+    // -----------------------------------------------------------------------------
+
+    int CCompiler::GetComponent(const SValue& _rValue, int _Row, int _Column) const
+    {
+        if (IsScalar(_rValue.m_Type)) return _rValue.m_Registers[0];
+
+        return _rValue.m_Registers[_Row * _rValue.m_Type.m_Columns + _Column];
+    }
+
+    // -----------------------------------------------------------------------------
+    // The type operands are converted to: the widest base type and the
+    // smallest shape except for scalars.
+    // -----------------------------------------------------------------------------
+
+    bool CCompiler::GetCommonType(const std::vector<SValue>& _rValues, SType* _pType)
+    {
+        *_pType = MakeType(SType::Bool);
+
+        bool IsFirst = true;
+
+        for (const SValue& rValue : _rValues)
+        {
+            const SType& rType = rValue.m_Type;
+
+            if (!IsNumeric(rType))
+            {
+                Error("%s is no numeric type", GetTypeName(rType).c_str());
+
+                return false;
+            }
+
+            _pType->m_Base = std::max(_pType->m_Base, rType.m_Base);
+
+            if (IsScalar(rType)) continue;
+
+            if (IsFirst || IsScalar(*_pType))
+            {
+                _pType->m_Rows    = rType.m_Rows;
+                _pType->m_Columns = rType.m_Columns;
+            }
+            else if (IsMatrix(*_pType) != IsMatrix(rType))
+            {
+                Error("cannot combine %s with %s", GetTypeName(*_pType).c_str(), GetTypeName(rType).c_str());
+
+                return false;
+            }
+            else
+            {
+                _pType->m_Rows    = std::min(_pType->m_Rows   , rType.m_Rows);
+                _pType->m_Columns = std::min(_pType->m_Columns, rType.m_Columns);
+            }
+
+            IsFirst = false;
+        }
+
+        return true;
+    }
+
+    // -----------------------------------------------------------------------------
+    // After a branch or loop the lanes which were executing before it execute
+    // again, except the ones which returned or left the loop in it.
+    // -----------------------------------------------------------------------------
+
+    void CCompiler::RestoreExecution(int _SavedMask)
+    {
+        const SFrame& rFrame = m_Frames.back();
+
+        Emit(SInstruction::MaskMove, 0, _SavedMask);
+
+        if (rFrame.m_IsReturnMaskUsed) Emit(SInstruction::MaskAndNot, 0, 0, rFrame.m_ReturnMask);
+
+        if (m_Loops.size() > rFrame.m_IndexOfFirstLoop)
+        {
+            const SLoop& rLoop = m_Loops.back();
+
+            if (rLoop.m_IsBreakMaskUsed)    Emit(SInstruction::MaskAndNot, 0, 0, rLoop.m_BreakMask);
+            if (rLoop.m_IsContinueMaskUsed) Emit(SInstruction::MaskAndNot, 0, 0, rLoop.m_ContinueMask);
+        }
+    }
+
+    // -----------------------------------------------------------------------------
+    // Counts the returns of the function and the breaks and continues of the
+    // innermost loop, which leave lanes disabled for the following code.
+    // -----------------------------------------------------------------------------
+
+    int CCompiler::GetNumberOfExits() const
+    {
+        const SFrame& rFrame = m_Frames.back();
+
+        int NumberOfExits = rFrame.m_NumberOfReturns;
+
+        if (m_Loops.size() > rFrame.m_IndexOfFirstLoop) NumberOfExits += m_Loops.back().m_NumberOfExits;
+
+        return NumberOfExits;
+    }
+} // namespace
+
+// -----------------------------------------------------------------------------
+// Statements
+// -----------------------------------------------------------------------------
+
+namespace
+{
+    void CCompiler::CompileStatement()
+    {
+        CNesting Nesting(&m_Nesting);
+
+        if (IsNestedTooDeep()) return;
+
+        int NumberOfRegisters = m_NumberOfRegisters;
+        int NumberOfMasks     = m_NumberOfMasks;
+
+        while (IsToken("[") && GetToken(1).m_Kind == SToken::Identifier) SkipBalanced();   // Attributes like [unroll].
+
+        if (Accept("{"))
+        {
+            CompileBlock();
+        }
+        else if (IsToken("if"))
+        {
+            CompileIf();
+        }
+        else if (IsToken("for") || IsToken("while") || IsToken("do"))
+        {
+            CompileLoop();
+        }
+        else if (IsToken("return"))
+        {
+            CompileReturn();
+        }
+        else if (IsToken("break") || IsToken("continue"))
+        {
+            CompileExit(IsToken("break"));
+        }
+        else if (IsToken("discard"))
+        {
+            Error("discard is not supported");
+        }
+        else if (Accept(";"))
+        {
+        }
+        else if (IsDeclaration())
+        {
+            CompileDeclaration();
+
+            return;
+        }
+        else
+        {
+            CompileExpression();
+
+            Expect(";");
+        }
+
+        m_NumberOfRegisters = NumberOfRegisters;
+        m_NumberOfMasks     = NumberOfMasks;
+    }
+
+    // -----------------------------------------------------------------------------
+    // The opening brace has been read.
+    // -----------------------------------------------------------------------------
+
+    void CCompiler::CompileBlock()
+    {
+        size_t NumberOfSymbols   = m_Symbols.size();
+        size_t IndexOfScope      = m_IndexOfScope;
+        int    NumberOfRegisters = m_NumberOfRegisters;
+        int    NumberOfMasks     = m_NumberOfMasks;
+
+        m_IndexOfScope = NumberOfSymbols;
+
+        while (!IsEnd() && !IsToken("}")) CompileStatement();
+
+        Expect("}");
+
+        m_Symbols.resize(NumberOfSymbols);
+
+        m_IndexOfScope = IndexOfScope;
+
+        m_NumberOfRegisters = NumberOfRegisters;
+        m_NumberOfMasks     = NumberOfMasks;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool CCompiler::IsDeclaration() const
+    {
+        if (IsToken("const") || IsToken("static") || IsToken("uniform")) return true;
+
+        return IsTypeName() && GetToken(1).m_Kind == SToken::Identifier;
+    }
+
+    // -----------------------------------------------------------------------------
+    // Variables without an initializer are 0. A constant initialized with
+    // literals or members of constant buffers uses their registers.
+    // -----------------------------------------------------------------------------
+
+    void CCompiler::CompileDeclaration()
+    {
+        bool IsConstant = false;
+
+        for (size_t Offset = 0; IsToken("static", Offset) || IsToken("const", Offset) || IsToken("uniform", Offset); ++Offset)
+        {
+            IsConstant = IsConstant || IsToken("const", Offset);
+        }
+
+        SkipModifiers();
+
+        SType Type;
+
+        if (!ParseType(&Type)) return;
+
+        if (!IsNumeric(Type) && Type.m_Base != SType::Struct)
+        {
+            Error("variables of type %s are not supported", GetTypeName(Type).c_str());
+
+            return;
+        }
+
+        do
+        {
+            SSymbol Symbol;
+
+            if (!ExpectIdentifier(&Symbol.m_Name)) return;
+
+            if (IsToken("["))
+            {
+                Error("arrays are not supported");
+
+                return;
+            }
+
+            for (size_t IndexOfSymbol = m_IndexOfScope; IndexOfSymbol < m_Symbols.size(); ++IndexOfSymbol)
+            {
+                if (m_Symbols[IndexOfSymbol].m_Name != Symbol.m_Name) continue;
+
+                --m_Position;
+
+                Error("'%s' is already declared in this scope", Symbol.m_Name.c_str());
+
+                return;
+            }
+
+            if (Accept(":")) SkipTo(IsToken("=") ? "=" : ";");
+
+            Symbol.m_Type       = Type;
+            Symbol.m_IsConstant = IsConstant;
+            Symbol.m_Buffer     = -1;
+            Symbol.m_Offset     = 0;
+            Symbol.m_Slot       = -1;
+
+            int NumberOfFloats = GetNumberOfFloats(Type);
+            int FirstRegister  = AllocateRegisters(NumberOfFloats);
+            int NumberOfMasks  = m_NumberOfMasks;
+
+            for (int Index = 0; Index < NumberOfFloats; ++Index) Symbol.m_Registers.push_back(FirstRegister + Index);
+
+            if (Accept("="))
+            {
+                SValue Value = Convert(CompileExpression(), Type);
+
+                bool IsUniform = IsConstant;
+
+                for (int Register : Value.m_Registers) IsUniform = IsUniform && Register >= s_ConstantRegister;
+
+                if (IsUniform)
+                {
+                    Symbol.m_Registers = Value.m_Registers;
+                }
+                else if (!m_HasError)
+                {
+                    Store(Symbol.m_Registers, Value.m_Registers);
+                }
+            }
+            else
+            {
+                Store(Symbol.m_Registers, std::vector<int>(NumberOfFloats, GetLiteral(0.0f)));
+            }
+
+            m_NumberOfRegisters = FirstRegister + NumberOfFloats;
+            m_NumberOfMasks     = NumberOfMasks;
+
+            m_Symbols.push_back(Symbol);
+        }
+        while (Accept(","));
+
+        Expect(";");
+    }
+
+    // -----------------------------------------------------------------------------
+    // The lanes of the condition execute the first statement, the others the
+    // one after else. Both run unless they have no lanes, so a branch costs
+    // the sum of its statements if the lanes diverge.
+    // -----------------------------------------------------------------------------
+
+    void CCompiler::CompileIf()
+    {
+        Expect("if");
+        Expect("(");
+
+        int Condition = GetCondition(CompileExpression());
+
+        Expect(")");
+
+        int SavedMask     = AllocateMask();
+        int Depth         = m_Depth;
+        int NumberOfExits = GetNumberOfExits();
+
+        Emit(SInstruction::MaskMove, SavedMask, 0);
+        Emit(SInstruction::MaskAnd, 0, SavedMask, Condition);
+
+        int Jump = Emit(SInstruction::JumpIfNone, 0, 0);
+
+        m_Depth = Depth + 1;
+
+        CompileStatement();
+
+        if (Accept("else"))
+        {
+            PatchJump(Jump);
+
+            Emit(SInstruction::MaskAndNot, 0, SavedMask, Condition);
+
+            Jump = Emit(SInstruction::JumpIfNone, 0, 0);
+
+            m_Depth = Depth + 1;
+
+            CompileStatement();
+        }
+
+        PatchJump(Jump);
+
+        RestoreExecution(SavedMask);
+
+        m_Depth = Depth + (GetNumberOfExits() != NumberOfExits ? 1 : 0);
+    }
+
+    // -----------------------------------------------------------------------------
+    // for, while and do. The lanes for which the condition fails stop, the
+    // loop ends when no lane is left. The increment of a for loop is parsed
+    // after the body.
+    // -----------------------------------------------------------------------------
+
+    void CCompiler::CompileLoop()
+    {
+        size_t NumberOfSymbols = m_Symbols.size();
+        size_t IndexOfScope    = m_IndexOfScope;
+        bool   IsFor           = Accept("for");
+        bool   IsDo            = !IsFor && Accept("do");
+
+        m_IndexOfScope = NumberOfSymbols;
+
+        if (!IsDo && !IsFor) Expect("while");
+
+        if (!IsDo) Expect("(");
+
+        if (IsFor && !Accept(";"))
+        {
+            if (IsDeclaration())
+            {
+                CompileDeclaration();
+            }
+            else
+            {
+                CompileExpression();
+
+                Expect(";");
+            }
+        }
+
+        int  SavedMask     = AllocateMask();
+        int  Depth         = m_Depth;
+        int  NumberOfExits = GetNumberOfExits();
+
+        Emit(SInstruction::MaskMove, SavedMask, 0);
+
+        SLoop Loop;
+
+        Loop.m_BreakMask          = AllocateMask();
+        Loop.m_BreakMaskClear     = Emit(SInstruction::Nop, 0);
+        Loop.m_IsBreakMaskUsed    = false;
+        Loop.m_ContinueMask       = AllocateMask();
+        Loop.m_ContinueMaskClear  = Emit(SInstruction::Nop, 0);
+        Loop.m_IsContinueMaskUsed = false;
+        Loop.m_NumberOfExits      = 0;
+
+        m_Loops.push_back(Loop);
+
+        int IndexOfStart = static_cast<int>(m_Instructions.size());
+        int ExitJump     = -1;
+
+        m_Depth = Depth + 1;
+
+        if (!IsDo)
+        {
+            if (!IsToken(IsFor ? ";" : ")"))
+            {
+                int Condition = GetCondition(CompileExpression());
+
+                Emit(SInstruction::MaskAnd, 0, 0, Condition);
+
+                ExitJump = Emit(SInstruction::JumpIfNone, 0, 0);
+            }
+
+            Expect(IsFor ? ";" : ")");
+        }
+
+        size_t IndexOfIncrement = m_Position;
+
+        if (IsFor)
+        {
+            SkipTo(")");
+            Expect(")");
+        }
+
+        CompileStatement();
+
+        if (m_Loops.back().m_IsContinueMaskUsed)
+        {
+            Emit(SInstruction::MaskOr, 0, 0, m_Loops.back().m_ContinueMask);
+            Emit(SInstruction::MaskClear, m_Loops.back().m_ContinueMask);
+        }
+
+        if (IsFor)
+        {
+            size_t IndexOfEnd = m_Position;
+
+            m_Position = IndexOfIncrement;
+
+            if (!IsToken(")")) CompileExpression();
+
+            Expect(")");
+
+            m_Position = IndexOfEnd;
+        }
+
+        if (IsDo)
+        {
+            Expect("while");
+            Expect("(");
+
+            int Condition = GetCondition(CompileExpression());
+
+            Expect(")");
+            Expect(";");
+
+            Emit(SInstruction::MaskAnd, 0, 0, Condition);
+            Emit(SInstruction::JumpIfAny, 0, 0, 0, 0, IndexOfStart);
+        }
+        else
+        {
+            Emit(SInstruction::Jump, 0, 0, 0, 0, IndexOfStart);
+        }
+
+        if (ExitJump >= 0) PatchJump(ExitJump);
+
+        m_Loops.pop_back();
+
+        RestoreExecution(SavedMask);
+
+        m_Depth = Depth + (GetNumberOfExits() != NumberOfExits ? 1 : 0);
+
+        m_Symbols.resize(NumberOfSymbols);
+
+        m_IndexOfScope = IndexOfScope;
+    }
+
+    // -----------------------------------------------------------------------------
+    // A return of all executing lanes jumps to the end of the function, the
+    // lanes of a return in a branch are disabled until the function ends.
+    // -----------------------------------------------------------------------------
+
+    void CCompiler::CompileReturn()
+    {
+        Expect("return");
+
+        SType ReturnType = m_Frames.back().m_pFunction->m_ReturnType;
+
+        if (!IsToken(";"))
+        {
+            SValue Value = CompileExpression();
+
+            if (ReturnType.m_Base == SType::Void)
+            {
+                Error("the function %s returns no value", m_Frames.back().m_pFunction->m_Name.c_str());
+
+                return;
+            }
+
+            Value = Convert(Value, ReturnType);
+
+            if (!m_HasError) Store(m_Frames.back().m_ReturnRegisters, Value.m_Registers);
+        }
+
+        Expect(";");
+
+        SFrame& rFrame = m_Frames.back();
+
+        if (m_Depth == rFrame.m_Depth)
+        {
+            rFrame.m_ReturnJumps.push_back(Emit(SInstruction::Jump, 0));
+        }
+        else
+        {
+            UseMask(rFrame.m_ReturnMaskClear, rFrame.m_ReturnMask, &rFrame.m_IsReturnMaskUsed);
+
+            Emit(SInstruction::MaskOr, rFrame.m_ReturnMask, rFrame.m_ReturnMask, 0);
+            Emit(SInstruction::MaskClear, 0);
+
+            ++rFrame.m_NumberOfReturns;
+        }
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void CCompiler::CompileExit(bool _IsBreak)
+    {
+        ++m_Position;
+
+        Expect(";");
+
+        if (m_Loops.size() <= m_Frames.back().m_IndexOfFirstLoop)
+        {
+            Error("%s outside of a loop", _IsBreak ? "break" : "continue");
+
+            return;
+        }
+
+        SLoop& rLoop = m_Loops.back();
+
+        if (_IsBreak)
+        {
+            UseMask(rLoop.m_BreakMaskClear, rLoop.m_BreakMask, &rLoop.m_IsBreakMaskUsed);
+
+            Emit(SInstruction::MaskOr, rLoop.m_BreakMask, rLoop.m_BreakMask, 0);
+        }
+        else
+        {
+            UseMask(rLoop.m_ContinueMaskClear, rLoop.m_ContinueMask, &rLoop.m_IsContinueMaskUsed);
+
+            Emit(SInstruction::MaskOr, rLoop.m_ContinueMask, rLoop.m_ContinueMask, 0);
+        }
+
+        Emit(SInstruction::MaskClear, 0);
+
+        ++rLoop.m_NumberOfExits;
+    }
+
+    // -----------------------------------------------------------------------------
+    // Compiles the body of a function in place. Its parameters are the last
+    // symbols.
+    // -----------------------------------------------------------------------------
+
+    SValue CCompiler::InlineFunction(const SFunction& _rFunction)
+    {
+        if (m_Frames.size() >= static_cast<size_t>(s_MaxCallDepth))
+        {
+            Error("the call of %s is nested too deep, recursion is not supported", _rFunction.m_Name.c_str());
+
+            return MakeValue(_rFunction.m_ReturnType, std::vector<int>(GetNumberOfFloats(_rFunction.m_ReturnType), GetLiteral(0.0f)));
+        }
+
+        SFrame Frame;
+
+        int NumberOfFloats = GetNumberOfFloats(_rFunction.m_ReturnType);
+        int FirstRegister  = AllocateRegisters(NumberOfFloats);
+
+        for (int Index = 0; Index < NumberOfFloats; ++Index) Frame.m_ReturnRegisters.push_back(FirstRegister + Index);
+
+        Frame.m_pFunction          = &_rFunction;
+        Frame.m_IndexOfFirstSymbol = m_Symbols.size() - _rFunction.m_Parameters.size();
+        Frame.m_IndexOfFirstLoop   = m_Loops.size();
+        Frame.m_Depth              = m_Depth;
+        Frame.m_ReturnMask         = AllocateMask();
+        Frame.m_ReturnMaskClear    = Emit(SInstruction::Nop, 0);
+        Frame.m_IsReturnMaskUsed   = false;
+        Frame.m_NumberOfReturns    = 0;
+
+        m_Frames.push_back(Frame);
+
+        size_t Position = m_Position;
+
+        m_Position = _rFunction.m_IndexOfBody;
+
+        Expect("{");
+
+        CompileBlock();
+
+        m_Position = Position;
+
+        const SFrame& rFrame = m_Frames.back();
+
+        for (int IndexOfJump : rFrame.m_ReturnJumps) PatchJump(IndexOfJump);
+
+        if (rFrame.m_IsReturnMaskUsed) Emit(SInstruction::MaskOr, 0, 0, rFrame.m_ReturnMask);
+
+        m_Depth = rFrame.m_Depth;
+
+        SValue Result = MakeValue(_rFunction.m_ReturnType, rFrame.m_ReturnRegisters);
+
+        m_Frames.pop_back();
+
+        return Result;
+    }
+} // namespace
+
+// -----------------------------------------------------------------------------
+// Expressions
+// -----------------------------------------------------------------------------
+
+namespace
+{
+    SValue CCompiler::CompileExpression()
+    {
+        static const struct
+        {
+            const char*           m_pOperator;
+            const char*           m_pBinaryOperator;
+        }
+        s_Assignments[] =
+        {
+            { "=" , nullptr },
+            { "+=", "+" },
+            { "-=", "-" },
+            { "*=", "*" },
+            { "/=", "/" },
+            { "%=", "%" },
+        };
+
+        CNesting Nesting(&m_Nesting);
+
+        if (IsNestedTooDeep()) return MakeValue(MakeType(SType::Float), { GetLiteral(0.0f) });
+
+        SValue Left = CompileConditional();
+
+        for (const auto& rAssignment : s_Assignments)
+        {
+            if (!Accept(rAssignment.m_pOperator)) continue;
+
+            if (!Left.m_IsWritable)
+            {
+                Error("the left side of %s cannot be written", rAssignment.m_pOperator);
+
+                return Left;
+            }
+
+            SValue Right = CompileExpression();
+
+            if (rAssignment.m_pBinaryOperator != nullptr) Right = CompileOperation(rAssignment.m_pBinaryOperator, Left, Right);
+
+            Right = Convert(Right, Left.m_Type);
+
+            if (!m_HasError) Store(Left.m_Registers, Right.m_Registers);
+
+            return Left;
+        }
+
+        return Left;
+    }
+
+    // -----------------------------------------------------------------------------
+    // Both sides of ?:, && and || are evaluated, like in HLSL.
+    // -----------------------------------------------------------------------------
+
+    SValue CCompiler::CompileConditional()
+    {
+        CNesting Nesting(&m_Nesting);
+
+        if (IsNestedTooDeep()) return MakeValue(MakeType(SType::Float), { GetLiteral(0.0f) });
+
+        SValue Condition = CompileBinary(0);
+
+        if (!Accept("?")) return Condition;
+
+        SValue True = CompileExpression();
+
+        Expect(":");
+
+        SValue False = CompileConditional();
+
+        SType Type;
+
+        if (!GetCommonType({ True, False }, &Type)) return True;
+
+        True  = Convert(True , Type);
+        False = Convert(False, Type);
+
+        std::vector<int> Registers;
+
+        for (size_t Index = 0; Index < True.m_Registers.size() && !m_HasError; ++Index)
+        {
+            Registers.push_back(EmitSelect(GetMask(Condition, static_cast<int>(Index)), True.m_Registers[Index], False.m_Registers[Index]));
+        }
+
+        return MakeValue(Type, Registers);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    SValue CCompiler::CompileBinary(int _Level)
+    {
+        static const char* const s_Operators[][4] =
+        {
+            { "||" },
+            { "&&" },
+            { "==", "!=" },
+            { "<", ">", "<=", ">=" },
+            { "+", "-" },
+            { "*", "/", "%" },
+        };
+
+        const int NumberOfLevels = sizeof(s_Operators) / sizeof(s_Operators[0]);
+
+        if (_Level == NumberOfLevels) return CompileUnary();
+
+        SValue Left = CompileBinary(_Level + 1);
+
+        while (!m_HasError)
+        {
+            const char* pOperator = nullptr;
+
+            for (const char* pCandidate : s_Operators[_Level])
+            {
+                if (pCandidate != nullptr && IsToken(pCandidate)) pOperator = pCandidate;
+            }
+
+            if (pOperator == nullptr) break;
+
+            ++m_Position;
+
+            SValue Right = CompileBinary(_Level + 1);
+
+            Left = CompileOperation(pOperator, Left, Right);
+        }
+
+        return Left;
+    }
+
+    // -----------------------------------------------------------------------------
+    // Arithmetic is done in the common type, an integer division truncates.
+    // -----------------------------------------------------------------------------
+
+    SValue CCompiler::CompileOperation(const std::string& _rOperator, const SValue& _rLeft, const SValue& _rRight)
+    {
+        static const struct
+        {
+            const char*           m_pOperator;
+            SInstruction::EOpcode m_Opcode;
+        }
+        s_Operations[] =
+        {
+            { "+" , SInstruction::Add },
+            { "-" , SInstruction::Subtract },
+            { "*" , SInstruction::Multiply },
+            { "/" , SInstruction::Divide },
+            { "%" , SInstruction::Divide },
+            { "<" , SInstruction::Less },
+            { "<=", SInstruction::LessEqual },
+            { ">" , SInstruction::Greater },
+            { ">=", SInstruction::GreaterEqual },
+            { "==", SInstruction::Equal },
+            { "!=", SInstruction::NotEqual },
+            { "&&", SInstruction::MaskAnd },
+            { "||", SInstruction::MaskOr },
+        };
+
+        SType Type;
+
+        if (!GetCommonType({ _rLeft, _rRight }, &Type)) return _rLeft;
+
+        SInstruction::EOpcode Opcode = SInstruction::Nop;
+
+        for (const auto& rOperation : s_Operations)
+        {
+            if (_rOperator == rOperation.m_pOperator) Opcode = rOperation.m_Opcode;
+        }
+
+        if (Opcode == SInstruction::MaskAnd || Opcode == SInstruction::MaskOr)
+        {
+            std::vector<int> Masks;
+
+            for (int Row = 0; Row < Type.m_Rows; ++Row)
+            {
+                for (int Column = 0; Column < Type.m_Columns; ++Column)
+                {
+                    int Component = Row * Type.m_Columns + Column;
+                    int Mask      = AllocateMask();
+
+                    Emit(Opcode, Mask, GetMask(_rLeft, Component), GetMask(_rRight, Component));
+
+                    Masks.push_back(Mask);
+                }
+            }
+
+            return MakeBool(Masks);
+        }
+
+        if (Type.m_Base == SType::Bool) Type.m_Base = SType::Int;
+
+        SValue Left  = Convert(_rLeft , IsScalar(_rLeft .m_Type) ? MakeType(Type.m_Base) : Type);
+        SValue Right = Convert(_rRight, IsScalar(_rRight.m_Type) ? MakeType(Type.m_Base) : Type);
+
+        bool             IsComparison = Opcode >= SInstruction::Less && Opcode <= SInstruction::NotEqual;
+        bool             IsInteger    = Type.m_Base != SType::Float;
+        std::vector<int> Registers;
+        std::vector<int> Masks;
+
+        for (int Row = 0; Row < Type.m_Rows && !m_HasError; ++Row)
+        {
+            for (int Column = 0; Column < Type.m_Columns; ++Column)
+            {
+                int Source0 = GetComponent(Left , Row, Column);
+                int Source1 = GetComponent(Right, Row, Column);
+
+                if (IsComparison)
+                {
+                    Masks.push_back(EmitComparison(Opcode, Source0, Source1));
+
+                    continue;
+                }
+
+                int Register = EmitOperation(Opcode, Source0, Source1);
+
+                if (Opcode == SInstruction::Divide && (IsInteger || _rOperator == "%"))
+                {
+                    if (IsInteger || _rOperator == "%") Register = EmitOperation(SInstruction::Truncate, Register);
+
+                    if (_rOperator == "%") Register = EmitOperation(SInstruction::Subtract, Source0, EmitOperation(SInstruction::Multiply, Source1, Register));
+                }
+
+                Registers.push_back(Register);
+            }
+        }
+
+        if (IsComparison) return MakeBool(Masks);
+
+        return MakeValue(Type, Registers);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    SValue CCompiler::CompileUnary()
+    {
+        CNesting Nesting(&m_Nesting);
+
+        if (IsNestedTooDeep()) return MakeValue(MakeType(SType::Float), { GetLiteral(0.0f) });
+
+        if (IsToken("(") && IsTypeName(1) && IsToken(")", 2))
+        {
+            ++m_Position;
+
+            SType Type;
+
+            ParseType(&Type);
+
+            Expect(")");
+
+            return Convert(CompileUnary(), Type);
+        }
+
+        if (Accept("+")) return CompileUnary();
+
+        if (Accept("-"))
+        {
+            SValue Value = CompileUnary();
+
+            if (!IsNumeric(Value.m_Type))
+            {
+                Error("cannot negate %s", GetTypeName(Value.m_Type).c_str());
+
+                return Value;
+            }
+
+            std::vector<int> Registers;
+
+            for (int Register : Value.m_Registers) Registers.push_back(EmitOperation(SInstruction::Negate, Register));
+
+            return MakeValue(Value.m_Type.m_Base == SType::Bool ? MakeType(SType::Int, Value.m_Type.m_Rows, Value.m_Type.m_Columns) : Value.m_Type, Registers);
+        }
+
+        if (Accept("!"))
+        {
+            SValue Value = CompileUnary();
+
+            if (!IsNumeric(Value.m_Type))
+            {
+                Error("cannot apply ! to %s", GetTypeName(Value.m_Type).c_str());
+
+                return Value;
+            }
+
+            std::vector<int> Masks;
+
+            for (int Register : Value.m_Registers) Masks.push_back(EmitComparison(SInstruction::Equal, Register, GetLiteral(0.0f)));
+
+            return MakeBool(Masks);
+        }
+
+        if (IsToken("++") || IsToken("--"))
+        {
+            bool IsIncrement = Accept("++") || (++m_Position, false);
+
+            SValue Value = CompileUnary();
+
+            if (!Value.m_IsWritable)
+            {
+                Error("the operand of %s cannot be written", IsIncrement ? "++" : "--");
+
+                return Value;
+            }
+
+            Store(Value.m_Registers, Convert(CompileOperation(IsIncrement ? "+" : "-", Value, MakeValue(MakeType(SType::Int), { GetLiteral(1.0f) })), Value.m_Type).m_Registers);
+
+            return Value;
+        }
+
+        return CompilePostfix();
+    }
+
+    // -----------------------------------------------------------------------------
+
+    SValue CCompiler::CompilePostfix()
+    {
+        SValue Value = CompilePrimary();
+
+        while (!m_HasError)
+        {
+            if (Accept("."))
+            {
+                Value = CompileMember(Value);
+            }
+            else if (Accept("["))
+            {
+                Value = CompileIndex(Value);
+            }
+            else if (IsToken("++") || IsToken("--"))
+            {
+                bool IsIncrement = IsToken("++");
+
+                ++m_Position;
+
+                if (!Value.m_IsWritable)
+                {
+                    Error("the operand of %s cannot be written", IsIncrement ? "++" : "--");
+
+                    return Value;
+                }
+
+                SValue Copy = MakeValue(Value.m_Type, {});
+
+                for (int Register : Value.m_Registers)
+                {
+                    Copy.m_Registers.push_back(AllocateRegisters(1));
+
+                    Emit(SInstruction::Move, Copy.m_Registers.back(), Register);
+                }
+
+                Store(Value.m_Registers, Convert(CompileOperation(IsIncrement ? "+" : "-", Value, MakeValue(MakeType(SType::Int), { GetLiteral(1.0f) })), Value.m_Type).m_Registers);
+
+                Value = Copy;
+            }
+            else
+            {
+                break;
+            }
+        }
+
+        return Value;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    SValue CCompiler::CompilePrimary()
+    {
+        const SToken& rToken = GetToken();
+
+        if (rToken.m_Kind == SToken::Number)
+        {
+            std::string Text = rToken.m_Text;
+
+            ++m_Position;
+
+            bool IsHexadecimal = Text.size() > 2 && (Text[1] == 'x' || Text[1] == 'X');
+            bool IsFloat       = !IsHexadecimal && Text.find_first_of(".eEfFhH") != std::string::npos;
+            bool IsUnsigned    = !IsFloat && Text.find_first_of("uU") != std::string::npos;
+
+            char* pEnd  = nullptr;
+            float Value = IsFloat ? std::strtof(Text.c_str(), &pEnd) : static_cast<float>(std::strtoull(Text.c_str(), &pEnd, 0));
+
+            if (pEnd == Text.c_str() || std::strspn(pEnd, IsFloat ? "fFhHlL" : "uUlL") != std::strlen(pEnd))
+            {
+                --m_Position;
+
+                Error("invalid number '%s'", Text.c_str());
+            }
+
+            return MakeValue(MakeType(IsFloat ? SType::Float : (IsUnsigned ? SType::UInt : SType::Int)), { GetLiteral(Value) });
+        }
+
+        if (Accept("true"))  return MakeValue(MakeType(SType::Bool), { GetLiteral(1.0f) });
+        if (Accept("false")) return MakeValue(MakeType(SType::Bool), { GetLiteral(0.0f) });
+
+        if (Accept("("))
+        {
+            SValue Value = CompileExpression();
+
+            Expect(")");
+
+            return Value;
+        }
+
+        if (IsTypeName() && IsToken("(", 1))
+        {
+            SType Type;
+
+            ParseType(&Type);
+
+            return CompileConstructor(Type);
+        }
+
+        if (rToken.m_Kind == SToken::Identifier && IsToken("(", 1))
+        {
+            std::string Name = rToken.m_Text;
+
+            m_Position += 2;
+
+            return CompileCall(Name);
+        }
+
+        if (rToken.m_Kind == SToken::Identifier)
+        {
+            const SSymbol* pSymbol = FindSymbol(rToken.m_Text);
+
+            if (pSymbol != nullptr)
+            {
+                ++m_Position;
+
+                return CompileSymbol(*pSymbol);
+            }
+
+            Error("unknown name '%s'", rToken.m_Text.c_str());
+        }
+        else
+        {
+            Error("unexpected '%s'", rToken.m_Kind == SToken::End ? "end of file" : rToken.m_Text.c_str());
+        }
+
+        return MakeValue(MakeType(SType::Float), { GetLiteral(0.0f) });
+    }
+
+    // -----------------------------------------------------------------------------
+    // Members of constant buffers are loaded on their first use.
+    // -----------------------------------------------------------------------------
+
+    SValue CCompiler::CompileSymbol(const SSymbol& _rSymbol)
+    {
+        SValue Value = MakeValue(_rSymbol.m_Type, _rSymbol.m_Registers);
+
+        Value.m_IsWritable = !_rSymbol.m_IsConstant;
+        Value.m_Slot       = _rSymbol.m_Slot;
+
+        if (_rSymbol.m_Buffer >= 0)
+        {
+            SInstruction::EOpcode Opcode = _rSymbol.m_Type.m_Base == SType::Float ? SInstruction::LoadFloat : (_rSymbol.m_Type.m_Base == SType::Int ? SInstruction::LoadInt : SInstruction::LoadUInt);
+
+            for (int Row = 0; Row < _rSymbol.m_Type.m_Rows; ++Row)
+            {
+                for (int Column = 0; Column < _rSymbol.m_Type.m_Columns; ++Column)
+                {
+                    Value.m_Registers.push_back(GetConstant(Opcode, _rSymbol.m_Buffer, _rSymbol.m_Offset + 4 * Row + Column, 0.0f));
+                }
+            }
+        }
+
+        return Value;
+    }
+
+    // -----------------------------------------------------------------------------
+    // Members of structs, swizzles and the Sample method of textures.
+    // -----------------------------------------------------------------------------
+
+    SValue CCompiler::CompileMember(const SValue& _rValue)
+    {
+        std::string Name;
+
+        if (!ExpectIdentifier(&Name)) return _rValue;
+
+        if (_rValue.m_Type.m_Base == SType::Struct)
+        {
+            for (const SMember& rMember : m_Structs[_rValue.m_Type.m_IndexOfStruct].m_Members)
+            {
+                if (rMember.m_Name != Name) continue;
+
+                SValue Member = _rValue;
+
+                Member.m_Type = rMember.m_Type;
+
+                Member.m_Registers.assign(_rValue.m_Registers.begin() + rMember.m_Offset, _rValue.m_Registers.begin() + rMember.m_Offset + GetNumberOfFloats(rMember.m_Type));
+
+                return Member;
+            }
+
+            Error("%s has no member %s", GetTypeName(_rValue.m_Type).c_str(), Name.c_str());
+
+            return _rValue;
+        }
+
+        if (_rValue.m_Type.m_Base == SType::Texture)
+        {
+            std::vector<SValue> Arguments;
+
+            if (Name != "Sample" && Name != "SampleLevel")
+            {
+                Error("textures only support Sample and SampleLevel");
+
+                return _rValue;
+            }
+
+            if (!Expect("(") || !ParseArguments(&Arguments)) return _rValue;
+
+            if (Arguments.size() != (Name == "Sample" ? 2u : 3u) || Arguments[0].m_Type.m_Base != SType::Sampler)
+            {
+                Error("%s takes a sampler and the texture coordinates%s", Name.c_str(), Name == "Sample" ? "" : " and the level");
+
+                return _rValue;
+            }
+
+            SValue Coordinates = Convert(Arguments[1], MakeType(SType::Float, 1, 2));
+
+            int Register = AllocateRegisters(4);
+
+            Emit(SInstruction::Sample, Register, Coordinates.m_Registers[0], Coordinates.m_Registers[1], 0, _rValue.m_Slot);
+
+            return MakeValue(MakeType(SType::Float, 1, 4), { Register, Register + 1, Register + 2, Register + 3 });
+        }
+
+        if (!IsNumeric(_rValue.m_Type) || IsMatrix(_rValue.m_Type) || Name.size() > 4)
+        {
+            Error("invalid member %s of %s", Name.c_str(), GetTypeName(_rValue.m_Type).c_str());
+
+            return _rValue;
+        }
+
+        SValue Swizzle = _rValue;
+
+        Swizzle.m_Registers.clear();
+        Swizzle.m_Masks.clear();
+
+        for (char Character : Name)
+        {
+            const char* pXYZW = std::strchr("xyzw", Character);
+            const char* pRGBA = std::strchr("rgba", Character);
+
+            int Component = pXYZW != nullptr ? static_cast<int>(pXYZW - "xyzw") : (pRGBA != nullptr ? static_cast<int>(pRGBA - "rgba") : 4);
+
+            if (Character == '\0' || Component >= _rValue.m_Type.m_Columns)
+            {
+                Error("invalid swizzle %s of %s", Name.c_str(), GetTypeName(_rValue.m_Type).c_str());
+
+                return _rValue;
+            }
+
+            for (int Register : Swizzle.m_Registers) Swizzle.m_IsWritable = Swizzle.m_IsWritable && Register != _rValue.m_Registers[Component];
+
+            Swizzle.m_Registers.push_back(_rValue.m_Registers[Component]);
+
+            if (_rValue.m_Masks.size() == _rValue.m_Registers.size()) Swizzle.m_Masks.push_back(_rValue.m_Masks[Component]);
+        }
+
+        Swizzle.m_Type.m_Columns = static_cast<int>(Name.size());
+
+        return Swizzle;
+    }
+
+    // -----------------------------------------------------------------------------
+    // The index of a vector or a row of a matrix has to be a literal.
+    // -----------------------------------------------------------------------------
+
+    SValue CCompiler::CompileIndex(const SValue& _rValue)
+    {
+        SValue Index = CompileExpression();
+
+        Expect("]");
+
+        float Literal = 0.0f;
+
+        if (!IsScalar(Index.m_Type) || !IsLiteral(Index.m_Registers[0], &Literal))
+        {
+            Error("an index has to be a constant");
+
+            return _rValue;
+        }
+
+        int Component = static_cast<int>(Literal);
+        int Size      = IsMatrix(_rValue.m_Type) ? _rValue.m_Type.m_Rows : _rValue.m_Type.m_Columns;
+
+        if (!IsNumeric(_rValue.m_Type) || Component < 0 || Component >= Size)
+        {
+            Error("the index %d is out of the range of %s", Component, GetTypeName(_rValue.m_Type).c_str());
+
+            return _rValue;
+        }
+
+        SValue Value = _rValue;
+
+        Value.m_Masks.clear();
+
+        if (IsMatrix(_rValue.m_Type))
+        {
+            int Columns = _rValue.m_Type.m_Columns;
+
+            Value.m_Type = MakeType(_rValue.m_Type.m_Base, 1, Columns);
+
+            Value.m_Registers.assign(_rValue.m_Registers.begin() + Component * Columns, _rValue.m_Registers.begin() + (Component + 1) * Columns);
+        }
+        else
+        {
+            Value.m_Type = MakeType(_rValue.m_Type.m_Base);
+
+            Value.m_Registers.assign(1, _rValue.m_Registers[Component]);
+        }
+
+        return Value;
+    }
+
+    // -----------------------------------------------------------------------------
+    // float4(float3, 1.0f), float3x3(row, row, row) or a replicated scalar.
+    // -----------------------------------------------------------------------------
+
+    SValue CCompiler::CompileConstructor(const SType& _rType)
+    {
+        std::vector<SValue> Arguments;
+
+        if (!Expect("(") || !ParseArguments(&Arguments)) return MakeValue(_rType, {});
+
+        if (!IsNumeric(_rType))
+        {
+            Error("%s has no constructor", GetTypeName(_rType).c_str());
+
+            return MakeValue(_rType, {});
+        }
+
+        if (Arguments.size() == 1 && IsScalar(Arguments[0].m_Type)) return Convert(Arguments[0], _rType);
+
+        std::vector<int> Registers;
+
+        for (const SValue& rArgument : Arguments)
+        {
+            if (!IsNumeric(rArgument.m_Type))
+            {
+                Error("cannot construct %s from %s", GetTypeName(_rType).c_str(), GetTypeName(rArgument.m_Type).c_str());
+
+                return MakeValue(_rType, {});
+            }
+
+            SType Type = rArgument.m_Type;
+
+            Type.m_Base = _rType.m_Base;
+
+            SValue Argument = Convert(rArgument, Type);
+
+            Registers.insert(Registers.end(), Argument.m_Registers.begin(), Argument.m_Registers.end());
+        }
+
+        if (static_cast<int>(Registers.size()) != GetNumberOfFloats(_rType))
+        {
+            Error("%s needs %d components instead of %d", GetTypeName(_rType).c_str(), GetNumberOfFloats(_rType), static_cast<int>(Registers.size()));
+
+            return MakeValue(_rType, std::vector<int>(GetNumberOfFloats(_rType), GetLiteral(0.0f)));
+        }
+
+        return MakeValue(_rType, Registers);
+    }
+
+    // -----------------------------------------------------------------------------
+    // The opening parenthesis has been read.
+    // -----------------------------------------------------------------------------
+
+    bool CCompiler::ParseArguments(std::vector<SValue>* _pArguments)
+    {
+        if (Accept(")")) return true;
+
+        do
+        {
+            _pArguments->push_back(CompileExpression());
+        }
+        while (!m_HasError && Accept(","));
+
+        return Expect(")");
+    }
+
+    // -----------------------------------------------------------------------------
+    // The arguments are copied to the parameters, unless the function does not
+    // write a parameter. Out parameters are copied back after the call.
+    // -----------------------------------------------------------------------------
+
+    SValue CCompiler::CompileCall(const std::string& _rName)
+    {
+        std::vector<SValue> Arguments;
+
+        if (!ParseArguments(&Arguments)) return MakeValue(MakeType(SType::Float), { GetLiteral(0.0f) });
+
+        bool   IsIntrinsic = false;
+        SValue Result      = CompileIntrinsic(_rName, Arguments, &IsIntrinsic);
+
+        if (IsIntrinsic || m_HasError) return Result;
+
+        SFunction* pFunction = const_cast<SFunction*>(FindFunction(_rName, Arguments.size()));
+
+        if (pFunction == nullptr)
+        {
+            Error("unknown function %s with %d arguments", _rName.c_str(), static_cast<int>(Arguments.size()));
+
+            return Result;
+        }
+
+        if (!pFunction->m_IsAnalyzed) AnalyzeFunction(pFunction);
+
+        size_t NumberOfSymbols = m_Symbols.size();
+
+        for (size_t IndexOfArgument = 0; IndexOfArgument < Arguments.size(); ++IndexOfArgument)
+        {
+            const SParameter& rParameter = pFunction->m_Parameters[IndexOfArgument];
+
+            if (rParameter.m_IsOut && !Arguments[IndexOfArgument].m_IsWritable)
+            {
+                Error("the argument %d of %s cannot be written", static_cast<int>(IndexOfArgument) + 1, _rName.c_str());
+
+                return Result;
+            }
+
+            SSymbol Symbol;
+
+            Symbol.m_Name       = rParameter.m_Name;
+            Symbol.m_Type       = rParameter.m_Type;
+            Symbol.m_IsConstant = false;
+            Symbol.m_Buffer     = -1;
+            Symbol.m_Offset     = 0;
+            Symbol.m_Slot       = Arguments[IndexOfArgument].m_Slot;
+
+            SValue Argument = rParameter.m_IsIn ? Convert(Arguments[IndexOfArgument], rParameter.m_Type) : MakeValue(rParameter.m_Type, std::vector<int>(GetNumberOfFloats(rParameter.m_Type), GetLiteral(0.0f)));
+
+            if (rParameter.m_IsWritten)
+            {
+                int NumberOfFloats = GetNumberOfFloats(rParameter.m_Type);
+                int FirstRegister  = AllocateRegisters(NumberOfFloats);
+
+                for (int Index = 0; Index < NumberOfFloats; ++Index) Symbol.m_Registers.push_back(FirstRegister + Index);
+
+                Store(Symbol.m_Registers, Argument.m_Registers);
+            }
+            else
+            {
+                Symbol.m_Registers = Argument.m_Registers;
+            }
+
+            m_Symbols.push_back(Symbol);
+        }
+
+        Result = InlineFunction(*pFunction);
+
+        for (size_t IndexOfArgument = 0; IndexOfArgument < Arguments.size() && !m_HasError; ++IndexOfArgument)
+        {
+            if (!pFunction->m_Parameters[IndexOfArgument].m_IsOut) continue;
+
+            const SSymbol& rParameter = m_Symbols[NumberOfSymbols + IndexOfArgument];
+
+            Store(Arguments[IndexOfArgument].m_Registers, Convert(MakeValue(rParameter.m_Type, rParameter.m_Registers), Arguments[IndexOfArgument].m_Type).m_Registers);
+        }
+
+        m_Symbols.resize(NumberOfSymbols);
+
+        return Result;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    SValue CCompiler::CompileIntrinsic(const std::string& _rName, const std::vector<SValue>& _rArguments, bool* _pIsIntrinsic)
+    {
+        static const struct
+        {
+            const char*           m_pName;
+            size_t                m_NumberOfArguments;
+            SInstruction::EOpcode m_Opcode;
+        }
+        s_ComponentWise[] =
+        {
+            { "min"  , 2, SInstruction::Minimum },
+            { "max"  , 2, SInstruction::Maximum },
+            { "abs"  , 1, SInstruction::Absolute },
+            { "sqrt" , 1, SInstruction::SquareRoot },
+            { "floor", 1, SInstruction::Floor },
+            { "trunc", 1, SInstruction::Truncate },
+            { "pow"  , 2, SInstruction::Power },
+            { "exp"  , 1, SInstruction::Exponent },
+            { "exp2" , 1, SInstruction::Exponent2 },
+            { "log"  , 1, SInstruction::Logarithm },
+            { "log2" , 1, SInstruction::Logarithm2 },
+            { "sin"  , 1, SInstruction::Sine },
+            { "cos"  , 1, SInstruction::Cosine },
+        };
+
+        static const struct
+        {
+            const char* m_pName;
+            size_t      m_NumberOfArguments;
+        }
+        s_Others[] =
+        {
+            { "mul", 2 }, { "dot", 2 }, { "cross", 2 }, { "length", 1 }, { "distance", 2 }, { "normalize", 1 }, { "step", 2 },
+            { "saturate", 1 }, { "clamp", 3 }, { "lerp", 3 }, { "rsqrt", 1 }, { "ceil", 1 }, { "frac", 1 },
+        };
+
+        *_pIsIntrinsic = false;
+
+        SValue Result = MakeValue(MakeType(SType::Float), { GetLiteral(0.0f) });
+
+        for (const auto& rIntrinsic : s_ComponentWise)
+        {
+            if (_rName != rIntrinsic.m_pName) continue;
+
+            *_pIsIntrinsic = true;
+
+            if (_rArguments.size() != rIntrinsic.m_NumberOfArguments)
+            {
+                Error("%s takes %d arguments", _rName.c_str(), static_cast<int>(rIntrinsic.m_NumberOfArguments));
+
+                return Result;
+            }
+
+            return CompileComponentWise(_rArguments, rIntrinsic.m_Opcode);
+        }
+
+        for (const auto& rIntrinsic : s_Others)
+        {
+            if (_rName != rIntrinsic.m_pName) continue;
+
+            *_pIsIntrinsic = true;
+
+            if (_rArguments.size() != rIntrinsic.m_NumberOfArguments)
+            {
+                Error("%s takes %d arguments", _rName.c_str(), static_cast<int>(rIntrinsic.m_NumberOfArguments));
+
+                return Result;
+            }
+        }
+
+        if (!*_pIsIntrinsic) return Result;
+
+        std::vector<SValue> Arguments;
+
+        for (const SValue& rArgument : _rArguments)
+        {
+            if (!IsNumeric(rArgument.m_Type))
+            {
+                Error("%s takes no %s", _rName.c_str(), GetTypeName(rArgument.m_Type).c_str());
+
+                return Result;
+            }
+
+            Arguments.push_back(Convert(rArgument, MakeType(SType::Float, rArgument.m_Type.m_Rows, rArgument.m_Type.m_Columns)));
+        }
+
+        std::vector<int> Registers;
+
+        if (_rName == "mul")
+        {
+            return CompileMul(Arguments[0], Arguments[1]);
+        }
+        else if (_rName == "dot")
+        {
+            return MakeValue(MakeType(SType::Float), { CompileDot(Arguments[0], Arguments[1]) });
+        }
+        else if (_rName == "length" || _rName == "distance")
+        {
+            SValue Vector = _rName == "length" ? Arguments[0] : CompileOperation("-", Arguments[0], Arguments[1]);
+
+            return MakeValue(MakeType(SType::Float), { EmitOperation(SInstruction::SquareRoot, CompileDot(Vector, Vector)) });
+        }
+        else if (_rName == "normalize")
+        {
+            int Scale = EmitOperation(SInstruction::Divide, GetLiteral(1.0f), EmitOperation(SInstruction::SquareRoot, CompileDot(Arguments[0], Arguments[0])));
+
+            return CompileOperation("*", Arguments[0], MakeValue(MakeType(SType::Float), { Scale }));
+        }
+        else if (_rName == "cross")
+        {
+            SValue Left  = Convert(Arguments[0], MakeType(SType::Float, 1, 3));
+            SValue Right = Convert(Arguments[1], MakeType(SType::Float, 1, 3));
+
+            if (m_HasError) return Result;
+
+            for (int Component = 0; Component < 3; ++Component)
+            {
+                int Next = (Component + 1) % 3;
+                int Last = (Component + 2) % 3;
+
+                int Product0 = EmitOperation(SInstruction::Multiply, Left.m_Registers[Next], Right.m_Registers[Last]);
+                int Product1 = EmitOperation(SInstruction::Multiply, Left.m_Registers[Last], Right.m_Registers[Next]);
+
+                Registers.push_back(EmitOperation(SInstruction::Subtract, Product0, Product1));
+            }
+
+            return MakeValue(MakeType(SType::Float, 1, 3), Registers);
+        }
+
+        // -----------------------------------------------------------------------------
+        // The remaining intrinsics work on the components.
+        // -----------------------------------------------------------------------------
+        SType Type;
+
+        if (!GetCommonType(Arguments, &Type)) return Result;
+
+        for (int Row = 0; Row < Type.m_Rows; ++Row)
+        {
+            for (int Column = 0; Column < Type.m_Columns; ++Column)
+            {
+                int Source0 = GetComponent(Arguments[0], Row, Column);
+                int Source1 = Arguments.size() > 1 ? GetComponent(Arguments[1], Row, Column) : 0;
+                int Source2 = Arguments.size() > 2 ? GetComponent(Arguments[2], Row, Column) : 0;
+
+                int Register = 0;
+
+                if (_rName == "step")
+                {
+                    Register = EmitSelect(EmitComparison(SInstruction::GreaterEqual, Source1, Source0), GetLiteral(1.0f), GetLiteral(0.0f));
+                }
+                else if (_rName == "saturate")
+                {
+                    Register = EmitOperation(SInstruction::Maximum, EmitOperation(SInstruction::Minimum, Source0, GetLiteral(1.0f)), GetLiteral(0.0f));
+                }
+                else if (_rName == "clamp")
+                {
+                    Register = EmitOperation(SInstruction::Minimum, EmitOperation(SInstruction::Maximum, Source0, Source1), Source2);
+                }
+                else if (_rName == "lerp")
+                {
+                    Register = EmitOperation(SInstruction::Add, Source0, EmitOperation(SInstruction::Multiply, EmitOperation(SInstruction::Subtract, Source1, Source0), Source2));
+                }
+                else if (_rName == "rsqrt")
+                {
+                    Register = EmitOperation(SInstruction::Divide, GetLiteral(1.0f), EmitOperation(SInstruction::SquareRoot, Source0));
+                }
+                else if (_rName == "ceil")
+                {
+                    Register = EmitOperation(SInstruction::Negate, EmitOperation(SInstruction::Floor, EmitOperation(SInstruction::Negate, Source0)));
+                }
+                else
+                {
+                    Register = EmitOperation(SInstruction::Subtract, Source0, EmitOperation(SInstruction::Floor, Source0));
+                }
+
+                Registers.push_back(Register);
+            }
+        }
+
+        return MakeValue(Type, Registers);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    SValue CCompiler::CompileComponentWise(const std::vector<SValue>& _rArguments, SInstruction::EOpcode _Opcode)
+    {
+        SType Type;
+
+        if (!GetCommonType(_rArguments, &Type)) return _rArguments[0];
+
+        bool IsFloat = !(_Opcode == SInstruction::Minimum || _Opcode == SInstruction::Maximum || _Opcode == SInstruction::Absolute);
+
+        if (IsFloat || Type.m_Base == SType::Bool) Type.m_Base = IsFloat ? SType::Float : SType::Int;
+
+        std::vector<int> Registers;
+
+        for (int Row = 0; Row < Type.m_Rows; ++Row)
+        {
+            for (int Column = 0; Column < Type.m_Columns; ++Column)
+            {
+                int Source1 = _rArguments.size() > 1 ? GetComponent(_rArguments[1], Row, Column) : 0;
+
+                Registers.push_back(EmitOperation(_Opcode, GetComponent(_rArguments[0], Row, Column), Source1));
+            }
+        }
+
+        return MakeValue(Type, Registers);
+    }
+
+    // -----------------------------------------------------------------------------
+    // Vectors are rows on the left of a matrix and columns on its right. The
+    // products are summed in the order of the components.
+    // -----------------------------------------------------------------------------
+
+    SValue CCompiler::CompileMul(const SValue& _rLeft, const SValue& _rRight)
+    {
+        const SType& rLeft  = _rLeft .m_Type;
+        const SType& rRight = _rRight.m_Type;
+
+        if (IsScalar(rLeft) || IsScalar(rRight)) return CompileOperation("*", _rLeft, _rRight);
+
+        if (!IsMatrix(rLeft) && !IsMatrix(rRight)) return MakeValue(MakeType(SType::Float), { CompileDot(_rLeft, _rRight) });
+
+        int Rows    = IsMatrix(rLeft) ? rLeft.m_Rows : 1;
+        int Columns = IsMatrix(rRight) ? rRight.m_Columns : 1;
+        int Inner   = std::min(rLeft.m_Columns, IsMatrix(rRight) ? rRight.m_Rows : rRight.m_Columns);
+
+        std::vector<int> Registers;
+
+        for (int Row = 0; Row < Rows; ++Row)
+        {
+            for (int Column = 0; Column < Columns; ++Column)
+            {
+                int Sum = -1;
+
+                for (int Index = 0; Index < Inner; ++Index)
+                {
+                    int Left    = _rLeft.m_Registers[Row * rLeft.m_Columns + Index];
+                    int Right   = IsMatrix(rRight) ? _rRight.m_Registers[Index * rRight.m_Columns + Column] : _rRight.m_Registers[Index];
+                    int Product = EmitOperation(SInstruction::Multiply, Left, Right);
+
+                    Sum = Sum < 0 ? Product : EmitOperation(SInstruction::Add, Sum, Product);
+                }
+
+                Registers.push_back(Sum);
+            }
+        }
+
+        if (IsMatrix(rLeft) && IsMatrix(rRight)) return MakeValue(MakeType(SType::Float, Rows, Columns), Registers);
+
+        return MakeValue(MakeType(SType::Float, 1, static_cast<int>(Registers.size())), Registers);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    int CCompiler::CompileDot(const SValue& _rLeft, const SValue& _rRight)
+    {
+        int NumberOfComponents = std::min(IsScalar(_rLeft.m_Type) ? 4 : _rLeft.m_Type.m_Columns, IsScalar(_rRight.m_Type) ? 4 : _rRight.m_Type.m_Columns);
+
+        if (IsScalar(_rLeft.m_Type) && IsScalar(_rRight.m_Type)) NumberOfComponents = 1;
+
+        int Sum = -1;
+
+        for (int Component = 0; Component < NumberOfComponents; ++Component)
+        {
+            int Product = EmitOperation(SInstruction::Multiply, GetComponent(_rLeft, 0, Component), GetComponent(_rRight, 0, Component));
+
+            Sum = Sum < 0 ? Product : EmitOperation(SInstruction::Add, Sum, Product);
+        }
+
+        return Sum;
+    }
+} // namespace
+
+// -----------------------------------------------------------------------------
+// Entry point
+// -----------------------------------------------------------------------------
+
+namespace
+{
+    // -----------------------------------------------------------------------------
+    // The input is the members of the parameters or the parameters with a
+    // semantic. A pixel shader which does not take SV_Position first skips it.
+    // -----------------------------------------------------------------------------
+
+    bool CCompiler::CompileEntryPoint(const char* _pShaderName, bool _IsVertexShader)
+    {
+        const SFunction* pFunction = nullptr;
+
+        for (const SFunction& rFunction : m_Functions)
+        {
+            if (rFunction.m_Name == _pShaderName) pFunction = &rFunction;
+        }
+
+        if (pFunction == nullptr)
+        {
+            std::fprintf(stderr, "%s: error: the entry point %s does not exist\n", m_pPath, _pShaderName);
+
+            m_HasError = true;
+
+            return false;
+        }
+
+        m_Position = pFunction->m_IndexOfBody;
+
+        std::vector<std::pair<std::string, SType>> Inputs;
+
+        for (const SParameter& rParameter : pFunction->m_Parameters)
+        {
+            if (rParameter.m_IsOut)
+            {
+                Error("the output of an entry point has to be its return value");
+
+                return false;
+            }
+
+            if (rParameter.m_Type.m_Base != SType::Struct)
+            {
+                Inputs.push_back(std::make_pair(rParameter.m_Semantic, rParameter.m_Type));
+
+                continue;
+            }
+
+            for (const SMember& rMember : m_Structs[rParameter.m_Type.m_IndexOfStruct].m_Members) Inputs.push_back(std::make_pair(rMember.m_Semantic, rMember.m_Type));
+        }
+
+        int NumberOfHiddenInputs = !_IsVertexShader && (Inputs.empty() || !IsSameText(Inputs[0].first, "SV_POSITION")) ? 4 : 0;
+        int NumberOfInputs       = NumberOfHiddenInputs;
+
+        for (const auto& rInput : Inputs)
+        {
+            if (rInput.second.m_Base == SType::Struct || IsMatrix(rInput.second) || rInput.first.empty())
+            {
+                Error("the input of an entry point has to be vectors with a semantic");
+
+                return false;
+            }
+
+            NumberOfInputs += rInput.second.m_Columns;
+
+            if (m_pProgram->m_Semantics.size() == 16 || NumberOfInputs > s_MaxShaderFloats)
+            {
+                Error("the input of an entry point is limited to 16 registers");
+
+                return false;
+            }
+
+            if (_IsVertexShader)
+            {
+                m_pProgram->m_Info.m_Inputs[m_pProgram->m_Semantics.size()].m_NumberOfComponents = rInput.second.m_Columns;
+
+                m_pProgram->m_Semantics.push_back(rInput.first);
+            }
+        }
+
+        m_pProgram->m_NumberOfInputs = NumberOfInputs;
+
+        int FirstRegister = AllocateRegisters(NumberOfInputs) + NumberOfHiddenInputs;
+
+        // -----------------------------------------------------------------------------
+        // The declarations of static globals run first, as if they were
+        // the first statements of the entry point.
+        // -----------------------------------------------------------------------------
+        for (size_t IndexOfDeclaration : m_StaticGlobals)
+        {
+            m_Position = IndexOfDeclaration;
+
+            CompileDeclaration();
+        }
+
+        m_NumberOfGlobals = m_Symbols.size();
+
+        for (const SParameter& rParameter : pFunction->m_Parameters)
+        {
+            SSymbol Symbol;
+
+            Symbol.m_Name       = rParameter.m_Name;
+            Symbol.m_Type       = rParameter.m_Type;
+            Symbol.m_IsConstant = false;
+            Symbol.m_Buffer     = -1;
+            Symbol.m_Offset     = 0;
+            Symbol.m_Slot       = -1;
+
+            for (int Index = 0; Index < GetNumberOfFloats(rParameter.m_Type); ++Index) Symbol.m_Registers.push_back(FirstRegister++);
+
+            m_Symbols.push_back(Symbol);
+        }
+
+        SValue Output = InlineFunction(*pFunction);
+
+        if (m_HasError) return false;
+
+        const SType& rType = Output.m_Type;
+
+        if (_IsVertexShader)
+        {
+            bool IsPositionFirst = rType.m_Base == SType::Struct ? !m_Structs[rType.m_IndexOfStruct].m_Members.empty() && IsSameText(m_Structs[rType.m_IndexOfStruct].m_Members[0].m_Semantic, "SV_POSITION") && GetNumberOfFloats(m_Structs[rType.m_IndexOfStruct].m_Members[0].m_Type) == 4 : IsSameText(pFunction->m_Semantic, "SV_POSITION") && GetNumberOfFloats(rType) == 4;
+
+            if (!IsPositionFirst || Output.m_Registers.size() > static_cast<size_t>(s_MaxShaderFloats))
+            {
+                std::fprintf(stderr, "%s: error: the output of %s has to start with a float4 SV_Position and is limited to 16 registers\n", m_pPath, _pShaderName);
+
+                m_HasError = true;
+
+                return false;
+            }
+        }
+        else if (!IsNumeric(rType) || IsMatrix(rType))
+        {
+            std::fprintf(stderr, "%s: error: the pixel shader %s has to return the color of SV_Target\n", m_pPath, _pShaderName);
+
+            m_HasError = true;
+
+            return false;
+        }
+
+        m_pProgram->m_OutputRegisters = Output.m_Registers;
+
+        while (!_IsVertexShader && m_pProgram->m_OutputRegisters.size() < 4) m_pProgram->m_OutputRegisters.push_back(GetLiteral(0.0f));
+
+        return true;
+    }
+
+    // -----------------------------------------------------------------------------
+    // Puts the loads of the constants in front of the code, gives them the
+    // registers after the others and removes the placeholders and the jumps
+    // to the next instruction.
+    // -----------------------------------------------------------------------------
+
+    void CCompiler::Finalize()
+    {
+        std::vector<SInstruction>& rInstructions = m_pProgram->m_Instructions;
+
+        int NumberOfConstants = static_cast<int>(m_Constants.size());
+
+        auto GetRegister = [&](int _Register)
+        {
+            return _Register >= s_ConstantRegister ? m_MaxNumberOfRegisters + _Register - s_ConstantRegister : _Register;
+        };
+
+        for (int IndexOfConstant = 0; IndexOfConstant < NumberOfConstants; ++IndexOfConstant)
+        {
+            const SConstant& rConstant = m_Constants[IndexOfConstant];
+
+            SInstruction Instruction = {};
+
+            Instruction.m_Opcode      = rConstant.m_Opcode;
+            Instruction.m_Destination = m_MaxNumberOfRegisters + IndexOfConstant;
+            Instruction.m_Sources[0]  = rConstant.m_Offset;
+            Instruction.m_Parameter   = rConstant.m_Buffer;
+            Instruction.m_Value       = rConstant.m_Value;
+
+            rInstructions.push_back(Instruction);
+        }
+
+        for (size_t IndexOfInstruction = 0; IndexOfInstruction < m_Instructions.size(); ++IndexOfInstruction)
+        {
+            SInstruction& rInstruction = m_Instructions[IndexOfInstruction];
+
+            if (rInstruction.m_Opcode != SInstruction::Jump) continue;
+
+            size_t IndexOfTarget = IndexOfInstruction + 1;
+
+            while (IndexOfTarget < m_Instructions.size() && m_Instructions[IndexOfTarget].m_Opcode == SInstruction::Nop) ++IndexOfTarget;
+
+            if (static_cast<int>(IndexOfTarget) >= rInstruction.m_Parameter && rInstruction.m_Parameter > static_cast<int>(IndexOfInstruction)) rInstruction.m_Opcode = SInstruction::Nop;
+        }
+
+        std::vector<int> NewIndices(m_Instructions.size() + 1);
+
+        int NumberOfInstructions = NumberOfConstants;
+
+        for (size_t IndexOfInstruction = 0; IndexOfInstruction < m_Instructions.size(); ++IndexOfInstruction)
+        {
+            NewIndices[IndexOfInstruction] = NumberOfInstructions;
+
+            if (m_Instructions[IndexOfInstruction].m_Opcode != SInstruction::Nop) ++NumberOfInstructions;
+        }
+
+        NewIndices[m_Instructions.size()] = NumberOfInstructions;
+
+        for (SInstruction Instruction : m_Instructions)
+        {
+            if (Instruction.m_Opcode == SInstruction::Nop) continue;
+
+            if (IsJump(Instruction.m_Opcode))
+            {
+                Instruction.m_Parameter = NewIndices[Instruction.m_Parameter];
+            }
+            else
+            {
+                Instruction.m_Destination = GetRegister(Instruction.m_Destination);
+
+                for (int& rSource : Instruction.m_Sources) rSource = GetRegister(rSource);
+            }
+
+            rInstructions.push_back(Instruction);
+        }
+
+        for (int& rRegister : m_pProgram->m_OutputRegisters) rRegister = GetRegister(rRegister);
+
+        // -----------------------------------------------------------------------------
+        // Instructions on masks name their masks in the fields of registers,
+        // so there are at least as many registers as masks.
+        // -----------------------------------------------------------------------------
+        m_pProgram->m_NumberOfRegisters = std::max(m_MaxNumberOfRegisters + NumberOfConstants, m_MaxNumberOfMasks);
+        m_pProgram->m_NumberOfMasks     = m_MaxNumberOfMasks;
+    }
+} // namespace
+
+// -----------------------------------------------------------------------------
+
+bool CompileSoftwareProgram(const char* _pPath, const char* _pShaderName, bool _IsVertexShader, SSoftwareProgram* _pProgram)
+{
+    std::string Path = _pPath;
+    std::string Source;
+
+    for (char& rCharacter : Path)
+    {
+        if (rCharacter == '\\') rCharacter = '/';
+    }
+
+    std::FILE* pFile = std::fopen(Path.c_str(), "rb");
+
+    if (pFile == nullptr)
+    {
+        std::fprintf(stderr, "Cannot open the effect %s\n", Path.c_str());
+
+        return false;
+    }
+
+    char Buffer[4096];
+
+    for (size_t Size; (Size = std::fread(Buffer, 1, sizeof(Buffer), pFile)) > 0; ) Source.append(Buffer, Size);
+
+    std::fclose(pFile);
+
+    std::vector<SToken> Tokens;
+
+    if (!Tokenize(Path.c_str(), Source, &Tokens)) return false;
+
+    SSoftwareProgram& rProgram = *_pProgram;
+
+    rProgram.m_FileName   = Path.substr(Path.find_last_of('/') + 1);
+    rProgram.m_ShaderName = _pShaderName;
+    rProgram.m_Info       = SSoftwareShaderInfo();
+
+    CCompiler Compiler(Path.c_str(), Tokens, _pProgram);
+
+    if (!Compiler.Compile(_pShaderName, _IsVertexShader)) return false;
+
+    SSoftwareShaderInfo& rInfo = rProgram.m_Info;
+
+    rInfo.m_pFileName       = rProgram.m_FileName.c_str();
+    rInfo.m_pShaderName     = rProgram.m_ShaderName.c_str();
+    rInfo.m_NumberOfInputs  = static_cast<int>(rProgram.m_Semantics.size());
+    rInfo.m_NumberOfOutputs = static_cast<int>(rProgram.m_OutputRegisters.size());
+    rInfo.m_pFunction       = RunSoftwareProgram;
+    rInfo.m_pFunction4      = RunSoftwareProgram;
+    rInfo.m_pFunction8      = RunSoftwareProgram;
+
+    for (int IndexOfInput = 0; IndexOfInput < rInfo.m_NumberOfInputs; ++IndexOfInput) rInfo.m_Inputs[IndexOfInput].m_pSemantic = rProgram.m_Semantics[IndexOfInput].c_str();
+
+    return true;
+}
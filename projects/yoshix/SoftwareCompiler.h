@@ -0,0 +1,31 @@
+#pragma once
+
+#include "SoftwareProgram.h"
+
+// -----------------------------------------------------------------------------
+// Compiles an entry point of an effect to a program of the software backend.
+// The front end reads the subset of HLSL the effects in data/shader are
+// written in:
+//
+//   - constant buffers with the packing rules of Direct3D, matrices stored
+//     row by row like the matrices of the gfx math functions
+//   - structs with semantics, Texture2D, sampler and static const globals
+//   - bool, int, uint and float scalars, vectors and matrices, swizzles,
+//     constructors, casts and the arithmetic and logical operators
+//   - functions, which are inlined at every call, with in, out and inout
+//     parameters
+//   - if, for, while, do, break, continue and return
+//   - the intrinsics mul, dot, cross, length, distance, normalize, step,
+//     saturate, clamp, lerp, min, max, abs, sqrt, rsqrt, floor, ceil, frac,
+//     pow, exp, exp2, log, log2, sin, cos and the Sample method of textures
+//
+// #define is expanded for macros without parameters. The input of a vertex
+// shader is the members of its parameters, in the order of declaration, its
+// output has to start with SV_Position. A pixel shader gets the output of the
+// vertex shader and returns SV_Target.
+//
+// Errors are printed to stderr with the line in the effect. Returns false if
+// the effect could not be read or compiled.
+// -----------------------------------------------------------------------------
+
+bool CompileSoftwareProgram(const char* _pPath, const char* _pShaderName, bool _IsVertexShader, SSoftwareProgram* _pProgram);
@@ -0,0 +1,568 @@
+#pragma once
+
+#include <cmath>
+
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define YOSHIX_SSE2 1
+#include <emmintrin.h>
+#if defined(__SSE4_1__) || defined(__AVX__)
+#include <smmintrin.h>
+#endif
+#else
+#define YOSHIX_SSE2 0
+#endif
+
+// -----------------------------------------------------------------------------
+// The lane types native shaders are written against. A shader is a function
+// template over the lane type and runs on float for single pixels and
+// vertices, on SSoftwareFloat4 for the four pixels of a 2x2 quad and on
+// SSoftwareFloat8 for eight pixels of a row of a block or eight vertices.
+//
+// Comparisons yield a mask of the lanes, which selects between two values
+// with Select. A branch of HLSL becomes a Select of both sides, a loop runs
+// until Any or All of the lanes are done.
+// -----------------------------------------------------------------------------
+
+struct SSoftwareMask4
+{
+#if YOSHIX_SSE2
+    __m128 m_Value;                                     // All bits of a lane set if it is true.
+#else
+    bool   m_Values[4];
+#endif
+};
+
+// -----------------------------------------------------------------------------
+
+struct SSoftwareFloat4
+{
+    static const int s_NumberOfLanes = 4;
+
+#if YOSHIX_SSE2
+    __m128 m_Value;
+#else
+    float  m_Values[4];
+#endif
+
+    SSoftwareFloat4()
+    {
+    }
+
+    SSoftwareFloat4(float _Value)
+    {
+#if YOSHIX_SSE2
+        m_Value = _mm_set1_ps(_Value);
+#else
+        m_Values[0] = m_Values[1] = m_Values[2] = m_Values[3] = _Value;
+#endif
+    }
+
+    static SSoftwareFloat4 Load(const float* _pValues)
+    {
+        SSoftwareFloat4 Result;
+
+#if YOSHIX_SSE2
+        Result.m_Value = _mm_loadu_ps(_pValues);
+#else
+        for (int Lane = 0; Lane < 4; ++Lane) Result.m_Values[Lane] = _pValues[Lane];
+#endif
+
+        return Result;
+    }
+
+    void Store(float* _pValues) const
+    {
+#if YOSHIX_SSE2
+        _mm_storeu_ps(_pValues, m_Value);
+#else
+        for (int Lane = 0; Lane < 4; ++Lane) _pValues[Lane] = m_Values[Lane];
+#endif
+    }
+};
+
+// -----------------------------------------------------------------------------
+// Eight lanes are two halves of four, so they need nothing beyond SSE2.
+// -----------------------------------------------------------------------------
+
+struct SSoftwareMask8
+{
+    SSoftwareMask4 m_Low;
+    SSoftwareMask4 m_High;
+};
+
+// -----------------------------------------------------------------------------
+
+struct SSoftwareFloat8
+{
+    static const int s_NumberOfLanes = 8;
+
+    SSoftwareFloat4 m_Low;
+    SSoftwareFloat4 m_High;
+
+    SSoftwareFloat8()
+    {
+    }
+
+    SSoftwareFloat8(float _Value)
+        : m_Low (_Value)
+        , m_High(_Value)
+    {
+    }
+
+    static SSoftwareFloat8 Load(const float* _pValues)
+    {
+        SSoftwareFloat8 Result;
+
+        Result.m_Low  = SSoftwareFloat4::Load(_pValues);
+        Result.m_High = SSoftwareFloat4::Load(_pValues + 4);
+
+        return Result;
+    }
+
+    void Store(float* _pValues) const
+    {
+        m_Low .Store(_pValues);
+        m_High.Store(_pValues + 4);
+    }
+};
+
+// -----------------------------------------------------------------------------
+// Four lanes
+// -----------------------------------------------------------------------------
+
+#if YOSHIX_SSE2
+
+#define YOSHIX_FLOAT4_OPERATOR(_Operator, _Intrinsic)                                                     \
+    inline SSoftwareFloat4 operator _Operator (const SSoftwareFloat4& _rLeft, const SSoftwareFloat4& _rRight) \
+    {                                                                                                     \
+        SSoftwareFloat4 Result;                                                                           \
+        Result.m_Value = _Intrinsic(_rLeft.m_Value, _rRight.m_Value);                                     \
+        return Result;                                                                                    \
+    }
+
+#define YOSHIX_FLOAT4_COMPARISON(_Operator, _Intrinsic)                                                   \
+    inline SSoftwareMask4 operator _Operator (const SSoftwareFloat4& _rLeft, const SSoftwareFloat4& _rRight) \
+    {                                                                                                     \
+        SSoftwareMask4 Result;                                                                            \
+        Result.m_Value = _Intrinsic(_rLeft.m_Value, _rRight.m_Value);                                     \
+        return Result;                                                                                    \
+    }
+
+#define YOSHIX_FLOAT4_FUNCTION(_Name, _Intrinsic)                                                         \
+    inline SSoftwareFloat4 _Name(const SSoftwareFloat4& _rLeft, const SSoftwareFloat4& _rRight)           \
+    {                                                                                                     \
+        SSoftwareFloat4 Result;                                                                           \
+        Result.m_Value = _Intrinsic(_rLeft.m_Value, _rRight.m_Value);                                     \
+        return Result;                                                                                    \
+    }
+
+#define YOSHIX_MASK4_OPERATOR(_Operator, _Intrinsic)                                                      \
+    inline SSoftwareMask4 operator _Operator (const SSoftwareMask4& _rLeft, const SSoftwareMask4& _rRight) \
+    {                                                                                                     \
+        SSoftwareMask4 Result;                                                                            \
+        Result.m_Value = _Intrinsic(_rLeft.m_Value, _rRight.m_Value);                                     \
+        return Result;                                                                                    \
+    }
+
+YOSHIX_FLOAT4_OPERATOR(+, _mm_add_ps)
+YOSHIX_FLOAT4_OPERATOR(-, _mm_sub_ps)
+YOSHIX_FLOAT4_OPERATOR(*, _mm_mul_ps)
+YOSHIX_FLOAT4_OPERATOR(/, _mm_div_ps)
+
+YOSHIX_FLOAT4_COMPARISON(< , _mm_cmplt_ps)
+YOSHIX_FLOAT4_COMPARISON(<=, _mm_cmple_ps)
+YOSHIX_FLOAT4_COMPARISON(> , _mm_cmpgt_ps)
+YOSHIX_FLOAT4_COMPARISON(>=, _mm_cmpge_ps)
+YOSHIX_FLOAT4_COMPARISON(==, _mm_cmpeq_ps)
+YOSHIX_FLOAT4_COMPARISON(!=, _mm_cmpneq_ps)
+
+YOSHIX_FLOAT4_FUNCTION(Min, _mm_min_ps)
+YOSHIX_FLOAT4_FUNCTION(Max, _mm_max_ps)
+
+YOSHIX_MASK4_OPERATOR(&, _mm_and_ps)
+YOSHIX_MASK4_OPERATOR(|, _mm_or_ps)
+YOSHIX_MASK4_OPERATOR(^, _mm_xor_ps)
+
+#undef YOSHIX_FLOAT4_OPERATOR
+#undef YOSHIX_FLOAT4_COMPARISON
+#undef YOSHIX_FLOAT4_FUNCTION
+#undef YOSHIX_MASK4_OPERATOR
+
+inline SSoftwareFloat4 operator - (const SSoftwareFloat4& _rValue)
+{
+    SSoftwareFloat4 Result;
+
+    Result.m_Value = _mm_xor_ps(_rValue.m_Value, _mm_set1_ps(-0.0f));
+
+    return Result;
+}
+
+inline SSoftwareMask4 operator ! (const SSoftwareMask4& _rMask)
+{
+    SSoftwareMask4 Result;
+
+    Result.m_Value = _mm_xor_ps(_rMask.m_Value, _mm_castsi128_ps(_mm_set1_epi32(-1)));
+
+    return Result;
+}
+
+inline SSoftwareFloat4 Abs(const SSoftwareFloat4& _rValue)
+{
+    SSoftwareFloat4 Result;
+
+    Result.m_Value = _mm_andnot_ps(_mm_set1_ps(-0.0f), _rValue.m_Value);
+
+    return Result;
+}
+
+inline SSoftwareFloat4 Sqrt(const SSoftwareFloat4& _rValue)
+{
+    SSoftwareFloat4 Result;
+
+    Result.m_Value = _mm_sqrt_ps(_rValue.m_Value);
+
+    return Result;
+}
+
+// -----------------------------------------------------------------------------
+// SSE2 has no rounding to minus infinity, the truncation is corrected for
+// negative values. Floats of 2^23 and more have no fraction and are kept as
+// they are, like infinity and NaN, which the conversion to int would break.
+// -----------------------------------------------------------------------------
+
+inline SSoftwareFloat4 Floor(const SSoftwareFloat4& _rValue)
+{
+    SSoftwareFloat4 Result;
+
+#if defined(__SSE4_1__) || defined(__AVX__)
+    Result.m_Value = _mm_floor_ps(_rValue.m_Value);
+#else
+    __m128 Magnitude = _mm_andnot_ps(_mm_set1_ps(-0.0f), _rValue.m_Value);
+    __m128 IsInRange = _mm_cmplt_ps(Magnitude, _mm_set1_ps(8388608.0f));
+    __m128 Truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(_rValue.m_Value));
+    __m128 Floored   = _mm_sub_ps(Truncated, _mm_and_ps(_mm_cmpgt_ps(Truncated, _rValue.m_Value), _mm_set1_ps(1.0f)));
+
+    Result.m_Value = _mm_or_ps(_mm_and_ps(IsInRange, Floored), _mm_andnot_ps(IsInRange, _rValue.m_Value));
+#endif
+
+    return Result;
+}
+
+inline SSoftwareFloat4 Select(const SSoftwareMask4& _rMask, const SSoftwareFloat4& _rTrue, const SSoftwareFloat4& _rFalse)
+{
+    SSoftwareFloat4 Result;
+
+    Result.m_Value = _mm_or_ps(_mm_and_ps(_rMask.m_Value, _rTrue.m_Value), _mm_andnot_ps(_rMask.m_Value, _rFalse.m_Value));
+
+    return Result;
+}
+
+inline bool Any(const SSoftwareMask4& _rMask)
+{
+    return _mm_movemask_ps(_rMask.m_Value) != 0;
+}
+
+inline bool All(const SSoftwareMask4& _rMask)
+{
+    return _mm_movemask_ps(_rMask.m_Value) == 0xf;
+}
+
+#else
+
+#define YOSHIX_FLOAT4_OPERATOR(_Operator)                                                                 \
+    inline SSoftwareFloat4 operator _Operator (const SSoftwareFloat4& _rLeft, const SSoftwareFloat4& _rRight) \
+    {                                                                                                     \
+        SSoftwareFloat4 Result;                                                                           \
+        for (int Lane = 0; Lane < 4; ++Lane) Result.m_Values[Lane] = _rLeft.m_Values[Lane] _Operator _rRight.m_Values[Lane]; \
+        return Result;                                                                                    \
+    }
+
+#define YOSHIX_FLOAT4_COMPARISON(_Operator)                                                               \
+    inline SSoftwareMask4 operator _Operator (const SSoftwareFloat4& _rLeft, const SSoftwareFloat4& _rRight) \
+    {                                                                                                     \
+        SSoftwareMask4 Result;                                                                            \
+        for (int Lane = 0; Lane < 4; ++Lane) Result.m_Values[Lane] = _rLeft.m_Values[Lane] _Operator _rRight.m_Values[Lane]; \
+        return Result;                                                                                    \
+    }
+
+#define YOSHIX_MASK4_OPERATOR(_Operator)                                                                  \
+    inline SSoftwareMask4 operator _Operator (const SSoftwareMask4& _rLeft, const SSoftwareMask4& _rRight) \
+    {                                                                                                     \
+        SSoftwareMask4 Result;                                                                            \
+        for (int Lane = 0; Lane < 4; ++Lane) Result.m_Values[Lane] = (_rLeft.m_Values[Lane] _Operator _rRight.m_Values[Lane]) != 0; \
+        return Result;                                                                                    \
+    }
+
+YOSHIX_FLOAT4_OPERATOR(+)
+YOSHIX_FLOAT4_OPERATOR(-)
+YOSHIX_FLOAT4_OPERATOR(*)
+YOSHIX_FLOAT4_OPERATOR(/)
+
+YOSHIX_FLOAT4_COMPARISON(< )
+YOSHIX_FLOAT4_COMPARISON(<=)
+YOSHIX_FLOAT4_COMPARISON(> )
+YOSHIX_FLOAT4_COMPARISON(>=)
+YOSHIX_FLOAT4_COMPARISON(==)
+YOSHIX_FLOAT4_COMPARISON(!=)
+
+YOSHIX_MASK4_OPERATOR(&)
+YOSHIX_MASK4_OPERATOR(|)
+YOSHIX_MASK4_OPERATOR(^)
+
+#undef YOSHIX_FLOAT4_OPERATOR
+#undef YOSHIX_FLOAT4_COMPARISON
+#undef YOSHIX_MASK4_OPERATOR
+
+inline SSoftwareFloat4 operator - (const SSoftwareFloat4& _rValue)
+{
+    SSoftwareFloat4 Result;
+
+    for (int Lane = 0; Lane < 4; ++Lane) Result.m_Values[Lane] = -_rValue.m_Values[Lane];
+
+    return Result;
+}
+
+inline SSoftwareMask4 operator ! (const SSoftwareMask4& _rMask)
+{
+    SSoftwareMask4 Result;
+
+    for (int Lane = 0; Lane < 4; ++Lane) Result.m_Values[Lane] = !_rMask.m_Values[Lane];
+
+    return Result;
+}
+
+inline SSoftwareFloat4 Min(const SSoftwareFloat4& _rLeft, const SSoftwareFloat4& _rRight)
+{
+    SSoftwareFloat4 Result;
+
+    for (int Lane = 0; Lane < 4; ++Lane) Result.m_Values[Lane] = _rLeft.m_Values[Lane] < _rRight.m_Values[Lane] ? _rLeft.m_Values[Lane] : _rRight.m_Values[Lane];
+
+    return Result;
+}
+
+inline SSoftwareFloat4 Max(const SSoftwareFloat4& _rLeft, const SSoftwareFloat4& _rRight)
+{
+    SSoftwareFloat4 Result;
+
+    for (int Lane = 0; Lane < 4; ++Lane) Result.m_Values[Lane] = _rLeft.m_Values[Lane] > _rRight.m_Values[Lane] ? _rLeft.m_Values[Lane] : _rRight.m_Values[Lane];
+
+    return Result;
+}
+
+inline SSoftwareFloat4 Abs(const SSoftwareFloat4& _rValue)
+{
+    SSoftwareFloat4 Result;
+
+    for (int Lane = 0; Lane < 4; ++Lane) Result.m_Values[Lane] = std::fabs(_rValue.m_Values[Lane]);
+
+    return Result;
+}
+
+inline SSoftwareFloat4 Sqrt(const SSoftwareFloat4& _rValue)
+{
+    SSoftwareFloat4 Result;
+
+    for (int Lane = 0; Lane < 4; ++Lane) Result.m_Values[Lane] = std::sqrt(_rValue.m_Values[Lane]);
+
+    return Result;
+}
+
+inline SSoftwareFloat4 Floor(const SSoftwareFloat4& _rValue)
+{
+    SSoftwareFloat4 Result;
+
+    for (int Lane = 0; Lane < 4; ++Lane) Result.m_Values[Lane] = std::floor(_rValue.m_Values[Lane]);
+
+    return Result;
+}
+
+inline SSoftwareFloat4 Select(const SSoftwareMask4& _rMask, const SSoftwareFloat4& _rTrue, const SSoftwareFloat4& _rFalse)
+{
+    SSoftwareFloat4 Result;
+
+    for (int Lane = 0; Lane < 4; ++Lane) Result.m_Values[Lane] = _rMask.m_Values[Lane] ? _rTrue.m_Values[Lane] : _rFalse.m_Values[Lane];
+
+    return Result;
+}
+
+inline bool Any(const SSoftwareMask4& _rMask)
+{
+    return _rMask.m_Values[0] || _rMask.m_Values[1] || _rMask.m_Values[2] || _rMask.m_Values[3];
+}
+
+inline bool All(const SSoftwareMask4& _rMask)
+{
+    return _rMask.m_Values[0] && _rMask.m_Values[1] && _rMask.m_Values[2] && _rMask.m_Values[3];
+}
+
+#endif // YOSHIX_SSE2
+
+// -----------------------------------------------------------------------------
+// Eight lanes
+// -----------------------------------------------------------------------------
+
+#define YOSHIX_FLOAT8_OPERATOR(_Operator)                                                                 \
+    inline SSoftwareFloat8 operator _Operator (const SSoftwareFloat8& _rLeft, const SSoftwareFloat8& _rRight) \
+    {                                                                                                     \
+        SSoftwareFloat8 Result;                                                                           \
+        Result.m_Low  = _rLeft.m_Low  _Operator _rRight.m_Low;                                            \
+        Result.m_High = _rLeft.m_High _Operator _rRight.m_High;                                           \
+        return Result;                                                                                    \
+    }
+
+#define YOSHIX_FLOAT8_COMPARISON(_Operator)                                                               \
+    inline SSoftwareMask8 operator _Operator (const SSoftwareFloat8& _rLeft, const SSoftwareFloat8& _rRight) \
+    {                                                                                                     \
+        SSoftwareMask8 Result;                                                                            \
+        Result.m_Low  = _rLeft.m_Low  _Operator _rRight.m_Low;                                            \
+        Result.m_High = _rLeft.m_High _Operator _rRight.m_High;                                           \
+        return Result;                                                                                    \
+    }
+
+#define YOSHIX_FLOAT8_FUNCTION(_Name)                                                                     \
+    inline SSoftwareFloat8 _Name(const SSoftwareFloat8& _rLeft, const SSoftwareFloat8& _rRight)           \
+    {                                                                                                     \
+        SSoftwareFloat8 Result;                                                                           \
+        Result.m_Low  = _Name(_rLeft.m_Low , _rRight.m_Low );                                             \
+        Result.m_High = _Name(_rLeft.m_High, _rRight.m_High);                                             \
+        return Result;                                                                                    \
+    }
+
+#define YOSHIX_MASK8_OPERATOR(_Operator)                                                                  \
+    inline SSoftwareMask8 operator _Operator (const SSoftwareMask8& _rLeft, const SSoftwareMask8& _rRight) \
+    {                                                                                                     \
+        SSoftwareMask8 Result;                                                                            \
+        Result.m_Low  = _rLeft.m_Low  _Operator _rRight.m_Low;                                            \
+        Result.m_High = _rLeft.m_High _Operator _rRight.m_High;                                           \
+        return Result;                                                                                    \
+    }
+
+YOSHIX_FLOAT8_OPERATOR(+)
+YOSHIX_FLOAT8_OPERATOR(-)
+YOSHIX_FLOAT8_OPERATOR(*)
+YOSHIX_FLOAT8_OPERATOR(/)
+
+YOSHIX_FLOAT8_COMPARISON(< )
+YOSHIX_FLOAT8_COMPARISON(<=)
+YOSHIX_FLOAT8_COMPARISON(> )
+YOSHIX_FLOAT8_COMPARISON(>=)
+YOSHIX_FLOAT8_COMPARISON(==)
+YOSHIX_FLOAT8_COMPARISON(!=)
+
+YOSHIX_FLOAT8_FUNCTION(Min)
+YOSHIX_FLOAT8_FUNCTION(Max)
+
+YOSHIX_MASK8_OPERATOR(&)
+YOSHIX_MASK8_OPERATOR(|)
+YOSHIX_MASK8_OPERATOR(^)
+
+#undef YOSHIX_FLOAT8_OPERATOR
+#undef YOSHIX_FLOAT8_COMPARISON
+#undef YOSHIX_FLOAT8_FUNCTION
+#undef YOSHIX_MASK8_OPERATOR
+
+inline SSoftwareFloat8 operator - (const SSoftwareFloat8& _rValue)
+{
+    SSoftwareFloat8 Result;
+
+    Result.m_Low  = -_rValue.m_Low;
+    Result.m_High = -_rValue.m_High;
+
+    return Result;
+}
+
+inline SSoftwareMask8 operator ! (const SSoftwareMask8& _rMask)
+{
+    SSoftwareMask8 Result;
+
+    Result.m_Low  = !_rMask.m_Low;
+    Result.m_High = !_rMask.m_High;
+
+    return Result;
+}
+
+inline SSoftwareFloat8 Abs(const SSoftwareFloat8& _rValue)
+{
+    SSoftwareFloat8 Result;
+
+    Result.m_Low  = Abs(_rValue.m_Low);
+    Result.m_High = Abs(_rValue.m_High);
+
+    return Result;
+}
+
+inline SSoftwareFloat8 Sqrt(const SSoftwareFloat8& _rValue)
+{
+    SSoftwareFloat8 Result;
+
+    Result.m_Low  = Sqrt(_rValue.m_Low);
+    Result.m_High = Sqrt(_rValue.m_High);
+
+    return Result;
+}
+
+inline SSoftwareFloat8 Floor(const SSoftwareFloat8& _rValue)
+{
+    SSoftwareFloat8 Result;
+
+    Result.m_Low  = Floor(_rValue.m_Low);
+    Result.m_High = Floor(_rValue.m_High);
+
+    return Result;
+}
+
+inline SSoftwareFloat8 Select(const SSoftwareMask8& _rMask, const SSoftwareFloat8& _rTrue, const SSoftwareFloat8& _rFalse)
+{
+    SSoftwareFloat8 Result;
+
+    Result.m_Low  = Select(_rMask.m_Low , _rTrue.m_Low , _rFalse.m_Low );
+    Result.m_High = Select(_rMask.m_High, _rTrue.m_High, _rFalse.m_High);
+
+    return Result;
+}
+
+inline bool Any(const SSoftwareMask8& _rMask)
+{
+    return Any(_rMask.m_Low) || Any(_rMask.m_High);
+}
+
+inline bool All(const SSoftwareMask8& _rMask)
+{
+    return All(_rMask.m_Low) && All(_rMask.m_High);
+}
+
+// -----------------------------------------------------------------------------
+// A single lane is a plain float with bool as its mask.
+// -----------------------------------------------------------------------------
+
+inline float Min(float _Left, float _Right)                      { return _Left < _Right ? _Left : _Right; }
+inline float Max(float _Left, float _Right)                      { return _Left > _Right ? _Left : _Right; }
+inline float Abs(float _Value)                                   { return std::fabs(_Value); }
+inline float Sqrt(float _Value)                                  { return std::sqrt(_Value); }
+inline float Floor(float _Value)                                 { return std::floor(_Value); }
+inline float Select(bool _Mask, float _True, float _False)       { return _Mask ? _True : _False; }
+inline bool  Any(bool _Mask)                                     { return _Mask; }
+inline bool  All(bool _Mask)                                     { return _Mask; }
+
+// -----------------------------------------------------------------------------
+// Access to the single lanes for the work without a vector instruction, like
+// sampling a texture.
+// -----------------------------------------------------------------------------
+
+template <typename TFloat>
+struct SSoftwareLanes
+{
+    static const int s_NumberOfLanes = TFloat::s_NumberOfLanes;
+
+    static TFloat Load(const float* _pValues)                   { return TFloat::Load(_pValues); }
+    static void   Store(const TFloat& _rValue, float* _pValues) { _rValue.Store(_pValues); }
+};
+
+template <>
+struct SSoftwareLanes<float>
+{
+    static const int s_NumberOfLanes = 1;
+
+    static float Load(const float* _pValues)                    { return *_pValues; }
+    static void  Store(float _Value, float* _pValues)           { *_pValues = _Value; }
+};
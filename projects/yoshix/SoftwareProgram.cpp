@@ -0,0 +1,186 @@
+#include "SoftwareProgram.h"
+#include "SoftwareTexture.h"
+
+#include <cmath>
+#include <cstring>
+#include <memory>
+
+namespace
+{
+    // -----------------------------------------------------------------------------
+    // Applies a function of the standard library to every lane.
+    // -----------------------------------------------------------------------------
+
+    template <typename TFloat, typename TFunction>
+    TFloat ForEachLane(const TFloat& _rLeft, const TFloat& _rRight, TFunction _Function)
+    {
+        const int NumberOfLanes = SSoftwareLanes<TFloat>::s_NumberOfLanes;
+
+        float Left [NumberOfLanes];
+        float Right[NumberOfLanes];
+
+        SSoftwareLanes<TFloat>::Store(_rLeft , Left);
+        SSoftwareLanes<TFloat>::Store(_rRight, Right);
+
+        for (int Lane = 0; Lane < NumberOfLanes; ++Lane) Left[Lane] = _Function(Left[Lane], Right[Lane]);
+
+        return SSoftwareLanes<TFloat>::Load(Left);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    template <typename TFloat>
+    void SampleLanes(const SSoftwareTexture* _pTexture, const TFloat& _rU, const TFloat& _rV, TFloat* _pColor)
+    {
+        const int NumberOfLanes = SSoftwareLanes<TFloat>::s_NumberOfLanes;
+
+        float U[NumberOfLanes];
+        float V[NumberOfLanes];
+        float Colors[4][NumberOfLanes];
+
+        SSoftwareLanes<TFloat>::Store(_rU, U);
+        SSoftwareLanes<TFloat>::Store(_rV, V);
+
+        for (int Lane = 0; Lane < NumberOfLanes; ++Lane)
+        {
+            float Color[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+            if (_pTexture != nullptr) SampleSoftwareTexture(*_pTexture, U[Lane], V[Lane], Color);
+
+            for (int Channel = 0; Channel < 4; ++Channel) Colors[Channel][Lane] = Color[Channel];
+        }
+
+        for (int Channel = 0; Channel < 4; ++Channel) _pColor[Channel] = SSoftwareLanes<TFloat>::Load(Colors[Channel]);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    float LoadConstant(const SSoftwareShaderContext& _rContext, SSoftwareInstruction::EOpcode _Opcode, int _Register, int _Offset)
+    {
+        const float* pBuffer = static_cast<const float*>(_rContext.m_pConstantBuffers[_Register]);
+
+        if (pBuffer == nullptr) return 0.0f;
+
+        if (_Opcode == SSoftwareInstruction::LoadFloat) return pBuffer[_Offset];
+
+        unsigned int Value;
+
+        std::memcpy(&Value, pBuffer + _Offset, sizeof(Value));
+
+        return _Opcode == SSoftwareInstruction::LoadInt ? static_cast<float>(static_cast<int>(Value)) : static_cast<float>(Value);
+    }
+
+    // -----------------------------------------------------------------------------
+    // The registers live as long as the thread, a program only grows them.
+    // -----------------------------------------------------------------------------
+
+    template <typename TFloat>
+    void Run(const SSoftwareShaderContext& _rContext, const TFloat* _pInput, TFloat* _pOutput)
+    {
+        typedef SSoftwareInstruction  SInstruction;
+        typedef decltype(TFloat() < TFloat()) TMask;
+
+        thread_local std::vector<TFloat>         s_Registers;
+        thread_local std::unique_ptr<TMask[]>    s_pMasks;                  // No std::vector, which packs bools.
+        thread_local int                         s_NumberOfMasks = 0;
+
+        const SSoftwareProgram& rProgram = *_rContext.m_pProgram;
+
+        if (s_Registers.size() < static_cast<size_t>(rProgram.m_NumberOfRegisters)) s_Registers.resize(rProgram.m_NumberOfRegisters);
+
+        if (s_NumberOfMasks < rProgram.m_NumberOfMasks)
+        {
+            s_pMasks.reset(new TMask[rProgram.m_NumberOfMasks]);
+
+            s_NumberOfMasks = rProgram.m_NumberOfMasks;
+        }
+
+        TFloat* pRegisters = s_Registers.data();
+        TMask*  pMasks     = s_pMasks.get();
+
+        for (int Index = 0; Index < rProgram.m_NumberOfInputs; ++Index) pRegisters[Index] = _pInput[Index];
+
+        pMasks[0] = TFloat(0.0f) == TFloat(0.0f);
+
+        const SInstruction* pInstructions          = rProgram.m_Instructions.data();
+        int                 NumberOfInstructions   = static_cast<int>(rProgram.m_Instructions.size());
+        int                 IndexOfNextInstruction = 0;
+
+        while (IndexOfNextInstruction < NumberOfInstructions)
+        {
+            const SInstruction& rInstruction = pInstructions[IndexOfNextInstruction++];
+
+            TFloat&       rDestination = pRegisters[rInstruction.m_Destination];
+            const TFloat& rSource0     = pRegisters[rInstruction.m_Sources[0]];
+            const TFloat& rSource1     = pRegisters[rInstruction.m_Sources[1]];
+
+            switch (rInstruction.m_Opcode)
+            {
+                case SInstruction::Nop:          break;
+                case SInstruction::Move:         rDestination = rSource0; break;
+                case SInstruction::MoveMasked:   rDestination = Select(pMasks[0], rSource0, rDestination); break;
+                case SInstruction::Literal:      rDestination = rInstruction.m_Value; break;
+                case SInstruction::LoadFloat:
+                case SInstruction::LoadInt:
+                case SInstruction::LoadUInt:     rDestination = LoadConstant(_rContext, rInstruction.m_Opcode, rInstruction.m_Parameter, rInstruction.m_Sources[0]); break;
+                case SInstruction::Add:          rDestination = rSource0 + rSource1; break;
+                case SInstruction::Subtract:     rDestination = rSource0 - rSource1; break;
+                case SInstruction::Multiply:     rDestination = rSource0 * rSource1; break;
+                case SInstruction::Divide:       rDestination = rSource0 / rSource1; break;
+                case SInstruction::Minimum:      rDestination = Min(rSource0, rSource1); break;
+                case SInstruction::Maximum:      rDestination = Max(rSource0, rSource1); break;
+                case SInstruction::Negate:       rDestination = -rSource0; break;
+                case SInstruction::Absolute:     rDestination = Abs(rSource0); break;
+                case SInstruction::SquareRoot:   rDestination = Sqrt(rSource0); break;
+                case SInstruction::Floor:        rDestination = Floor(rSource0); break;
+                case SInstruction::Truncate:     rDestination = Select(rSource0 < TFloat(0.0f), -Floor(-rSource0), Floor(rSource0)); break;
+                case SInstruction::Power:        rDestination = ForEachLane(rSource0, rSource1, [](float _Left, float _Right) { return std::pow(_Left, _Right); }); break;
+                case SInstruction::Exponent:     rDestination = ForEachLane(rSource0, rSource0, [](float _Left, float)        { return std::exp(_Left); }); break;
+                case SInstruction::Exponent2:    rDestination = ForEachLane(rSource0, rSource0, [](float _Left, float)        { return std::exp2(_Left); }); break;
+                case SInstruction::Logarithm:    rDestination = ForEachLane(rSource0, rSource0, [](float _Left, float)        { return std::log(_Left); }); break;
+                case SInstruction::Logarithm2:   rDestination = ForEachLane(rSource0, rSource0, [](float _Left, float)        { return std::log2(_Left); }); break;
+                case SInstruction::Sine:         rDestination = ForEachLane(rSource0, rSource0, [](float _Left, float)        { return std::sin(_Left); }); break;
+                case SInstruction::Cosine:       rDestination = ForEachLane(rSource0, rSource0, [](float _Left, float)        { return std::cos(_Left); }); break;
+                case SInstruction::Select:       rDestination = Select(pMasks[rInstruction.m_Sources[2]], rSource0, rSource1); break;
+                case SInstruction::Less:         pMasks[rInstruction.m_Destination] = rSource0 <  rSource1; break;
+                case SInstruction::LessEqual:    pMasks[rInstruction.m_Destination] = rSource0 <= rSource1; break;
+                case SInstruction::Greater:      pMasks[rInstruction.m_Destination] = rSource0 >  rSource1; break;
+                case SInstruction::GreaterEqual: pMasks[rInstruction.m_Destination] = rSource0 >= rSource1; break;
+                case SInstruction::Equal:        pMasks[rInstruction.m_Destination] = rSource0 == rSource1; break;
+                case SInstruction::NotEqual:     pMasks[rInstruction.m_Destination] = rSource0 != rSource1; break;
+                case SInstruction::MaskMove:     pMasks[rInstruction.m_Destination] = pMasks[rInstruction.m_Sources[0]]; break;
+                case SInstruction::MaskAnd:      pMasks[rInstruction.m_Destination] = pMasks[rInstruction.m_Sources[0]] &  pMasks[rInstruction.m_Sources[1]]; break;
+                case SInstruction::MaskAndNot:   pMasks[rInstruction.m_Destination] = pMasks[rInstruction.m_Sources[0]] & !pMasks[rInstruction.m_Sources[1]]; break;
+                case SInstruction::MaskOr:       pMasks[rInstruction.m_Destination] = pMasks[rInstruction.m_Sources[0]] |  pMasks[rInstruction.m_Sources[1]]; break;
+                case SInstruction::MaskClear:    pMasks[rInstruction.m_Destination] = TFloat(0.0f) != TFloat(0.0f); break;
+                case SInstruction::Sample:       SampleLanes(_rContext.m_pTextures[rInstruction.m_Parameter], rSource0, rSource1, &rDestination); break;
+                case SInstruction::Jump:         IndexOfNextInstruction = rInstruction.m_Parameter; break;
+                case SInstruction::JumpIfNone:   if (!Any(pMasks[rInstruction.m_Sources[0]])) IndexOfNextInstruction = rInstruction.m_Parameter; break;
+                case SInstruction::JumpIfAny:    if ( Any(pMasks[rInstruction.m_Sources[0]])) IndexOfNextInstruction = rInstruction.m_Parameter; break;
+            }
+        }
+
+        for (size_t Index = 0; Index < rProgram.m_OutputRegisters.size(); ++Index) _pOutput[Index] = pRegisters[rProgram.m_OutputRegisters[Index]];
+    }
+} // namespace
+
+// -----------------------------------------------------------------------------
+
+void RunSoftwareProgram(const SSoftwareShaderContext& _rContext, const float* _pInput, float* _pOutput)
+{
+    Run(_rContext, _pInput, _pOutput);
+}
+
+// -----------------------------------------------------------------------------
+
+void RunSoftwareProgram(const SSoftwareShaderContext& _rContext, const SSoftwareFloat4* _pInput, SSoftwareFloat4* _pOutput)
+{
+    Run(_rContext, _pInput, _pOutput);
+}
+
+// -----------------------------------------------------------------------------
+
+void RunSoftwareProgram(const SSoftwareShaderContext& _rContext, const SSoftwareFloat8* _pInput, SSoftwareFloat8* _pOutput)
+{
+    Run(_rContext, _pInput, _pOutput);
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "SoftwareShader.h"
+
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// An entry point of an effect compiled to a structure-of-arrays bytecode, see
+// SoftwareCompiler.h. Vectors and matrices are split into their components,
+// so every register holds one float of all lanes, e.g. of a row of 8 pixels.
+// Integers and booleans are stored as floats with their value.
+//
+// Control flow works on lane masks. Mask 0 holds the lanes which execute,
+// writes to variables living outside of a branch or a loop only change these
+// lanes. A branch masks its lanes with its condition and is jumped over if no
+// lane is left, a loop runs until the condition fails for every lane.
+// -----------------------------------------------------------------------------
+
+struct SSoftwareInstruction
+{
+    enum EOpcode
+    {
+        Nop,
+        Move,                                   // Destination = Source0
+        MoveMasked,                             // Destination = Source0 in the lanes of mask 0
+        Literal,                                // Destination = Value
+        LoadFloat,                              // Destination = float at offset Source0 of constant buffer Parameter
+        LoadInt,
+        LoadUInt,
+        Add,
+        Subtract,
+        Multiply,
+        Divide,
+        Minimum,
+        Maximum,
+        Negate,
+        Absolute,
+        SquareRoot,
+        Floor,
+        Truncate,                               // Rounds towards zero, like the conversion to int.
+        Power,                                  // The functions without a vector instruction run lane by lane.
+        Exponent,
+        Exponent2,
+        Logarithm,
+        Logarithm2,
+        Sine,
+        Cosine,
+        Select,                                 // Destination = mask Source2 ? Source0 : Source1
+        Less,                                   // Mask Destination = Source0 < Source1
+        LessEqual,
+        Greater,
+        GreaterEqual,
+        Equal,
+        NotEqual,
+        MaskMove,                               // Mask Destination = mask Source0
+        MaskAnd,                                // Mask Destination = mask Source0 & mask Source1
+        MaskAndNot,                             // Mask Destination = mask Source0 & !mask Source1
+        MaskOr,
+        MaskClear,
+        Sample,                                 // Destination..Destination + 3 = texture Parameter at (Source0, Source1)
+        Jump,                                   // Continues at instruction Parameter.
+        JumpIfNone,                             // Jumps if no lane of mask Source0 is set.
+        JumpIfAny,
+    };
+
+    EOpcode m_Opcode;
+    int     m_Destination;
+    int     m_Sources[3];
+    int     m_Parameter;
+    float   m_Value;
+};
+
+// -----------------------------------------------------------------------------
+// The first registers hold the input of the shader, m_OutputRegisters names
+// the registers of its output in order. m_Info runs the program of the
+// context, so the context of a draw has to point to the program.
+// -----------------------------------------------------------------------------
+
+struct SSoftwareProgram
+{
+    SSoftwareShaderInfo               m_Info;
+    std::string                       m_FileName;
+    std::string                       m_ShaderName;
+    std::vector<std::string>          m_Semantics;              // Of the inputs of a vertex shader.
+    std::vector<SSoftwareInstruction> m_Instructions;
+    std::vector<int>                  m_OutputRegisters;
+    int                               m_NumberOfInputs;         // Number of floats of the input.
+    int                               m_NumberOfRegisters;
+    int                               m_NumberOfMasks;
+};
+
+// -----------------------------------------------------------------------------
+// Runs _rContext.m_pProgram on a single pixel or vertex or on the lanes of
+// 4 or 8 of them.
+// -----------------------------------------------------------------------------
+
+void RunSoftwareProgram(const SSoftwareShaderContext& _rContext, const float* _pInput, float* _pOutput);
+void RunSoftwareProgram(const SSoftwareShaderContext& _rContext, const SSoftwareFloat4* _pInput, SSoftwareFloat4* _pOutput);
+void RunSoftwareProgram(const SSoftwareShaderContext& _rContext, const SSoftwareFloat8* _pInput, SSoftwareFloat8* _pOutput);
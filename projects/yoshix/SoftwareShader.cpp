@@ -0,0 +1,661 @@
+#include "SoftwareShader.h"
+#include "SoftwareTexture.h"
+
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <deque>
+
+// -----------------------------------------------------------------------------
+// The C++ ports of the effects in data/shader. Every function follows its HLSL
+// entry point statement by statement, so the rendering matches the one of
+// Direct3D up to the rounding of the rasterizer. Matrices in constant buffers
+// are stored row by row and vectors are multiplied from the left, like the
+// matrices of the gfx math functions.
+//
+// The native ports are templates over the lane type, see SoftwareLanes.h. The
+// remaining ones only run on single pixels and vertices.
+// -----------------------------------------------------------------------------
+
+namespace
+{
+    const float* GetFloats(const SSoftwareShaderContext& _rContext, int _Register, int _Offset)
+    {
+        return static_cast<const float*>(_rContext.m_pConstantBuffers[_Register]) + _Offset;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    unsigned int GetUInt(const SSoftwareShaderContext& _rContext, int _Register, int _Offset)
+    {
+        unsigned int Value;
+
+        std::memcpy(&Value, GetFloats(_rContext, _Register, _Offset), sizeof(Value));
+
+        return Value;
+    }
+
+    // -----------------------------------------------------------------------------
+    // mul(float4(_pPoint, 1.0f), _pMatrix)
+    // -----------------------------------------------------------------------------
+
+    template <typename TFloat>
+    void MulPoint(const TFloat* _pPoint, const float* _pMatrix, TFloat* _pResult)
+    {
+        for (int Column = 0; Column < 4; ++Column)
+        {
+            _pResult[Column] = _pPoint[0] * _pMatrix[Column] + _pPoint[1] * _pMatrix[4 + Column] + _pPoint[2] * _pMatrix[8 + Column] + _pMatrix[12 + Column];
+        }
+    }
+
+    // -----------------------------------------------------------------------------
+    // mul(float4(_pPoint, 1.0f), _pMatrix) followed by mul(_, _pMatrix2)
+    // -----------------------------------------------------------------------------
+
+    template <typename TFloat>
+    void MulPoint(const TFloat* _pPoint, const float* _pMatrix, const float* _pMatrix2, TFloat* _pResult)
+    {
+        TFloat Point[4];
+
+        MulPoint(_pPoint, _pMatrix, Point);
+
+        for (int Column = 0; Column < 4; ++Column)
+        {
+            _pResult[Column] = Point[0] * _pMatrix2[Column] + Point[1] * _pMatrix2[4 + Column] + Point[2] * _pMatrix2[8 + Column] + Point[3] * _pMatrix2[12 + Column];
+        }
+    }
+
+    // -----------------------------------------------------------------------------
+    // mul(_pVector, (float3x3) _pMatrix)
+    // -----------------------------------------------------------------------------
+
+    template <typename TFloat>
+    void MulVector(const TFloat* _pVector, const float* _pMatrix, TFloat* _pResult)
+    {
+        for (int Column = 0; Column < 3; ++Column)
+        {
+            _pResult[Column] = _pVector[0] * _pMatrix[Column] + _pVector[1] * _pMatrix[4 + Column] + _pVector[2] * _pMatrix[8 + Column];
+        }
+    }
+
+    // -----------------------------------------------------------------------------
+
+    template <typename TFloat>
+    TFloat Dot3(const TFloat* _pVector1, const TFloat* _pVector2)
+    {
+        return _pVector1[0] * _pVector2[0] + _pVector1[1] * _pVector2[1] + _pVector1[2] * _pVector2[2];
+    }
+
+    // -----------------------------------------------------------------------------
+
+    template <typename TFloat>
+    void Normalize3(TFloat* _pVector)
+    {
+        TFloat Scale = TFloat(1.0f) / Sqrt(Dot3(_pVector, _pVector));
+
+        _pVector[0] = _pVector[0] * Scale;
+        _pVector[1] = _pVector[1] * Scale;
+        _pVector[2] = _pVector[2] * Scale;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    template <typename TFloat>
+    TFloat Step(const TFloat& _rEdge, const TFloat& _rValue)
+    {
+        return Select(_rValue >= _rEdge, TFloat(1.0f), TFloat(0.0f));
+    }
+
+    // -----------------------------------------------------------------------------
+
+    template <typename TFloat>
+    TFloat Saturate(const TFloat& _rValue)
+    {
+        return Select(_rValue < TFloat(0.0f), TFloat(0.0f), Select(_rValue > TFloat(1.0f), TFloat(1.0f), _rValue));
+    }
+
+    // -----------------------------------------------------------------------------
+    // Texture fetches and pow have no vector instruction, they run lane by
+    // lane.
+    // -----------------------------------------------------------------------------
+
+    template <typename TFloat>
+    void Sample(const SSoftwareShaderContext& _rContext, int _Register, const TFloat& _rU, const TFloat& _rV, TFloat* _pColor)
+    {
+        const int NumberOfLanes = SSoftwareLanes<TFloat>::s_NumberOfLanes;
+
+        float U[NumberOfLanes];
+        float V[NumberOfLanes];
+        float Colors[4][NumberOfLanes];
+
+        SSoftwareLanes<TFloat>::Store(_rU, U);
+        SSoftwareLanes<TFloat>::Store(_rV, V);
+
+        for (int Lane = 0; Lane < NumberOfLanes; ++Lane)
+        {
+            float Color[4];
+
+            SampleSoftwareTexture(*_rContext.m_pTextures[_Register], U[Lane], V[Lane], Color);
+
+            for (int Channel = 0; Channel < 4; ++Channel) Colors[Channel][Lane] = Color[Channel];
+        }
+
+        for (int Channel = 0; Channel < 4; ++Channel) _pColor[Channel] = SSoftwareLanes<TFloat>::Load(Colors[Channel]);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    template <typename TFloat>
+    TFloat Pow(const TFloat& _rBase, float _Exponent)
+    {
+        const int NumberOfLanes = SSoftwareLanes<TFloat>::s_NumberOfLanes;
+
+        float Values[NumberOfLanes];
+
+        SSoftwareLanes<TFloat>::Store(_rBase, Values);
+
+        for (int Lane = 0; Lane < NumberOfLanes; ++Lane) Values[Lane] = std::pow(Values[Lane], _Exponent);
+
+        return SSoftwareLanes<TFloat>::Load(Values);
+    }
+} // namespace
+
+// -----------------------------------------------------------------------------
+// mandelbrot.fx
+// -----------------------------------------------------------------------------
+
+namespace
+{
+    template <typename TFloat>
+    void MandelbrotVSMain(const SSoftwareShaderContext& _rContext, const TFloat* _pInput, TFloat* _pOutput)
+    {
+        MulPoint(_pInput, GetFloats(_rContext, 1, 0), GetFloats(_rContext, 0, 0), _pOutput);
+
+        _pOutput[4] = _pInput[3];
+        _pOutput[5] = _pInput[4];
+    }
+
+    // -----------------------------------------------------------------------------
+    // The loop runs until every lane has escaped. A lane keeps iterating after
+    // its escape, but its result does not change any more.
+    // -----------------------------------------------------------------------------
+
+    template <typename TFloat>
+    TFloat IterateMandelbrot(const TFloat& _rCoordX, const TFloat& _rCoordY, int _MaxIterations)
+    {
+        TFloat ZX      = 0.0f;
+        TFloat ZY      = 0.0f;
+        TFloat Escaped = 0.0f;
+
+        for (int Iteration = 0; Iteration < _MaxIterations; ++Iteration)
+        {
+            TFloat X = ZX * ZX - ZY * ZY + _rCoordX;
+            TFloat Y = TFloat(2.0f) * ZX * ZY + _rCoordY;
+
+            ZX = X;
+            ZY = Y;
+
+            Escaped = Select(Sqrt(ZX * ZX + ZY * ZY) > TFloat(2.0f), TFloat(1.0f), Escaped);
+
+            if (All(Escaped == TFloat(1.0f))) break;
+        }
+
+        return Escaped;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    template <typename TFloat>
+    void MandelbrotPSMain(const SSoftwareShaderContext& _rContext, const TFloat* _pInput, TFloat* _pOutput)
+    {
+        const float* pColor = GetFloats(_rContext, 0, 0);
+
+        TFloat Escaped = IterateMandelbrot(_pInput[4], _pInput[5], static_cast<int>(GetUInt(_rContext, 0, 4)));
+
+        _pOutput[0] = Escaped * pColor[0];
+        _pOutput[1] = Escaped * pColor[1];
+        _pOutput[2] = Escaped * pColor[2];
+        _pOutput[3] = 1.0f;
+    }
+} // namespace
+
+// -----------------------------------------------------------------------------
+// chess.fx
+// -----------------------------------------------------------------------------
+
+namespace
+{
+    // -----------------------------------------------------------------------------
+    // The cell of a pixel is converted to uint in HLSL, which is its floor for
+    // the normed positions. A cell gets the first color if both coordinates
+    // are even or both are odd, i.e. if their sum is even.
+    // -----------------------------------------------------------------------------
+
+    template <typename TFloat>
+    void ChessPSMain(const SSoftwareShaderContext& _rContext, const TFloat* _pInput, TFloat* _pOutput)
+    {
+        const float* pColorA = GetFloats(_rContext, 0, 0);
+        const float* pColorB = GetFloats(_rContext, 0, 4);
+
+        TFloat CellX = Floor(_pInput[4] * static_cast<float>(GetUInt(_rContext, 0, 8)));
+        TFloat CellY = Floor(_pInput[5] * static_cast<float>(GetUInt(_rContext, 0, 9)));
+        TFloat Sum   = CellX + CellY;
+
+        auto IsColorA = Sum - TFloat(2.0f) * Floor(Sum * TFloat(0.5f)) == TFloat(0.0f);
+
+        _pOutput[0] = Select(IsColorA, TFloat(pColorA[0]), TFloat(pColorB[0]));
+        _pOutput[1] = Select(IsColorA, TFloat(pColorA[1]), TFloat(pColorB[1]));
+        _pOutput[2] = Select(IsColorA, TFloat(pColorA[2]), TFloat(pColorB[2]));
+        _pOutput[3] = 1.0f;
+    }
+} // namespace
+
+// -----------------------------------------------------------------------------
+// colored.fx, simple.fx and textured.fx
+// -----------------------------------------------------------------------------
+
+namespace
+{
+    template <typename TFloat>
+    void ColoredVSShader(const SSoftwareShaderContext& _rContext, const TFloat* _pInput, TFloat* _pOutput)
+    {
+        MulPoint(_pInput, GetFloats(_rContext, 0, 16), GetFloats(_rContext, 0, 0), _pOutput);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    template <typename TFloat>
+    void ColoredPSShader(const SSoftwareShaderContext& _rContext, const TFloat*, TFloat* _pOutput)
+    {
+        const float* pColor = GetFloats(_rContext, 0, 0);
+
+        _pOutput[0] = pColor[0];
+        _pOutput[1] = pColor[1];
+        _pOutput[2] = pColor[2];
+        _pOutput[3] = pColor[3];
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void SimplePSShader(const SSoftwareShaderContext&, const float*, float* _pOutput)
+    {
+        _pOutput[0] = 1.0f;
+        _pOutput[1] = 0.0f;
+        _pOutput[2] = 0.0f;
+        _pOutput[3] = 1.0f;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void TexturedVSShader(const SSoftwareShaderContext& _rContext, const float* _pInput, float* _pOutput)
+    {
+        MulPoint(_pInput, GetFloats(_rContext, 0, 16), GetFloats(_rContext, 0, 0), _pOutput);
+
+        _pOutput[4] = _pInput[3];
+        _pOutput[5] = _pInput[4];
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void TexturedPSShader(const SSoftwareShaderContext& _rContext, const float* _pInput, float* _pOutput)
+    {
+        Sample(_rContext, 0, _pInput[4], _pInput[5], _pOutput);
+    }
+} // namespace
+
+// -----------------------------------------------------------------------------
+// post_effect.fx
+// -----------------------------------------------------------------------------
+
+namespace
+{
+    void PostEffectVSGBufferShader(const SSoftwareShaderContext& _rContext, const float* _pInput, float* _pOutput)
+    {
+        MulPoint (_pInput, GetFloats(_rContext, 0, 16), GetFloats(_rContext, 0, 0), _pOutput);
+        MulVector(_pInput + 3, GetFloats(_rContext, 0, 16), _pOutput + 4);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void PostEffectPSGBufferShader(const SSoftwareShaderContext&, const float* _pInput, float* _pOutput)
+    {
+        float Normal[3] = { _pInput[4], _pInput[5], _pInput[6] };
+
+        Normalize3(Normal);
+
+        _pOutput[0] = Normal[0] * 0.5f + 0.5f;
+        _pOutput[1] = Normal[1] * 0.5f + 0.5f;
+        _pOutput[2] = Normal[2] * 0.5f + 0.5f;
+        _pOutput[3] = 1.0f;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void PostEffectVSShader(const SSoftwareShaderContext& _rContext, const float* _pInput, float* _pOutput)
+    {
+        MulPoint (_pInput, GetFloats(_rContext, 0, 16), GetFloats(_rContext, 0, 0), _pOutput);
+        MulVector(_pInput + 3, GetFloats(_rContext, 0, 16), _pOutput + 4);
+
+        _pOutput[7] = _pInput[6];
+        _pOutput[8] = _pInput[7];
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void PostEffectPSShader(const SSoftwareShaderContext& _rContext, const float* _pInput, float* _pOutput)
+    {
+        Sample(_rContext, 0, _pInput[7], _pInput[8], _pOutput);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void PostEffectVSPostShader(const SSoftwareShaderContext& _rContext, const float* _pInput, float* _pOutput)
+    {
+        const float OffsetX = 1.0f / 800.0f;
+        const float OffsetY = 1.0f / 600.0f;
+
+        const float Offsets[8][2] =
+        {
+            { -OffsetX, -OffsetY },                 // Left Top
+            {  OffsetX,  OffsetY },                 // Right Bottom
+            {  OffsetX, -OffsetY },                 // Right Top
+            { -OffsetX,  OffsetY },                 // Left Bottom
+            { -OffsetX,     0.0f },                 // Left
+            {  OffsetX,     0.0f },                 // Right
+            {     0.0f, -OffsetY },                 // Top
+            {     0.0f,  OffsetY },                 // Bottom
+        };
+
+        MulPoint(_pInput, GetFloats(_rContext, 0, 32), _pOutput);
+
+        _pOutput[4] = _pInput[0];                   // Center
+        _pOutput[5] = _pInput[1];
+
+        for (int IndexOfOffset = 0; IndexOfOffset < 8; ++IndexOfOffset)
+        {
+            _pOutput[6 + 2 * IndexOfOffset + 0] = _pInput[0] + Offsets[IndexOfOffset][0];
+            _pOutput[6 + 2 * IndexOfOffset + 1] = _pInput[1] + Offsets[IndexOfOffset][1];
+        }
+    }
+
+    // -----------------------------------------------------------------------------
+
+    float GetLinearDepth(const SSoftwareShaderContext& _rContext, const float* _pTexCoords)
+    {
+        const float* pNearFar = GetFloats(_rContext, 0, 0);
+
+        float Color[4];
+
+        Sample(_rContext, 0, _pTexCoords[0], _pTexCoords[1], Color);
+
+        return ((pNearFar[0] * pNearFar[1]) / (pNearFar[1] - (Color[0] * (pNearFar[1] - pNearFar[0])))) / pNearFar[1];
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void GetNormal(const SSoftwareShaderContext& _rContext, const float* _pTexCoords, float* _pNormal)
+    {
+        float Color[4];
+
+        Sample(_rContext, 2, _pTexCoords[0], _pTexCoords[1], Color);
+
+        _pNormal[0] = Color[0] * 2.0f - 1.0f;
+        _pNormal[1] = Color[1] * 2.0f - 1.0f;
+        _pNormal[2] = Color[2] * 2.0f - 1.0f;
+
+        Normalize3(_pNormal);
+    }
+
+    // -----------------------------------------------------------------------------
+    // The screen coordinates of the input are the center followed by left top,
+    // right bottom, right top, left bottom, left, right, top and bottom.
+    // -----------------------------------------------------------------------------
+
+    void PostEffectPSPostShader(const SSoftwareShaderContext& _rContext, const float* _pInput, float* _pOutput)
+    {
+        const float BarrierX = 0.80f;
+        const float BarrierY = 0.10f;
+        const float WeightX  = 0.25f;
+        const float WeightY  = 0.25f;
+
+        const float* pCoords = _pInput + 4;
+
+        float Depths[9];
+
+        for (int IndexOfCoord = 0; IndexOfCoord < 9; ++IndexOfCoord)
+        {
+            Depths[IndexOfCoord] = GetLinearDepth(_rContext, pCoords + 2 * IndexOfCoord);
+        }
+
+        float NormalCenter[3];
+
+        GetNormal(_rContext, pCoords, NormalCenter);
+
+        float NormalEpsilon = 0.0f;
+
+        for (int IndexOfCoord = 1; IndexOfCoord < 5; ++IndexOfCoord)
+        {
+            float Normal[3];
+
+            GetNormal(_rContext, pCoords + 2 * IndexOfCoord, Normal);
+
+            NormalEpsilon += Step(0.0f, Dot3(NormalCenter, Normal) - BarrierX) * WeightX;
+        }
+
+        NormalEpsilon = Saturate(NormalEpsilon);
+
+        float DepthEpsilon = 0.0f;
+
+        for (int IndexOfPair = 0; IndexOfPair < 4; ++IndexOfPair)
+        {
+            float DepthDifference = std::fabs(2.0f * Depths[0] - (Depths[1 + 2 * IndexOfPair] + Depths[2 + 2 * IndexOfPair])) - BarrierY;
+
+            DepthEpsilon += Step(DepthDifference, 0.0f) * WeightY;
+        }
+
+        DepthEpsilon = Saturate(DepthEpsilon);
+
+        float Weight = (1.0f - NormalEpsilon * DepthEpsilon) * 2.5f;
+
+        float OffsetX = pCoords[0] * (1.0f - Weight);
+        float OffsetY = pCoords[1] * (1.0f - Weight);
+
+        _pOutput[0] = _pOutput[1] = _pOutput[2] = _pOutput[3] = 0.0f;
+
+        for (int IndexOfCoord = 1; IndexOfCoord < 5; ++IndexOfCoord)
+        {
+            float Color[4];
+
+            Sample(_rContext, 1, OffsetX + pCoords[2 * IndexOfCoord] * Weight, OffsetY + pCoords[2 * IndexOfCoord + 1] * Weight, Color);
+
+            for (int Channel = 0; Channel < 4; ++Channel) _pOutput[Channel] += Color[Channel] / 4.0f;
+        }
+    }
+} // namespace
+
+// -----------------------------------------------------------------------------
+// bump_mapping.fx
+// -----------------------------------------------------------------------------
+
+namespace
+{
+    template <typename TFloat>
+    void BumpMappingVSShader(const SSoftwareShaderContext& _rContext, const TFloat* _pInput, TFloat* _pOutput)
+    {
+        const float* pWorldMatrix   = GetFloats(_rContext, 0, 16);
+        const float* pEyePosition   = GetFloats(_rContext, 0, 32);
+        const float* pLightPosition = GetFloats(_rContext, 0, 36);
+
+        TFloat WSPosition[4];
+
+        MulPoint(_pInput, pWorldMatrix, WSPosition);
+        MulPoint(_pInput, pWorldMatrix, GetFloats(_rContext, 0, 0), _pOutput);
+
+        for (int IndexOfVector = 0; IndexOfVector < 3; ++IndexOfVector)
+        {
+            TFloat* pVector = _pOutput + 4 + 3 * IndexOfVector;
+
+            MulVector(_pInput + 3 + 3 * IndexOfVector, pWorldMatrix, pVector);
+
+            Normalize3(pVector);
+        }
+
+        for (int Component = 0; Component < 3; ++Component)
+        {
+            _pOutput[13 + Component] = pEyePosition  [Component] - WSPosition[Component];
+            _pOutput[16 + Component] = pLightPosition[Component] - WSPosition[Component];
+        }
+
+        _pOutput[19] = _pInput[12];
+        _pOutput[20] = _pInput[13];
+    }
+
+    // -----------------------------------------------------------------------------
+
+    template <typename TFloat>
+    void BumpMappingPSShader(const SSoftwareShaderContext& _rContext, const TFloat* _pInput, TFloat* _pOutput)
+    {
+        const float* pAmbientLightColor  = GetFloats(_rContext, 0, 0);
+        const float* pDiffuseLightColor  = GetFloats(_rContext, 0, 4);
+        const float* pSpecularLightColor = GetFloats(_rContext, 0, 8);
+        const float  SpecularExponent    = *GetFloats(_rContext, 0, 12);
+
+        TFloat WSTangent [3] = { _pInput[ 4], _pInput[ 5], _pInput[ 6] };
+        TFloat WSBinormal[3] = { _pInput[ 7], _pInput[ 8], _pInput[ 9] };
+        TFloat WSNormal  [3] = { _pInput[10], _pInput[11], _pInput[12] };
+        TFloat WSView    [3] = { _pInput[13], _pInput[14], _pInput[15] };
+        TFloat WSLight   [3] = { _pInput[16], _pInput[17], _pInput[18] };
+
+        Normalize3(WSTangent);
+        Normalize3(WSBinormal);
+        Normalize3(WSNormal);
+        Normalize3(WSView);
+        Normalize3(WSLight);
+
+        TFloat WSHalf[3];
+
+        for (int Component = 0; Component < 3; ++Component) WSHalf[Component] = (WSView[Component] + WSLight[Component]) * TFloat(0.5f);
+
+        // -----------------------------------------------------------------------------
+        // mul(TSNormal, float3x3(WSTangent, WSBinormal, WSNormal))
+        // -----------------------------------------------------------------------------
+        TFloat NormalMap[4];
+
+        Sample(_rContext, 1, _pInput[19], _pInput[20], NormalMap);
+
+        TFloat TSNormal[3];
+
+        for (int Component = 0; Component < 3; ++Component) TSNormal[Component] = NormalMap[Component] * TFloat(2.0f) - TFloat(1.0f);
+
+        TFloat Normal[3];
+
+        for (int Component = 0; Component < 3; ++Component)
+        {
+            Normal[Component] = TSNormal[0] * WSTangent[Component] + TSNormal[1] * WSBinormal[Component] + TSNormal[2] * WSNormal[Component];
+        }
+
+        Normalize3(Normal);
+
+        TFloat Diffuse  = Max(Dot3(Normal, WSLight), TFloat(0.0f));
+        TFloat Specular = Pow(Max(Dot3(Normal, WSHalf), TFloat(0.0f)), SpecularExponent);
+
+        TFloat Color[4];
+
+        Sample(_rContext, 0, _pInput[19], _pInput[20], Color);
+
+        for (int Channel = 0; Channel < 4; ++Channel)
+        {
+            TFloat Light = TFloat(pAmbientLightColor[Channel]) + TFloat(pDiffuseLightColor[Channel]) * Diffuse + TFloat(pSpecularLightColor[Channel]) * Specular;
+
+            _pOutput[Channel] = Color[Channel] * Light;
+        }
+    }
+} // namespace
+
+// -----------------------------------------------------------------------------
+
+namespace
+{
+#define YOSHIX_NATIVE_SHADER(_Function) _Function<float>, _Function<SSoftwareFloat4>, _Function<SSoftwareFloat8>
+#define YOSHIX_SCALAR_SHADER(_Function) _Function, nullptr, nullptr
+
+    const SSoftwareShaderInfo s_Shaders[] =
+    {
+        { "mandelbrot.fx"  , "VSMain"         , 2, { { "OSPOSITION", 3 }, { "POSITION_NORMED", 2 } }              ,  6, YOSHIX_NATIVE_SHADER(MandelbrotVSMain) },
+        { "mandelbrot.fx"  , "PSMain"         , 0, {}                                                             ,  4, YOSHIX_NATIVE_SHADER(MandelbrotPSMain) },
+        { "chess.fx"       , "VSMain"         , 2, { { "OSPOSITION", 3 }, { "POSITION_NORMED", 2 } }              ,  6, YOSHIX_NATIVE_SHADER(MandelbrotVSMain) },
+        { "chess.fx"       , "PSMain"         , 0, {}                                                             ,  4, YOSHIX_NATIVE_SHADER(ChessPSMain) },
+        { "colored.fx"     , "VSShader"       , 1, { { "POSITION", 3 } }                                          ,  4, YOSHIX_NATIVE_SHADER(ColoredVSShader) },
+        { "colored.fx"     , "PSShader"       , 0, {}                                                             ,  4, YOSHIX_NATIVE_SHADER(ColoredPSShader) },
+        { "simple.fx"      , "VSShader"       , 1, { { "POSITION", 3 } }                                          ,  4, YOSHIX_SCALAR_SHADER(ColoredVSShader<float>) },
+        { "simple.fx"      , "PSShader"       , 0, {}                                                             ,  4, YOSHIX_SCALAR_SHADER(SimplePSShader) },
+        { "textured.fx"    , "VSShader"       , 2, { { "POSITION", 3 }, { "TEXCOORD", 2 } }                       ,  6, YOSHIX_SCALAR_SHADER(TexturedVSShader) },
+        { "textured.fx"    , "PSShader"       , 0, {}                                                             ,  4, YOSHIX_SCALAR_SHADER(TexturedPSShader) },
+        { "bump_mapping.fx", "VSShader"       , 5, { { "POSITION", 3 }, { "TANGENT", 3 }, { "BINORMAL", 3 }, { "NORMAL", 3 }, { "TEXCOORD", 2 } }, 21, YOSHIX_NATIVE_SHADER(BumpMappingVSShader) },
+        { "bump_mapping.fx", "PSShader"       , 0, {}                                                             ,  4, YOSHIX_NATIVE_SHADER(BumpMappingPSShader) },
+        { "post_effect.fx" , "VSGBufferShader", 3, { { "POSITION", 3 }, { "NORMAL", 3 }, { "TEXCOORD", 2 } }      ,  7, YOSHIX_SCALAR_SHADER(PostEffectVSGBufferShader) },
+        { "post_effect.fx" , "PSGBufferShader", 0, {}                                                             ,  4, YOSHIX_SCALAR_SHADER(PostEffectPSGBufferShader) },
+        { "post_effect.fx" , "VSShader"       , 3, { { "POSITION", 3 }, { "NORMAL", 3 }, { "TEXCOORD", 2 } }      ,  9, YOSHIX_SCALAR_SHADER(PostEffectVSShader) },
+        { "post_effect.fx" , "PSShader"       , 0, {}                                                             ,  4, YOSHIX_SCALAR_SHADER(PostEffectPSShader) },
+        { "post_effect.fx" , "VSPostShader"   , 1, { { "POSITION", 3 } }                                          , 22, YOSHIX_SCALAR_SHADER(PostEffectVSPostShader) },
+        { "post_effect.fx" , "PSPostShader"   , 0, {}                                                             ,  4, YOSHIX_SCALAR_SHADER(PostEffectPSPostShader) },
+    };
+
+#undef YOSHIX_SCALAR_SHADER
+#undef YOSHIX_NATIVE_SHADER
+
+    // -----------------------------------------------------------------------------
+
+    bool IsSameName(const char* _pName1, const char* _pName2)
+    {
+        for (; *_pName1 != '\0' && *_pName2 != '\0'; ++_pName1, ++_pName2)
+        {
+            if (std::tolower(static_cast<unsigned char>(*_pName1)) != std::tolower(static_cast<unsigned char>(*_pName2))) return false;
+        }
+
+        return *_pName1 == *_pName2;
+    }
+} // namespace
+
+// -----------------------------------------------------------------------------
+
+namespace
+{
+    std::deque<SSoftwareShaderInfo>& GetRegisteredShaders()
+    {
+        static std::deque<SSoftwareShaderInfo> s_RegisteredShaders;
+
+        return s_RegisteredShaders;
+    }
+} // namespace
+
+// -----------------------------------------------------------------------------
+
+void RegisterSoftwareShader(const SSoftwareShaderInfo& _rInfo)
+{
+    GetRegisteredShaders().push_back(_rInfo);
+}
+
+// -----------------------------------------------------------------------------
+
+const SSoftwareShaderInfo* FindSoftwareShader(const char* _pPath, const char* _pShaderName)
+{
+    const char* pFileName = _pPath;
+
+    for (const char* pCharacter = _pPath; *pCharacter != '\0'; ++pCharacter)
+    {
+        if (*pCharacter == '\\' || *pCharacter == '/') pFileName = pCharacter + 1;
+    }
+
+    for (const SSoftwareShaderInfo& rShader : GetRegisteredShaders())
+    {
+        if (IsSameName(rShader.m_pFileName, pFileName) && std::strcmp(rShader.m_pShaderName, _pShaderName) == 0) return &rShader;
+    }
+
+    for (const SSoftwareShaderInfo& rShader : s_Shaders)
+    {
+        if (IsSameName(rShader.m_pFileName, pFileName) && std::strcmp(rShader.m_pShaderName, _pShaderName) == 0) return &rShader;
+    }
+
+    return nullptr;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "SoftwareLanes.h"
+
+struct SSoftwareProgram;
+struct SSoftwareTexture;
+
+// -----------------------------------------------------------------------------
+// What a shader of the software backend sees of its material: the constant
+// buffers of its stage and the textures, both indexed by register. A shader
+// compiled from its effect also finds its program here.
+// -----------------------------------------------------------------------------
+
+struct SSoftwareShaderContext
+{
+    const void*             m_pConstantBuffers[16];
+    const SSoftwareTexture* m_pTextures[16];
+    const SSoftwareProgram* m_pProgram;                     // nullptr for the C++ ports.
+};
+
+// -----------------------------------------------------------------------------
+// A shader reads and writes its inputs and outputs as consecutive floats in
+// the order of the members of the HLSL structs, integers are stored bitwise.
+// A vertex shader starts its output with SV_Position. The pixel shader gets
+// the same values interpolated, with SV_Position holding the pixel center,
+// the depth and w. It writes the four components of SV_Target.
+// -----------------------------------------------------------------------------
+
+typedef void (*FSoftwareShader)(const SSoftwareShaderContext& _rContext, const float* _pInput, float* _pOutput);
+
+// -----------------------------------------------------------------------------
+// A native shader has the same inputs and outputs, but every float is a lane
+// type holding the values of 4 or 8 pixels or vertices. It is written once as
+// a function template over the lane type and registered with its
+// instantiations for float, SSoftwareFloat4 and SSoftwareFloat8.
+// -----------------------------------------------------------------------------
+
+typedef void (*FSoftwareShader4)(const SSoftwareShaderContext& _rContext, const SSoftwareFloat4* _pInput, SSoftwareFloat4* _pOutput);
+typedef void (*FSoftwareShader8)(const SSoftwareShaderContext& _rContext, const SSoftwareFloat8* _pInput, SSoftwareFloat8* _pOutput);
+
+struct SSoftwareShaderInput
+{
+    const char* m_pSemantic;
+    int         m_NumberOfComponents;
+};
+
+struct SSoftwareShaderInfo
+{
+    const char*          m_pFileName;               // The file name of the effect without its directory, e.g. "colored.fx".
+    const char*          m_pShaderName;             // The name of the entry point.
+    int                  m_NumberOfInputs;          // Vertex shader only, pixel shaders take the output of the vertex shader.
+    SSoftwareShaderInput m_Inputs[16];
+    int                  m_NumberOfOutputs;         // Number of floats including SV_Position, 4 for pixel shaders.
+    FSoftwareShader      m_pFunction;
+    FSoftwareShader4     m_pFunction4;              // Pixel shaders run on 2x2 quads, nullptr if the shader is not native.
+    FSoftwareShader8     m_pFunction8;              // Pixel shaders run on rows of 8 pixels, nullptr if the shader is not native.
+};
+
+// -----------------------------------------------------------------------------
+// Adds a shader for an entry point of an effect, e.g. a native version of
+// an application's own .fx file. A registered shader takes precedence over the
+// ports of this backend. Register before the shaders are created, usually in
+// main; the info is copied.
+// -----------------------------------------------------------------------------
+
+void RegisterSoftwareShader(const SSoftwareShaderInfo& _rInfo);
+
+// -----------------------------------------------------------------------------
+// Finds the C++ port of an entry point of an effect in data/shader. Only the
+// file name of the path counts, so Windows and Unix paths both work. Returns
+// nullptr if the shader has not been ported.
+// -----------------------------------------------------------------------------
+
+const SSoftwareShaderInfo* FindSoftwareShader(const char* _pPath, const char* _pShaderName);
@@ -0,0 +1,445 @@
+#include "SoftwareTexture.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+    const unsigned int s_DDSMagic         = 0x20534444;     // "DDS "
+    const unsigned int s_DDSHeaderSize    = 124;
+    const unsigned int s_DDSAlphaPixels   = 0x00000001;
+    const unsigned int s_DDSAlpha         = 0x00000002;
+    const unsigned int s_DDSFourCC        = 0x00000004;
+    const unsigned int s_DDSLuminance     = 0x00020000;
+
+    // -----------------------------------------------------------------------------
+
+    unsigned int GetFourCC(const char* _pCode)
+    {
+        return static_cast<unsigned char>(_pCode[0]) | static_cast<unsigned char>(_pCode[1]) << 8 | static_cast<unsigned char>(_pCode[2]) << 16 | static_cast<unsigned char>(_pCode[3]) << 24;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    unsigned int ReadUInt(const unsigned char* _pBytes)
+    {
+        return _pBytes[0] | _pBytes[1] << 8 | _pBytes[2] << 16 | static_cast<unsigned int>(_pBytes[3]) << 24;
+    }
+
+    // -----------------------------------------------------------------------------
+    // Scales the bits of a channel mask onto 0..255.
+    // -----------------------------------------------------------------------------
+
+    unsigned int GetChannel(unsigned int _Pixel, unsigned int _Mask, unsigned int _Default)
+    {
+        if (_Mask == 0) return _Default;
+
+        unsigned int Shift = 0;
+
+        while ((_Mask >> Shift & 1) == 0) ++Shift;
+
+        unsigned int Maximum = _Mask >> Shift;
+
+        return ((_Pixel & _Mask) >> Shift) * 255 / Maximum;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    unsigned int GetRGB565(unsigned int _Color)
+    {
+        unsigned int Red   = (_Color >> 11 & 31) * 255 / 31;
+        unsigned int Green = (_Color >>  5 & 63) * 255 / 63;
+        unsigned int Blue  = (_Color       & 31) * 255 / 31;
+
+        return Red | Green << 8 | Blue << 16 | 0xff000000u;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    unsigned int MixColors(unsigned int _Color0, unsigned int _Color1, unsigned int _Weight0, unsigned int _Weight1)
+    {
+        unsigned int Result = 0;
+
+        for (int Shift = 0; Shift < 24; Shift += 8)
+        {
+            unsigned int Channel = ((_Color0 >> Shift & 0xff) * _Weight0 + (_Color1 >> Shift & 0xff) * _Weight1) / (_Weight0 + _Weight1);
+
+            Result |= Channel << Shift;
+        }
+
+        return Result | 0xff000000u;
+    }
+
+    // -----------------------------------------------------------------------------
+    // Decodes the 4x4 texels of a color block of DXT1, DXT3 and DXT5.
+    // -----------------------------------------------------------------------------
+
+    void DecodeColorBlock(const unsigned char* _pBlock, bool _IsDXT1, unsigned int* _pTexels)
+    {
+        unsigned int Color0 = _pBlock[0] | _pBlock[1] << 8;
+        unsigned int Color1 = _pBlock[2] | _pBlock[3] << 8;
+
+        unsigned int Colors[4];
+
+        Colors[0] = GetRGB565(Color0);
+        Colors[1] = GetRGB565(Color1);
+
+        if (Color0 > Color1 || !_IsDXT1)
+        {
+            Colors[2] = MixColors(Colors[0], Colors[1], 2, 1);
+            Colors[3] = MixColors(Colors[0], Colors[1], 1, 2);
+        }
+        else
+        {
+            Colors[2] = MixColors(Colors[0], Colors[1], 1, 1);
+            Colors[3] = 0;
+        }
+
+        unsigned int Indices = ReadUInt(_pBlock + 4);
+
+        for (int IndexOfTexel = 0; IndexOfTexel < 16; ++IndexOfTexel)
+        {
+            _pTexels[IndexOfTexel] = Colors[Indices >> (2 * IndexOfTexel) & 3];
+        }
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void DecodeAlphaBlock(const unsigned char* _pBlock, bool _IsDXT5, unsigned int* _pTexels)
+    {
+        unsigned int Alphas[16];
+
+        if (!_IsDXT5)
+        {
+            for (int IndexOfTexel = 0; IndexOfTexel < 16; ++IndexOfTexel)
+            {
+                Alphas[IndexOfTexel] = (_pBlock[IndexOfTexel / 2] >> (4 * (IndexOfTexel % 2)) & 15) * 17;
+            }
+        }
+        else
+        {
+            unsigned int Alpha0 = _pBlock[0];
+            unsigned int Alpha1 = _pBlock[1];
+
+            unsigned int Palette[8] = { Alpha0, Alpha1 };
+
+            for (unsigned int Index = 1; Index < 7; ++Index)
+            {
+                if (Alpha0 > Alpha1)  Palette[Index + 1] = (Alpha0 * (7 - Index) + Alpha1 * Index) / 7;
+                else if (Index < 5)   Palette[Index + 1] = (Alpha0 * (5 - Index) + Alpha1 * Index) / 5;
+                else                  Palette[Index + 1] = Index == 5 ? 0 : 255;
+            }
+
+            unsigned long long Indices = 0;
+
+            for (int IndexOfByte = 0; IndexOfByte < 6; ++IndexOfByte)
+            {
+                Indices |= static_cast<unsigned long long>(_pBlock[2 + IndexOfByte]) << (8 * IndexOfByte);
+            }
+
+            for (int IndexOfTexel = 0; IndexOfTexel < 16; ++IndexOfTexel)
+            {
+                Alphas[IndexOfTexel] = Palette[Indices >> (3 * IndexOfTexel) & 7];
+            }
+        }
+
+        for (int IndexOfTexel = 0; IndexOfTexel < 16; ++IndexOfTexel)
+        {
+            _pTexels[IndexOfTexel] = (_pTexels[IndexOfTexel] & 0x00ffffffu) | Alphas[IndexOfTexel] << 24;
+        }
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool DecodeCompressed(const unsigned char* _pData, size_t _NumberOfBytes, unsigned int _FourCC, SSoftwareTexture* _pTexture)
+    {
+        bool IsDXT1 = _FourCC == GetFourCC("DXT1");
+        bool IsDXT5 = _FourCC == GetFourCC("DXT5") || _FourCC == GetFourCC("DXT4");
+
+        if (!IsDXT1 && !IsDXT5 && _FourCC != GetFourCC("DXT3") && _FourCC != GetFourCC("DXT2")) return false;
+
+        int    NumberOfBlocksX = (_pTexture->m_Width  + 3) / 4;
+        int    NumberOfBlocksY = (_pTexture->m_Height + 3) / 4;
+        size_t BlockSize       = IsDXT1 ? 8 : 16;
+
+        if (_NumberOfBytes < BlockSize * NumberOfBlocksX * NumberOfBlocksY) return false;
+
+        for (int BlockY = 0; BlockY < NumberOfBlocksY; ++BlockY)
+        {
+            for (int BlockX = 0; BlockX < NumberOfBlocksX; ++BlockX)
+            {
+                const unsigned char* pBlock = _pData + BlockSize * (static_cast<size_t>(BlockY) * NumberOfBlocksX + BlockX);
+
+                unsigned int Texels[16];
+
+                DecodeColorBlock(pBlock + BlockSize - 8, IsDXT1, Texels);
+
+                if (!IsDXT1) DecodeAlphaBlock(pBlock, IsDXT5, Texels);
+
+                for (int Y = 0; Y < 4 && BlockY * 4 + Y < _pTexture->m_Height; ++Y)
+                {
+                    for (int X = 0; X < 4 && BlockX * 4 + X < _pTexture->m_Width; ++X)
+                    {
+                        _pTexture->m_Colors[static_cast<size_t>(BlockY * 4 + Y) * _pTexture->m_Width + BlockX * 4 + X] = Texels[Y * 4 + X];
+                    }
+                }
+            }
+        }
+
+        return true;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool DecodeUncompressed(const unsigned char* _pData, size_t _NumberOfBytes, const unsigned char* _pFormat, SSoftwareTexture* _pTexture)
+    {
+        unsigned int Flags          = ReadUInt(_pFormat + 4);
+        unsigned int NumberOfBits   = ReadUInt(_pFormat + 12);
+        unsigned int RedMask        = ReadUInt(_pFormat + 16);
+        unsigned int GreenMask      = ReadUInt(_pFormat + 20);
+        unsigned int BlueMask       = ReadUInt(_pFormat + 24);
+        unsigned int AlphaMask      = (Flags & (s_DDSAlphaPixels | s_DDSAlpha)) != 0 ? ReadUInt(_pFormat + 28) : 0;
+        size_t       NumberOfPixels = static_cast<size_t>(_pTexture->m_Width) * _pTexture->m_Height;
+
+        if (NumberOfBits == 0 || NumberOfBits > 32 || NumberOfBits % 8 != 0) return false;
+
+        size_t BytesPerPixel = NumberOfBits / 8;
+
+        if (_NumberOfBytes < BytesPerPixel * NumberOfPixels) return false;
+
+        for (size_t IndexOfPixel = 0; IndexOfPixel < NumberOfPixels; ++IndexOfPixel)
+        {
+            unsigned int Pixel = 0;
+
+            for (size_t IndexOfByte = 0; IndexOfByte < BytesPerPixel; ++IndexOfByte)
+            {
+                Pixel |= static_cast<unsigned int>(_pData[IndexOfPixel * BytesPerPixel + IndexOfByte]) << (8 * IndexOfByte);
+            }
+
+            unsigned int Red   = GetChannel(Pixel, RedMask, 0);
+            unsigned int Green = (Flags & s_DDSLuminance) != 0 ? Red : GetChannel(Pixel, GreenMask, 0);
+            unsigned int Blue  = (Flags & s_DDSLuminance) != 0 ? Red : GetChannel(Pixel, BlueMask, 0);
+            unsigned int Alpha = GetChannel(Pixel, AlphaMask, 255);
+
+            _pTexture->m_Colors[IndexOfPixel] = Red | Green << 8 | Blue << 16 | Alpha << 24;
+        }
+
+        return true;
+    }
+} // namespace
+
+// -----------------------------------------------------------------------------
+
+bool LoadSoftwareTexture(const char* _pPath, SSoftwareTexture* _pTexture)
+{
+    FILE* pFile = std::fopen(_pPath, "rb");
+
+    if (pFile == nullptr) return false;
+
+    std::vector<unsigned char> Bytes;
+
+    unsigned char Buffer[65536];
+
+    for (size_t NumberOfBytes; (NumberOfBytes = std::fread(Buffer, 1, sizeof(Buffer), pFile)) > 0; )
+    {
+        Bytes.insert(Bytes.end(), Buffer, Buffer + NumberOfBytes);
+    }
+
+    std::fclose(pFile);
+
+    if (Bytes.size() < 4 + s_DDSHeaderSize || ReadUInt(&Bytes[0]) != s_DDSMagic || ReadUInt(&Bytes[4]) != s_DDSHeaderSize) return false;
+
+    const unsigned char* pHeader = &Bytes[4];
+    const unsigned char* pFormat = pHeader + 72;
+
+    int Height = static_cast<int>(ReadUInt(pHeader + 8));
+    int Width  = static_cast<int>(ReadUInt(pHeader + 12));
+
+    if (Width <= 0 || Height <= 0) return false;
+
+    _pTexture->m_Format = SSoftwareTexture::Color;
+    _pTexture->m_Width  = Width;
+    _pTexture->m_Height = Height;
+
+    _pTexture->m_Colors.assign(static_cast<size_t>(Width) * Height, 0);
+    _pTexture->m_Depths.clear();
+
+    const unsigned char* pData         = pHeader + s_DDSHeaderSize;
+    size_t               NumberOfBytes = Bytes.size() - 4 - s_DDSHeaderSize;
+
+    if ((ReadUInt(pFormat + 4) & s_DDSFourCC) != 0) return DecodeCompressed(pData, NumberOfBytes, ReadUInt(pFormat + 8), _pTexture);
+
+    return DecodeUncompressed(pData, NumberOfBytes, pFormat, _pTexture);
+}
+
+// -----------------------------------------------------------------------------
+
+void SampleSoftwareTexture(const SSoftwareTexture& _rTexture, float _U, float _V, float* _pColor)
+{
+    float X = _U * _rTexture.m_Width  - 0.5f;
+    float Y = _V * _rTexture.m_Height - 0.5f;
+
+    float FloorX = std::floor(X);
+    float FloorY = std::floor(Y);
+
+    float WeightX = X - FloorX;
+    float WeightY = Y - FloorY;
+
+    int X0 = std::min(std::max(static_cast<int>(FloorX),     0), _rTexture.m_Width  - 1);
+    int X1 = std::min(std::max(static_cast<int>(FloorX) + 1, 0), _rTexture.m_Width  - 1);
+    int Y0 = std::min(std::max(static_cast<int>(FloorY),     0), _rTexture.m_Height - 1);
+    int Y1 = std::min(std::max(static_cast<int>(FloorY) + 1, 0), _rTexture.m_Height - 1);
+
+    size_t Texels[4] =
+    {
+        static_cast<size_t>(Y0) * _rTexture.m_Width + X0,
+        static_cast<size_t>(Y0) * _rTexture.m_Width + X1,
+        static_cast<size_t>(Y1) * _rTexture.m_Width + X0,
+        static_cast<size_t>(Y1) * _rTexture.m_Width + X1,
+    };
+
+    float Weights[4] =
+    {
+        (1.0f - WeightX) * (1.0f - WeightY),
+        WeightX          * (1.0f - WeightY),
+        (1.0f - WeightX) * WeightY,
+        WeightX          * WeightY,
+    };
+
+    if (_rTexture.m_Format == SSoftwareTexture::Depth)
+    {
+        float Depth = 0.0f;
+
+        for (int Index = 0; Index < 4; ++Index) Depth += _rTexture.m_Depths[Texels[Index]] * Weights[Index];
+
+        _pColor[0] = Depth;
+        _pColor[1] = 0.0f;
+        _pColor[2] = 0.0f;
+        _pColor[3] = 1.0f;
+
+        return;
+    }
+
+    _pColor[0] = _pColor[1] = _pColor[2] = _pColor[3] = 0.0f;
+
+    for (int Index = 0; Index < 4; ++Index)
+    {
+        unsigned int Texel = _rTexture.m_Colors[Texels[Index]];
+
+        for (int Channel = 0; Channel < 4; ++Channel)
+        {
+            _pColor[Channel] += static_cast<float>(Texel >> (8 * Channel) & 0xff) * Weights[Index];
+        }
+    }
+
+    for (int Channel = 0; Channel < 4; ++Channel) _pColor[Channel] *= 1.0f / 255.0f;
+}
+
+// -----------------------------------------------------------------------------
+
+unsigned int PackSoftwareColor(const float* _pColor)
+{
+    unsigned int Color = 0;
+
+    for (int Channel = 0; Channel < 4; ++Channel)
+    {
+        float Value = std::min(std::max(_pColor[Channel], 0.0f), 1.0f);
+
+        Color |= static_cast<unsigned int>(Value * 255.0f + 0.5f) << (8 * Channel);
+    }
+
+    return Color;
+}
+
+// -----------------------------------------------------------------------------
+
+void UnpackSoftwareColor(unsigned int _Color, float* _pColor)
+{
+    for (int Channel = 0; Channel < 4; ++Channel)
+    {
+        _pColor[Channel] = static_cast<float>(_Color >> (8 * Channel) & 0xff) * (1.0f / 255.0f);
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+void ClearSoftwareDepth(SSoftwareTexture* _pTexture, float _Depth)
+{
+    const int BlockSize = SSoftwareTexture::s_DepthBlockSize;
+
+    size_t NumberOfPixels = static_cast<size_t>(_pTexture->m_Width) * _pTexture->m_Height;
+
+    _pTexture->m_NumberOfBlocksX = (_pTexture->m_Width + BlockSize - 1) / BlockSize;
+
+    size_t NumberOfBlocks = static_cast<size_t>(_pTexture->m_NumberOfBlocksX) * ((_pTexture->m_Height + BlockSize - 1) / BlockSize);
+
+    _pTexture->m_Depths   .assign(NumberOfPixels, _Depth);
+    _pTexture->m_MinDepths.assign(NumberOfBlocks, _Depth);
+    _pTexture->m_MaxDepths.assign(NumberOfBlocks, _Depth);
+}
+
+// -----------------------------------------------------------------------------
+
+void UpdateSoftwareDepthBlock(SSoftwareTexture* _pTexture, int _BlockX, int _BlockY)
+{
+    const int BlockSize = SSoftwareTexture::s_DepthBlockSize;
+
+    int MinX = _BlockX * BlockSize;
+    int MinY = _BlockY * BlockSize;
+    int MaxX = std::min(MinX + BlockSize, _pTexture->m_Width );
+    int MaxY = std::min(MinY + BlockSize, _pTexture->m_Height);
+
+    float MinDepth = _pTexture->m_Depths[static_cast<size_t>(MinY) * _pTexture->m_Width + MinX];
+    float MaxDepth = MinDepth;
+
+    for (int Y = MinY; Y < MaxY; ++Y)
+    {
+        const float* pDepths = _pTexture->m_Depths.data() + static_cast<size_t>(Y) * _pTexture->m_Width;
+
+        for (int X = MinX; X < MaxX; ++X)
+        {
+            MinDepth = std::min(MinDepth, pDepths[X]);
+            MaxDepth = std::max(MaxDepth, pDepths[X]);
+        }
+    }
+
+    size_t IndexOfBlock = static_cast<size_t>(_BlockY) * _pTexture->m_NumberOfBlocksX + _BlockX;
+
+    _pTexture->m_MinDepths[IndexOfBlock] = MinDepth;
+    _pTexture->m_MaxDepths[IndexOfBlock] = MaxDepth;
+}
+
+// -----------------------------------------------------------------------------
+
+bool WriteSoftwareTexture(const SSoftwareTexture& _rTexture, const char* _pPath)
+{
+    if (_rTexture.m_Format != SSoftwareTexture::Color) return false;
+
+    FILE* pFile = std::fopen(_pPath, "wb");
+
+    if (pFile == nullptr) return false;
+
+    std::fprintf(pFile, "P6\n%d %d\n255\n", _rTexture.m_Width, _rTexture.m_Height);
+
+    std::vector<unsigned char> Row(static_cast<size_t>(_rTexture.m_Width) * 3);
+
+    for (int Y = 0; Y < _rTexture.m_Height; ++Y)
+    {
+        for (int X = 0; X < _rTexture.m_Width; ++X)
+        {
+            unsigned int Color = _rTexture.m_Colors[static_cast<size_t>(Y) * _rTexture.m_Width + X];
+
+            Row[3 * X + 0] = static_cast<unsigned char>(Color);
+            Row[3 * X + 1] = static_cast<unsigned char>(Color >> 8);
+            Row[3 * X + 2] = static_cast<unsigned char>(Color >> 16);
+        }
+
+        std::fwrite(Row.data(), 1, Row.size(), pFile);
+    }
+
+    bool IsWritten = std::ferror(pFile) == 0;
+
+    return std::fclose(pFile) == 0 && IsWritten;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// A texture or render target of the software backend. Color textures hold
+// RGBA with 8 bits per channel and red in the lowest byte, depth targets one
+// float per pixel. Row 0 is the top of the image, like in Direct3D.
+//
+// Depth targets also keep the bounds of the depths of every 8x8 block, so the
+// rasterizer can accept or reject whole blocks of a triangle. The bounds are
+// conservative: the minimum is never above and the maximum never below the
+// depths of the block.
+// -----------------------------------------------------------------------------
+
+struct SSoftwareTexture
+{
+    enum EFormat
+    {
+        Color,
+        Depth,
+    };
+
+    static const int s_DepthBlockSize = 8;
+
+    EFormat                   m_Format;
+    int                       m_Width;
+    int                       m_Height;
+    std::vector<unsigned int> m_Colors;             // Empty for depth targets.
+    std::vector<float>        m_Depths;             // Empty for color textures.
+    int                       m_NumberOfBlocksX;    // Blocks per row of the depth bounds.
+    std::vector<float>        m_MinDepths;          // Per block of a depth target.
+    std::vector<float>        m_MaxDepths;
+};
+
+// -----------------------------------------------------------------------------
+// Reads the first mip level of a DDS file. Uncompressed RGB, RGBA, luminance
+// and alpha formats with any channel masks are read as well as DXT1, DXT3 and
+// DXT5.
+// -----------------------------------------------------------------------------
+
+bool LoadSoftwareTexture(const char* _pPath, SSoftwareTexture* _pTexture);
+
+// -----------------------------------------------------------------------------
+// Filters the four texels around the texture coordinates bilinearly. The
+// coordinates are clamped to the edge like the default sampler of Direct3D.
+// Depth targets are read as (depth, 0, 0, 1).
+// -----------------------------------------------------------------------------
+
+void SampleSoftwareTexture(const SSoftwareTexture& _rTexture, float _U, float _V, float* _pColor);
+
+// -----------------------------------------------------------------------------
+
+unsigned int PackSoftwareColor(const float* _pColor);           // Saturates and rounds to 8 bits per channel.
+void UnpackSoftwareColor(unsigned int _Color, float* _pColor);
+
+// -----------------------------------------------------------------------------
+// Sets every depth of a depth target of m_Width x m_Height pixels and the
+// bounds of its blocks, allocating them on the first clear.
+// -----------------------------------------------------------------------------
+
+void ClearSoftwareDepth(SSoftwareTexture* _pTexture, float _Depth);
+
+// -----------------------------------------------------------------------------
+// Computes the exact bounds of a block after its depths have been written.
+// -----------------------------------------------------------------------------
+
+void UpdateSoftwareDepthBlock(SSoftwareTexture* _pTexture, int _BlockX, int _BlockY);
+
+// -----------------------------------------------------------------------------
+// Writes a color texture as binary PPM, the alpha channel is dropped.
+// -----------------------------------------------------------------------------
+
+bool WriteSoftwareTexture(const SSoftwareTexture& _rTexture, const char* _pPath);
@@ -0,0 +1,448 @@
+#include "yoshix.h"
+
+#include "CSoftwareDevice.h"
+
+// -----------------------------------------------------------------------------
+// Headless software implementation of yoshix.h for platforms without the
+// prebuilt Direct3D library, e.g. the Linux build servers. Applications link
+// the yoshix_software target of the CMakeLists.txt in the root instead of
+// lib/yoshix_debug.lib. It depends on the tile_scheduler target, the worker
+// pool in projects/src shared with the CPU Mandelbrot renderer:
+//
+//    cmake -S . -B build && cmake --build build
+//
+// The application runs through the same lifecycle as in a window, see
+// CSoftwareDevice for the environment variables controlling the frames. The
+// shaders are C++ ports of the effects in data/shader, see SoftwareShader.cpp.
+// Applications add native shaders of their own with RegisterSoftwareShader.
+// Shaders without a port are compiled from the effect, see SoftwareCompiler.h.
+// -----------------------------------------------------------------------------
+
+namespace gfx
+{
+    IApplication::~IApplication()
+    {
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool IApplication::OnStartup()
+    {
+        return InternOnStartup();
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool IApplication::OnShutdown()
+    {
+        return InternOnShutdown();
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool IApplication::OnCreateTextures()
+    {
+        return InternOnCreateTextures();
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool IApplication::OnReleaseTextures()
+    {
+        return InternOnReleaseTextures();
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool IApplication::OnCreateConstantBuffers()
+    {
+        return InternOnCreateConstantBuffers();
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool IApplication::OnReleaseConstantBuffers()
+    {
+        return InternOnReleaseConstantBuffers();
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool IApplication::OnCreateShader()
+    {
+        return InternOnCreateShader();
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool IApplication::OnReleaseShader()
+    {
+        return InternOnReleaseShader();
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool IApplication::OnCreateMaterials()
+    {
+        return InternOnCreateMaterials();
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool IApplication::OnReleaseMaterials()
+    {
+        return InternOnReleaseMaterials();
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool IApplication::OnCreateMeshes()
+    {
+        return InternOnCreateMeshes();
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool IApplication::OnReleaseMeshes()
+    {
+        return InternOnReleaseMeshes();
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool IApplication::OnResize(int _Width, int _Height)
+    {
+        return InternOnResize(_Width, _Height);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool IApplication::OnKeyEvent(unsigned int _Key, bool _IsKeyDown, bool _IsAltDown)
+    {
+        return InternOnKeyEvent(_Key, _IsKeyDown, _IsAltDown);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool IApplication::OnMouseEvent(int _X, int _Y, int _Button, bool _IsButtonDown, bool _IsDoubleClick, int _WheelDelta)
+    {
+        return InternOnMouseEvent(_X, _Y, _Button, _IsButtonDown, _IsDoubleClick, _WheelDelta);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool IApplication::OnUpdate()
+    {
+        return InternOnUpdate();
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool IApplication::OnFrame()
+    {
+        return InternOnFrame();
+    }
+
+    // -----------------------------------------------------------------------------
+
+    bool IApplication::InternOnStartup()                { return true; }
+    bool IApplication::InternOnShutdown()               { return true; }
+    bool IApplication::InternOnCreateTextures()         { return true; }
+    bool IApplication::InternOnReleaseTextures()        { return true; }
+    bool IApplication::InternOnCreateConstantBuffers()  { return true; }
+    bool IApplication::InternOnReleaseConstantBuffers() { return true; }
+    bool IApplication::InternOnCreateShader()           { return true; }
+    bool IApplication::InternOnReleaseShader()          { return true; }
+    bool IApplication::InternOnCreateMaterials()        { return true; }
+    bool IApplication::InternOnReleaseMaterials()       { return true; }
+    bool IApplication::InternOnCreateMeshes()           { return true; }
+    bool IApplication::InternOnReleaseMeshes()          { return true; }
+    bool IApplication::InternOnResize(int, int)         { return true; }
+    bool IApplication::InternOnUpdate()                 { return true; }
+    bool IApplication::InternOnFrame()                  { return true; }
+
+    bool IApplication::InternOnKeyEvent(unsigned int, bool, bool)             { return true; }
+    bool IApplication::InternOnMouseEvent(int, int, int, bool, bool, int)     { return true; }
+} // namespace gfx
+
+namespace gfx
+{
+    void RunApplication(int _Width, int _Height, const char* _pTitle, IApplication* _pApplication)
+    {
+        CSoftwareDevice::GetInstance().Run(_Width, _Height, _pTitle, _pApplication);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void StopApplication()
+    {
+        CSoftwareDevice::GetInstance().Stop();
+    }
+} // namespace gfx
+
+namespace gfx
+{
+    void SetClearColor(const float* _pColor)
+    {
+        CSoftwareDevice::GetInstance().SetClearColor(_pColor);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void SetDepthTest(SDepthTest::ETest _Test)
+    {
+        CSoftwareDevice::GetInstance().SetDepthTest(_Test);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void SetWireFrame(bool _Flag)
+    {
+        CSoftwareDevice::GetInstance().SetWireFrame(_Flag);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void SetAlphaBlending(bool _Flag)
+    {
+        CSoftwareDevice::GetInstance().SetAlphaBlending(_Flag);
+    }
+} // namespace gfx
+
+namespace gfx
+{
+    void CreateTexture(const char* _pPath, BHandle* _ppTexture)
+    {
+        *_ppTexture = CSoftwareDevice::GetInstance().CreateTexture(_pPath);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void CreateColorTarget(BHandle* _ppTexture)
+    {
+        *_ppTexture = CSoftwareDevice::GetInstance().CreateTarget(SSoftwareTexture::Color);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void CreateDepthTarget(BHandle* _ppTexture)
+    {
+        *_ppTexture = CSoftwareDevice::GetInstance().CreateTarget(SSoftwareTexture::Depth);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void ReleaseTexture(BHandle _pTexture)
+    {
+        CSoftwareDevice::GetInstance().ReleaseTexture(_pTexture);
+    }
+} // namespace gfx
+
+namespace gfx
+{
+    void CreateConstantBuffer(int _NumberOfBytes, BHandle* _ppConstantBuffer)
+    {
+        *_ppConstantBuffer = CSoftwareDevice::GetInstance().CreateConstantBuffer(_NumberOfBytes);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void ReleaseConstantBuffer(BHandle _pConstantBuffer)
+    {
+        CSoftwareDevice::GetInstance().ReleaseConstantBuffer(_pConstantBuffer);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void UploadConstantBuffer(void* _pData, BHandle _pConstantBuffer)
+    {
+        CSoftwareDevice::GetInstance().UploadConstantBuffer(_pData, _pConstantBuffer);
+    }
+} // namespace gfx
+
+namespace gfx
+{
+    void CreateVertexShader(const char* _pPath, const char* _pShaderName, BHandle* _ppShader)
+    {
+        *_ppShader = CSoftwareDevice::GetInstance().CreateShader(_pPath, _pShaderName, true);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void ReleaseVertexShader(BHandle _pShader)
+    {
+        CSoftwareDevice::GetInstance().ReleaseShader(_pShader);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void CreatePixelShader(const char* _pPath, const char* _pShaderName, BHandle* _ppShader)
+    {
+        *_ppShader = CSoftwareDevice::GetInstance().CreateShader(_pPath, _pShaderName, false);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void ReleasePixelShader(BHandle _pShader)
+    {
+        CSoftwareDevice::GetInstance().ReleaseShader(_pShader);
+    }
+} // namespace gfx
+
+namespace gfx
+{
+    void CreateMaterial(const SMaterialInfo& _rMaterialInfo, BHandle* _ppMaterial)
+    {
+        *_ppMaterial = CSoftwareDevice::GetInstance().CreateMaterial(_rMaterialInfo);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void ReleaseMaterial(BHandle _pMaterial)
+    {
+        CSoftwareDevice::GetInstance().ReleaseMaterial(_pMaterial);
+    }
+} // namespace gfx
+
+namespace gfx
+{
+    void CreateMesh(const SMeshInfo& _rMeshInfo, BHandle* _ppMesh)
+    {
+        *_ppMesh = CSoftwareDevice::GetInstance().CreateMesh(_rMeshInfo);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void ReleaseMesh(BHandle _pMesh)
+    {
+        CSoftwareDevice::GetInstance().ReleaseMesh(_pMesh);
+    }
+} // namespace gfx
+
+namespace gfx
+{
+    void ResetRenderTargets()
+    {
+        CSoftwareDevice::GetInstance().ResetRenderTargets();
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void SetRenderTargets(BHandle* _ppColorTargets, int _NumberOfColorTargets, BHandle _pDepthTarget)
+    {
+        CSoftwareDevice::GetInstance().SetRenderTargets(_ppColorTargets, _NumberOfColorTargets, _pDepthTarget);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void ClearColorTarget(BHandle _pTexture, const float* _pColor)
+    {
+        CSoftwareDevice::GetInstance().ClearColorTarget(_pTexture, _pColor);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void ClearDepthTarget(BHandle _pTexture, float _Depth)
+    {
+        CSoftwareDevice::GetInstance().ClearDepthTarget(_pTexture, _Depth);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void DrawMesh(BHandle _pMesh)
+    {
+        CSoftwareDevice::GetInstance().DrawMesh(_pMesh);
+    }
+} // namespace gfx
+
+namespace gfx
+{
+    void CreateCommandList(BHandle* _ppCommandList)
+    {
+        *_ppCommandList = CSoftwareDevice::GetInstance().CreateCommandList();
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void ReleaseCommandList(BHandle _pCommandList)
+    {
+        CSoftwareDevice::GetInstance().ReleaseCommandList(_pCommandList);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void SubmitCommandList(BHandle _pCommandList)
+    {
+        CSoftwareDevice::GetInstance().SubmitCommandList(_pCommandList);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void WaitForCommandLists()
+    {
+        CSoftwareDevice::GetInstance().WaitForCommandLists();
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void SetDepthTest(BHandle _pCommandList, SDepthTest::ETest _Test)
+    {
+        CSoftwareDevice::GetInstance().SetDepthTest(_pCommandList, _Test);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void SetWireFrame(BHandle _pCommandList, bool _Flag)
+    {
+        CSoftwareDevice::GetInstance().SetWireFrame(_pCommandList, _Flag);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void SetAlphaBlending(BHandle _pCommandList, bool _Flag)
+    {
+        CSoftwareDevice::GetInstance().SetAlphaBlending(_pCommandList, _Flag);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void UploadConstantBuffer(BHandle _pCommandList, void* _pData, BHandle _pConstantBuffer)
+    {
+        CSoftwareDevice::GetInstance().UploadConstantBuffer(_pCommandList, _pData, _pConstantBuffer);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void ResetRenderTargets(BHandle _pCommandList)
+    {
+        CSoftwareDevice::GetInstance().ResetRenderTargets(_pCommandList);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void SetRenderTargets(BHandle _pCommandList, BHandle* _ppColorTargets, int _NumberOfColorTargets, BHandle _pDepthTarget)
+    {
+        CSoftwareDevice::GetInstance().SetRenderTargets(_pCommandList, _ppColorTargets, _NumberOfColorTargets, _pDepthTarget);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void ClearColorTarget(BHandle _pCommandList, BHandle _pTexture, const float* _pColor)
+    {
+        CSoftwareDevice::GetInstance().ClearColorTarget(_pCommandList, _pTexture, _pColor);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void ClearDepthTarget(BHandle _pCommandList, BHandle _pTexture, float _Depth)
+    {
+        CSoftwareDevice::GetInstance().ClearDepthTarget(_pCommandList, _pTexture, _Depth);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    void DrawMesh(BHandle _pCommandList, BHandle _pMesh)
+    {
+        CSoftwareDevice::GetInstance().DrawMesh(_pCommandList, _pMesh);
+    }
+} // namespace gfx
@@ -0,0 +1,276 @@
+#include "yoshix.h"
+
+#include <cmath>
+#include <cstring>
+
+// -----------------------------------------------------------------------------
+// The math of YoshiX follows Direct3D: vectors are rows which are multiplied
+// from the left, matrices are stored row by row with the translation in the
+// last row, and the coordinate systems are left-handed. Angles are given in
+// degrees.
+// -----------------------------------------------------------------------------
+
+namespace
+{
+    const float s_Pi = 3.14159265358979323846f;
+
+    // -----------------------------------------------------------------------------
+
+    float GetRadians(float _Degrees)
+    {
+        return _Degrees * s_Pi / 180.0f;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    float* SetMatrix(float _M00, float _M01, float _M02, float _M03,
+                     float _M10, float _M11, float _M12, float _M13,
+                     float _M20, float _M21, float _M22, float _M23,
+                     float _M30, float _M31, float _M32, float _M33, float* _pResultMatrix)
+    {
+        const float Matrix[16] =
+        {
+            _M00, _M01, _M02, _M03,
+            _M10, _M11, _M12, _M13,
+            _M20, _M21, _M22, _M23,
+            _M30, _M31, _M32, _M33,
+        };
+
+        std::memcpy(_pResultMatrix, Matrix, sizeof(Matrix));
+
+        return _pResultMatrix;
+    }
+} // namespace
+
+namespace gfx
+{
+    float GetDotProduct2D(const float* _pVector1, const float* _pVector2)
+    {
+        return _pVector1[0] * _pVector2[0] + _pVector1[1] * _pVector2[1];
+    }
+
+    // -----------------------------------------------------------------------------
+
+    float GetDotProduct3D(const float* _pVector1, const float* _pVector2)
+    {
+        return _pVector1[0] * _pVector2[0] + _pVector1[1] * _pVector2[1] + _pVector1[2] * _pVector2[2];
+    }
+
+    // -----------------------------------------------------------------------------
+
+    float GetDotProduct4D(const float* _pVector1, const float* _pVector2)
+    {
+        return _pVector1[0] * _pVector2[0] + _pVector1[1] * _pVector2[1] + _pVector1[2] * _pVector2[2] + _pVector1[3] * _pVector2[3];
+    }
+
+    // -----------------------------------------------------------------------------
+
+    float* GetCrossProduct(const float* _pVector1, const float* _pVector2, float* _pResultVector)
+    {
+        float X = _pVector1[1] * _pVector2[2] - _pVector1[2] * _pVector2[1];
+        float Y = _pVector1[2] * _pVector2[0] - _pVector1[0] * _pVector2[2];
+        float Z = _pVector1[0] * _pVector2[1] - _pVector1[1] * _pVector2[0];
+
+        _pResultVector[0] = X;
+        _pResultVector[1] = Y;
+        _pResultVector[2] = Z;
+
+        return _pResultVector;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    float* GetNormalizedVector(const float* _pVector, float* _pResultVector)
+    {
+        float Length = std::sqrt(GetDotProduct3D(_pVector, _pVector));
+
+        float Scale = Length > 0.0f ? 1.0f / Length : 0.0f;
+
+        _pResultVector[0] = _pVector[0] * Scale;
+        _pResultVector[1] = _pVector[1] * Scale;
+        _pResultVector[2] = _pVector[2] * Scale;
+
+        return _pResultVector;
+    }
+
+    // -----------------------------------------------------------------------------
+    // Transforms the point (x, y, z, 1) and projects the result back onto w = 1.
+    // -----------------------------------------------------------------------------
+
+    float* TransformVector(const float* _pVector, const float* _pMatrix, float* _pResultVector)
+    {
+        float Result[4];
+
+        for (int Column = 0; Column < 4; ++Column)
+        {
+            Result[Column] = _pVector[0] * _pMatrix[0 * 4 + Column] + _pVector[1] * _pMatrix[1 * 4 + Column] + _pVector[2] * _pMatrix[2 * 4 + Column] + _pMatrix[3 * 4 + Column];
+        }
+
+        float Scale = Result[3] != 0.0f ? 1.0f / Result[3] : 1.0f;
+
+        _pResultVector[0] = Result[0] * Scale;
+        _pResultVector[1] = Result[1] * Scale;
+        _pResultVector[2] = Result[2] * Scale;
+
+        return _pResultVector;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    float* MulMatrix(const float* _pLeftMatrix, const float* _pRightMatrix, float* _pResultMatrix)
+    {
+        float Result[16];
+
+        for (int Row = 0; Row < 4; ++Row)
+        {
+            for (int Column = 0; Column < 4; ++Column)
+            {
+                float Sum = 0.0f;
+
+                for (int Index = 0; Index < 4; ++Index)
+                {
+                    Sum += _pLeftMatrix[Row * 4 + Index] * _pRightMatrix[Index * 4 + Column];
+                }
+
+                Result[Row * 4 + Column] = Sum;
+            }
+        }
+
+        std::memcpy(_pResultMatrix, Result, sizeof(Result));
+
+        return _pResultMatrix;
+    }
+
+    // -----------------------------------------------------------------------------
+
+    float* GetIdentityMatrix(float* _pResultMatrix)
+    {
+        return GetScaleMatrix(1.0f, _pResultMatrix);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    float* GetTranslationMatrix(float _X, float _Y, float _Z, float* _pResultMatrix)
+    {
+        return SetMatrix(
+            1.0f, 0.0f, 0.0f, 0.0f,
+            0.0f, 1.0f, 0.0f, 0.0f,
+            0.0f, 0.0f, 1.0f, 0.0f,
+            _X,   _Y,   _Z,   1.0f, _pResultMatrix);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    float* GetScaleMatrix(float _Scalar, float* _pResultMatrix)
+    {
+        return GetScaleMatrix(_Scalar, _Scalar, _Scalar, _pResultMatrix);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    float* GetScaleMatrix(float _ScalarX, float _ScalarY, float _ScalarZ, float* _pResultMatrix)
+    {
+        return SetMatrix(
+            _ScalarX, 0.0f,     0.0f,     0.0f,
+            0.0f,     _ScalarY, 0.0f,     0.0f,
+            0.0f,     0.0f,     _ScalarZ, 0.0f,
+            0.0f,     0.0f,     0.0f,     1.0f, _pResultMatrix);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    float* GetRotationXMatrix(float _Degrees, float* _pResultMatrix)
+    {
+        float Sin = std::sin(GetRadians(_Degrees));
+        float Cos = std::cos(GetRadians(_Degrees));
+
+        return SetMatrix(
+            1.0f,  0.0f, 0.0f, 0.0f,
+            0.0f,  Cos,  Sin,  0.0f,
+            0.0f, -Sin,  Cos,  0.0f,
+            0.0f,  0.0f, 0.0f, 1.0f, _pResultMatrix);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    float* GetRotationYMatrix(float _Degrees, float* _pResultMatrix)
+    {
+        float Sin = std::sin(GetRadians(_Degrees));
+        float Cos = std::cos(GetRadians(_Degrees));
+
+        return SetMatrix(
+            Cos,  0.0f, -Sin,  0.0f,
+            0.0f, 1.0f,  0.0f, 0.0f,
+            Sin,  0.0f,  Cos,  0.0f,
+            0.0f, 0.0f,  0.0f, 1.0f, _pResultMatrix);
+    }
+
+    // -----------------------------------------------------------------------------
+
+    float* GetRotationZMatrix(float _Degrees, float* _pResultMatrix)
+    {
+        float Sin = std::sin(GetRadians(_Degrees));
+        float Cos = std::cos(GetRadians(_Degrees));
+
+        return SetMatrix(
+             Cos,  Sin,  0.0f, 0.0f,
+            -Sin,  Cos,  0.0f, 0.0f,
+             0.0f, 0.0f, 1.0f, 0.0f,
+             0.0f, 0.0f, 0.0f, 1.0f, _pResultMatrix);
+    }
+
+    // -----------------------------------------------------------------------------
+    // Left-handed look-at matrix, the camera looks along +z of the view space.
+    // -----------------------------------------------------------------------------
+
+    float* GetViewMatrix(float* _pEye, float* _pAt, float* _pUp, float* _pResultMatrix)
+    {
+        float Direction[3] = { _pAt[0] - _pEye[0], _pAt[1] - _pEye[1], _pAt[2] - _pEye[2] };
+
+        float AxisZ[3];
+        float AxisX[3];
+        float AxisY[3];
+
+        GetNormalizedVector(Direction, AxisZ);
+        GetNormalizedVector(GetCrossProduct(_pUp, AxisZ, AxisX), AxisX);
+        GetCrossProduct(AxisZ, AxisX, AxisY);
+
+        return SetMatrix(
+            AxisX[0], AxisY[0], AxisZ[0], 0.0f,
+            AxisX[1], AxisY[1], AxisZ[1], 0.0f,
+            AxisX[2], AxisY[2], AxisZ[2], 0.0f,
+            -GetDotProduct3D(AxisX, _pEye), -GetDotProduct3D(AxisY, _pEye), -GetDotProduct3D(AxisZ, _pEye), 1.0f, _pResultMatrix);
+    }
+
+    // -----------------------------------------------------------------------------
+    // Left-handed perspective projection onto a depth from 0 at the near plane
+    // to 1 at the far plane.
+    // -----------------------------------------------------------------------------
+
+    float* GetProjectionMatrix(float _FieldOfViewY, float _AspectRatio, float _Near, float _Far, float* _pResultMatrix)
+    {
+        float ScaleY = 1.0f / std::tan(GetRadians(_FieldOfViewY) * 0.5f);
+        float ScaleX = ScaleY / _AspectRatio;
+        float ScaleZ = _Far / (_Far - _Near);
+
+        return SetMatrix(
+            ScaleX, 0.0f,   0.0f,            0.0f,
+            0.0f,   ScaleY, 0.0f,            0.0f,
+            0.0f,   0.0f,   ScaleZ,          1.0f,
+            0.0f,   0.0f,   -_Near * ScaleZ, 0.0f, _pResultMatrix);
+    }
+
+    // -----------------------------------------------------------------------------
+    // Maps the unit square with y pointing down, i.e. texture coordinates, onto
+    // the whole render target.
+    // -----------------------------------------------------------------------------
+
+    float* GetScreenMatrix(float* _pResultMatrix)
+    {
+        return SetMatrix(
+             2.0f,  0.0f, 0.0f, 0.0f,
+             0.0f, -2.0f, 0.0f, 0.0f,
+             0.0f,  0.0f, 1.0f, 0.0f,
+            -1.0f,  1.0f, 0.0f, 1.0f, _pResultMatrix);
+    }
+} // namespace gfx